@@ -0,0 +1,8 @@
+#version 330 core
+
+layout(location = 0) out vec4 FragColor;
+
+void main()
+{
+	FragColor = vec4(0.5f, 0.5f, 0.5f, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#version 330 core
+
+// Passes on the particles that are still alive, the dead ones are left out of the captured buffer
+layout(points) in;
+layout(points, max_vertices = 1) out;
+
+in vec3 Position[];
+in vec3 Velocity[];
+in vec2 Age[];
+
+out vec3 outPosition;
+out vec3 outVelocity;
+out vec2 outAge;
+
+void main()
+{
+	if (Age[0].x < Age[0].y)
+	{
+		outPosition = Position[0];
+		outVelocity = Velocity[0];
+		outAge = Age[0];
+		EmitVertex();
+		EndPrimitive();
+	}
+}
\ No newline at end of file
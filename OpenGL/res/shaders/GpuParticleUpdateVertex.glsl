@@ -0,0 +1,78 @@
+#version 330 core
+
+// State of one particle, also the layout GLBasics::GpuParticleSystem captures with transform feedback
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec3 aVelocity;
+layout(location = 2) in vec2 aAge;  // age and lifetime in seconds
+
+out vec3 Position;
+out vec3 Velocity;
+out vec2 Age;
+
+uniform float deltaTime;
+uniform vec3 gravity;
+uniform float damping;
+uniform float bounce;
+
+// MAX_PLANES is defined by GLBasics::GpuParticleSystem
+// Normal in xyz and distance from the origin in w, particles are kept on the side the normal points to
+uniform vec4 planes[MAX_PLANES];
+uniform int planeCount;
+
+// Set for the draw that emits, which turns every vertex it draws into a new particle
+uniform bool emitting;
+uniform uint seed;
+uniform vec3 emitterPosition;
+uniform vec3 emitterExtent;
+uniform vec3 emitterVelocity;
+uniform vec3 velocitySpread;
+uniform vec2 lifetimeRange;
+
+uint randomState;
+
+// PCG hash of a running state, in [0, 1)
+float Random()
+{
+	randomState = randomState * 747796405u + 2891336453u;
+	uint word = ((randomState >> ((randomState >> 28u) + 4u)) ^ randomState) * 277803737u;
+	word = (word >> 22u) ^ word;
+	return float(word >> 8u) / 16777216.0f;
+}
+
+vec3 RandomSigned3()
+{
+	float x = Random();
+	float y = Random();
+	float z = Random();
+	return vec3(x, y, z) * 2.0f - 1.0f;
+}
+
+void main()
+{
+	if (emitting)
+	{
+		randomState = uint(gl_VertexID) ^ (seed * 2654435769u);
+		Position = emitterPosition + RandomSigned3() * emitterExtent;
+		Velocity = emitterVelocity + RandomSigned3() * velocitySpread;
+		Age = vec2(0.0f, mix(lifetimeRange.x, lifetimeRange.y, Random()));
+		return;
+	}
+
+	Age = vec2(aAge.x + deltaTime, aAge.y);
+	Velocity = aVelocity * damping + gravity * deltaTime;
+	Position = aPosition + Velocity * deltaTime;
+	for (int i = 0; i < planeCount; i++)
+	{
+		float distance = dot(planes[i].xyz, Position) - planes[i].w;
+		if (distance < 0.0f)
+		{
+			// pushed back onto the plane, and the speed into it reflected
+			Position -= planes[i].xyz * distance;
+			float speed = dot(planes[i].xyz, Velocity);
+			if (speed < 0.0f)
+			{
+				Velocity -= planes[i].xyz * (speed * bounce);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#version 330 core
+
+layout(location = 0) in vec3 aPosition;
+layout(location = 2) in vec2 aAge;  // age and lifetime in seconds
+
+out vec4 Color;
+
+uniform vec4 startColor;
+uniform vec4 endColor;
+// Size at birth in x and at death in y, the height of the viewport in pixels in z
+uniform vec4 sizeRamp;
+#include "include/Camera.glsl"
+
+void main()
+{
+	float t = aAge.x / aAge.y;
+	gl_Position = projection * view * vec4(aPosition, 1.0f);
+	// a point sprite as wide as the billboard of the CPU particles, size being half of it
+	gl_PointSize = max(mix(sizeRamp.x, sizeRamp.y, t) * projection[1][1] * sizeRamp.z / gl_Position.w, 1.0f);
+	Color = mix(startColor, endColor, t);
+}
\ No newline at end of file
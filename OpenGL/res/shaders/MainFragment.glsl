@@ -1,13 +1,73 @@
 #version 330 core
 
+// Number of textures blended together, 1 samples sampler0 only
+#ifndef TEXTURE_COUNT
+#define TEXTURE_COUNT 2
+#endif
+
+// YUV_TEXTURE samples the planes of a video frame instead and VIRTUAL_TEXTURE a virtual
+// texture, VIRTUAL_TEXTURE_FEEDBACK writes the pages it needs for GLBasics::VirtualTextureFeedback
+#ifdef VIRTUAL_TEXTURE_FEEDBACK
+layout(location = 0) out uvec4 Feedback;
+#else
 layout(location = 0) out vec4 FragColor;
+#endif
 
 in vec2 TexCoord;
 
+// SHADOWS lights the surface by the directional light of GLBasics::CascadedShadowMap
+#ifdef SHADOWS
+in vec3 WorldPosition;
+in vec3 Normal;
+in float ViewDistance;
+
+#include "include/Shadows.glsl"
+#endif
+
+#if defined(YUV_TEXTURE)
+#include "include/YUV.glsl"
+#elif defined(VIRTUAL_TEXTURE) || defined(VIRTUAL_TEXTURE_FEEDBACK)
+#include "include/VirtualTexture.glsl"
+#elif defined(TEXTURE_ARRAY)
+flat in float TextureLayer;
+
+uniform sampler2DArray samplerArray;
+#else
 uniform sampler2D sampler0;
+#if TEXTURE_COUNT > 1
 uniform sampler2D sampler1;
+#endif
+#endif
 
 void main()
 {
+#if defined(VIRTUAL_TEXTURE_FEEDBACK)
+	Feedback = VirtualTextureFeedback(TexCoord);
+#elif defined(YUV_TEXTURE)
+	FragColor = SampleYUV(TexCoord);
+#elif defined(VIRTUAL_TEXTURE)
+	FragColor = VirtualTextureSample(TexCoord);
+#elif defined(TEXTURE_ARRAY)
+	FragColor = texture(samplerArray, vec3(TexCoord, TextureLayer));
+#elif TEXTURE_COUNT > 1
 	FragColor = mix(texture(sampler0, TexCoord), texture(sampler1, TexCoord), 0.2f);
+#else
+	FragColor = texture(sampler0, TexCoord);
+#endif
+
+#if defined(SHADOWS) && !defined(VIRTUAL_TEXTURE_FEEDBACK)
+	// A quarter of the light reaches everywhere, the rest only what faces it and isn't shadowed
+	vec3 normal = normalize(Normal);
+	float diffuse = max(dot(normal, -lightDirection.xyz), 0.0f);
+	float shadow = diffuse > 0.0f ? SampleShadow(WorldPosition, normal, ViewDistance) : 0.0f;
+	FragColor.rgb *= 0.25f + 0.75f * diffuse * shadow;
+#endif
+
+	// ALPHA_TEST holds the alpha below which fragments are discarded
+#if defined(ALPHA_TEST) && !defined(VIRTUAL_TEXTURE_FEEDBACK)
+	if (FragColor.a < ALPHA_TEST)
+	{
+		discard;
+	}
+#endif
 }
\ No newline at end of file
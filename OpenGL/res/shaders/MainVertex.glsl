@@ -2,15 +2,80 @@
 
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec2 aTexCoord;
+// location 2 is the normal of a Mesh, SHADOWS lights the surface with it
+#ifdef SHADOWS
+layout(location = 2) in vec2 aNormal;
+#endif
+#ifdef INSTANCING
+layout(location = 3) in mat4 aModel;
+#ifdef TEXTURE_ARRAY
+layout(location = 7) in vec4 aTextureRect;
+layout(location = 8) in float aTextureLayer;
+#endif
+#endif
 
 out vec2 TexCoord;
+#ifdef TEXTURE_ARRAY
+flat out float TextureLayer;
+#endif
+#ifdef SHADOWS
+out vec3 WorldPosition;
+out vec3 Normal;
+out float ViewDistance;
+#endif
 
+#ifndef INSTANCING
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#ifdef SHADOWS
+// The inverse transpose of the model matrix, without the position transform of a Mesh
+uniform mat4 normalMatrix;
+#endif
+#ifdef TEXTURE_ARRAY
+// Region of the texture array the object samples, offset in xy and scale in zw
+uniform vec4 textureRect;
+uniform int textureLayer;
+#endif
+#endif
+#include "include/Camera.glsl"
+
+#ifdef SHADOWS
+// Utils::VertexQuantizer::DecodeOctahedral
+vec3 DecodeOctahedral(vec2 encoded)
+{
+	vec3 normal = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-normal.z, 0.0f);
+	normal.xy += mix(vec2(fold), vec2(-fold), greaterThanEqual(normal.xy, vec2(0.0f)));
+	return normalize(normal);
+}
+#endif
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0f);
+#ifdef INSTANCING
+	vec4 worldPosition = aModel * vec4(aPos, 1.0f);
+#else
+	vec4 worldPosition = model * vec4(aPos, 1.0f);
+#endif
+	gl_Position = projection * view * worldPosition;
+
+#ifdef SHADOWS
+	WorldPosition = worldPosition.xyz;
+	ViewDistance = -(view * worldPosition).z;
+#ifdef INSTANCING
+	// Instances are taken to be scaled the same on every axis
+	Normal = mat3(aModel) * DecodeOctahedral(aNormal);
+#else
+	Normal = mat3(normalMatrix) * DecodeOctahedral(aNormal);
+#endif
+#endif
+
+#if defined(TEXTURE_ARRAY) && defined(INSTANCING)
+	TexCoord = aTextureRect.xy + aTexCoord * aTextureRect.zw;
+	TextureLayer = aTextureLayer;
+#elif defined(TEXTURE_ARRAY)
+	TexCoord = textureRect.xy + aTexCoord * textureRect.zw;
+	TextureLayer = float(textureLayer);
+#else
 	TexCoord = aTexCoord;
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,23 @@
+#version 330 core
+
+layout(location = 0) out vec4 FragColor;
+
+// POINT_SPRITE takes the corner from the point being drawn instead of the vertex shader
+#ifndef POINT_SPRITE
+in vec2 Corner;
+#endif
+in vec4 Color;
+
+void main()
+{
+#ifdef POINT_SPRITE
+	vec2 Corner = gl_PointCoord * 2.0f - 1.0f;
+#endif
+	// A round dot fading out towards its edge
+	float falloff = 1.0f - dot(Corner, Corner);
+	if (falloff <= 0.0f)
+	{
+		discard;
+	}
+	FragColor = vec4(Color.rgb, Color.a * falloff);
+}
\ No newline at end of file
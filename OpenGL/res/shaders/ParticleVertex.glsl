@@ -0,0 +1,20 @@
+#version 330 core
+
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in float aSize;
+layout(location = 2) in vec4 aColor;
+
+out vec2 Corner;
+out vec4 Color;
+
+#include "include/Camera.glsl"
+
+void main()
+{
+	// Four vertices per instance drawn as a strip, the corners of a square facing the camera
+	Corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0f - 1.0f;
+	vec4 viewPosition = view * vec4(aPosition, 1.0f);
+	viewPosition.xy += Corner * aSize;
+	gl_Position = projection * viewPosition;
+	Color = aColor;
+}
\ No newline at end of file
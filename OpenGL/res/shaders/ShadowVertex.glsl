@@ -0,0 +1,12 @@
+#version 330 core
+
+layout(location = 0) in vec3 aPos;
+
+uniform mat4 model;
+// World to the clip space of the cascade being drawn, GLBasics::CascadedShadowMap::GetLightMatrix
+uniform mat4 lightMatrix;
+
+void main()
+{
+	gl_Position = lightMatrix * model * vec4(aPos, 1.0f);
+}
\ No newline at end of file
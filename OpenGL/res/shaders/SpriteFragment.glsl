@@ -0,0 +1,14 @@
+#version 330 core
+
+layout(location = 0) out vec4 FragColor;
+
+in vec2 TexCoord;
+flat in float TextureLayer;
+in vec4 Color;
+
+uniform sampler2DArray sprites;
+
+void main()
+{
+	FragColor = texture(sprites, vec3(TexCoord, TextureLayer)) * Color;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#version 330 core
+
+layout(location = 0) in vec2 aPosition;
+layout(location = 1) in vec2 aSize;
+layout(location = 2) in float aRotation;
+layout(location = 3) in float aLayer;
+layout(location = 4) in vec4 aUVRect;
+layout(location = 5) in vec4 aColor;
+
+out vec2 TexCoord;
+flat out float TextureLayer;
+out vec4 Color;
+
+// The 2D projection, such as Maths::GetOrthoProjMatrix
+uniform mat4 projection;
+
+void main()
+{
+	// Four vertices per instance drawn as a strip, the corners of the quad around its center
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+	vec2 offset = (corner - 0.5f) * aSize;
+	float s = sin(aRotation);
+	float c = cos(aRotation);
+	gl_Position = projection * vec4(aPosition + vec2(c * offset.x - s * offset.y, s * offset.x + c * offset.y), 0.0f, 1.0f);
+
+	TexCoord = aUVRect.xy + corner * aUVRect.zw;
+	TextureLayer = aLayer;
+	Color = aColor;
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#version 330 core
+
+layout(location = 0) out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec4 Color;
+
+// The signed distance field in alpha, 0.5 on the outline
+uniform sampler2D atlas;
+
+void main()
+{
+	float distance = texture(atlas, TexCoord).a;
+	// About one pixel of antialiasing at any scale
+	float smoothing = max(fwidth(distance) * 0.7f, 1.0f / 255.0f);
+	float alpha = smoothstep(0.5f - smoothing, 0.5f + smoothing, distance);
+	if (alpha <= 0.0f)
+	{
+		discard;
+	}
+	FragColor = vec4(Color.rgb, Color.a * alpha);
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#version 330 core
+
+layout(location = 0) in vec3 aAnchor;
+layout(location = 1) in uint aSpace;
+layout(location = 2) in vec2 aOffset;
+layout(location = 3) in vec2 aSize;
+layout(location = 4) in vec4 aUVRect;
+layout(location = 5) in vec4 aColor;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+#include "include/Camera.glsl"
+
+// The size of the viewport in pixels in xy
+uniform vec4 viewport;
+
+// GLBasics::TextSpace
+const uint SPACE_SCREEN = 0u;
+const uint SPACE_WORLD = 1u;
+const uint SPACE_OVERLAY = 2u;
+
+void main()
+{
+	// Four vertices per instance drawn as a strip, the corners of the glyph quad
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+	vec2 offset = aOffset + corner * aSize;
+	if (aSpace == SPACE_WORLD)
+	{
+		// Along the right and up axes of the camera, so the text faces it
+		vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+		vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+		gl_Position = projection * view * vec4(aAnchor + right * offset.x + up * offset.y, 1.0f);
+	}
+	else if (aSpace == SPACE_OVERLAY)
+	{
+		gl_Position = projection * view * vec4(aAnchor, 1.0f);
+		gl_Position.xy += offset * 2.0f / viewport.xy * gl_Position.w;
+		// Behind the camera the offset would flip, clip the label instead
+		if (gl_Position.w <= 0.0f)
+		{
+			gl_Position = vec4(2.0f, 2.0f, 2.0f, 1.0f);
+		}
+	}
+	else
+	{
+		gl_Position = vec4((aAnchor.xy + offset) * 2.0f / viewport.xy - 1.0f, 0.0f, 1.0f);
+	}
+
+	TexCoord = aUVRect.xy + corner * aUVRect.zw;
+	Color = aColor;
+}
\ No newline at end of file
@@ -0,0 +1,3 @@
+// Camera matrices shared by every shader that draws into the 3D scene
+uniform mat4 view;
+uniform mat4 projection;
\ No newline at end of file
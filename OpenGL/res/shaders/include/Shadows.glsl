@@ -0,0 +1,37 @@
+// Cascaded shadows of a directional light, the uniforms are set by GLBasics::CascadedShadowMap::SetUniforms
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 lightMatrices[4];
+uniform int cascadeCount;
+// How far from the camera each cascade reaches, and the width of its texels in world units
+uniform vec4 cascadeSplits;
+uniform vec4 cascadeTexelSizes;
+// Where the light shines towards in xyz
+uniform vec4 lightDirection;
+
+// How much light reaches a point, 0 in shadow and 1 lit
+float SampleShadow(vec3 worldPosition, vec3 normal, float viewDistance)
+{
+	if (viewDistance > cascadeSplits[cascadeCount - 1])
+	{
+		return 1.0f;
+	}
+	int cascade = 0;
+	while (viewDistance > cascadeSplits[cascade])
+	{
+		cascade++;
+	}
+
+	// Pushed out along the normal by a texel and a half so surfaces don't shadow themselves
+	vec3 position = worldPosition + normal * cascadeTexelSizes[cascade] * 1.5f;
+	vec3 coords = (lightMatrices[cascade] * vec4(position, 1.0f)).xyz * 0.5f + 0.5f;
+
+	// Four taps a texel apart, each filtered over 2x2 texels by the comparison
+	vec2 texel = 1.0f / vec2(textureSize(shadowMap, 0).xy);
+	float lit = 0.0f;
+	for (int i = 0; i < 4; i++)
+	{
+		vec2 offset = vec2(i & 1, i >> 1) - 0.5f;
+		lit += texture(shadowMap, vec4(coords.xy + offset * texel, float(cascade), coords.z));
+	}
+	return lit * 0.25f;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+// Sampling of virtual textures, see GLBasics::VirtualTexture. Pages are looked up in the
+// indirection texture, which points every page at the finest resident page covering it
+uniform sampler2D vtIndirection;
+uniform sampler2D vtCache;
+// x: pages per side on level 0, y: level count, z: page size in texels, w: feedback id
+uniform vec4 vtInfo;
+// x: slot size, y: border, z: page size, all over the cache size; w: mip bias of the feedback pass
+uniform vec4 vtCacheInfo;
+
+// The level whose texels are about as large as the pixels, from the screen space derivatives
+int VirtualTextureMip(vec2 uv)
+{
+	vec2 texels = uv * vtInfo.x * vtInfo.z;
+	vec2 dx = dFdx(texels);
+	vec2 dy = dFdy(texels);
+	float lod = 0.5f * log2(max(dot(dx, dx), dot(dy, dy))) + vtCacheInfo.w;
+	return int(clamp(floor(lod), 0.0f, vtInfo.y - 1.0f));
+}
+
+// The page the texel at uv lies in on a level, textures repeat
+ivec2 VirtualTexturePage(vec2 uv, int mip)
+{
+	float pages = max(vtInfo.x / exp2(float(mip)), 1.0f);
+	return min(ivec2(fract(uv) * pages), ivec2(pages - 1.0f));
+}
+
+// What the feedback pass writes for a fragment, id 0 is left for the cleared background
+uvec4 VirtualTextureFeedback(vec2 uv)
+{
+	int mip = VirtualTextureMip(uv);
+	return uvec4(uvec2(VirtualTexturePage(uv, mip)), uint(mip), uint(vtInfo.w));
+}
+
+vec4 VirtualTextureSample(vec2 uv)
+{
+	int mip = VirtualTextureMip(uv);
+	// xy: slot in the cache, z: level of the page held there
+	vec3 entry = texelFetch(vtIndirection, VirtualTexturePage(uv, mip), mip).xyz * 255.0f;
+	float pages = max(vtInfo.x / exp2(entry.z), 1.0f);
+	vec2 inPage = fract(fract(uv) * pages);
+	return texture(vtCache, floor(entry.xy + 0.5f) * vtCacheInfo.x + vtCacheInfo.y + inPage * vtCacheInfo.z);
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+// Turns the planes of a GLBasics::StreamingTexture holding I420 or, with YUV_NV12, NV12 frames into RGB
+uniform sampler2D yuvPlaneY;
+#ifdef YUV_NV12
+uniform sampler2D yuvPlaneUV;
+#else
+uniform sampler2D yuvPlaneU;
+uniform sampler2D yuvPlaneV;
+#endif
+
+// BT.709 with limited range, what HD and 4K video is encoded with
+vec4 SampleYUV(vec2 uv)
+{
+	float y = texture(yuvPlaneY, uv).r;
+#ifdef YUV_NV12
+	vec2 chroma = texture(yuvPlaneUV, uv).rg;
+#else
+	vec2 chroma = vec2(texture(yuvPlaneU, uv).r, texture(yuvPlaneV, uv).r);
+#endif
+
+	y = (y - 16.0f / 255.0f) * (255.0f / 219.0f);
+	chroma = (chroma - 128.0f / 255.0f) * (255.0f / 224.0f);
+	vec3 rgb = vec3(y + 1.5748f * chroma.y, y - 0.1873f * chroma.x - 0.4681f * chroma.y, y + 1.8556f * chroma.x);
+	return vec4(clamp(rgb, 0.0f, 1.0f), 1.0f);
+}
\ No newline at end of file
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
 
 #include <Gl/glew.h>
@@ -7,13 +10,30 @@
 #include <GLM/glm.hpp>
 #include <GLM/gtx/string_cast.hpp>
 
-#include "GLBasics/VertexArray.h"
-#include "GLBasics/VertexBuffer.h"
-#include "GLBasics/VertexBufferLayout.h"
-#include "GLBasics/IndexBuffer.h"
+#include "GLBasics/CascadedShadowMap.h"
+#include "GLBasics/Font.h"
+#include "GLBasics/GpuParticleSystem.h"
+#include "GLBasics/Mesh.h"
+#include "GLBasics/MeshBufferPool.h"
+#include "GLBasics/ParticleBuffer.h"
+#include "GLBasics/VertexArrayCache.h"
 #include "GLBasics/Shader.h"
+#include "GLBasics/ShaderCompileQueue.h"
+#include "GLBasics/ShaderReloader.h"
+#include "GLBasics/ShaderVariantCache.h"
+#include "GLBasics/SpriteBatch.h"
+#include "GLBasics/TextBatch.h"
+#include "GLBasics/FrameCapture.h"
+#include "GLBasics/ReadbackService.h"
 #include "GLBasics/Texture.h"
+#include "GLBasics/TextureCache.h"
+#include "GLBasics/TextureLoader.h"
+#include "GLBasics/TexturePacker.h"
 #include "Utils/MainUtils.h"
+#include "Utils/MeshImporter.h"
+#include "Utils/MeshOptimizer.h"
+#include "Utils/ParticleSystem.h"
+#include "Utils/ThreadPool.h"
 #include "Maths/Projection.h"
 #include "Maths/View.h"
 #include "Maths/Model.h"
@@ -64,55 +84,6 @@ int main(void)
 
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-    float vertices[] = {
-    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-     0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
-     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-
-    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-    -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-
-    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-    -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-     0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
-     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-
-    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-    -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
-    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
-    };
-
-    const unsigned int indices[] = {
-        0, 1, 2,
-        2, 3, 0
-    };
-
     glm::vec3 cubePositions[] = {
     glm::vec3(0.0f,  0.0f,  0.0f),
     glm::vec3(2.0f,  5.0f, -15.0f),
@@ -126,22 +97,82 @@ int main(void)
     glm::vec3(-1.3f,  1.0f, -1.5f)
     };
 
-    const auto vbo = new GLBasics::VertexBuffer(vertices, 36 * 5 * sizeof(float));
-    const auto vbl = new GLBasics::VertexBufferLayout();
-    vbl->Push<float>(3);
-    vbl->Push<float>(2);
-    const auto ibo = new GLBasics::IndexBuffer(indices, 6);
-    const auto vao = new GLBasics::VertexArray();
-    vao->BindBuffer(*vbo, *vbl, *ibo);
-
-    const auto shader = new GLBasics::Shader("res/shaders/MainVertex.glsl", "res/shaders/MainFragment.glsl");
-
-    const auto texture0 = new GLBasics::Texture("res/textures/container.jpg");
-    const auto texture1 = new GLBasics::Texture("res/textures/awesomeface.png");
+    const auto shaderQueue = new GLBasics::ShaderCompileQueue();
+    const auto fallbackShader = new GLBasics::Shader("res/shaders/FallbackVertex.glsl", "res/shaders/FallbackFragment.glsl");
+    shaderQueue->SetFallback(fallbackShader);
+    const auto shaderVariants = new GLBasics::ShaderVariantCache(shaderQueue);
+    auto blendedShader = shaderVariants->Get("res/shaders/MainVertex.glsl", "res/shaders/MainFragment.glsl");
+    auto singleTextureShader = shaderVariants->Get("res/shaders/MainVertex.glsl", "res/shaders/MainFragment.glsl",
+        { { "TEXTURE_COUNT", "1" } });
+    auto particleShader = shaderVariants->Get("res/shaders/ParticleVertex.glsl", "res/shaders/ParticleFragment.glsl");
+    auto gpuParticleShader = shaderVariants->Get("res/shaders/GpuParticleVertex.glsl", "res/shaders/ParticleFragment.glsl",
+        { { "POINT_SPRITE", "" } });
+    auto spriteShader = shaderVariants->Get("res/shaders/SpriteVertex.glsl", "res/shaders/SpriteFragment.glsl");
+    auto textShader = shaderVariants->Get("res/shaders/TextVertex.glsl", "res/shaders/TextFragment.glsl");
+    auto shadowedShader = shaderVariants->Get("res/shaders/MainVertex.glsl", "res/shaders/MainFragment.glsl", { { "SHADOWS", "" } });
+    auto shadowCasterShader = shaderVariants->Get("res/shaders/ShadowVertex.glsl", "res/shaders/ShadowFragment.glsl");
+    const auto shaderReloader = new GLBasics::ShaderReloader(window);
+    shaderReloader->Watch(*blendedShader);
+    shaderReloader->Watch(*singleTextureShader);
+    shaderReloader->Watch(*particleShader);
+    shaderReloader->Watch(*gpuParticleShader);
+    shaderReloader->Watch(*spriteShader);
+    shaderReloader->Watch(*textShader);
+    shaderReloader->Watch(*shadowedShader);
+    shaderReloader->Watch(*shadowCasterShader);
+
+    const auto threadPool = new Utils::ThreadPool();
+    Utils::MeshData cubeData;
+    if (!Utils::MeshImporter::Import("res/models/cube.obj", cubeData, threadPool))
+    {
+        // the demo goes on with an empty mesh, which draws nothing
+        std::cout << "ERROR::APPLICATION::MESH_NOT_IMPORTED res/models/cube.obj" << std::endl;
+    }
+    const Utils::MeshOptimizationReport cubeReport = Utils::MeshOptimizer::Optimize(cubeData);
+    const auto vertexArrayCache = new GLBasics::VertexArrayCache();
+    // a fountain of up to a million particles bouncing off the floor below the cubes
+    const auto particles = new Utils::ParticleSystem(1000000);
+    particles->GetSettings().emitterPosition = glm::vec3(0.0f, -3.0f, -6.0f);
+    particles->GetSettings().emitRate = 300000.0f;
+    particles->AddPlane({ glm::vec3(0.0f, 1.0f, 0.0f), -4.0f });
+    const auto particleBuffer = new GLBasics::ParticleBuffer(particles->GetCapacity());
+    // the same fountain simulated on the GPU instead
+    const auto gpuParticles = new GLBasics::GpuParticleSystem(particles->GetCapacity());
+    gpuParticles->GetSettings() = particles->GetSettings();
+    gpuParticles->AddPlane({ glm::vec3(0.0f, 1.0f, 0.0f), -4.0f });
+    const auto meshBufferPool = new GLBasics::MeshBufferPool(*vertexArrayCache, sizeof(Utils::QuantizedVertex));
+    const auto cube = new GLBasics::Mesh(cubeData, vertexArrayCache, meshBufferPool);
+    const auto textureLoader = new GLBasics::TextureLoader(*threadPool);
+    textureLoader->SetMipGeneration({}, "cache/mips");
+    const auto textureCache = new GLBasics::TextureCache(*textureLoader);
+    const auto readbackService = new GLBasics::ReadbackService();
+    const auto frameCapture = new GLBasics::FrameCapture(*readbackService, *threadPool, "captures");
+    auto texture0 = textureCache->Get("res/textures/container.jpg");
+    auto texture1 = textureCache->Get("res/textures/awesomeface.png");
+    // the images the sprites are drawn with, the small round dot is packed into an atlas
+    unsigned char spriteDot[16 * 16 * 4];
+    for (int i = 0; i < 16 * 16; i++)
+    {
+        const float x = (i % 16 - 7.5f) / 8.0f, y = (i / 16 - 7.5f) / 8.0f;
+        spriteDot[i * 4 + 0] = spriteDot[i * 4 + 1] = spriteDot[i * 4 + 2] = 255;
+        spriteDot[i * 4 + 3] = static_cast<unsigned char>(std::max(1.0f - (x * x + y * y), 0.0f) * 255.0f);
+    }
+    const auto spritePacker = new GLBasics::TexturePacker();
+    const int spriteImages[] = { spritePacker->Add("res/textures/container.jpg"), spritePacker->Add("res/textures/awesomeface.png"),
+                                 spritePacker->Add(16, 16, spriteDot) };
+    spritePacker->Build();
+    const auto spriteBatch = new GLBasics::SpriteBatch();
+    // cooked from a system font before the build, see the README
+    const auto font = new GLBasics::Font("res/fonts/segoeui.json");
+    const auto textBatch = new GLBasics::TextBatch();
+    const auto shadowMap = new GLBasics::CascadedShadowMap();
     texture0->Bind(0);
-    shader->SetUniform1i("sampler0", 0);
+    blendedShader->SetUniform1i("sampler0", 0);
+    singleTextureShader->SetUniform1i("sampler0", 0);
+    shadowedShader->SetUniform1i("sampler0", 0);
     texture1->Bind(1);
-    shader->SetUniform1i("sampler1", 1);
+    blendedShader->SetUniform1i("sampler1", 1);
+    shadowedShader->SetUniform1i("sampler1", 1);
 
     const auto camera = new Maths::ViewMatrix({0.0f, 0.0f, -3.0f}, {0.0f, 1.0f, 0.0f}, 0.0f, 0.0f);
     Utils::UpdateCamera(camera);
@@ -159,6 +190,24 @@ int main(void)
     bool useBlending = false;
     bool useWireFrameMode = false;
     bool useDepthTest = false;
+    bool useSingleTexture = false;
+    bool recordFrames = false;
+    bool useParticleSimd = particles->IsSimdEnabled();
+    bool useGpuParticles = false;
+    double particleUpdateTime = 0.0;
+    double benchmarkScalar = 0.0, benchmarkSimd = 0.0;
+    bool drawSprites = false;
+    int spriteCount = 100000;
+    double spriteBatchTime = 0.0;
+    bool drawText = false;
+    int labelCount = 2000;
+    double textBatchTime = 0.0;
+    bool drawShadows = false;
+    bool cacheStaticShadows = true;
+    float lightAngle = 30.0f;
+    unsigned int shadowCasterDraws = 0;
+    unsigned int staticShadowCasters = 0;   // per cascade, as of the last time the static casters were drawn
+    unsigned int dynamicShadowCasters = 0;  // per cascade
     // ImGui environment ends
 
     
@@ -171,6 +220,85 @@ int main(void)
         Utils::deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
+        shaderQueue->Update();
+        shaderReloader->Update();
+        textureLoader->Update();
+        textureCache->Update();
+        readbackService->Update();
+
+        {
+            const double updateStart = glfwGetTime();
+            // a long hitch would otherwise throw the particles through the floor
+            const float particleDeltaTime = std::min(Utils::deltaTime, 0.1f);
+            if (useGpuParticles)
+            {
+                gpuParticles->Update(particleDeltaTime);
+            }
+            else
+            {
+                particles->SetSimdEnabled(useParticleSimd);
+                particles->Update(particleDeltaTime, threadPool);
+                particleBuffer->Upload(*particles, threadPool);
+            }
+            particleUpdateTime = (glfwGetTime() - updateStart) * 1000.0;
+        }
+
+        if (drawSprites)
+        {
+            const double batchStart = glfwGetTime();
+            // a spinning disc of sprites, added with their images and layers interleaved so they need sorting
+            spriteBatch->Begin();
+            for (int i = 0; i < spriteCount; i++)
+            {
+                const GLBasics::TextureRegion& region = spritePacker->GetRegion(spriteImages[i % 3]);
+                const float radius = std::sqrt((i + 0.5f) / spriteCount);
+                const float angle = i * 2.39996f + currentFrame * 0.2f;
+                GLBasics::Sprite sprite;
+                sprite.position = glm::vec2(std::cos(angle), std::sin(angle)) * radius * 0.95f;
+                sprite.size = glm::vec2(i % 3 == 2 ? 0.012f : 0.008f);
+                sprite.rotation = currentFrame + i;
+                sprite.uvRect = region.rect;
+                sprite.color = i % 3 == 2 ? glm::vec4(1.0f, 0.6f + 0.4f * radius, 0.2f, 0.8f) : glm::vec4(1.0f);
+                sprite.texture = &spritePacker->GetArray(region.arrayIndex);
+                sprite.textureLayer = region.layer;
+                sprite.drawLayer = i % 3 == 2 ? 1 : 0;
+                spriteBatch->Draw(sprite);
+            }
+            spriteBatch->End();
+            spriteBatchTime = (glfwGetTime() - batchStart) * 1000.0;
+        }
+
+        if (drawText && font->IsLoaded())
+        {
+            const double batchStart = glfwGetTime();
+            // a title, a name over every cube and a cloud of labels around the fountain, most of them
+            // unchanged from frame to frame so only the frame time is laid out again
+            textBatch->Begin();
+            char line[64];
+            std::snprintf(line, sizeof(line), "%.1f FPS", ImGui::GetIO().Framerate);
+            textBatch->Draw(*font, "GLBasics text", glm::vec3(16.0f, Utils::windowHeight - 16.0f, 0.0f), 40.0f,
+                            glm::vec4(1.0f), GLBasics::TextSpace::Screen, glm::vec2(0.0f, 1.0f));
+            textBatch->Draw(*font, line, glm::vec3(16.0f, Utils::windowHeight - 60.0f, 0.0f), 20.0f,
+                            glm::vec4(1.0f, 1.0f, 0.6f, 1.0f), GLBasics::TextSpace::Screen, glm::vec2(0.0f, 1.0f));
+            for (int i = 0; i < 10; i++)
+            {
+                std::snprintf(line, sizeof(line), "Cube %d", i);
+                textBatch->Draw(*font, line, cubePositions[i] + glm::vec3(0.0f, 1.0f, 0.0f), 0.4f,
+                                glm::vec4(1.0f), GLBasics::TextSpace::World, glm::vec2(0.5f, 0.0f));
+            }
+            for (int i = 0; i < labelCount; i++)
+            {
+                const float angle = i * 2.39996f;
+                const float radius = 1.0f + 6.0f * std::sqrt((i + 0.5f) / labelCount);
+                const glm::vec3 position(std::cos(angle) * radius, -3.5f + (i % 7) * 0.5f, -6.0f + std::sin(angle) * radius);
+                std::snprintf(line, sizeof(line), "#%d", i);
+                textBatch->Draw(*font, line, position, 14.0f, glm::vec4(0.6f, 0.9f, 1.0f, 0.9f),
+                                GLBasics::TextSpace::Overlay, glm::vec2(0.5f));
+            }
+            textBatch->End();
+            textBatchTime = (glfwGetTime() - batchStart) * 1000.0;
+        }
+
         //                             green and grey ish color
         renderer->Clear(glm::vec4(0.2f, 0.3f, 0.3f, 1.0f));
 
@@ -184,6 +312,42 @@ int main(void)
             ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
             ImGui::Text("Window Width: %d", Utils::windowWidth);
             ImGui::Text("Window Height: %d", Utils::windowHeight);
+            ImGui::Text("Shaders compiling: %u", shaderQueue->GetPendingCount());
+            ImGui::Text("Textures loading: %u", textureLoader->GetPendingCount());
+            ImGui::Text("Textures cached: %u (%u paths)", textureCache->GetTextureCount(), textureCache->GetPathCount());
+            ImGui::Text("Shader variants: %u (%u programs)", shaderVariants->GetVariantCount(), shaderVariants->GetProgramCount());
+            ImGui::Text("Cube ACMR: %.2f -> %.2f, ATVR: %.2f -> %.2f", cubeReport.before.acmr, cubeReport.after.acmr,
+                        cubeReport.before.atvr, cubeReport.after.atvr);
+            ImGui::Text("VAO binds: %u (%u buffer binds, %u formats)", vertexArrayCache->GetVertexArrayBinds(),
+                        vertexArrayCache->GetBufferBinds(), vertexArrayCache->GetFormatCount());
+            ImGui::Text("Mesh arenas: %u (%zu / %zu KB used)", meshBufferPool->GetArenaCount(),
+                        meshBufferPool->GetUsedBytes() / 1024, meshBufferPool->GetCapacity() / 1024);
+            if (useGpuParticles)
+            {
+                ImGui::Text("GPU particles: up to %u (%.2f ms to submit the update)", gpuParticles->GetCapacity(), particleUpdateTime);
+            }
+            else
+            {
+                ImGui::Text("Particles: %u (%.2f ms to update and upload, %u orphaned)", particles->GetAliveCount(), particleUpdateTime,
+                            particleBuffer->GetOrphanCount());
+            }
+            if (drawSprites)
+            {
+                ImGui::Text("Sprites: %u in %zu draws (%.2f ms to batch and upload, %u orphaned)", spriteBatch->GetSpriteCount(),
+                            spriteBatch->GetBatches().size(), spriteBatchTime, spriteBatch->GetOrphanCount());
+            }
+            if (drawText)
+            {
+                ImGui::Text("Text: %u glyphs in %zu draws, %u layouts built (%zu cached, %.2f ms)", textBatch->GetGlyphCount(),
+                            textBatch->GetBatches().size(), textBatch->GetLayoutsBuilt(), textBatch->GetCachedLayoutCount(), textBatchTime);
+            }
+            if (drawShadows)
+            {
+                ImGui::Text("Shadows: %u caster draws (%u without the cache), %u of %u static redraws over %u frames",
+                            shadowCasterDraws, shadowMap->GetCascadeCount() * (staticShadowCasters + dynamicShadowCasters), shadowMap->GetStaticDrawTotal(),
+                            shadowMap->GetCascadeCount() * shadowMap->GetUpdateCount(), shadowMap->GetUpdateCount());
+            }
+            ImGui::Text("Frames captured: %u (%u skipped)", frameCapture->GetWrittenCount(), frameCapture->GetSkippedCount());
             ImGui::End();
         }
         
@@ -199,6 +363,31 @@ int main(void)
             ImGui::Checkbox("Use OpenGL blending", &useBlending);
             ImGui::Checkbox("Enable wireframe mode", &useWireFrameMode);
             ImGui::Checkbox("Enable OpenGL depth test", &useDepthTest);
+            ImGui::Checkbox("Use single texture shader variant", &useSingleTexture);
+            ImGui::Checkbox("Draw shadows", &drawShadows);
+            ImGui::Checkbox("Cache static shadow casters", &cacheStaticShadows);
+            ImGui::SliderFloat("Light angle", &lightAngle, 0.0f, 360.0f);
+            if (ImGui::Button("Save screenshot")) { frameCapture->TakeScreenshot(); }
+            ImGui::Checkbox("Record frames", &recordFrames);
+            ImGui::Checkbox("Draw sprites", &drawSprites);
+            ImGui::SliderInt("Sprite count", &spriteCount, 1, 100000);
+            if (font->IsLoaded())
+            {
+                ImGui::Checkbox("Draw text", &drawText);
+                ImGui::SliderInt("Label count", &labelCount, 0, 20000);
+            }
+            if (ImGui::Checkbox("Simulate particles on the GPU", &useGpuParticles))
+            {
+                particles->Clear();
+                gpuParticles->Clear();
+            }
+            if (Utils::ParticleSystem::IsSimdSupported()) { ImGui::Checkbox("Use AVX2 for particles", &useParticleSimd); }
+            if (ImGui::Button("Benchmark particle update"))
+            {
+                benchmarkScalar = Utils::ParticleSystem::Benchmark(1000000, 20, false, threadPool);
+                benchmarkSimd = Utils::ParticleSystem::Benchmark(1000000, 20, true, threadPool);
+            }
+            ImGui::Text("1M particles: %.2f ms scalar, %.2f ms AVX2", benchmarkScalar, benchmarkSimd);
             ImGui::End();
         }
 
@@ -208,17 +397,7 @@ int main(void)
         else
             projection = Maths::GetOrthoProjMatrix(static_cast<Maths::ScaleMode>(scaleMode), Utils::windowWidth, Utils::windowHeight);
 
-        shader->SetUniformMat4f("view", camera->GetMatrix());
-        shader->SetUniformMat4f("projection", projection);
-
-        if (useBlending) { renderer->EnableBlending(); }
-        else { renderer->DisableBlending(); }
-        if (useWireFrameMode) { renderer->EnableWireFrameMode(); }
-        else { renderer->DisableWireFrameMode(); }
-        if (useDepthTest) { renderer->EnableDepthTest(); }
-        else { renderer->DisableDepthTest(); }
-
-        for (int i = 0; i < 10; i++)
+        const auto cubeMatrix = [&](const int i)
         {
             Maths::ModelMatrix model(glm::mat4(1.0f));
             model.Translate(cubePositions[i]);
@@ -238,11 +417,142 @@ int main(void)
                 float angle = 20.0f * i;
                 model.Rotate(angle, glm::vec3(1.0f, 0.3f, 0.5f));
             }
-            shader->SetUniformMat4f("model", model.GetMatrix());
+            return model.GetMatrix();
+        };
+        // a slab under the cubes for the shadows to fall on
+        Maths::ModelMatrix floorModel(glm::mat4(1.0f));
+        floorModel.Translate(glm::vec3(0.0f, -4.1f, -7.0f));
+        floorModel.Scale(glm::vec3(30.0f, 0.2f, 30.0f));
+
+        if (drawShadows)
+        {
+            // the cubes turned by the model rotation are dynamic casters, the others and the floor are
+            // static and only drawn into the cache when the view or the light moved far enough
+            const float lightRadians = glm::radians(lightAngle);
+            shadowMap->SetLightDirection(glm::vec3(std::cos(lightRadians) * 0.5f, -1.0f, std::sin(lightRadians) * 0.5f));
+            if (!cacheStaticShadows) { shadowMap->InvalidateStatic(); }
+            shadowMap->Update(*camera, projection);
+
+            renderer->DisableWireFrameMode();
+            shadowCasterShader->Bind();
+            shadowCasterDraws = 0;
+            for (unsigned int cascade = 0; cascade < shadowMap->GetCascadeCount(); cascade++)
+            {
+                shadowCasterShader->SetUniformMat4f("lightMatrix", shadowMap->GetLightMatrix(cascade));
+                if (!shadowMap->IsStaticCached(cascade))
+                {
+                    shadowMap->BeginStatic(cascade);
+                    staticShadowCasters = 0;
+                    for (int i = 0; i < 10; i++)
+                    {
+                        if (i % 3 != 0)
+                        {
+                            shadowCasterShader->SetUniformMat4f("model", cubeMatrix(i) * cube->GetPositionTransform());
+                            renderer->DrawMesh(*cube, *shadowCasterShader);
+                            staticShadowCasters++;
+                        }
+                    }
+                    shadowCasterShader->SetUniformMat4f("model", floorModel.GetMatrix() * cube->GetPositionTransform());
+                    renderer->DrawMesh(*cube, *shadowCasterShader);
+                    staticShadowCasters++;
+                    shadowCasterDraws += staticShadowCasters;
+                    shadowMap->End();
+                }
+                shadowMap->BeginDynamic(cascade);
+                dynamicShadowCasters = 0;
+                for (int i = 0; i < 10; i += 3)
+                {
+                    shadowCasterShader->SetUniformMat4f("model", cubeMatrix(i) * cube->GetPositionTransform());
+                    renderer->DrawMesh(*cube, *shadowCasterShader);
+                    dynamicShadowCasters++;
+                }
+                shadowCasterDraws += dynamicShadowCasters;
+                shadowMap->End();
+            }
+        }
 
-            renderer->DrawArrays(GL_TRIANGLES, *vbo, *shader, 36);
+        const GLBasics::Shader* shader = useSingleTexture ? singleTextureShader.get() : blendedShader.get();
+        if (drawShadows) { shader = shadowedShader.get(); }
+        // uniforms go to the bound program
+        shader->Bind();
+        shader->SetUniformMat4f("view", camera->GetMatrix());
+        shader->SetUniformMat4f("projection", projection);
+        if (drawShadows)
+        {
+            shadowMap->Bind(2);
+            shadowMap->SetUniforms(*shader, 2);
         }
 
+        if (useBlending) { renderer->EnableBlending(); }
+        else { renderer->DisableBlending(); }
+        if (useWireFrameMode) { renderer->EnableWireFrameMode(); }
+        else { renderer->DisableWireFrameMode(); }
+        if (useDepthTest) { renderer->EnableDepthTest(); }
+        else { renderer->DisableDepthTest(); }
+
+        for (int i = 0; i < 10; i++)
+        {
+            const glm::mat4 model = cubeMatrix(i);
+            shader->SetUniformMat4f("model", model * cube->GetPositionTransform());
+            if (drawShadows) { shader->SetUniformMat4f("normalMatrix", glm::transpose(glm::inverse(model))); }
+
+            renderer->DrawMesh(*cube, *shader);
+        }
+        if (drawShadows)
+        {
+            shader->SetUniformMat4f("model", floorModel.GetMatrix() * cube->GetPositionTransform());
+            shader->SetUniformMat4f("normalMatrix", glm::transpose(glm::inverse(floorModel.GetMatrix())));
+            renderer->DrawMesh(*cube, *shader);
+        }
+        vertexArrayCache->Update();
+        meshBufferPool->Defragment();
+
+        renderer->EnableBlending();
+        if (useGpuParticles)
+        {
+            // uniforms go to the bound program
+            gpuParticleShader->Bind();
+            gpuParticleShader->SetUniformMat4f("view", camera->GetMatrix());
+            gpuParticleShader->SetUniformMat4f("projection", projection);
+            gpuParticles->SetUniforms(*gpuParticleShader, Utils::windowHeight);
+            renderer->DrawParticles(*gpuParticles, *gpuParticleShader);
+        }
+        else
+        {
+            particleShader->Bind();
+            particleShader->SetUniformMat4f("view", camera->GetMatrix());
+            particleShader->SetUniformMat4f("projection", projection);
+            renderer->DrawParticles(*particleBuffer, *particleShader);
+        }
+        if (drawSprites)
+        {
+            // over the scene, in the units of the 2D projection
+            renderer->DisableDepthTest();
+            spriteShader->Bind();
+            spriteShader->SetUniformMat4f("projection",
+                Maths::GetOrthoProjMatrix(static_cast<Maths::ScaleMode>(scaleMode), Utils::windowWidth, Utils::windowHeight));
+            spriteShader->SetUniform1i("sprites", 0);
+            renderer->DrawSprites(*spriteBatch, *spriteShader);
+            if (useDepthTest) { renderer->EnableDepthTest(); }
+        }
+        if (drawText && font->IsLoaded())
+        {
+            // labels stay readable through the cubes
+            renderer->DisableDepthTest();
+            textShader->Bind();
+            textShader->SetUniformMat4f("view", camera->GetMatrix());
+            textShader->SetUniformMat4f("projection", projection);
+            textShader->SetUniform4f("viewport", static_cast<float>(Utils::windowWidth), static_cast<float>(Utils::windowHeight), 0.0f, 0.0f);
+            textShader->SetUniform1i("atlas", 0);
+            renderer->DrawGlyphs(*textBatch, *textShader);
+            if (useDepthTest) { renderer->EnableDepthTest(); }
+        }
+        if (!useBlending) { renderer->DisableBlending(); }
+
+        // captured before the UI is drawn on top
+        frameCapture->SetRecording(recordFrames);
+        frameCapture->Capture(Utils::windowWidth, Utils::windowHeight);
+
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
@@ -254,13 +564,44 @@ int main(void)
         glfwPollEvents();
     }
 
-    delete(vao);
-    delete(vbo);
-    delete(vbl);
-    delete(ibo);
-    delete(shader);
-    delete(texture0);
-    delete(texture1);
+    delete(shadowMap);
+    delete(textBatch);
+    delete(font);
+    delete(spriteBatch);
+    delete(spritePacker);
+    delete(gpuParticles);
+    delete(particleBuffer);
+    delete(particles);
+    delete(cube);
+    delete(meshBufferPool);
+    delete(vertexArrayCache);
+    shaderReloader->Unwatch(*blendedShader);
+    shaderReloader->Unwatch(*singleTextureShader);
+    shaderReloader->Unwatch(*particleShader);
+    shaderReloader->Unwatch(*gpuParticleShader);
+    shaderReloader->Unwatch(*spriteShader);
+    shaderReloader->Unwatch(*textShader);
+    shaderReloader->Unwatch(*shadowedShader);
+    shaderReloader->Unwatch(*shadowCasterShader);
+    delete(shaderReloader);
+    blendedShader.reset();
+    singleTextureShader.reset();
+    particleShader.reset();
+    gpuParticleShader.reset();
+    spriteShader.reset();
+    textShader.reset();
+    shadowedShader.reset();
+    shadowCasterShader.reset();
+    delete(shaderVariants);
+    delete(fallbackShader);
+    delete(shaderQueue);
+    texture0.reset();
+    texture1.reset();
+    delete(textureCache);
+    delete(textureLoader);
+    delete(frameCapture);
+    delete(readbackService);
+    delete(threadPool);
     delete(camera);
     delete(renderer);
 
@@ -0,0 +1,252 @@
+#include "CascadedShadowMap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include <GLM/gtc/matrix_transform.hpp>
+
+#include "Shader.h"
+#include "../Maths/View.h"
+#include "../Utils/GLDebugHelper.h"
+
+namespace GLBasics
+{
+    namespace
+    {
+        // A depth texture array with a layer per cascade
+        unsigned int CreateDepthArray(const int resolution, const unsigned int layers, const bool compare)
+        {
+            unsigned int textureID = 0;
+            GLCall(glGenTextures(1, &textureID));
+            GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, textureID));
+            GLCall(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, resolution, resolution, layers, 0, GL_DEPTH_COMPONENT,
+                                GL_UNSIGNED_INT, nullptr));
+            // compared texels are filtered into 2x2 percentage closer filtering for free
+            const int filter = compare ? GL_LINEAR : GL_NEAREST;
+            GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, filter));
+            GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, filter));
+            GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER));
+            GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER));
+            const float farthest[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+            GLCall(glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, farthest));
+            if (compare)
+            {
+                GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE));
+                GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL));
+            }
+            GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+            return textureID;
+        }
+
+        // A framebuffer with only depth, the layer is attached when it is drawn to
+        unsigned int CreateDepthFramebuffer()
+        {
+            unsigned int framebufferID = 0;
+            GLCall(glGenFramebuffers(1, &framebufferID));
+            GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebufferID));
+            GLCall(glDrawBuffer(GL_NONE));
+            GLCall(glReadBuffer(GL_NONE));
+            return framebufferID;
+        }
+    }
+
+    CascadedShadowMap::CascadedShadowMap(const int resolution, const unsigned int cascadeCount, const float maxDistance, const int cacheMargin)
+        : m_Resolution(std::max(resolution, 16)), m_CascadeCount(std::clamp(cascadeCount, 1u, MAX_CASCADES)), m_MaxDistance(maxDistance),
+          m_SplitBlend(0.75f), m_CacheMargin(std::clamp(cacheMargin, 0, m_Resolution / 4)), m_LightDirection(0.0f),
+          m_LightView(1.0f), m_Cascades(), m_ShadowTextureID(0), m_StaticTextureID(0), m_FramebufferID(0), m_CopyFramebufferID(0),
+          m_PreviousFramebuffer(0), m_PreviousViewport{ 0, 0, 0, 0 }, m_PreviousDepthTest(GL_FALSE), m_StaticDraws(0),
+          m_StaticDrawsTotal(0), m_UpdateCount(0)
+    {
+        SetLightDirection(glm::vec3(-0.3f, -1.0f, -0.4f));
+
+        m_ShadowTextureID = CreateDepthArray(m_Resolution, m_CascadeCount, true);
+        m_StaticTextureID = CreateDepthArray(m_Resolution, m_CascadeCount, false);
+
+        int previousFramebuffer = 0;
+        GLCall(glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer));
+        m_FramebufferID = CreateDepthFramebuffer();
+        m_CopyFramebufferID = CreateDepthFramebuffer();
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer));
+    }
+
+    CascadedShadowMap::~CascadedShadowMap()
+    {
+        GLCall(glDeleteFramebuffers(1, &m_FramebufferID));
+        GLCall(glDeleteFramebuffers(1, &m_CopyFramebufferID));
+        GLCall(glDeleteTextures(1, &m_ShadowTextureID));
+        GLCall(glDeleteTextures(1, &m_StaticTextureID));
+    }
+
+    void CascadedShadowMap::SetLightDirection(const glm::vec3& direction)
+    {
+        const glm::vec3 normalized = glm::normalize(direction);
+        if (normalized == m_LightDirection)
+        {
+            return;
+        }
+        m_LightDirection = normalized;
+        const glm::vec3 up = std::abs(normalized.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        m_LightView = glm::lookAt(glm::vec3(0.0f), normalized, up);
+
+        // no extent makes the next Update fit every cascade again
+        for (Cascade& cascade : m_Cascades)
+        {
+            cascade.extent = 0.0f;
+            cascade.staticCached = false;
+        }
+    }
+
+    void CascadedShadowMap::Update(const Maths::ViewMatrix& camera, const glm::mat4& projection)
+    {
+        m_StaticDraws = 0;
+        m_UpdateCount++;
+
+        // the near and far planes of glm::perspective and glm::ortho, read back from the matrix
+        const bool perspective = projection[2][3] != 0.0f;
+        const float nearPlane = perspective ? projection[3][2] / (projection[2][2] - 1.0f) : (projection[3][2] + 1.0f) / projection[2][2];
+        const float farPlane = perspective ? projection[3][2] / (projection[2][2] + 1.0f) : (projection[3][2] - 1.0f) / projection[2][2];
+        const float shadowFar = std::min(farPlane, nearPlane + m_MaxDistance);
+
+        // the corners of the view on the near and far planes, a slice lies on the lines between them
+        const glm::mat4 inverse = glm::inverse(projection * camera.GetMatrix());
+        glm::vec3 nearCorners[4], farCorners[4];
+        for (int i = 0; i < 4; i++)
+        {
+            const glm::vec2 corner(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f);
+            const glm::vec4 nearCorner = inverse * glm::vec4(corner, -1.0f, 1.0f);
+            const glm::vec4 farCorner = inverse * glm::vec4(corner, 1.0f, 1.0f);
+            nearCorners[i] = glm::vec3(nearCorner) / nearCorner.w;
+            farCorners[i] = glm::vec3(farCorner) / farCorner.w;
+        }
+
+        float sliceStart = nearPlane;
+        for (unsigned int i = 0; i < m_CascadeCount; i++)
+        {
+            Cascade& cascade = m_Cascades[i];
+
+            // logarithmic splits give every cascade the same texels per pixel, blended with even
+            // ones so the nearest cascade isn't wasted on the first few centimeters
+            const float fraction = static_cast<float>(i + 1) / m_CascadeCount;
+            float sliceEnd = nearPlane + (shadowFar - nearPlane) * fraction;
+            if (perspective && nearPlane > 0.0f)
+            {
+                sliceEnd = glm::mix(sliceEnd, nearPlane * std::pow(shadowFar / nearPlane, fraction), m_SplitBlend);
+            }
+
+            glm::vec3 corners[8];
+            glm::vec3 center(0.0f);
+            for (int j = 0; j < 4; j++)
+            {
+                corners[j] = glm::mix(nearCorners[j], farCorners[j], (sliceStart - nearPlane) / (farPlane - nearPlane));
+                corners[j + 4] = glm::mix(nearCorners[j], farCorners[j], (sliceEnd - nearPlane) / (farPlane - nearPlane));
+                center += corners[j] + corners[j + 4];
+            }
+            center /= 8.0f;
+            float radius = 0.0f;
+            for (const glm::vec3& corner : corners)
+            {
+                radius = std::max(radius, glm::length(corner - center));
+            }
+            // rounded up so the size stays put against rounding errors as the camera turns
+            radius = std::ceil(radius * 16.0f) / 16.0f;
+
+            const float extent = radius * m_Resolution / (m_Resolution - 2.0f * m_CacheMargin);
+            const float texelSize = 2.0f * extent / m_Resolution;
+            const float margin = extent - radius;
+            const glm::vec3 lightCenter(m_LightView * glm::vec4(center, 1.0f));
+            if (extent != cascade.extent || std::abs(lightCenter.x - cascade.center.x) > margin ||
+                std::abs(lightCenter.y - cascade.center.y) > margin || std::abs(-lightCenter.z - cascade.depth) > margin)
+            {
+                cascade.center = glm::round(glm::vec2(lightCenter) / texelSize) * texelSize;
+                cascade.depth = -lightCenter.z;
+                cascade.extent = extent;
+                // casters between the light and the near plane are clamped onto it while drawing,
+                // the room left towards the light keeps long triangles from flattening
+                cascade.lightMatrix = glm::ortho(cascade.center.x - extent, cascade.center.x + extent, cascade.center.y - extent,
+                                                 cascade.center.y + extent, cascade.depth - 2.0f * extent, cascade.depth + extent) * m_LightView;
+                cascade.staticCached = false;
+            }
+            cascade.splitDistance = sliceEnd;
+            sliceStart = sliceEnd;
+        }
+    }
+
+    void CascadedShadowMap::InvalidateStatic()
+    {
+        for (Cascade& cascade : m_Cascades)
+        {
+            cascade.staticCached = false;
+        }
+    }
+
+    void CascadedShadowMap::BeginStatic(const unsigned int cascade)
+    {
+        BeginLayer(m_StaticTextureID, cascade);
+        GLCall(glClear(GL_DEPTH_BUFFER_BIT));
+        m_Cascades[cascade].staticCached = true;
+        m_StaticDraws++;
+        m_StaticDrawsTotal++;
+    }
+
+    void CascadedShadowMap::BeginDynamic(const unsigned int cascade)
+    {
+        BeginLayer(m_ShadowTextureID, cascade);
+
+        GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_CopyFramebufferID));
+        GLCall(glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_StaticTextureID, 0, cascade));
+        GLCall(glBlitFramebuffer(0, 0, m_Resolution, m_Resolution, 0, 0, m_Resolution, m_Resolution, GL_DEPTH_BUFFER_BIT, GL_NEAREST));
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferID));
+    }
+
+    void CascadedShadowMap::End()
+    {
+        GLCall(glDisable(GL_POLYGON_OFFSET_FILL));
+        GLCall(glDisable(GL_DEPTH_CLAMP));
+        if (!m_PreviousDepthTest)
+        {
+            GLCall(glDisable(GL_DEPTH_TEST));
+        }
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_PreviousFramebuffer));
+        GLCall(glViewport(m_PreviousViewport[0], m_PreviousViewport[1], m_PreviousViewport[2], m_PreviousViewport[3]));
+    }
+
+    void CascadedShadowMap::Bind(const unsigned int slot) const
+    {
+        GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+        GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_ShadowTextureID));
+    }
+
+    void CascadedShadowMap::SetUniforms(const Shader& shader, const int slot) const
+    {
+        float splits[MAX_CASCADES] = {}, texelSizes[MAX_CASCADES] = {};
+        for (unsigned int i = 0; i < m_CascadeCount; i++)
+        {
+            shader.SetUniformMat4f("lightMatrices[" + std::to_string(i) + "]", m_Cascades[i].lightMatrix);
+            splits[i] = m_Cascades[i].splitDistance;
+            texelSizes[i] = 2.0f * m_Cascades[i].extent / m_Resolution;
+        }
+        shader.SetUniform1i("shadowMap", slot);
+        shader.SetUniform1i("cascadeCount", static_cast<int>(m_CascadeCount));
+        shader.SetUniform4f("cascadeSplits", splits[0], splits[1], splits[2], splits[3]);
+        shader.SetUniform4f("cascadeTexelSizes", texelSizes[0], texelSizes[1], texelSizes[2], texelSizes[3]);
+        shader.SetUniform4f("lightDirection", m_LightDirection.x, m_LightDirection.y, m_LightDirection.z, 0.0f);
+    }
+
+    void CascadedShadowMap::BeginLayer(const unsigned int textureID, const unsigned int cascade)
+    {
+        GLCall(glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_PreviousFramebuffer));
+        GLCall(glGetIntegerv(GL_VIEWPORT, m_PreviousViewport));
+        GLCall(m_PreviousDepthTest = glIsEnabled(GL_DEPTH_TEST));
+
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferID));
+        GLCall(glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, textureID, 0, cascade));
+        GLCall(glViewport(0, 0, m_Resolution, m_Resolution));
+        GLCall(glEnable(GL_DEPTH_TEST));
+        GLCall(glDepthMask(GL_TRUE));
+        // the slope of a surface away from the light is what makes it shadow itself
+        GLCall(glEnable(GL_POLYGON_OFFSET_FILL));
+        GLCall(glPolygonOffset(2.0f, 2.0f));
+        GLCall(glEnable(GL_DEPTH_CLAMP));
+    }
+}  // namespace GLBasics
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <GLM/glm.hpp>
+
+namespace Maths
+{
+    class ViewMatrix;
+}
+
+namespace GLBasics
+{
+    class Shader;
+
+    /**
+     * \brief Shadows of a directional light over what the camera sees, split along the view into
+     * cascades that each get a layer of a depth texture array. Every cascade covers the bounding
+     * sphere of its slice of the view, whose size doesn't change as the camera turns, plus a margin,
+     * and is snapped to its texels in light space so the shadows don't shimmer.
+     *
+     * Casters are drawn in two groups. Static casters go into a cache of their own, which is only
+     * drawn again when the slice wanders past the margin, the light turns or InvalidateStatic is
+     * called. Every frame the cache is copied into the shadow map and the dynamic casters are drawn
+     * on top, so a still scene costs a copy and its moving parts instead of every caster four times
+     */
+    class CascadedShadowMap
+    {
+    public:
+        static constexpr unsigned int MAX_CASCADES = 4;
+
+    private:
+        struct Cascade
+        {
+            glm::mat4 lightMatrix;  // world to the cascade's clip space, fixed while the cache is valid
+            glm::vec2 center;       // in light space, on the texel grid
+            float depth;            // of the center along the light
+            float extent;           // half the width of the cascade, the margin included
+            float splitDistance;    // how far from the camera the cascade reaches
+            bool staticCached;
+        };
+
+        int m_Resolution;
+        unsigned int m_CascadeCount;
+        float m_MaxDistance;
+        float m_SplitBlend;
+        int m_CacheMargin;
+
+        glm::vec3 m_LightDirection;
+        glm::mat4 m_LightView;
+        Cascade m_Cascades[MAX_CASCADES];
+
+        unsigned int m_ShadowTextureID, m_StaticTextureID;
+        unsigned int m_FramebufferID, m_CopyFramebufferID;
+        int m_PreviousFramebuffer;
+        int m_PreviousViewport[4];
+        unsigned char m_PreviousDepthTest;
+
+        unsigned int m_StaticDraws;
+        unsigned int m_StaticDrawsTotal;
+        unsigned int m_UpdateCount;
+
+    public:
+        /**
+         * \brief Constructs the shadow map and its static cache
+         * \param resolution The width and height of every cascade in texels
+         * \param cascadeCount How many cascades the view is split into, at most MAX_CASCADES
+         * \param maxDistance How far from the camera shadows reach, cut to the far plane of the projection
+         * \param cacheMargin How many texels the view may move before the static casters are drawn again,
+         * the cascades lose twice that much of their resolution
+         */
+        explicit CascadedShadowMap(int resolution = 1024, unsigned int cascadeCount = MAX_CASCADES, float maxDistance = 50.0f,
+                                   int cacheMargin = 64);
+
+        CascadedShadowMap(const CascadedShadowMap&) = delete;
+        CascadedShadowMap& operator=(const CascadedShadowMap&) = delete;
+
+        /**
+         * \brief Deletes the textures and framebuffers
+         */
+        ~CascadedShadowMap();
+
+        /**
+         * \brief Turn the light, which drops the static cache of every cascade
+         * \param direction Where the light shines towards, needn't be normalized
+         */
+        void SetLightDirection(const glm::vec3& direction);
+
+        /**
+         * \brief Split the view into cascades and fit them, called once per frame before any is drawn.
+         * Cascades that moved past their margin get a new light matrix and lose their static cache
+         * \param camera The camera the shadows are seen from
+         * \param projection The projection of the camera, perspective or orthographic
+         */
+        void Update(const Maths::ViewMatrix& camera, const glm::mat4& projection);
+
+        /**
+         * \brief Drop the static cache of every cascade, for when a static caster was moved, added or removed
+         */
+        void InvalidateStatic();
+
+        /**
+         * \brief Get whether a cascade's static casters are still cached, if so drawing them can be skipped
+         * \param cascade Which cascade, below GetCascadeCount()
+         * \return true if the cache is valid; false if BeginStatic has to be called and the static casters drawn
+         */
+        inline bool IsStaticCached(const unsigned int cascade) const { return m_Cascades[cascade].staticCached; }
+
+        /**
+         * \brief Bind and clear the static cache of a cascade, the static casters are drawn after this
+         * with the cascade's light matrix, then End is called. The cache is valid from then on
+         * \param cascade Which cascade, below GetCascadeCount()
+         */
+        void BeginStatic(unsigned int cascade);
+
+        /**
+         * \brief Copy the static cache of a cascade into the shadow map and bind it, the dynamic casters
+         * are drawn after this with the cascade's light matrix, then End is called. Has to be called
+         * for every cascade every frame, with no dynamic casters as well
+         * \param cascade Which cascade, below GetCascadeCount()
+         */
+        void BeginDynamic(unsigned int cascade);
+
+        /**
+         * \brief Bind the previous framebuffer and viewport again
+         */
+        void End();
+
+        /**
+         * \brief Bind the shadow map, to be sampled as a sampler2DArrayShadow
+         * \param slot Which texture slot to bind it to
+         */
+        void Bind(unsigned int slot) const;
+
+        /**
+         * \brief Set the uniforms of res/shaders/include/Shadows.glsl on the bound shader
+         * \param shader The shader, which must be bound
+         * \param slot The texture slot the shadow map is bound to
+         */
+        void SetUniforms(const Shader& shader, int slot) const;
+
+        /**
+         * \brief Get the matrix the casters of a cascade are drawn with
+         * \param cascade Which cascade, below GetCascadeCount()
+         * \return The matrix from world to the cascade's clip space
+         */
+        inline const glm::mat4& GetLightMatrix(const unsigned int cascade) const { return m_Cascades[cascade].lightMatrix; }
+
+        /**
+         * \brief Get the number of cascades
+         * \return The number of cascades
+         */
+        inline unsigned int GetCascadeCount() const { return m_CascadeCount; }
+
+        /**
+         * \brief Get how many cascades had their static casters drawn since the last Update
+         * \return The number of cascades
+         */
+        inline unsigned int GetStaticDrawCount() const { return m_StaticDraws; }
+
+        /**
+         * \brief Get how many times any cascade had its static casters drawn
+         * \return The number of static draws, out of GetCascadeCount() per Update
+         */
+        inline unsigned int GetStaticDrawTotal() const { return m_StaticDrawsTotal; }
+
+        /**
+         * \brief Get how many times Update was called
+         * \return The number of updates
+         */
+        inline unsigned int GetUpdateCount() const { return m_UpdateCount; }
+
+    private:
+        // Binds the framebuffer with a layer of a texture attached, remembering what was bound before
+        void BeginLayer(unsigned int textureID, unsigned int cascade);
+
+    };  // class CascadedShadowMap
+}  // namespace GLBasics
@@ -0,0 +1,336 @@
+#include "CompressedImage.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "../Utils/GLDebugHelper.h"
+
+namespace GLBasics
+{
+    namespace
+    {
+        constexpr uint32_t FourCC(const char a, const char b, const char c, const char d)
+        {
+            return static_cast<uint32_t>(a) | static_cast<uint32_t>(b) << 8 | static_cast<uint32_t>(c) << 16 | static_cast<uint32_t>(d) << 24;
+        }
+
+        // Both containers are little endian, as is every platform we build for
+        template<typename T>
+        T Read(const std::vector<unsigned char>& file, const size_t offset)
+        {
+            T value;
+            std::memcpy(&value, file.data() + offset, sizeof(T));
+            return value;
+        }
+
+        constexpr size_t DDS_HEADER_SIZE = 4 + 124;
+        constexpr size_t DDS_DX10_HEADER_SIZE = 20;
+        constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+        constexpr uint32_t DDPF_FOURCC = 0x4;
+
+        // past anything a driver accepts, and small enough that level sizes can't overflow
+        constexpr uint32_t MAX_DIMENSION = 65536;
+
+        // The number of levels of a full mip chain, a file can't hold more than that
+        unsigned int GetFullLevelCount(const uint32_t width, const uint32_t height)
+        {
+            unsigned int levelCount = 1;
+            while (std::max(width, height) >> levelCount > 0)
+            {
+                levelCount++;
+            }
+            return levelCount;
+        }
+
+        unsigned int FormatFromFourCC(const uint32_t fourCC)
+        {
+            switch (fourCC)
+            {
+            case FourCC('D', 'X', 'T', '1'): return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            case FourCC('D', 'X', 'T', '5'): return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case FourCC('A', 'T', 'I', '1'):
+            case FourCC('B', 'C', '4', 'U'): return GL_COMPRESSED_RED_RGTC1;
+            case FourCC('B', 'C', '4', 'S'): return GL_COMPRESSED_SIGNED_RED_RGTC1;
+            case FourCC('A', 'T', 'I', '2'):
+            case FourCC('B', 'C', '5', 'U'): return GL_COMPRESSED_RG_RGTC2;
+            case FourCC('B', 'C', '5', 'S'): return GL_COMPRESSED_SIGNED_RG_RGTC2;
+            default: return 0;
+            }
+        }
+
+        unsigned int FormatFromDXGI(const uint32_t dxgiFormat)
+        {
+            switch (dxgiFormat)
+            {
+            case 70:
+            case 71: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            case 72: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+            case 76:
+            case 77: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case 78: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+            case 79:
+            case 80: return GL_COMPRESSED_RED_RGTC1;
+            case 81: return GL_COMPRESSED_SIGNED_RED_RGTC1;
+            case 82:
+            case 83: return GL_COMPRESSED_RG_RGTC2;
+            case 84: return GL_COMPRESSED_SIGNED_RG_RGTC2;
+            case 97:
+            case 98: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+            case 99: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+            default: return 0;
+            }
+        }
+
+        const unsigned char KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+        constexpr size_t KTX2_HEADER_SIZE = 80;
+        constexpr size_t KTX2_LEVEL_INDEX_ENTRY_SIZE = 24;
+
+        unsigned int FormatFromVulkan(const uint32_t vkFormat)
+        {
+            switch (vkFormat)
+            {
+            case 131: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            case 132: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+            case 133: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            case 134: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+            case 137: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case 138: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+            case 139: return GL_COMPRESSED_RED_RGTC1;
+            case 140: return GL_COMPRESSED_SIGNED_RED_RGTC1;
+            case 141: return GL_COMPRESSED_RG_RGTC2;
+            case 142: return GL_COMPRESSED_SIGNED_RG_RGTC2;
+            case 145: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+            case 146: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+            default: return 0;
+            }
+        }
+
+        std::string GetExtension(const std::string& path)
+        {
+            std::string extension = std::filesystem::path(path).extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(),
+                           [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return extension;
+        }
+    }  // namespace
+
+    bool CompressedImage::IsCompressedFile(const std::string& path)
+    {
+        const std::string extension = GetExtension(path);
+        return extension == ".dds" || extension == ".ktx2";
+    }
+
+    bool CompressedImage::Load(const std::string& path, CompressedImage& image)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream)
+        {
+            std::cout << "ERROR::COMPRESSED_IMAGE::FILE_NOT_FOUND " << path << std::endl;
+            return false;
+        }
+        const std::vector<unsigned char> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+        std::string error;
+        const bool parsed = GetExtension(path) == ".dds" ? ParseDDS(file, image, error) : ParseKTX2(file, image, error);
+        if (!parsed)
+        {
+            std::cout << "ERROR::COMPRESSED_IMAGE::" << error << " " << path << std::endl;
+        }
+        return parsed;
+    }
+
+    bool CompressedImage::IsFormatSupported(const unsigned int internalFormat)
+    {
+        switch (internalFormat)
+        {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            return GLEW_EXT_texture_compression_s3tc;
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+            return GLEW_EXT_texture_compression_s3tc && GLEW_EXT_texture_sRGB;
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_SIGNED_RED_RGTC1:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_SIGNED_RG_RGTC2:
+            return true;  // core since 3.0
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+        default:
+            return false;
+        }
+    }
+
+    bool CompressedImage::ParseDDS(const std::vector<unsigned char>& file, CompressedImage& image, std::string& error)
+    {
+        if (file.size() < DDS_HEADER_SIZE || Read<uint32_t>(file, 0) != FourCC('D', 'D', 'S', ' '))
+        {
+            error = "NOT_A_DDS_FILE";
+            return false;
+        }
+
+        const auto flags = Read<uint32_t>(file, 8);
+        const auto height = Read<uint32_t>(file, 12);
+        const auto width = Read<uint32_t>(file, 16);
+        const auto mipMapCount = Read<uint32_t>(file, 28);
+        const auto pixelFormatFlags = Read<uint32_t>(file, 80);
+        const auto fourCC = Read<uint32_t>(file, 84);
+
+        size_t dataOffset = DDS_HEADER_SIZE;
+        unsigned int internalFormat = 0;
+        if (pixelFormatFlags & DDPF_FOURCC)
+        {
+            if (fourCC == FourCC('D', 'X', '1', '0'))
+            {
+                if (file.size() < DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE)
+                {
+                    error = "TRUNCATED";
+                    return false;
+                }
+                internalFormat = FormatFromDXGI(Read<uint32_t>(file, DDS_HEADER_SIZE));
+                dataOffset += DDS_DX10_HEADER_SIZE;
+            }
+            else
+            {
+                internalFormat = FormatFromFourCC(fourCC);
+            }
+        }
+        if (internalFormat == 0)
+        {
+            error = "UNSUPPORTED_FORMAT";
+            return false;
+        }
+
+        if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION)
+        {
+            error = "INVALID_SIZE";
+            return false;
+        }
+
+        // the first array element or cube face comes first with all of its levels
+        const unsigned int levelCount = (flags & DDSD_MIPMAPCOUNT)
+            ? std::min(std::max(1u, mipMapCount), GetFullLevelCount(width, height)) : 1u;
+        const size_t blockSize = GetBlockSize(internalFormat);
+
+        image.internalFormat = internalFormat;
+        image.width = static_cast<int>(width);
+        image.height = static_cast<int>(height);
+        image.levels.clear();
+
+        size_t offset = 0;
+        for (unsigned int level = 0; level < levelCount; level++)
+        {
+            const int levelWidth = std::max(1, image.width >> level);
+            const int levelHeight = std::max(1, image.height >> level);
+            const size_t size = static_cast<size_t>((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * blockSize;
+            image.levels.push_back({ levelWidth, levelHeight, offset, size });
+            offset += size;
+        }
+
+        if (offset > file.size() - dataOffset)
+        {
+            error = "TRUNCATED";
+            return false;
+        }
+        image.data.assign(file.begin() + dataOffset, file.begin() + dataOffset + offset);
+        return true;
+    }
+
+    bool CompressedImage::ParseKTX2(const std::vector<unsigned char>& file, CompressedImage& image, std::string& error)
+    {
+        if (file.size() < KTX2_HEADER_SIZE || std::memcmp(file.data(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+        {
+            error = "NOT_A_KTX2_FILE";
+            return false;
+        }
+
+        const auto vkFormat = Read<uint32_t>(file, 12);
+        const auto width = Read<uint32_t>(file, 20);
+        const auto height = Read<uint32_t>(file, 24);
+        const auto depth = Read<uint32_t>(file, 28);
+        const auto declaredLevelCount = std::max(1u, Read<uint32_t>(file, 40));
+        const auto supercompressionScheme = Read<uint32_t>(file, 44);
+
+        const unsigned int internalFormat = FormatFromVulkan(vkFormat);
+        if (internalFormat == 0 || depth > 0)
+        {
+            error = "UNSUPPORTED_FORMAT";
+            return false;
+        }
+        if (supercompressionScheme != 0)
+        {
+            error = "SUPERCOMPRESSION_NOT_SUPPORTED";
+            return false;
+        }
+        if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION)
+        {
+            error = "INVALID_SIZE";
+            return false;
+        }
+        const unsigned int levelCount = std::min(declaredLevelCount, GetFullLevelCount(width, height));
+        if (file.size() < KTX2_HEADER_SIZE + levelCount * KTX2_LEVEL_INDEX_ENTRY_SIZE)
+        {
+            error = "TRUNCATED";
+            return false;
+        }
+
+        const size_t blockSize = GetBlockSize(internalFormat);
+
+        image.internalFormat = internalFormat;
+        image.width = static_cast<int>(width);
+        image.height = static_cast<int>(height);
+        image.levels.clear();
+        image.data.clear();
+
+        // the level index starts at the base level, every level begins with its first layer and face
+        for (unsigned int level = 0; level < levelCount; level++)
+        {
+            const size_t entry = KTX2_HEADER_SIZE + level * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+            const auto byteOffset = Read<uint64_t>(file, entry);
+
+            const int levelWidth = std::max(1, image.width >> level);
+            const int levelHeight = std::max(1, image.height >> level);
+            const size_t size = static_cast<size_t>((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * blockSize;
+            if (byteOffset > file.size() || size > file.size() - byteOffset)
+            {
+                error = "TRUNCATED";
+                return false;
+            }
+
+            image.levels.push_back({ levelWidth, levelHeight, image.data.size(), size });
+            image.data.insert(image.data.end(), file.begin() + byteOffset, file.begin() + byteOffset + size);
+        }
+        return true;
+    }
+
+    size_t CompressedImage::GetBlockSize(const unsigned int internalFormat)
+    {
+        switch (internalFormat)
+        {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_SIGNED_RED_RGTC1:
+            return 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_SIGNED_RG_RGTC2:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+}  // namespace GLBasics
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace GLBasics
+{
+    /**
+     * \brief A block-compressed image with its mip chain read from a DDS or KTX2 file, ready to be
+     * uploaded with glCompressedTexImage2D. Supports BC1, BC3, BC4, BC5 and BC7 without supercompression.
+     * Images are uploaded as stored, so they should be written bottom row first like the decoded ones
+     */
+    struct CompressedImage
+    {
+        struct Level
+        {
+            int width, height;
+            size_t offset, size;  // into data
+        };
+
+        unsigned int internalFormat = 0;
+        int width = 0, height = 0;
+        std::vector<Level> levels;
+        std::vector<unsigned char> data;
+
+        /**
+         * \brief Check whether a path names a container this class reads, from its extension
+         * \param path A string that is the path to an image file
+         * \return true if the file is a .dds or .ktx2 file; false otherwise
+         */
+        static bool IsCompressedFile(const std::string& path);
+
+        /**
+         * \brief Read a DDS or KTX2 file, the container is picked from the extension
+         * \param path A string that is the path to the file
+         * \param image The image to fill in
+         * \return true if the file was read; false otherwise, with the reason printed
+         */
+        static bool Load(const std::string& path, CompressedImage& image);
+
+        /**
+         * \brief Check whether the current context can sample a compressed format
+         * \param internalFormat One of the GL_COMPRESSED_* formats
+         * \return true if it is supported; false otherwise
+         */
+        static bool IsFormatSupported(unsigned int internalFormat);
+
+    private:
+        // Parses a DDS file, with or without the DX10 header
+        static bool ParseDDS(const std::vector<unsigned char>& file, CompressedImage& image, std::string& error);
+
+        // Parses a KTX2 file, only the first layer and face are kept
+        static bool ParseKTX2(const std::vector<unsigned char>& file, CompressedImage& image, std::string& error);
+
+        // Returns the bytes of one 4x4 block, or 0 if the format isn't one we load
+        static size_t GetBlockSize(unsigned int internalFormat);
+
+    };  // struct CompressedImage
+}  // namespace GLBasics
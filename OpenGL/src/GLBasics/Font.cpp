@@ -0,0 +1,159 @@
+#include "Font.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "Texture.h"
+#include "../Utils/GLDebugHelper.h"
+#include "../Utils/Json.h"
+
+namespace GLBasics
+{
+    namespace
+    {
+        // Decodes the codepoint starting at position and moves past it, malformed bytes give U+FFFD
+        uint32_t NextCodepoint(const std::string& text, size_t& position)
+        {
+            const auto lead = static_cast<unsigned char>(text[position++]);
+            const int length = lead < 0x80 ? 0 : (lead & 0xE0) == 0xC0 ? 1 : (lead & 0xF0) == 0xE0 ? 2 : (lead & 0xF8) == 0xF0 ? 3 : -1;
+            if (length < 0)
+            {
+                return 0xFFFD;
+            }
+
+            uint32_t codepoint = length == 0 ? lead : lead & (0x3F >> length);
+            for (int i = 0; i < length; i++)
+            {
+                if (position >= text.size() || (static_cast<unsigned char>(text[position]) & 0xC0) != 0x80)
+                {
+                    return 0xFFFD;
+                }
+                codepoint = codepoint << 6 | (static_cast<unsigned char>(text[position++]) & 0x3F);
+            }
+            return codepoint;
+        }
+
+        uint64_t KerningKey(const uint32_t first, const uint32_t second)
+        {
+            return static_cast<uint64_t>(first) << 32 | second;
+        }
+    }
+
+    Font::Font(const std::string& path)
+        : m_PixelHeight(0.0f), m_Ascent(0.0f), m_Descent(0.0f), m_LineGap(0.0f), m_Loaded(false)
+    {
+        std::ifstream file(path);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        Utils::JsonValue root;
+        std::string error;
+        if (!file || !Utils::JsonValue::Parse(stream.str(), root, error))
+        {
+            std::cout << "ERROR::FONT::LOAD_FAILED " << path << ": " << (file ? error : "can't open the file") << std::endl;
+            return;
+        }
+
+        const float atlasWidth = static_cast<float>(root["atlasWidth"].AsNumber(1.0));
+        const float atlasHeight = static_cast<float>(root["atlasHeight"].AsNumber(1.0));
+        m_PixelHeight = static_cast<float>(root["pixelHeight"].AsNumber());
+        m_Ascent = static_cast<float>(root["ascent"].AsNumber());
+        m_Descent = static_cast<float>(root["descent"].AsNumber());
+        m_LineGap = static_cast<float>(root["lineGap"].AsNumber());
+
+        const Utils::JsonValue& glyphs = root["glyphs"];
+        for (size_t i = 0; i < glyphs.Size(); i++)
+        {
+            const Utils::JsonValue& glyph = glyphs[i];
+            const glm::vec2 position(glyph["x"].AsNumber(), glyph["y"].AsNumber());
+            const glm::vec2 size(glyph["width"].AsNumber(), glyph["height"].AsNumber());
+            m_Glyphs[static_cast<uint32_t>(glyph["codepoint"].AsNumber())] = {
+                static_cast<float>(glyph["advance"].AsNumber()),
+                glm::vec2(glyph["left"].AsNumber(), glyph["bottom"].AsNumber()), size,
+                glm::vec4(position.x / atlasWidth, position.y / atlasHeight, size.x / atlasWidth, size.y / atlasHeight)
+            };
+        }
+
+        const Utils::JsonValue& kerning = root["kerning"];
+        for (size_t i = 0; i < kerning.Size(); i++)
+        {
+            const Utils::JsonValue& pair = kerning[i];
+            m_Kerning[KerningKey(static_cast<uint32_t>(pair[0].AsNumber()), static_cast<uint32_t>(pair[1].AsNumber()))]
+                = static_cast<float>(pair[2].AsNumber());
+        }
+
+        const std::string atlasPath = (std::filesystem::path(path).parent_path() / root["atlas"].AsString()).string();
+        m_Atlas = std::make_unique<Texture>(atlasPath);
+        if (m_Atlas->GetWidth() == 0 || m_Glyphs.empty())
+        {
+            std::cout << "ERROR::FONT::LOAD_FAILED " << path << ": no glyphs or no atlas at " << atlasPath << std::endl;
+            return;
+        }
+        // glyphs are packed right next to each other, repeating would pull in the opposite edge
+        m_Atlas->SetSampling(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
+        m_Loaded = true;
+    }
+
+    Font::~Font() = default;
+
+    void Font::Layout(const std::string& text, TextLayout& layout) const
+    {
+        layout.glyphs.clear();
+        const Glyph* fallback = GetGlyph('?');
+        glm::vec2 pen(0.0f);
+        float width = 0.0f;
+        uint32_t previous = 0;
+
+        size_t position = 0;
+        while (position < text.size())
+        {
+            const uint32_t codepoint = NextCodepoint(text, position);
+            if (codepoint == '\n')
+            {
+                width = std::max(width, pen.x);
+                pen = glm::vec2(0.0f, pen.y - GetLineHeight());
+                previous = 0;
+                continue;
+            }
+
+            const Glyph* glyph = GetGlyph(codepoint);
+            const uint32_t drawn = glyph ? codepoint : '?';
+            glyph = glyph ? glyph : fallback;
+            if (!glyph)
+            {
+                continue;
+            }
+            if (previous)
+            {
+                pen.x += GetKerning(previous, drawn);
+            }
+            if (glyph->size.x > 0.0f)
+            {
+                layout.glyphs.push_back({ pen + glyph->offset, glyph->size, glyph->uvRect });
+            }
+            pen.x += glyph->advance;
+            previous = drawn;
+        }
+
+        layout.min = glm::vec2(0.0f, pen.y + m_Descent);
+        layout.max = glm::vec2(std::max(width, pen.x), m_Ascent);
+    }
+
+    const Glyph* Font::GetGlyph(const uint32_t codepoint) const
+    {
+        const auto found = m_Glyphs.find(codepoint);
+        return found != m_Glyphs.end() ? &found->second : nullptr;
+    }
+
+    float Font::GetKerning(const uint32_t first, const uint32_t second) const
+    {
+        if (m_Kerning.empty())
+        {
+            return 0.0f;
+        }
+        const auto found = m_Kerning.find(KerningKey(first, second));
+        return found != m_Kerning.end() ? found->second : 0.0f;
+    }
+}  // namespace GLBasics
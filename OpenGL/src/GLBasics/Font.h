@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <GLM/glm.hpp>
+
+namespace GLBasics
+{
+    class Texture;
+
+    /**
+     * \brief Where a glyph is in the atlas and how it sits on the baseline, in pixels of the atlas with y up
+     */
+    struct Glyph
+    {
+        float advance;
+        glm::vec2 offset;  // of the bottom left corner of the quad from the pen
+        glm::vec2 size;
+        glm::vec4 uvRect;  // offset and scale in the atlas
+    };
+
+    /**
+     * \brief One glyph of laid out text
+     */
+    struct LaidGlyph
+    {
+        glm::vec2 position;  // of the bottom left corner, the pen starts at the origin on the first baseline
+        glm::vec2 size;
+        glm::vec4 uvRect;
+    };
+
+    /**
+     * \brief Text turned into glyph quads, in pixels of the atlas
+     */
+    struct TextLayout
+    {
+        std::vector<LaidGlyph> glyphs;
+        glm::vec2 min = glm::vec2(0.0f);  // the box every line fits in, from the descent of the last line
+        glm::vec2 max = glm::vec2(0.0f);  // to the ascent of the first
+    };
+
+    /**
+     * \brief A signed distance field font cooked by TextureCooker --font: the atlas, with the
+     * distance in alpha, and the metrics and kerning of every glyph in it. Text drawn from it stays
+     * sharp at any size, the atlas size only limits how fine the corners are
+     */
+    class Font
+    {
+    private:
+        std::unique_ptr<Texture> m_Atlas;
+        std::unordered_map<uint32_t, Glyph> m_Glyphs;
+        std::unordered_map<uint64_t, float> m_Kerning;  // the first codepoint in the high half
+        float m_PixelHeight;
+        float m_Ascent, m_Descent, m_LineGap;
+        bool m_Loaded;
+
+    public:
+        /**
+         * \brief Load a cooked font, check IsLoaded for whether it worked
+         * \param path The .json file, the atlas is looked up next to it
+         */
+        explicit Font(const std::string& path);
+
+        Font(const Font&) = delete;
+        Font& operator=(const Font&) = delete;
+
+        /**
+         * \brief Deletes the atlas
+         */
+        ~Font();
+
+        /**
+         * \brief Lay out UTF-8 text left aligned, lines are broken at '\n' only. Codepoints without
+         * a glyph are drawn as '?'
+         * \param text The text
+         * \param layout Receives the glyphs and the box around them
+         */
+        void Layout(const std::string& text, TextLayout& layout) const;
+
+        /**
+         * \brief Get the glyph of a codepoint
+         * \param codepoint The codepoint
+         * \return The glyph, nullptr if the font was cooked without it
+         */
+        const Glyph* GetGlyph(uint32_t codepoint) const;
+
+        /**
+         * \brief Get how much closer a pair of glyphs is drawn than their advance
+         * \param first The codepoint on the left
+         * \param second The codepoint on the right
+         * \return The adjustment in pixels, usually negative, 0 for most pairs
+         */
+        float GetKerning(uint32_t first, uint32_t second) const;
+
+        /**
+         * \brief Get whether the metrics and the atlas were loaded
+         * \return true if they were; false otherwise
+         */
+        inline bool IsLoaded() const { return m_Loaded; }
+
+        /**
+         * \brief Get the height the font was cooked at, from the highest ascender to the lowest descender
+         * \return The height in pixels of the atlas
+         */
+        inline float GetPixelHeight() const { return m_PixelHeight; }
+
+        /**
+         * \brief Get the distance from one baseline to the next
+         * \return The distance in pixels of the atlas
+         */
+        inline float GetLineHeight() const { return m_Ascent - m_Descent + m_LineGap; }
+
+        /**
+         * \brief Get the atlas, sampled with its distance in alpha
+         * \return The atlas
+         */
+        inline const Texture& GetAtlas() const { return *m_Atlas; }
+
+    };  // class Font
+}  // namespace GLBasics
@@ -0,0 +1,135 @@
+#include "FrameCapture.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ReadbackService.h"
+#include "../Utils/GLDebugHelper.h"
+#include "../Utils/ImageWriter.h"
+#include "../Utils/ThreadPool.h"
+
+namespace GLBasics
+{
+    FrameCapture::FrameCapture(ReadbackService& readback, Utils::ThreadPool& threadPool, const std::string& directory,
+                               const CaptureFormat format, const unsigned int maxEncoding)
+        : m_Readback(readback), m_ThreadPool(threadPool), m_Directory(directory), m_Format(format),
+          m_MaxEncoding(maxEncoding ? maxEncoding : threadPool.GetThreadCount() * 2), m_Recording(false),
+          m_ScreenshotRequested(false), m_NextFrame(0), m_SkippedCount(0), m_Reading(0), m_Encoding(0), m_WrittenCount(0)
+    {
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        // the callbacks of frames still being read back point at us, so those have to come through first
+        if (m_Reading > 0)
+        {
+            GLCall(glFlush());
+            while (m_Reading > 0)
+            {
+                m_Readback.Update();
+                std::this_thread::yield();
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_EncodeFinished.wait(lock, [this] { return m_Encoding == 0; });
+    }
+
+    void FrameCapture::Capture(const int width, const int height)
+    {
+        if (!m_Recording && !m_ScreenshotRequested)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (m_Reading + m_Encoding >= m_MaxEncoding)
+            {
+                m_SkippedCount++;
+                return;
+            }
+        }
+
+        const unsigned int frame = m_NextFrame;
+        const bool requested = m_Readback.Request(0, 0, width, height, [this, frame](std::vector<unsigned char>& pixels, const int readWidth, const int readHeight)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Reading--;
+                if (pixels.empty())
+                {
+                    return;
+                }
+                m_Encoding++;
+            }
+            auto frameData = std::make_shared<std::vector<unsigned char>>(std::move(pixels));
+            m_ThreadPool.Enqueue([this, frameData, readWidth, readHeight, frame]
+            {
+                Encode(*frameData, readWidth, readHeight, frame);
+            });
+        });
+
+        if (requested)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Reading++;
+            m_NextFrame++;
+            m_ScreenshotRequested = false;
+        }
+        else
+        {
+            m_SkippedCount++;
+        }
+    }
+
+    unsigned int FrameCapture::GetWrittenCount()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_WrittenCount;
+    }
+
+    void FrameCapture::Encode(std::vector<unsigned char>& rgbaPixels, const int width, const int height, const unsigned int frame)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(m_Directory, error);
+
+        char name[64];
+        bool written;
+        if (m_Format == CaptureFormat::PNG)
+        {
+            std::snprintf(name, sizeof(name), "frame_%06u.png", frame);
+            written = Utils::ImageWriter::WritePNG((std::filesystem::path(m_Directory) / name).string(), width, height, rgbaPixels.data());
+        }
+        else
+        {
+            // flipped here so raw sequences can be fed to video encoders as they are
+            const size_t row = static_cast<size_t>(width) * 4;
+            std::vector<unsigned char> flipped(rgbaPixels.size());
+            for (int y = 0; y < height; y++)
+            {
+                std::copy_n(rgbaPixels.data() + (height - 1 - y) * row, row, flipped.data() + y * row);
+            }
+            std::snprintf(name, sizeof(name), "frame_%06u_%dx%d.rgba", frame, width, height);
+            written = Utils::ImageWriter::WriteRaw((std::filesystem::path(m_Directory) / name).string(), width, height, flipped.data());
+        }
+
+        if (!written)
+        {
+            std::cout << "ERROR::FRAME_CAPTURE::WRITE_FAILED " << name << std::endl;
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (written)
+        {
+            m_WrittenCount++;
+        }
+        m_Encoding--;
+        m_EncodeFinished.notify_all();
+    }
+}  // namespace GLBasics
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+    class ThreadPool;
+}
+
+namespace GLBasics
+{
+    class ReadbackService;
+
+    /**
+     * \brief The file formats FrameCapture writes
+     */
+    enum class CaptureFormat
+    {
+        PNG,  // uncompressed PNG files
+        Raw   // the RGBA8 pixels top row first, with the size in the file name
+    };
+
+    /**
+     * \brief Dumps frames to numbered files without slowing the frame down. Frames are read back
+     * through a ReadbackService and encoded on a thread pool, so the capture rate grows with the
+     * number of cores. When the encoders fall behind frames are skipped rather than queued up
+     */
+    class FrameCapture
+    {
+    private:
+        ReadbackService& m_Readback;
+        Utils::ThreadPool& m_ThreadPool;
+        std::string m_Directory;
+        CaptureFormat m_Format;
+        unsigned int m_MaxEncoding;
+
+        bool m_Recording;
+        bool m_ScreenshotRequested;
+        unsigned int m_NextFrame;
+        unsigned int m_SkippedCount;
+        unsigned int m_Reading;  // frames still in the readback service
+
+        std::mutex m_Mutex;
+        std::condition_variable m_EncodeFinished;
+        unsigned int m_Encoding;  // frames handed to the pool
+        unsigned int m_WrittenCount;
+
+    public:
+        /**
+         * \brief Constructs a capture that isn't recording
+         * \param readback Reads the frames back. Must outlive the capture
+         * \param threadPool The workers the frames are encoded on. Must outlive the capture
+         * \param directory Where the files are written, created when the first frame is
+         * \param format The file format
+         * \param maxEncoding How many frames may wait for or be in encoding, 0 for two per worker
+         */
+        FrameCapture(ReadbackService& readback, Utils::ThreadPool& threadPool, const std::string& directory,
+                     CaptureFormat format = CaptureFormat::PNG, unsigned int maxEncoding = 0);
+
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        /**
+         * \brief Waits until every frame captured so far is written
+         */
+        ~FrameCapture();
+
+        /**
+         * \brief Start or stop capturing every frame
+         * \param recording true to capture every frame from now on
+         */
+        inline void SetRecording(const bool recording) { m_Recording = recording; }
+
+        /**
+         * \brief Check whether every frame is captured
+         * \return true if recording; false otherwise
+         */
+        inline bool IsRecording() const { return m_Recording; }
+
+        /**
+         * \brief Capture the next frame only
+         */
+        inline void TakeScreenshot() { m_ScreenshotRequested = true; }
+
+        /**
+         * \brief Capture the framebuffer bound for reading if recording or a screenshot was asked for.
+         * Should be called once per frame once the scene is drawn
+         * \param width The width of the framebuffer
+         * \param height The height of the framebuffer
+         */
+        void Capture(int width, int height);
+
+        /**
+         * \brief Get the number of files written
+         * \return The number of frames written
+         */
+        unsigned int GetWrittenCount();
+
+        /**
+         * \brief Get how many frames were skipped because the readbacks or the encoders were busy
+         * \return The number of frames skipped
+         */
+        inline unsigned int GetSkippedCount() const { return m_SkippedCount; }
+
+    private:
+        // Writes one frame on a worker thread
+        void Encode(std::vector<unsigned char>& rgbaPixels, int width, int height, unsigned int frame);
+
+    };  // class FrameCapture
+}  // namespace GLBasics
@@ -0,0 +1,269 @@
+#include "GpuParticleSystem.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+#include "../Utils/GLDebugHelper.h"
+
+namespace GLBasics
+{
+    namespace
+    {
+        // The state of one particle as it is captured, interleaved
+        struct ParticleState
+        {
+            float position[3];
+            float velocity[3];
+            float age[2];  // age and lifetime
+        };
+
+        unsigned int CompileStage(const unsigned int type, const std::string& path, const ShaderDefines& defines)
+        {
+            const std::string source = ShaderPreprocessor::Process(path, defines).source;
+            const char* src = source.c_str();
+            GLCall(const unsigned int shaderID = glCreateShader(type));
+            GLCall(glShaderSource(shaderID, 1, &src, nullptr));
+            GLCall(glCompileShader(shaderID));
+
+            int success;
+            GLCall(glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success));
+            if (!success)
+            {
+                char infoLog[1024];
+                GLCall(glGetShaderInfoLog(shaderID, 1024, nullptr, infoLog));
+                std::cout << "ERROR::GPU_PARTICLES::COMPILATION_ERROR " << path << "\n" << infoLog << std::endl;
+            }
+            return shaderID;
+        }
+
+        // Links the vertex and geometry shaders with the outputs captured, returns 0 if it failed
+        unsigned int CreateUpdateProgram(const std::string& vertexShaderPath, const std::string& geometryShaderPath)
+        {
+            const ShaderDefines defines = { { "MAX_PLANES", std::to_string(GpuParticleSystem::MAX_PLANES) } };
+            const unsigned int vertexShader = CompileStage(GL_VERTEX_SHADER, vertexShaderPath, defines);
+            const unsigned int geometryShader = CompileStage(GL_GEOMETRY_SHADER, geometryShaderPath, defines);
+
+            GLCall(unsigned int programID = glCreateProgram());
+            GLCall(glAttachShader(programID, vertexShader));
+            GLCall(glAttachShader(programID, geometryShader));
+            // Must match ParticleState
+            const char* varyings[] = { "outPosition", "outVelocity", "outAge" };
+            GLCall(glTransformFeedbackVaryings(programID, 3, varyings, GL_INTERLEAVED_ATTRIBS));
+            GLCall(glLinkProgram(programID));
+            GLCall(glDeleteShader(vertexShader));
+            GLCall(glDeleteShader(geometryShader));
+
+            int success;
+            GLCall(glGetProgramiv(programID, GL_LINK_STATUS, &success));
+            if (!success)
+            {
+                char infoLog[1024];
+                GLCall(glGetProgramInfoLog(programID, 1024, nullptr, infoLog));
+                std::cout << "ERROR::GPU_PARTICLES::PROGRAM_LINKING_ERROR\n" << infoLog << std::endl;
+                GLCall(glDeleteProgram(programID));
+                programID = 0;
+            }
+            return programID;
+        }
+    }
+
+    GpuParticleSystem::GpuParticleSystem(const unsigned int capacity, const std::string& vertexShaderPath, const std::string& geometryShaderPath)
+        : m_Capacity(std::max(capacity, 1u)), m_Buffers{}, m_Current(0), m_Drawn(0), m_HasParticles(false),
+          m_UseFeedbackCount(GLEW_VERSION_4_0 || GLEW_ARB_transform_feedback2), m_ParticleCount(0), m_DeferredTime(0.0f),
+          m_UpdateProgram(CreateUpdateProgram(vertexShaderPath, geometryShaderPath)), m_Uniforms{}, m_EmitRemainder(0.0f), m_Frame(0)
+    {
+        for (StateBuffer& state : m_Buffers)
+        {
+            GLCall(glGenBuffers(1, &state.buffer));
+            GLCall(glBindBuffer(GL_ARRAY_BUFFER, state.buffer));
+            GLCall(glBufferData(GL_ARRAY_BUFFER, static_cast<size_t>(m_Capacity) * sizeof(ParticleState), nullptr, GL_DYNAMIC_COPY));
+
+            GLCall(glGenVertexArrays(1, &state.vertexArray));
+            GLCall(glBindVertexArray(state.vertexArray));
+            GLCall(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleState), reinterpret_cast<const void*>(offsetof(ParticleState, position))));
+            GLCall(glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleState), reinterpret_cast<const void*>(offsetof(ParticleState, velocity))));
+            GLCall(glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleState), reinterpret_cast<const void*>(offsetof(ParticleState, age))));
+            for (unsigned int index = 0; index < 3; index++)
+            {
+                GLCall(glEnableVertexAttribArray(index));
+            }
+            GLCall(glBindVertexArray(0));
+
+            if (m_UseFeedbackCount)
+            {
+                GLCall(glGenTransformFeedbacks(1, &state.transformFeedback));
+                GLCall(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, state.transformFeedback));
+                GLCall(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, state.buffer));
+                GLCall(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0));
+            }
+            else
+            {
+                GLCall(glGenQueries(1, &state.countQuery));
+            }
+        }
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+        if (m_UpdateProgram)
+        {
+            const auto location = [this](const char* name)
+            {
+                GLCall(const int uniform = glGetUniformLocation(m_UpdateProgram, name));
+                return uniform;
+            };
+            m_Uniforms = { location("deltaTime"), location("gravity"), location("damping"), location("bounce"),
+                           location("planes"), location("planeCount"), location("emitting"), location("seed"),
+                           location("emitterPosition"), location("emitterExtent"), location("emitterVelocity"),
+                           location("velocitySpread"), location("lifetimeRange") };
+        }
+    }
+
+    GpuParticleSystem::~GpuParticleSystem()
+    {
+        for (StateBuffer& state : m_Buffers)
+        {
+            if (state.transformFeedback)
+            {
+                GLCall(glDeleteTransformFeedbacks(1, &state.transformFeedback));
+            }
+            if (state.countQuery)
+            {
+                GLCall(glDeleteQueries(1, &state.countQuery));
+            }
+            GLCall(glDeleteVertexArrays(1, &state.vertexArray));
+            GLCall(glDeleteBuffers(1, &state.buffer));
+        }
+        if (m_UpdateProgram)
+        {
+            GLCall(glDeleteProgram(m_UpdateProgram));
+        }
+    }
+
+    void GpuParticleSystem::Update(const float deltaTime)
+    {
+        if (!m_UpdateProgram)
+        {
+            return;
+        }
+
+        // the survivors of the last capture can't be drawn from before they are counted, and waiting
+        // for the count would stall the CPU, so the update is put off until the GPU got that far
+        if (!m_UseFeedbackCount && m_HasParticles)
+        {
+            unsigned int available = 0;
+            GLCall(glGetQueryObjectuiv(m_Buffers[m_Current].countQuery, GL_QUERY_RESULT_AVAILABLE, &available));
+            if (!available)
+            {
+                m_DeferredTime += deltaTime;
+                return;
+            }
+            GLCall(glGetQueryObjectuiv(m_Buffers[m_Current].countQuery, GL_QUERY_RESULT, &m_ParticleCount));
+        }
+        const float step = deltaTime + m_DeferredTime;
+        m_DeferredTime = 0.0f;
+
+        const Utils::ParticleSettings& settings = m_Settings;
+        const float emitted = std::max(settings.emitRate * step + m_EmitRemainder, 0.0f);
+        const unsigned int emitCount = static_cast<unsigned int>(std::min(emitted, static_cast<float>(m_Capacity)));
+        m_EmitRemainder = emitted - static_cast<float>(emitCount);
+
+        GLCall(glUseProgram(m_UpdateProgram));
+        GLCall(glUniform1f(m_Uniforms.deltaTime, step));
+        GLCall(glUniform3f(m_Uniforms.gravity, settings.gravity.x, settings.gravity.y, settings.gravity.z));
+        GLCall(glUniform1f(m_Uniforms.damping, std::max(1.0f - settings.drag * step, 0.0f)));
+        GLCall(glUniform1f(m_Uniforms.bounce, 1.0f + settings.restitution));
+        const unsigned int planeCount = std::min(static_cast<unsigned int>(m_Planes.size()), MAX_PLANES);
+        float planes[MAX_PLANES * 4] = {};
+        for (unsigned int i = 0; i < planeCount; i++)
+        {
+            planes[i * 4 + 0] = m_Planes[i].normal.x;
+            planes[i * 4 + 1] = m_Planes[i].normal.y;
+            planes[i * 4 + 2] = m_Planes[i].normal.z;
+            planes[i * 4 + 3] = m_Planes[i].distance;
+        }
+        GLCall(glUniform4fv(m_Uniforms.planes, MAX_PLANES, planes));
+        GLCall(glUniform1i(m_Uniforms.planeCount, static_cast<int>(planeCount)));
+        GLCall(glUniform1ui(m_Uniforms.seed, m_Frame++));
+        GLCall(glUniform3f(m_Uniforms.emitterPosition, settings.emitterPosition.x, settings.emitterPosition.y, settings.emitterPosition.z));
+        GLCall(glUniform3f(m_Uniforms.emitterExtent, settings.emitterExtent.x, settings.emitterExtent.y, settings.emitterExtent.z));
+        GLCall(glUniform3f(m_Uniforms.emitterVelocity, settings.velocity.x, settings.velocity.y, settings.velocity.z));
+        GLCall(glUniform3f(m_Uniforms.velocitySpread, settings.velocitySpread.x, settings.velocitySpread.y, settings.velocitySpread.z));
+        GLCall(glUniform2f(m_Uniforms.lifetimeRange, settings.minLifetime, settings.maxLifetime));
+
+        const StateBuffer& source = m_Buffers[m_Current];
+        const StateBuffer& target = m_Buffers[1 - m_Current];
+        GLCall(glEnable(GL_RASTERIZER_DISCARD));
+        // The emitting draw reads the source too, its attributes are simply ignored
+        GLCall(glBindVertexArray(source.vertexArray));
+        if (m_UseFeedbackCount)
+        {
+            GLCall(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, target.transformFeedback));
+        }
+        else
+        {
+            GLCall(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, target.buffer));
+            GLCall(glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, target.countQuery));
+        }
+
+        // Both draws append to the same capture, the survivors first and the new particles after them
+        GLCall(glBeginTransformFeedback(GL_POINTS));
+        if (m_HasParticles)
+        {
+            GLCall(glUniform1i(m_Uniforms.emitting, GL_FALSE));
+            if (m_UseFeedbackCount)
+            {
+                GLCall(glDrawTransformFeedback(GL_POINTS, source.transformFeedback));
+            }
+            else if (m_ParticleCount > 0)
+            {
+                GLCall(glDrawArrays(GL_POINTS, 0, m_ParticleCount));
+            }
+        }
+        if (emitCount > 0)
+        {
+            GLCall(glUniform1i(m_Uniforms.emitting, GL_TRUE));
+            GLCall(glDrawArrays(GL_POINTS, 0, emitCount));
+        }
+        GLCall(glEndTransformFeedback());
+
+        if (m_UseFeedbackCount)
+        {
+            GLCall(glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0));
+        }
+        else
+        {
+            GLCall(glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN));
+            GLCall(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0));
+        }
+        GLCall(glBindVertexArray(0));
+        GLCall(glDisable(GL_RASTERIZER_DISCARD));
+        GLCall(glUseProgram(0));
+
+        // without the count of the new capture the source stays drawn, until an update reads that count
+        m_Drawn = m_UseFeedbackCount ? 1 - m_Current : m_Current;
+        m_Current = 1 - m_Current;
+        m_HasParticles = true;
+    }
+
+    void GpuParticleSystem::Clear()
+    {
+        m_HasParticles = false;
+        m_ParticleCount = 0;
+        m_DeferredTime = 0.0f;
+        m_EmitRemainder = 0.0f;
+    }
+
+    void GpuParticleSystem::SetUniforms(const Shader& shader, const int viewportHeight) const
+    {
+        const Utils::ParticleSettings& settings = m_Settings;
+        shader.SetUniform4f("startColor", settings.startColor.r, settings.startColor.g, settings.startColor.b, settings.startColor.a);
+        shader.SetUniform4f("endColor", settings.endColor.r, settings.endColor.g, settings.endColor.b, settings.endColor.a);
+        shader.SetUniform4f("sizeRamp", settings.startSize, settings.endSize, static_cast<float>(viewportHeight), 0.0f);
+    }
+
+    void GpuParticleSystem::Bind() const
+    {
+        GLCall(glBindVertexArray(m_Buffers[m_Drawn].vertexArray));
+    }
+}  // namespace GLBasics
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../Utils/ParticleSystem.h"
+
+namespace GLBasics
+{
+    class Shader;
+
+    /**
+     * \brief Simulates particles on the GPU with transform feedback, so the CPU never touches them.
+     * The particles live in two buffers used in turn: each update draws the particles of one as
+     * points through a vertex shader that moves them and a geometry shader that drops the dead ones,
+     * capturing the survivors into the other, then draws the new particles into the same capture.
+     * The number captured stays in the transform feedback object and is drawn from with
+     * glDrawTransformFeedback. Without ARB_transform_feedback2 it is counted by a query per buffer
+     * that is only read once the GPU is done with it: until then updates are put off and their time
+     * saved for the next one, and the particles are drawn one update late from the buffer whose count
+     * is known. Particles that don't fit are dropped, so the capacity can be large
+     */
+    class GpuParticleSystem
+    {
+    public:
+        static constexpr unsigned int MAX_PLANES = 4;
+
+    private:
+        struct StateBuffer
+        {
+            unsigned int buffer;
+            unsigned int vertexArray;
+            unsigned int transformFeedback;  // 0 without ARB_transform_feedback2
+            unsigned int countQuery;         // counts the captures into the buffer, 0 with ARB_transform_feedback2
+        };
+
+        struct UpdateUniforms
+        {
+            int deltaTime, gravity, damping, bounce, planes, planeCount;
+            int emitting, seed, emitterPosition, emitterExtent, emitterVelocity, velocitySpread, lifetimeRange;
+        };
+
+        Utils::ParticleSettings m_Settings;
+        std::vector<Utils::ParticlePlane> m_Planes;
+
+        unsigned int m_Capacity;
+        StateBuffer m_Buffers[2];
+        unsigned int m_Current;  // the buffer captured last
+        unsigned int m_Drawn;    // the buffer drawn, the one captured last unless its count isn't known yet
+        bool m_HasParticles;     // false until the current buffer was captured into
+        bool m_UseFeedbackCount;
+        unsigned int m_ParticleCount;  // in the drawn buffer, only known without ARB_transform_feedback2
+        float m_DeferredTime;          // of the updates put off while waiting for a count
+
+        unsigned int m_UpdateProgram;
+        UpdateUniforms m_Uniforms;
+        float m_EmitRemainder;
+        unsigned int m_Frame;
+
+    public:
+        /**
+         * \brief Constructs a system without particles and compiles the update program
+         * \param capacity The most particles alive at once
+         * \param vertexShaderPath The vertex shader that moves and emits particles
+         * \param geometryShaderPath The geometry shader that drops the dead ones
+         */
+        GpuParticleSystem(unsigned int capacity, const std::string& vertexShaderPath = "res/shaders/GpuParticleUpdateVertex.glsl",
+                          const std::string& geometryShaderPath = "res/shaders/GpuParticleUpdateGeometry.glsl");
+
+        GpuParticleSystem(const GpuParticleSystem&) = delete;
+        GpuParticleSystem& operator=(const GpuParticleSystem&) = delete;
+
+        /**
+         * \brief Deletes the buffers and the update program
+         */
+        ~GpuParticleSystem();
+
+        /**
+         * \brief Emit, move and bounce the particles and drop the ones that outlived their lifetime.
+         * Without ARB_transform_feedback2 this is put off while the count of the last capture isn't
+         * known yet. Leaves no VAO bound
+         * \param deltaTime The time since the last update in seconds
+         */
+        void Update(float deltaTime);
+
+        /**
+         * \brief Kill every particle
+         */
+        void Clear();
+
+        /**
+         * \brief Add a plane for the particles to bounce off, the first MAX_PLANES are used
+         * \param plane The plane
+         */
+        inline void AddPlane(const Utils::ParticlePlane& plane) { m_Planes.push_back(plane); }
+
+        /**
+         * \brief Remove every plane
+         */
+        inline void ClearPlanes() { m_Planes.clear(); }
+
+        /**
+         * \brief Get the emitter, physics and look settings, changes take effect on the next Update
+         * \return The settings
+         */
+        inline Utils::ParticleSettings& GetSettings() { return m_Settings; }
+
+        /**
+         * \brief Set the size and color ramps of the settings on a shader drawing the particles
+         * \param shader A shader built from GpuParticleVertex.glsl
+         * \param viewportHeight The height of the viewport in pixels, which the point size depends on
+         */
+        void SetUniforms(const Shader& shader, int viewportHeight) const;
+
+        /**
+         * \brief Bind the VAO of the particles to draw, position at location 0, velocity at 1 and age and lifetime at 2
+         */
+        void Bind() const;
+
+        /**
+         * \brief Get whether there is anything to draw
+         * \return true after the first Update; false before or after Clear
+         */
+        inline bool HasParticles() const { return m_HasParticles; }
+
+        /**
+         * \brief Get the transform feedback object holding the number of particles, for glDrawTransformFeedback
+         * \return Its name, 0 without ARB_transform_feedback2
+         */
+        inline unsigned int GetTransformFeedbackID() const { return m_Buffers[m_Current].transformFeedback; }
+
+        /**
+         * \brief Get the number of particles to draw, only known on the CPU without ARB_transform_feedback2
+         * \return The number read back from the query of the drawn buffer
+         */
+        inline unsigned int GetParticleCount() const { return m_ParticleCount; }
+
+        /**
+         * \brief Get the most particles alive at once
+         * \return The capacity
+         */
+        inline unsigned int GetCapacity() const { return m_Capacity; }
+
+    };  // class GpuParticleSystem
+}  // namespace GLBasics
@@ -1,15 +1,28 @@
 #include "IndexBuffer.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "../Utils/GLDebugHelper.h"
 
 namespace GLBasics
 {
-    IndexBuffer::IndexBuffer(const unsigned* data, unsigned count)
-        : m_RendererID(0), m_Count(count)
+    IndexBuffer::IndexBuffer(const unsigned* data, const unsigned count)
+        : m_RendererID(0), m_Count(count), m_Type(ChooseType(data, count)),
+          m_PrimitiveRestart(std::find(data, data + count, RESTART_INDEX) != data + count)
     {
+        const std::vector<uint8_t> packed = Pack(data, m_Count, m_Type);
         GLCall(glGenBuffers(1, &m_RendererID));
         GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
-        GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+        GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, packed.size(), packed.data(), GL_STATIC_DRAW));
+    }
+
+    IndexBuffer::IndexBuffer(const void* data, const unsigned count, const unsigned type, const bool primitiveRestart)
+        : m_RendererID(0), m_Count(count), m_Type(type), m_PrimitiveRestart(primitiveRestart)
+    {
+        GLCall(glGenBuffers(1, &m_RendererID));
+        GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+        GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Count * GetTypeSize(m_Type), data, GL_STATIC_DRAW));
     }
 
     IndexBuffer::~IndexBuffer()
@@ -26,4 +39,53 @@ namespace GLBasics
     {
         GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
     }
+
+    unsigned int IndexBuffer::ChooseType(const unsigned int* data, const unsigned int count)
+    {
+        unsigned int maxIndex = 0;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (data[i] != RESTART_INDEX)
+            {
+                maxIndex = std::max(maxIndex, data[i]);
+            }
+        }
+        // The largest value of each type is kept for primitive restart
+        return maxIndex < 0xFF ? GL_UNSIGNED_BYTE : maxIndex < 0xFFFF ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    }
+
+    std::vector<uint8_t> IndexBuffer::Pack(const unsigned int* data, const unsigned int count, const unsigned int type)
+    {
+        std::vector<uint8_t> packed(static_cast<size_t>(count) * GetTypeSize(type));
+        if (type == GL_UNSIGNED_BYTE)
+        {
+            for (unsigned int i = 0; i < count; i++)
+            {
+                packed[i] = static_cast<uint8_t>(data[i] == RESTART_INDEX ? 0xFF : data[i]);
+            }
+        }
+        else if (type == GL_UNSIGNED_SHORT)
+        {
+            uint16_t* indices = reinterpret_cast<uint16_t*>(packed.data());
+            for (unsigned int i = 0; i < count; i++)
+            {
+                indices[i] = static_cast<uint16_t>(data[i] == RESTART_INDEX ? 0xFFFF : data[i]);
+            }
+        }
+        else if (count > 0)
+        {
+            std::memcpy(packed.data(), data, packed.size());
+        }
+        return packed;
+    }
+
+    unsigned int IndexBuffer::GetTypeSize(const unsigned int type)
+    {
+        return type == GL_UNSIGNED_BYTE ? 1 : type == GL_UNSIGNED_SHORT ? 2 : 4;
+    }
+
+    unsigned int IndexBuffer::GetRestartIndex(const unsigned int type)
+    {
+        return type == GL_UNSIGNED_BYTE ? 0xFF : type == GL_UNSIGNED_SHORT ? 0xFFFF : 0xFFFFFFFF;
+    }
 }  // namespace GLBasics
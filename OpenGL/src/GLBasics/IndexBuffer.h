@@ -1,29 +1,56 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 namespace GLBasics
 {
     /**
-     * \brief IndexBuffer class representing one single IBO in OpenGL
+     * \brief IndexBuffer class representing one single IBO in OpenGL. The indices are stored as the
+     * narrowest of unsigned bytes, shorts or ints that holds the largest one
      */
     class IndexBuffer
     {
     private:
         unsigned int m_RendererID;
         unsigned int m_Count;
+        unsigned int m_Type;
+        bool m_PrimitiveRestart;
 
     public:
+        /**
+         * \brief Marks where a strip or fan ends and the next one starts, in the indices given to the constructor
+         */
+        static constexpr unsigned int RESTART_INDEX = 0xFFFFFFFF;
+
         /**
          * \brief Constructs a IBO. Client is responsible for freeing the data
-         * \param data A const unsigned int pointer pointing to the beginning of the buffer
+         * \param data A const unsigned int pointer pointing to the beginning of the buffer, RESTART_INDEX
+         * starts a new primitive
          * \param count The number of unsigned int inside the buffer
          */
         IndexBuffer(const unsigned int* data, unsigned int count);
 
+        /**
+         * \brief Constructs a IBO from indices already stored as type, such as the ones from Pack
+         * \param data A pointer to the beginning of the buffer
+         * \param count The number of indices inside the buffer
+         * \param type GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+         * \param primitiveRestart Whether the largest value of type starts a new primitive
+         */
+        IndexBuffer(const void* data, unsigned int count, unsigned int type, bool primitiveRestart);
+
         /**
          * \brief Calls the underlying OpenGL functions to delete the buffer
          */
         ~IndexBuffer();
 
+        /**
+         * \brief Get the OpenGL name of the buffer
+         * \return The buffer name
+         */
+        inline unsigned int GetRendererID() const { return m_RendererID; }
+
         /**
          * \brief Bind the buffer stored in this IBO
          */
@@ -40,5 +67,54 @@ namespace GLBasics
          */
         inline unsigned int GetCount() const { return m_Count; }
 
+        /**
+         * \brief Get how the indices are stored, for glDrawElements
+         * \return GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+         */
+        inline unsigned int GetType() const { return m_Type; }
+
+        /**
+         * \brief Get whether the indices have to be drawn with primitive restart enabled
+         * \return true if some index is GetRestartIndex; false otherwise
+         */
+        inline bool HasPrimitiveRestart() const { return m_PrimitiveRestart; }
+
+        /**
+         * \brief Get the value that starts a new primitive in this IBO
+         * \return The largest value of the index type
+         */
+        inline unsigned int GetRestartIndex() const { return GetRestartIndex(m_Type); }
+
+        /**
+         * \brief Find the narrowest type that holds every index, leaving its largest value for primitive restart
+         * \param data The indices, RESTART_INDEX is skipped
+         * \param count The number of indices
+         * \return GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+         */
+        static unsigned int ChooseType(const unsigned int* data, unsigned int count);
+
+        /**
+         * \brief Narrow indices to a type, turning RESTART_INDEX into the restart index of the type
+         * \param data The indices, each of which fits in type
+         * \param count The number of indices
+         * \param type GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+         * \return The bytes to upload
+         */
+        static std::vector<uint8_t> Pack(const unsigned int* data, unsigned int count, unsigned int type);
+
+        /**
+         * \brief Get the size of one index
+         * \param type GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+         * \return 1, 2 or 4
+         */
+        static unsigned int GetTypeSize(unsigned int type);
+
+        /**
+         * \brief Get the value that starts a new primitive
+         * \param type GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+         * \return 0xFF, 0xFFFF or 0xFFFFFFFF
+         */
+        static unsigned int GetRestartIndex(unsigned int type);
+
     };  // class IndexBuffer
 }  // namespace GLBasics
@@ -0,0 +1,56 @@
+#include "InstanceStream.h"
+
+#include "../Utils/GLDebugHelper.h"
+
+namespace GLBasics
+{
+    InstanceStream::InstanceStream(const size_t size)
+        : m_RendererID(0), m_Size(std::max<size_t>(size, 1)), m_WriteOffset(0), m_OrphanCount(0)
+    {
+        GLCall(glGenBuffers(1, &m_RendererID));
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+        GLCall(glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GL_STREAM_DRAW));
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    }
+
+    InstanceStream::~InstanceStream()
+    {
+        GLCall(glDeleteBuffers(1, &m_RendererID));
+    }
+
+    void* InstanceStream::Map(const size_t size, size_t& offset)
+    {
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+        if (size > m_Size)
+        {
+            m_Size = std::max(size, m_Size * 2);
+            GLCall(glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GL_STREAM_DRAW));
+            m_WriteOffset = 0;
+        }
+        else if (m_WriteOffset + size > m_Size)
+        {
+            // the draws from the old storage keep it alive, new storage is written to without waiting for them
+            GLCall(glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GL_STREAM_DRAW));
+            m_WriteOffset = 0;
+            m_OrphanCount++;
+        }
+
+        // nothing reads the range past the write offset since the storage was last replaced
+        offset = m_WriteOffset;
+        m_WriteOffset += size;
+        GLCall(void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, offset, size,
+                                               GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+        if (!mapped)
+        {
+            GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+        }
+        return mapped;
+    }
+
+    bool InstanceStream::Unmap()
+    {
+        GLCall(const bool unmapped = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE);
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+        return unmapped;
+    }
+}  // namespace GLBasics
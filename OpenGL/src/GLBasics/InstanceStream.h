@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace GLBasics
+{
+    /**
+     * \brief Convert a value in [0, 1] to a normalized 16-bit integer, clamping anything outside
+     * \param value The value to convert
+     * \return The rounded integer
+     */
+    inline uint16_t ToUnorm16(const float value)
+    {
+        return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+    }
+
+    /**
+     * \brief Convert a value in [0, 1] to a normalized 8-bit integer, clamping anything outside
+     * \param value The value to convert
+     * \return The rounded integer
+     */
+    inline uint8_t ToUnorm8(const float value)
+    {
+        return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    /**
+     * \brief A vertex buffer that instance data is written to every frame. Each frame's data goes
+     * after the previous one's and is mapped unsynchronized, since nothing reads the range past the
+     * write offset. When the data doesn't fit any more the storage is orphaned, so the draws from
+     * the old storage keep it alive and writing never waits for them. Data larger than the whole
+     * buffer grows it
+     */
+    class InstanceStream
+    {
+    private:
+        unsigned int m_RendererID;
+        size_t m_Size;
+        size_t m_WriteOffset;
+        unsigned int m_OrphanCount;
+
+    public:
+        /**
+         * \brief Constructs the buffer with storage for the given number of bytes
+         * \param size The initial size of the buffer, at least one byte
+         */
+        explicit InstanceStream(size_t size);
+
+        InstanceStream(const InstanceStream&) = delete;
+        InstanceStream& operator=(const InstanceStream&) = delete;
+
+        /**
+         * \brief Calls the underlying OpenGL function to delete the buffer
+         */
+        ~InstanceStream();
+
+        /**
+         * \brief Map the range the next data is written to. The buffer stays bound to GL_ARRAY_BUFFER
+         * until Unmap if the map succeeded
+         * \param size The number of bytes to write
+         * \param offset Receives where the range starts in the buffer, for pointing the attributes at it
+         * \return The mapped range, or nullptr if the map failed and nothing may be drawn from it
+         */
+        void* Map(size_t size, size_t& offset);
+
+        /**
+         * \brief Unmap the range from the last successful Map and unbind the buffer
+         * \return true if the data arrived; false if the storage was lost, as on a mode switch
+         */
+        bool Unmap();
+
+        /**
+         * \brief Get the OpenGL name of the buffer, which stays the same when it grows
+         * \return The name of the buffer
+         */
+        inline unsigned int GetRendererID() const { return m_RendererID; }
+
+        /**
+         * \brief Get how often the buffer filled up and got new storage
+         * \return The number of orphaned buffers
+         */
+        inline unsigned int GetOrphanCount() const { return m_OrphanCount; }
+
+    };  // class InstanceStream
+}  // namespace GLBasics
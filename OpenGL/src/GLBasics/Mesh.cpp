@@ -0,0 +1,100 @@
+#include "Mesh.h"
+
+#include "../Utils/MeshOptimizer.h"
+
+namespace GLBasics
+{
+    Mesh::Mesh(const Utils::MeshData& data, VertexArrayCache* vertexArrayCache, MeshBufferPool* meshBufferPool)
+        : m_VertexArrayCache(vertexArrayCache && vertexArrayCache->IsSupported() ? vertexArrayCache : nullptr),
+          m_MeshBufferPool(m_VertexArrayCache ? meshBufferPool : nullptr),
+          m_VertexArray(CreateVertexArray(m_VertexArrayCache)),
+          m_PoolHandle(MeshBufferPool::INVALID_HANDLE), m_IndexType(0), m_IndexCount(static_cast<unsigned int>(data.indices.size())),
+          m_BoundsMin(data.boundsMin), m_BoundsMax(data.boundsMax),
+          m_PositionTransform(Utils::VertexQuantizer::GetPositionTransform(data)), m_Format(0)
+    {
+        // Split only when needed, to not copy the mesh; the parts keep the bounds so they quantize alike
+        std::vector<Utils::MeshData> split;
+        if (data.vertices.size() > 0xFFFF)
+        {
+            split = Utils::MeshOptimizer::Split(data);
+        }
+
+        std::vector<Utils::QuantizedVertex> vertices;
+        std::vector<unsigned int> indices;
+        const size_t partCount = split.empty() ? 1 : split.size();
+        for (size_t i = 0; i < partCount; i++)
+        {
+            const Utils::MeshData& part = split.empty() ? data : split[i];
+            m_Parts.push_back({ static_cast<unsigned int>(part.indices.size()), indices.size(), static_cast<int>(vertices.size()) });
+            const std::vector<Utils::QuantizedVertex> quantized = Utils::VertexQuantizer::Quantize(part);
+            vertices.insert(vertices.end(), quantized.begin(), quantized.end());
+            indices.insert(indices.end(), part.indices.begin(), part.indices.end());
+        }
+
+        m_IndexType = IndexBuffer::ChooseType(indices.data(), static_cast<unsigned int>(indices.size()));
+        const unsigned int indexSize = IndexBuffer::GetTypeSize(m_IndexType);
+        for (MeshPart& part : m_Parts)
+        {
+            part.indexOffset *= indexSize;
+        }
+        const std::vector<uint8_t> packed = IndexBuffer::Pack(indices.data(), static_cast<unsigned int>(indices.size()), m_IndexType);
+
+        if (m_MeshBufferPool)
+        {
+            m_PoolHandle = m_MeshBufferPool->Allocate(vertices.data(), static_cast<unsigned int>(vertices.size()), packed.data(), m_IndexCount, indexSize);
+        }
+        else
+        {
+            m_VertexBuffer = std::make_unique<VertexBuffer>(vertices.data(), static_cast<unsigned int>(vertices.size() * sizeof(Utils::QuantizedVertex)));
+            m_IndexBuffer = std::make_unique<IndexBuffer>(packed.data(), m_IndexCount, m_IndexType, false);
+        }
+
+        if (m_VertexArrayCache)
+        {
+            m_Format = m_VertexArrayCache->GetFormat<Utils::QuantizedVertex>();
+        }
+        else
+        {
+            m_VertexArray->BindBuffer<Utils::QuantizedVertex>(*m_VertexBuffer, *m_IndexBuffer);
+        }
+    }
+
+    Mesh::~Mesh()
+    {
+        if (m_MeshBufferPool)
+        {
+            m_MeshBufferPool->Free(m_PoolHandle);
+        }
+        else if (m_VertexArrayCache)
+        {
+            m_VertexArrayCache->Release(*m_VertexBuffer, *m_IndexBuffer);
+        }
+    }
+
+    void Mesh::Bind() const
+    {
+        if (m_MeshBufferPool)
+        {
+            const MeshAllocation& allocation = m_MeshBufferPool->Get(m_PoolHandle);
+            m_VertexArrayCache->Bind(m_Format, allocation.vertexBuffer, sizeof(Utils::QuantizedVertex), allocation.indexBuffer);
+        }
+        else if (m_VertexArrayCache)
+        {
+            m_VertexArrayCache->Bind(m_Format, *m_VertexBuffer, sizeof(Utils::QuantizedVertex), *m_IndexBuffer);
+        }
+        else
+        {
+            m_VertexArray->Bind();
+        }
+    }
+
+    std::unique_ptr<VertexArray> Mesh::CreateVertexArray(VertexArrayCache* vertexArrayCache)
+    {
+        if (vertexArrayCache)
+        {
+            vertexArrayCache->Invalidate();
+            return nullptr;
+        }
+        return std::make_unique<VertexArray>();
+    }
+}  // namespace GLBasics
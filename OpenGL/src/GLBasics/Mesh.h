@@ -0,0 +1,141 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <GLM/glm.hpp>
+
+#include "IndexBuffer.h"
+#include "MeshBufferPool.h"
+#include "VertexArray.h"
+#include "VertexArrayCache.h"
+#include "VertexBuffer.h"
+#include "VertexLayout.h"
+#include "../Utils/MeshImporter.h"
+#include "../Utils/VertexQuantizer.h"
+
+namespace GLBasics
+{
+    template<>
+    struct VertexTraits<Utils::QuantizedVertex>
+    {
+        static constexpr std::array<VertexAttribute, 3> attributes = {
+            VERTEX_ATTRIBUTE(Utils::QuantizedVertex, position, Normalized),
+            VERTEX_ATTRIBUTE(Utils::QuantizedVertex, texCoord, Float),
+            VERTEX_ATTRIBUTE(Utils::QuantizedVertex, normal, Normalized)
+        };
+    };
+
+    /**
+     * \brief A range of a Mesh's indices drawn with one call
+     */
+    struct MeshPart
+    {
+        unsigned int indexCount;
+        size_t indexOffset;  // in bytes, from the mesh's first index
+        int baseVertex;      // from the mesh's first vertex
+    };
+
+    /**
+     * \brief An indexed triangle mesh on the GPU, stored as 12-byte quantized vertices with the
+     * position, texture coordinate and normal at attribute locations 0, 1 and 2. Positions are read
+     * in [0, 1] across the bounds, so the model matrix has to be multiplied by GetPositionTransform.
+     * Given a pool, the mesh lives in its arenas instead of buffers of its own and has to be drawn
+     * with GetBaseVertex and GetIndexOffset. Indices are 8 or 16-bit, meshes with more vertices than
+     * 16 bits can index are split into parts drawn one after the other
+     */
+    class Mesh
+    {
+    private:
+        VertexArrayCache* m_VertexArrayCache;
+        MeshBufferPool* m_MeshBufferPool;
+        std::unique_ptr<VertexArray> m_VertexArray;  // first, so the buffers below are recorded in it and in no other VAO
+        std::unique_ptr<VertexBuffer> m_VertexBuffer;  // null in the pool
+        std::unique_ptr<IndexBuffer> m_IndexBuffer;
+        unsigned int m_PoolHandle;
+        unsigned int m_IndexType;
+        unsigned int m_IndexCount;
+        std::vector<MeshPart> m_Parts;
+
+        glm::vec3 m_BoundsMin;
+        glm::vec3 m_BoundsMax;
+        glm::mat4 m_PositionTransform;
+        unsigned int m_Format;  // in m_VertexArrayCache
+
+    public:
+        /**
+         * \brief Uploads an imported mesh
+         * \param data The vertices, indices and bounds, can be freed once the mesh is constructed
+         * \param vertexArrayCache Shares its VAO with the other meshes, nullptr or an unsupported cache to give the mesh its own. Must outlive the mesh
+         * \param meshBufferPool Where to put the vertices and indices, with a stride of sizeof(Utils::QuantizedVertex).
+         * Only used along with a supported cache, nullptr for buffers of the mesh's own. Must outlive the mesh
+         */
+        explicit Mesh(const Utils::MeshData& data, VertexArrayCache* vertexArrayCache = nullptr, MeshBufferPool* meshBufferPool = nullptr);
+
+        Mesh(const Mesh&) = delete;
+        Mesh& operator=(const Mesh&) = delete;
+
+        /**
+         * \brief Releases the buffers from the shared VAO, or the space in the pool
+         */
+        ~Mesh();
+
+        /**
+         * \brief Bind the VAO and buffers to draw the mesh with
+         */
+        void Bind() const;
+
+        /**
+         * \brief Get the number of indices to draw
+         * \return Three times the number of triangles
+         */
+        inline unsigned int GetIndexCount() const { return m_IndexCount; }
+
+        /**
+         * \brief Get how the indices are stored
+         * \return GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+         */
+        inline unsigned int GetIndexType() const { return m_IndexType; }
+
+        /**
+         * \brief Get the ranges to draw, relative to GetBaseVertex and GetIndexOffset
+         * \return One part, or more for meshes split to keep their indices 16-bit
+         */
+        inline const std::vector<MeshPart>& GetParts() const { return m_Parts; }
+
+        /**
+         * \brief Get the value added to every index, for glDrawElementsBaseVertex
+         * \return The first vertex of the mesh in the bound vertex buffer
+         */
+        inline int GetBaseVertex() const { return m_MeshBufferPool ? m_MeshBufferPool->Get(m_PoolHandle).baseVertex : 0; }
+
+        /**
+         * \brief Get where the indices start in the bound index buffer
+         * \return The offset in bytes
+         */
+        inline size_t GetIndexOffset() const { return m_MeshBufferPool ? m_MeshBufferPool->Get(m_PoolHandle).indexOffset : 0; }
+
+        /**
+         * \brief Get the corner of the bounding box with the smallest coordinates
+         * \return The corner in model space
+         */
+        inline const glm::vec3& GetBoundsMin() const { return m_BoundsMin; }
+
+        /**
+         * \brief Get the corner of the bounding box with the largest coordinates
+         * \return The corner in model space
+         */
+        inline const glm::vec3& GetBoundsMax() const { return m_BoundsMax; }
+
+        /**
+         * \brief Get the transform from the stored positions to model space
+         * \return The matrix the model matrix is multiplied by
+         */
+        inline const glm::mat4& GetPositionTransform() const { return m_PositionTransform; }
+
+    private:
+        // Makes the mesh's own VAO, or unbinds the shared ones so creating the buffers leaves them alone
+        static std::unique_ptr<VertexArray> CreateVertexArray(VertexArrayCache* vertexArrayCache);
+
+    };  // class Mesh
+}  // namespace GLBasics
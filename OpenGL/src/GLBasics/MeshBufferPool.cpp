@@ -0,0 +1,229 @@
+#include "MeshBufferPool.h"
+
+#include <algorithm>
+
+#include "VertexArrayCache.h"
+#include "../Utils/GLDebugHelper.h"
+
+namespace GLBasics
+{
+    namespace
+    {
+        // Small enough not to waste much on tiny meshes, large enough to keep the free lists short
+        constexpr size_t MIN_BLOCK_SIZE = 256;
+    }
+
+    MeshBufferPool::Arena::Arena(const size_t size, const size_t minBlockSize)
+        : buffer(0), allocator(size, minBlockSize)
+    {
+        // The copy targets leave the VAOs' element buffers alone
+        GLCall(glGenBuffers(1, &buffer));
+        GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+        GLCall(glBufferData(GL_COPY_WRITE_BUFFER, allocator.GetSize(), nullptr, GL_STATIC_DRAW));
+    }
+
+    MeshBufferPool::Arena::~Arena()
+    {
+        GLCall(glDeleteBuffers(1, &buffer));
+    }
+
+    MeshBufferPool::MeshBufferPool(VertexArrayCache& vertexArrayCache, const unsigned int vertexStride, const size_t arenaSize)
+        : m_VertexArrayCache(vertexArrayCache), m_VertexStride(vertexStride), m_ArenaSize(arenaSize)
+    {
+    }
+
+    MeshBufferPool::~MeshBufferPool()
+    {
+        for (const auto& arena : m_VertexArenas)
+        {
+            m_VertexArrayCache.Release(arena->buffer);
+        }
+        for (const auto& arena : m_IndexArenas)
+        {
+            m_VertexArrayCache.Release(arena->buffer);
+        }
+    }
+
+    unsigned int MeshBufferPool::Allocate(const void* vertices, const unsigned int vertexCount, const void* indices, const unsigned int indexCount,
+                                          const unsigned int indexSize)
+    {
+        Entry entry;
+        entry.vertexBytes = static_cast<size_t>(vertexCount) * m_VertexStride;
+        entry.indexBytes = static_cast<size_t>(indexCount) * indexSize;
+        // One stride more than needed, so the vertices can start on a multiple of the stride
+        entry.vertexArena = AllocateBlock(m_VertexArenas, entry.vertexBytes + m_VertexStride - 1, nullptr, true, entry.vertexBlock);
+        entry.indexArena = AllocateBlock(m_IndexArenas, std::max<size_t>(entry.indexBytes, 1), nullptr, true, entry.indexBlock);
+
+        MeshAllocation& allocation = entry.allocation;
+        allocation.vertexBuffer = entry.vertexArena->buffer;
+        allocation.indexBuffer = entry.indexArena->buffer;
+        allocation.baseVertex = GetBaseVertex(entry.vertexBlock);
+        allocation.indexOffset = entry.indexBlock;
+        allocation.indexCount = indexCount;
+
+        GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, allocation.vertexBuffer));
+        GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<size_t>(allocation.baseVertex) * m_VertexStride, entry.vertexBytes, vertices));
+        GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, allocation.indexBuffer));
+        GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.indexOffset, entry.indexBytes, indices));
+
+        if (!m_FreeHandles.empty())
+        {
+            const unsigned int handle = m_FreeHandles.back();
+            m_FreeHandles.pop_back();
+            m_Entries[handle] = entry;
+            return handle;
+        }
+        m_Entries.push_back(entry);
+        return static_cast<unsigned int>(m_Entries.size() - 1);
+    }
+
+    void MeshBufferPool::Free(const unsigned int handle)
+    {
+        Entry& entry = m_Entries[handle];
+        if (!entry.vertexArena)
+        {
+            return;
+        }
+        entry.vertexArena->allocator.Free(entry.vertexBlock);
+        entry.indexArena->allocator.Free(entry.indexBlock);
+        entry = Entry();
+        m_FreeHandles.push_back(handle);
+    }
+
+    size_t MeshBufferPool::Defragment(const size_t maxBytes)
+    {
+        size_t copied = Evacuate(m_VertexArenas, true, maxBytes);
+        copied += Evacuate(m_IndexArenas, false, maxBytes - copied);
+        DeleteEmptyArenas(m_VertexArenas);
+        DeleteEmptyArenas(m_IndexArenas);
+        return copied;
+    }
+
+    size_t MeshBufferPool::GetCapacity() const
+    {
+        size_t capacity = 0;
+        for (const auto& arena : m_VertexArenas)
+        {
+            capacity += arena->allocator.GetSize();
+        }
+        for (const auto& arena : m_IndexArenas)
+        {
+            capacity += arena->allocator.GetSize();
+        }
+        return capacity;
+    }
+
+    size_t MeshBufferPool::GetUsedBytes() const
+    {
+        size_t used = 0;
+        for (const auto& arena : m_VertexArenas)
+        {
+            used += arena->allocator.GetUsedBytes();
+        }
+        for (const auto& arena : m_IndexArenas)
+        {
+            used += arena->allocator.GetUsedBytes();
+        }
+        return used;
+    }
+
+    MeshBufferPool::Arena* MeshBufferPool::AllocateBlock(std::vector<std::unique_ptr<Arena>>& arenas, const size_t bytes,
+                                                         const Arena* skip, const bool grow, size_t& block)
+    {
+        for (const auto& arena : arenas)
+        {
+            if (arena.get() != skip && arena->allocator.Allocate(bytes, block))
+            {
+                return arena.get();
+            }
+        }
+        if (!grow)
+        {
+            return nullptr;
+        }
+        arenas.push_back(std::make_unique<Arena>(std::max(m_ArenaSize, bytes), MIN_BLOCK_SIZE));
+        arenas.back()->allocator.Allocate(bytes, block);
+        return arenas.back().get();
+    }
+
+    size_t MeshBufferPool::Evacuate(std::vector<std::unique_ptr<Arena>>& arenas, const bool vertexArenas, const size_t maxBytes)
+    {
+        if (arenas.size() < 2)
+        {
+            return 0;
+        }
+
+        Arena* source = nullptr;
+        for (const auto& arena : arenas)
+        {
+            const size_t used = arena->allocator.GetUsedBytes();
+            if (used > 0 && used < arena->allocator.GetSize() / 2 &&
+                (!source || used * source->allocator.GetSize() < source->allocator.GetUsedBytes() * arena->allocator.GetSize()))
+            {
+                source = arena.get();
+            }
+        }
+        if (!source)
+        {
+            return 0;
+        }
+
+        size_t copied = 0;
+        for (Entry& entry : m_Entries)
+        {
+            if ((vertexArenas ? entry.vertexArena : entry.indexArena) != source)
+            {
+                continue;
+            }
+            const size_t bytes = vertexArenas ? entry.vertexBytes : entry.indexBytes;
+            if (copied + bytes > maxBytes)
+            {
+                break;
+            }
+            size_t block;
+            Arena* target = AllocateBlock(arenas, vertexArenas ? bytes + m_VertexStride - 1 : std::max<size_t>(bytes, 1), source, false, block);
+            if (!target)
+            {
+                continue;
+            }
+
+            MeshAllocation& allocation = entry.allocation;
+            const size_t sourceOffset = vertexArenas ? static_cast<size_t>(allocation.baseVertex) * m_VertexStride : allocation.indexOffset;
+            const size_t targetOffset = vertexArenas ? static_cast<size_t>(GetBaseVertex(block)) * m_VertexStride : block;
+            GLCall(glBindBuffer(GL_COPY_READ_BUFFER, source->buffer));
+            GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, target->buffer));
+            GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, targetOffset, bytes));
+
+            if (vertexArenas)
+            {
+                source->allocator.Free(entry.vertexBlock);
+                entry.vertexArena = target;
+                entry.vertexBlock = block;
+                allocation.vertexBuffer = target->buffer;
+                allocation.baseVertex = GetBaseVertex(block);
+            }
+            else
+            {
+                source->allocator.Free(entry.indexBlock);
+                entry.indexArena = target;
+                entry.indexBlock = block;
+                allocation.indexBuffer = target->buffer;
+                allocation.indexOffset = block;
+            }
+            copied += bytes;
+        }
+        return copied;
+    }
+
+    void MeshBufferPool::DeleteEmptyArenas(std::vector<std::unique_ptr<Arena>>& arenas)
+    {
+        for (size_t i = arenas.size(); i-- > 0 && arenas.size() > 1;)
+        {
+            if (arenas[i]->allocator.IsEmpty())
+            {
+                m_VertexArrayCache.Release(arenas[i]->buffer);
+                arenas.erase(arenas.begin() + i);
+            }
+        }
+    }
+}  // namespace GLBasics
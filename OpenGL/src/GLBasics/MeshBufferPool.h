@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "../Utils/BuddyAllocator.h"
+
+namespace GLBasics
+{
+    class VertexArrayCache;
+
+    /**
+     * \brief Where a mesh lives in a MeshBufferPool, everything glDrawElementsBaseVertex needs
+     */
+    struct MeshAllocation
+    {
+        unsigned int vertexBuffer = 0;
+        unsigned int indexBuffer = 0;
+        int baseVertex = 0;      // added to every index
+        size_t indexOffset = 0;  // in bytes
+        unsigned int indexCount = 0;
+    };
+
+    /**
+     * \brief Carves the vertices and indices of many meshes of one vertex format out of a few large
+     * buffers, the arenas, so drawing them needs no buffer switches and far fewer objects exist for
+     * the driver to track. Each arena is split up with a buddy allocator. Defragment moves meshes out
+     * of the emptiest arenas into the holes of the others and deletes the arenas that become empty,
+     * so allocations are referred to by handle and have to be looked up again after it
+     */
+    class MeshBufferPool
+    {
+    private:
+        struct Arena
+        {
+            unsigned int buffer;
+            Utils::BuddyAllocator allocator;
+
+            Arena(size_t size, size_t minBlockSize);
+            ~Arena();
+        };
+
+        struct Entry
+        {
+            MeshAllocation allocation;
+            Arena* vertexArena = nullptr;
+            Arena* indexArena = nullptr;
+            size_t vertexBlock = 0;
+            size_t indexBlock = 0;
+            size_t vertexBytes = 0;
+            size_t indexBytes = 0;
+        };
+
+        VertexArrayCache& m_VertexArrayCache;
+        unsigned int m_VertexStride;
+        size_t m_ArenaSize;
+        std::vector<std::unique_ptr<Arena>> m_VertexArenas;
+        std::vector<std::unique_ptr<Arena>> m_IndexArenas;
+        std::vector<Entry> m_Entries;
+        std::vector<unsigned int> m_FreeHandles;
+
+    public:
+        static constexpr unsigned int INVALID_HANDLE = 0xFFFFFFFF;
+
+        /**
+         * \brief Constructs a pool without any arena
+         * \param vertexArrayCache Told about arenas before they are deleted. Must outlive the pool
+         * \param vertexStride The size of one vertex, the same for every mesh in the pool
+         * \param arenaSize The size of each arena, rounded up to a power of two. Larger meshes get an arena of their own
+         */
+        MeshBufferPool(VertexArrayCache& vertexArrayCache, unsigned int vertexStride, size_t arenaSize = 16 * 1024 * 1024);
+
+        MeshBufferPool(const MeshBufferPool&) = delete;
+        MeshBufferPool& operator=(const MeshBufferPool&) = delete;
+
+        /**
+         * \brief Deletes every arena
+         */
+        ~MeshBufferPool();
+
+        /**
+         * \brief Upload a mesh into the arenas, adding one if none has room
+         * \param vertices The vertices, vertexStride bytes each
+         * \param vertexCount The number of vertices
+         * \param indices The indices, counting from the mesh's first vertex
+         * \param indexCount The number of indices
+         * \param indexSize The size of one index, 1, 2 or 4
+         * \return A handle for Get and Free
+         */
+        unsigned int Allocate(const void* vertices, unsigned int vertexCount, const void* indices, unsigned int indexCount,
+                              unsigned int indexSize = sizeof(unsigned int));
+
+        /**
+         * \brief Give back the space of a mesh
+         * \param handle A handle from Allocate
+         */
+        void Free(unsigned int handle);
+
+        /**
+         * \brief Get where a mesh is right now, which changes when Defragment moves it
+         * \param handle A handle from Allocate
+         * \return The buffers and offsets to draw it from
+         */
+        inline const MeshAllocation& Get(const unsigned int handle) const { return m_Entries[handle].allocation; }
+
+        /**
+         * \brief Move meshes out of the emptiest arena into the others and delete the arenas that are empty.
+         * The copies are done on the GPU, so it's cheap enough to be called once per frame
+         * \param maxBytes How many bytes may be copied
+         * \return The number of bytes copied
+         */
+        size_t Defragment(size_t maxBytes = 4 * 1024 * 1024);
+
+        /**
+         * \brief Get the number of buffers the pool holds
+         * \return The number of vertex and index arenas
+         */
+        inline unsigned int GetArenaCount() const { return static_cast<unsigned int>(m_VertexArenas.size() + m_IndexArenas.size()); }
+
+        /**
+         * \brief Get the number of bytes the arenas take together
+         * \return The capacity in bytes
+         */
+        size_t GetCapacity() const;
+
+        /**
+         * \brief Get the number of bytes handed out, with the rounding up of every block
+         * \return The used bytes
+         */
+        size_t GetUsedBytes() const;
+
+    private:
+        // Takes a block from the first arena with room, adding one if grow is set
+        Arena* AllocateBlock(std::vector<std::unique_ptr<Arena>>& arenas, size_t bytes, const Arena* skip, bool grow, size_t& block);
+
+        // Moves the entries out of the emptiest arena that is less than half full, returns the bytes copied
+        size_t Evacuate(std::vector<std::unique_ptr<Arena>>& arenas, bool vertexArenas, size_t maxBytes);
+
+        // Deletes the empty arenas but one
+        void DeleteEmptyArenas(std::vector<std::unique_ptr<Arena>>& arenas);
+
+        // Returns the first vertex that starts at or after a block
+        inline int GetBaseVertex(const size_t block) const { return static_cast<int>((block + m_VertexStride - 1) / m_VertexStride); }
+
+    };  // class MeshBufferPool
+}  // namespace GLBasics
@@ -0,0 +1,101 @@
+#include "ParticleBuffer.h"
+
+#include <algorithm>
+
+namespace GLBasics
+{
+    ParticleBuffer::ParticleBuffer(const unsigned int capacity, const unsigned int bufferCount)
+        : m_Buffers(std::max(bufferCount, 1u)), m_CurrentBuffer(0),
+          m_BufferSize(static_cast<size_t>(std::max(capacity, 1u)) * sizeof(Utils::ParticleInstance)),
+          m_InstanceCount(0), m_OrphanCount(0)
+    {
+        for (InstanceBuffer& buffer : m_Buffers)
+        {
+            GLCall(glGenBuffers(1, &buffer.buffer));
+            GLCall(glBindBuffer(GL_ARRAY_BUFFER, buffer.buffer));
+            GLCall(glBufferData(GL_ARRAY_BUFFER, m_BufferSize, nullptr, GL_STREAM_DRAW));
+            buffer.vertexArray = std::make_unique<VertexArray>();
+            buffer.vertexArray->BindInstanceBuffer<Utils::ParticleInstance>(buffer.buffer);
+            buffer.vertexArray->UnBind();
+            buffer.fence = nullptr;
+        }
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    }
+
+    ParticleBuffer::~ParticleBuffer()
+    {
+        for (InstanceBuffer& buffer : m_Buffers)
+        {
+            if (buffer.fence)
+            {
+                GLCall(glDeleteSync(buffer.fence));
+            }
+            GLCall(glDeleteBuffers(1, &buffer.buffer));
+        }
+    }
+
+    void ParticleBuffer::Upload(const Utils::ParticleSystem& particles, Utils::ThreadPool* threadPool)
+    {
+        // Every draw from the current buffer has been issued by now
+        InstanceBuffer& drawn = m_Buffers[m_CurrentBuffer];
+        if (!drawn.fence)
+        {
+            GLCall(drawn.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        }
+        m_CurrentBuffer = (m_CurrentBuffer + 1) % m_Buffers.size();
+        InstanceBuffer& buffer = m_Buffers[m_CurrentBuffer];
+
+        m_InstanceCount = 0;
+        const size_t size = static_cast<size_t>(particles.GetAliveCount()) * sizeof(Utils::ParticleInstance);
+        if (size == 0)
+        {
+            return;
+        }
+        if (size > m_BufferSize)
+        {
+            std::cout << "ERROR::PARTICLE_BUFFER::CAPACITY_EXCEEDED " << particles.GetAliveCount() << " particles" << std::endl;
+            return;
+        }
+
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, buffer.buffer));
+        unsigned int access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+        if (buffer.fence)
+        {
+            GLCall(const unsigned int state = glClientWaitSync(buffer.fence, 0, 0));
+            if (state == GL_ALREADY_SIGNALED || state == GL_CONDITION_SATISFIED)
+            {
+                access |= GL_MAP_UNSYNCHRONIZED_BIT;
+            }
+            else
+            {
+                // fresh storage to write to while the driver keeps the old one until the draws from it are done
+                GLCall(glBufferData(GL_ARRAY_BUFFER, m_BufferSize, nullptr, GL_STREAM_DRAW));
+                m_OrphanCount++;
+            }
+            GLCall(glDeleteSync(buffer.fence));
+            buffer.fence = nullptr;
+        }
+        else
+        {
+            access |= GL_MAP_UNSYNCHRONIZED_BIT;
+        }
+
+        GLCall(void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, size, access));
+        if (mapped)
+        {
+            const unsigned int written = particles.WriteInstances(static_cast<Utils::ParticleInstance*>(mapped), threadPool);
+            // the contents are lost if the storage was, as on a mode switch
+            GLCall(const bool unmapped = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE);
+            if (unmapped)
+            {
+                m_InstanceCount = written;
+            }
+        }
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    }
+
+    void ParticleBuffer::Bind() const
+    {
+        m_Buffers[m_CurrentBuffer].vertexArray->Bind();
+    }
+}  // namespace GLBasics
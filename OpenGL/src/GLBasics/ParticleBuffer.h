@@ -0,0 +1,93 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "VertexArray.h"
+#include "VertexLayout.h"
+#include "../Utils/GLDebugHelper.h"
+#include "../Utils/ParticleSystem.h"
+
+namespace Utils
+{
+    class ThreadPool;
+}
+
+namespace GLBasics
+{
+    template<>
+    struct VertexTraits<Utils::ParticleInstance>
+    {
+        static constexpr std::array<VertexAttribute, 3> attributes = {
+            VERTEX_ATTRIBUTE(Utils::ParticleInstance, position, Float),
+            VERTEX_ATTRIBUTE(Utils::ParticleInstance, size, Float),
+            VERTEX_ATTRIBUTE(Utils::ParticleInstance, color, Normalized)
+        };
+    };
+
+    /**
+     * \brief Streams the alive particles of a Utils::ParticleSystem to the GPU every frame, to be
+     * drawn as instanced billboards with the position, size and color at attribute locations 0, 1
+     * and 2. The workers write the instances straight into a mapped buffer out of a ring, a buffer
+     * is fenced when the next upload starts, after the draws from it, and only written again once
+     * the fence has passed; its storage is orphaned otherwise so uploading never waits for the GPU
+     */
+    class ParticleBuffer
+    {
+    private:
+        struct InstanceBuffer
+        {
+            unsigned int buffer;
+            std::unique_ptr<VertexArray> vertexArray;
+            GLsync fence;  // nullptr once the draws from the buffer are known to be finished
+        };
+
+        std::vector<InstanceBuffer> m_Buffers;
+        unsigned int m_CurrentBuffer;
+        size_t m_BufferSize;
+        unsigned int m_InstanceCount;
+        unsigned int m_OrphanCount;
+
+    public:
+        /**
+         * \brief Constructs the ring of instance buffers and their VAOs
+         * \param capacity The most particles uploaded at once, the capacity of the system
+         * \param bufferCount The number of instance buffers used in turn
+         */
+        explicit ParticleBuffer(unsigned int capacity, unsigned int bufferCount = 3);
+
+        ParticleBuffer(const ParticleBuffer&) = delete;
+        ParticleBuffer& operator=(const ParticleBuffer&) = delete;
+
+        /**
+         * \brief Deletes the buffers and their fences
+         */
+        ~ParticleBuffer();
+
+        /**
+         * \brief Write the alive particles into the next buffer of the ring
+         * \param particles The system, with no more particles than the capacity
+         * \param threadPool The workers the instances are written on, nullptr to write them on the calling thread
+         */
+        void Upload(const Utils::ParticleSystem& particles, Utils::ThreadPool* threadPool = nullptr);
+
+        /**
+         * \brief Bind the VAO of the buffer uploaded last
+         */
+        void Bind() const;
+
+        /**
+         * \brief Get the number of particles uploaded last
+         * \return The number of instances to draw
+         */
+        inline unsigned int GetInstanceCount() const { return m_InstanceCount; }
+
+        /**
+         * \brief Get how often a buffer was still in use and had to get new storage instead, a
+         * number that keeps growing means the ring is too small
+         * \return The number of orphaned buffers
+         */
+        inline unsigned int GetOrphanCount() const { return m_OrphanCount; }
+
+    };  // class ParticleBuffer
+}  // namespace GLBasics
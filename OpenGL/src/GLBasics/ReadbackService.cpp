@@ -0,0 +1,102 @@
+#include "ReadbackService.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace GLBasics
+{
+    ReadbackService::ReadbackService(const unsigned int maxInFlight)
+        : m_Readbacks(std::max(maxInFlight, 1u)), m_RefusedCount(0)
+    {
+        for (unsigned int i = 0; i < m_Readbacks.size(); i++)
+        {
+            m_Readbacks[i] = { 0, 0, nullptr, 0, 0, nullptr };
+            GLCall(glGenBuffers(1, &m_Readbacks[i].buffer));
+            m_Free.push_back(i);
+        }
+    }
+
+    ReadbackService::~ReadbackService()
+    {
+        for (Readback& readback : m_Readbacks)
+        {
+            if (readback.fence)
+            {
+                GLCall(glDeleteSync(readback.fence));
+            }
+            GLCall(glDeleteBuffers(1, &readback.buffer));
+        }
+    }
+
+    bool ReadbackService::Request(const int x, const int y, const int width, const int height, Callback callback)
+    {
+        if (width <= 0 || height <= 0)
+        {
+            return false;
+        }
+        if (m_Free.empty())
+        {
+            m_RefusedCount++;
+            return false;
+        }
+
+        const unsigned int index = m_Free.back();
+        m_Free.pop_back();
+        Readback& readback = m_Readbacks[index];
+        readback.width = width;
+        readback.height = height;
+        readback.callback = std::move(callback);
+
+        const size_t size = static_cast<size_t>(width) * height * 4;
+        GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer));
+        if (size > readback.capacity)
+        {
+            GLCall(glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ));
+            readback.capacity = size;
+        }
+        // with a pack buffer bound this only queues the copy, the data pointer is an offset
+        GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+        GLCall(glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+        GLCall(readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+        m_InFlight.push_back(index);
+        return true;
+    }
+
+    void ReadbackService::Update()
+    {
+        // the GPU finishes in order, so the first readback that isn't done means none after it is
+        while (!m_InFlight.empty())
+        {
+            Readback& readback = m_Readbacks[m_InFlight.front()];
+            GLCall(const unsigned int state = glClientWaitSync(readback.fence, 0, 0));
+            if (state != GL_ALREADY_SIGNALED && state != GL_CONDITION_SATISFIED)
+            {
+                break;
+            }
+            GLCall(glDeleteSync(readback.fence));
+            readback.fence = nullptr;
+
+            const size_t size = static_cast<size_t>(readback.width) * readback.height * 4;
+            std::vector<unsigned char> pixels;
+            GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer));
+            GLCall(const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+            if (mapped)
+            {
+                pixels.assign(static_cast<const unsigned char*>(mapped), static_cast<const unsigned char*>(mapped) + size);
+                GLCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+            }
+            GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+            // the readback is free again before the callback runs, which may request the next one
+            const Callback callback = std::move(readback.callback);
+            const int width = readback.width, height = readback.height;
+            readback.callback = nullptr;
+            m_Free.push_back(m_InFlight.front());
+            m_InFlight.pop_front();
+
+            callback(pixels, width, height);
+        }
+    }
+}  // namespace GLBasics
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "../Utils/GLDebugHelper.h"
+
+namespace GLBasics
+{
+    /**
+     * \brief Reads pixels back from the GPU without waiting for it. Every request copies into a
+     * pixel pack buffer and fences the copy, the buffer is only mapped once the fence has passed,
+     * usually a few frames later. When every buffer is still in flight a request is refused
+     * instead of stalling
+     */
+    class ReadbackService
+    {
+    public:
+        /**
+         * \brief Receives the pixels of a finished readback on the render thread, four bytes per
+         * texel starting with the bottom row, or none if the buffer couldn't be mapped. The vector may be moved from
+         */
+        using Callback = std::function<void(std::vector<unsigned char>& rgbaPixels, int width, int height)>;
+
+    private:
+        struct Readback
+        {
+            unsigned int buffer;
+            size_t capacity;
+            GLsync fence;
+            int width, height;
+            Callback callback;
+        };
+
+        std::vector<Readback> m_Readbacks;
+        std::vector<unsigned int> m_Free;  // indices of idle readbacks
+        std::deque<unsigned int> m_InFlight;  // in the order they were requested
+        unsigned int m_RefusedCount;
+
+    public:
+        /**
+         * \brief Constructs the service and its pixel pack buffers
+         * \param maxInFlight How many readbacks may be waiting for the GPU at once
+         */
+        explicit ReadbackService(unsigned int maxInFlight = 4);
+
+        ReadbackService(const ReadbackService&) = delete;
+        ReadbackService& operator=(const ReadbackService&) = delete;
+
+        /**
+         * \brief Deletes the buffers and their fences, readbacks in flight are dropped
+         */
+        ~ReadbackService();
+
+        /**
+         * \brief Start reading a rectangle of the framebuffer bound for reading
+         * \param x The left edge of the rectangle
+         * \param y The bottom edge of the rectangle
+         * \param width The width of the rectangle
+         * \param height The height of the rectangle
+         * \param callback Receives the pixels once they are ready
+         * \return true if the readback was started; false if every buffer is in flight
+         */
+        bool Request(int x, int y, int width, int height, Callback callback);
+
+        /**
+         * \brief Hand the readbacks whose fence has passed to their callbacks. Should be called once per frame
+         */
+        void Update();
+
+        /**
+         * \brief Get the number of readbacks waiting for the GPU
+         * \return The number of readbacks in flight
+         */
+        inline unsigned int GetInFlightCount() const { return static_cast<unsigned int>(m_InFlight.size()); }
+
+        /**
+         * \brief Get how many requests were refused because every buffer was in flight
+         * \return The number of refused requests
+         */
+        inline unsigned int GetRefusedCount() const { return m_RefusedCount; }
+
+    };  // class ReadbackService
+}  // namespace GLBasics
@@ -1,33 +1,69 @@
 #include "Shader.h"
 
+#include <algorithm>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 
 #include <GLM/gtc/type_ptr.hpp>
 
+#include "ShaderCompileQueue.h"
 #include "../Utils/GLDebugHelper.h"
 
 namespace GLBasics
 {
     Shader::Shader(const std::string& vertexShaderPath, const std::string& fragmentShaderPath)
-        : m_RendererID(0)
+        : Shader(vertexShaderPath, fragmentShaderPath, ShaderDefines(), nullptr)
     {
-        std::string vertexShaderSource = ParseShader(vertexShaderPath);
-        std::string fragmentShaderSource = ParseShader(fragmentShaderPath);
-        const unsigned int vertexShader = CompileShader(GL_VERTEX_SHADER, vertexShaderSource);
-        const unsigned int fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-        m_RendererID = CreateProgram(vertexShader, fragmentShader);
-        GLCall(glUseProgram(m_RendererID));
+    }
+
+    Shader::Shader(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, ShaderCompileQueue& queue)
+        : Shader(vertexShaderPath, fragmentShaderPath, ShaderDefines(), &queue)
+    {
+    }
+
+    Shader::Shader(const std::string& vertexShaderPath, const std::string& fragmentShaderPath,
+        const ShaderDefines& defines, ShaderCompileQueue* queue)
+        : Shader(vertexShaderPath, fragmentShaderPath, defines, ShaderPreprocessor::Process(vertexShaderPath, defines),
+            ShaderPreprocessor::Process(fragmentShaderPath, defines), queue)
+    {
+    }
+
+    Shader::Shader(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const ShaderDefines& defines,
+        const PreprocessedShader& vertexShaderSource, const PreprocessedShader& fragmentShaderSource, ShaderCompileQueue* queue)
+        : m_VertexShaderPath(vertexShaderPath), m_FragmentShaderPath(fragmentShaderPath), m_Defines(defines), m_RendererID(0),
+          m_VertexShaderID(0), m_FragmentShaderID(0), m_Status(ShaderStatus::Compiling),
+          m_Queue(queue), m_Fallback(queue ? queue->GetFallback() : nullptr)
+    {
+        SetDependencies(vertexShaderSource, fragmentShaderSource);
+        BeginCompile(vertexShaderSource.source, fragmentShaderSource.source);
+        if (m_Queue)
+        {
+            m_Queue->Submit(*this);
+        }
+        else
+        {
+            FinishCompile();
+            GLCall(glUseProgram(m_RendererID));
+        }
     }
 
     Shader::~Shader()
     {
+        if (m_Queue && m_Status == ShaderStatus::Compiling)
+        {
+            m_Queue->Cancel(*this);
+            GLCall(glDeleteShader(m_VertexShaderID));
+            GLCall(glDeleteShader(m_FragmentShaderID));
+        }
         GLCall(glDeleteProgram(m_RendererID));
     }
 
     void Shader::Bind() const
     {
+        if (const Shader* fallback = GetDrawFallback())
+        {
+            fallback->Bind();
+            return;
+        }
         GLCall(glUseProgram(m_RendererID));
     }
 
@@ -38,62 +74,208 @@ namespace GLBasics
 
     void Shader::SetUniform1i(const std::string& uniformName, int value) const
     {
-        GLCall(glUniform1i(GetUniformLocation(uniformName), value));
+        UniformState& uniform = GetUniform(uniformName);
+        uniform.type = GL_INT;
+        uniform.intValue = value;
+
+        if (const Shader* fallback = GetDrawFallback())
+        {
+            fallback->SetUniform1i(uniformName, value);
+        }
+        else if (IsReady())
+        {
+            GLCall(glUniform1i(uniform.location, value));
+        }
     }
 
     void Shader::SetUniform4f(const std::string& uniformName, float v0, float v1, float v2, float v3) const
     {
-        GLCall(glUniform4f(GetUniformLocation(uniformName), v0, v1, v2, v3));
+        UniformState& uniform = GetUniform(uniformName);
+        uniform.type = GL_FLOAT_VEC4;
+        uniform.floatValues[0] = v0;
+        uniform.floatValues[1] = v1;
+        uniform.floatValues[2] = v2;
+        uniform.floatValues[3] = v3;
+
+        if (const Shader* fallback = GetDrawFallback())
+        {
+            fallback->SetUniform4f(uniformName, v0, v1, v2, v3);
+        }
+        else if (IsReady())
+        {
+            GLCall(glUniform4f(uniform.location, v0, v1, v2, v3));
+        }
     }
 
     void Shader::SetUniformMat4f(const std::string& uniformName, const glm::mat4& matrix) const
     {
-        GLCall(glUniformMatrix4fv(GetUniformLocation(uniformName), 1, GL_FALSE, glm::value_ptr(matrix)));
+        UniformState& uniform = GetUniform(uniformName);
+        uniform.type = GL_FLOAT_MAT4;
+        std::copy_n(glm::value_ptr(matrix), 16, uniform.floatValues);
+
+        if (const Shader* fallback = GetDrawFallback())
+        {
+            fallback->SetUniformMat4f(uniformName, matrix);
+        }
+        else if (IsReady())
+        {
+            GLCall(glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(matrix)));
+        }
     }
 
-    int Shader::GetUniformLocation(const std::string& uniformName) const
+    Shader::UniformState& Shader::GetUniform(const std::string& uniformName) const
     {
-        if (m_UniformLocationMap.find(uniformName) != m_UniformLocationMap.end())
+        const auto it = m_UniformLocationMap.find(uniformName);
+        if (it != m_UniformLocationMap.end())
         {
-            return m_UniformLocationMap[uniformName];
+            return it->second;
         }
-        else
+
+        UniformState uniform = { -1, 0, 0, {} };
+        if (IsReady())
         {
-            GLCall(int location = glGetUniformLocation(m_RendererID, uniformName.c_str()));
-            m_UniformLocationMap.insert({ uniformName, location });
-            return location;
+            GLCall(uniform.location = glGetUniformLocation(m_RendererID, uniformName.c_str()));
         }
+        // locations of a program that is still compiling are resolved in FinishCompile
+        return m_UniformLocationMap.insert({ uniformName, uniform }).first->second;
     }
 
-    unsigned Shader::CompileShader(unsigned type, std::string& shaderSource) const
+    const Shader* Shader::GetDrawFallback() const
     {
-        GLCall(const unsigned int shaderID = glCreateShader(type));
-        const char* src = shaderSource.c_str();
-        GLCall(glShaderSource(shaderID, 1, &src, nullptr));
-        GLCall(glCompileShader(shaderID));
+        return m_Status == ShaderStatus::Ready ? nullptr : m_Fallback;
+    }
+
+    void Shader::SetDependencies(const PreprocessedShader& vertexShaderSource, const PreprocessedShader& fragmentShaderSource)
+    {
+        m_Dependencies = vertexShaderSource.dependencies;
+        for (const std::string& dependency : fragmentShaderSource.dependencies)
+        {
+            if (std::find(m_Dependencies.begin(), m_Dependencies.end(), dependency) == m_Dependencies.end())
+            {
+                m_Dependencies.push_back(dependency);
+            }
+        }
+    }
+
+    void Shader::BeginCompile(const std::string& vertexShaderSource, const std::string& fragmentShaderSource)
+    {
+        m_VertexShaderID = CompileShader(GL_VERTEX_SHADER, vertexShaderSource);
+        m_FragmentShaderID = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+        m_RendererID = CreateProgram(m_VertexShaderID, m_FragmentShaderID);
+    }
+
+    bool Shader::IsCompletionAvailable(const bool parallelCompile) const
+    {
+        if (!parallelCompile)
+        {
+            return true;  // the status query will simply wait for the driver
+        }
+
+        int completed = GL_FALSE;
+        GLCall(glGetProgramiv(m_RendererID, GL_COMPLETION_STATUS_KHR, &completed));
+        return completed == GL_TRUE;
+    }
+
+    void Shader::FinishCompile()
+    {
+        const bool success = CheckProgram(m_RendererID, m_VertexShaderID, m_FragmentShaderID);
+        m_VertexShaderID = 0;
+        m_FragmentShaderID = 0;
 
-        int success;
-        char infoLog[1024];
-        glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
         if (!success)
         {
-            glGetShaderInfoLog(shaderID, 1024, NULL, infoLog);
-            std::cout << "ERROR::SHADER_COMPILATION_ERROR: " << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+            m_Status = ShaderStatus::Failed;
+            return;
+        }
+
+        GLCall(glValidateProgram(m_RendererID));
+        m_Status = ShaderStatus::Ready;
+
+        // Apply everything that was set while the program was still compiling
+        ApplyUniformState();
+    }
+
+    void Shader::SwapProgram(const unsigned int programID)
+    {
+        if (m_Status == ShaderStatus::Compiling && m_Queue)
+        {
+            m_Queue->Cancel(*this);
+            GLCall(glDeleteShader(m_VertexShaderID));
+            GLCall(glDeleteShader(m_FragmentShaderID));
+            m_VertexShaderID = 0;
+            m_FragmentShaderID = 0;
+        }
+
+        int currentProgram = 0;
+        GLCall(glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram));
+
+        const unsigned int previousProgramID = m_RendererID;
+        m_RendererID = programID;
+        m_Status = ShaderStatus::Ready;
+        ApplyUniformState();
+
+        // keep drawing with this shader if the replaced program was bound
+        if (currentProgram != 0 && static_cast<unsigned int>(currentProgram) == previousProgramID)
+        {
+            GLCall(glUseProgram(m_RendererID));
+        }
+        GLCall(glDeleteProgram(previousProgramID));
+    }
+
+    void Shader::ApplyUniformState()
+    {
+        int previousProgram = 0;
+        GLCall(glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram));
+        GLCall(glUseProgram(m_RendererID));
+        for (auto& [uniformName, uniform] : m_UniformLocationMap)
+        {
+            GLCall(uniform.location = glGetUniformLocation(m_RendererID, uniformName.c_str()));
+            switch (uniform.type)
+            {
+                case GL_INT:        GLCall(glUniform1i(uniform.location, uniform.intValue)); break;
+                case GL_FLOAT_VEC4: GLCall(glUniform4fv(uniform.location, 1, uniform.floatValues)); break;
+                case GL_FLOAT_MAT4: GLCall(glUniformMatrix4fv(uniform.location, 1, GL_FALSE, uniform.floatValues)); break;
+                default:            break;  // never set
+            }
         }
+        GLCall(glUseProgram(previousProgram));
+    }
+
+    unsigned Shader::CompileShader(unsigned type, const std::string& shaderSource)
+    {
+        GLCall(const unsigned int shaderID = glCreateShader(type));
+        const char* src = shaderSource.c_str();
+        GLCall(glShaderSource(shaderID, 1, &src, nullptr));
+        GLCall(glCompileShader(shaderID));
 
         return shaderID;
     }
 
-    unsigned Shader::CreateProgram(unsigned vertexShader, unsigned fragmentShader) const
+    unsigned Shader::CreateProgram(unsigned vertexShader, unsigned fragmentShader)
     {
         GLCall(const unsigned int programID = glCreateProgram());
         GLCall(glAttachShader(programID, vertexShader));
         GLCall(glAttachShader(programID, fragmentShader));
         GLCall(glLinkProgram(programID));
-        GLCall(glValidateProgram(programID));
 
+        return programID;
+    }
+
+    bool Shader::CheckProgram(const unsigned programID, const unsigned vertexShader, const unsigned fragmentShader)
+    {
         int success;
         char infoLog[1024];
+
+        for (const unsigned int shaderID : { vertexShader, fragmentShader })
+        {
+            glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+            if (!success)
+            {
+                glGetShaderInfoLog(shaderID, 1024, NULL, infoLog);
+                std::cout << "ERROR::SHADER_COMPILATION_ERROR: " << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+            }
+        }
+
         glGetProgramiv(programID, GL_LINK_STATUS, &success);
         if (!success)
         {
@@ -104,25 +286,6 @@ namespace GLBasics
         GLCall(glDeleteShader(vertexShader));
         GLCall(glDeleteShader(fragmentShader));
 
-        return programID;
-    }
-
-    std::string Shader::ParseShader(const std::string& filePath) const
-    {
-        std::ifstream shaderFile;
-        std::stringstream shaderStream;
-        shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
-        {
-            shaderFile.open(filePath);
-            shaderStream << shaderFile.rdbuf();
-            shaderFile.close();
-        }
-        catch (std::ifstream::failure e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
-        }
-
-        return shaderStream.str();
+        return success == GL_TRUE;
     }
 }  // namespace GLBasics
@@ -2,11 +2,24 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <GLM/glm.hpp>
 
+#include "ShaderPreprocessor.h"
+
 namespace GLBasics
 {
+    class ShaderCompileQueue;
+
+    /**
+     * \brief Specifies where a Shader program is in its compile and link process
+     */
+    enum class ShaderStatus
+    {
+        Compiling, Ready, Failed
+    };
+
     /**
      * \brief A Shader class that manages creating, compiling, binding shaders and
      * provides helpers functions to manipulate uniforms
@@ -14,25 +27,73 @@ namespace GLBasics
     class Shader
     {
     private:
+        /**
+         * \brief The cached location and the last value set for one uniform
+         */
+        struct UniformState
+        {
+            int location;
+            unsigned int type;  // GL type of the last value set, 0 if never set
+            int intValue;
+            float floatValues[16];
+        };
+
+        std::string m_VertexShaderPath;
+        std::string m_FragmentShaderPath;
+        ShaderDefines m_Defines;
+        std::vector<std::string> m_Dependencies;
         unsigned int m_RendererID;
-        mutable std::unordered_map<std::string, int> m_UniformLocationMap;  // caching for uniforms
+        unsigned int m_VertexShaderID;
+        unsigned int m_FragmentShaderID;
+        ShaderStatus m_Status;
+        ShaderCompileQueue* m_Queue;
+        const Shader* m_Fallback;
+        mutable std::unordered_map<std::string, UniformState> m_UniformLocationMap;  // caching for uniforms
+
+        friend class ShaderCompileQueue;
+        friend class ShaderReloader;
+        friend class ShaderVariantCache;
 
     public:
         /**
          * \brief Constructs a Shader class and create, compile, bind vertex
-         * and fragment shaders
+         * and fragment shaders. Blocks until the program is linked
          * \param vertexShaderPath The path to the vertex shader source file
          * \param fragmentShaderPath The path to the fragment shader source file
          */
         Shader(const std::string& vertexShaderPath, const std::string& fragmentShaderPath);
 
+        /**
+         * \brief Constructs a Shader class and submits its vertex and fragment shaders to
+         * a compile queue without waiting for the driver. Until the queue reports the program
+         * as ready, binding and uniform calls are redirected to the queue's fallback shader
+         * \param vertexShaderPath The path to the vertex shader source file
+         * \param fragmentShaderPath The path to the fragment shader source file
+         * \param queue The ShaderCompileQueue that will finish compiling this shader
+         */
+        Shader(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, ShaderCompileQueue& queue);
+
+        /**
+         * \brief Constructs a Shader class from sources that are preprocessed with a define set
+         * \param vertexShaderPath The path to the vertex shader source file
+         * \param fragmentShaderPath The path to the fragment shader source file
+         * \param defines The macros defined in both stages
+         * \param queue The ShaderCompileQueue that will finish compiling this shader,
+         * or nullptr to block until the program is linked
+         */
+        Shader(const std::string& vertexShaderPath, const std::string& fragmentShaderPath,
+            const ShaderDefines& defines, ShaderCompileQueue* queue);
+
+        Shader(const Shader&) = delete;
+        Shader& operator=(const Shader&) = delete;
+
         /**
          * \brief Calls the underlying OpenGL functions to delete the shader program
          */
         ~Shader();
 
         /**
-         * \brief Bind this shader program
+         * \brief Bind this shader program, or the fallback program if it is not ready yet
          */
         void Bind() const;
 
@@ -65,20 +126,84 @@ namespace GLBasics
          */
         void SetUniformMat4f(const std::string& uniformName, const glm::mat4& matrix) const;
 
+        /**
+         * \brief Get where this shader is in its compile and link process
+         * \return A ShaderStatus enum
+         */
+        inline ShaderStatus GetStatus() const { return m_Status; }
+
+        /**
+         * \brief Check whether the program of this shader can be used for drawing
+         * \return true if the program is linked successfully; false otherwise
+         */
+        inline bool IsReady() const { return m_Status == ShaderStatus::Ready; }
+
+        /**
+         * \brief Get the path to the vertex shader source file
+         * \return The path this shader was constructed with
+         */
+        inline const std::string& GetVertexShaderPath() const { return m_VertexShaderPath; }
+
+        /**
+         * \brief Get the path to the fragment shader source file
+         * \return The path this shader was constructed with
+         */
+        inline const std::string& GetFragmentShaderPath() const { return m_FragmentShaderPath; }
+
+        /**
+         * \brief Get the macros this shader was compiled with
+         * \return The define set
+         */
+        inline const ShaderDefines& GetDefines() const { return m_Defines; }
+
+        /**
+         * \brief Get every file the sources of this shader were built from, including the included ones
+         * \return The normalized paths of the files
+         */
+        inline const std::vector<std::string>& GetDependencies() const { return m_Dependencies; }
+
     private:
-        // Retrieves uniform location from glProgram
-        int GetUniformLocation(const std::string& uniformName) const;
+        // Constructs a Shader class from sources that are already preprocessed
+        Shader(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const ShaderDefines& defines,
+            const PreprocessedShader& vertexShaderSource, const PreprocessedShader& fragmentShaderSource, ShaderCompileQueue* queue);
+
+        // Remembers the files both stages were built from
+        void SetDependencies(const PreprocessedShader& vertexShaderSource, const PreprocessedShader& fragmentShaderSource);
+
+        // Retrieves uniform location from glProgram and remembers the last value set
+        UniformState& GetUniform(const std::string& uniformName) const;
+
+        // Returns the fallback shader if this one can't be used for drawing yet, nullptr otherwise
+        const Shader* GetDrawFallback() const;
+
+        // Compiles both shaders and links them without querying any status
+        void BeginCompile(const std::string& vertexShaderSource, const std::string& fragmentShaderSource);
+
+        // Checks whether the driver finished compiling and linking.
+        // Only non-blocking when parallel shader compile is supported
+        bool IsCompletionAvailable(bool parallelCompile) const;
+
+        // Queries the compile and link results, then applies all the uniforms set so far
+        void FinishCompile();
+
+        // Replaces the program with one that is already linked, dropping any compile in flight.
+        // Uniform locations are resolved again and every value set so far is applied
+        void SwapProgram(unsigned int programID);
+
+        // Resolves all the cached uniform locations against the current program and applies their values
+        void ApplyUniformState();
 
-        // Compiles a shader of the given type and source code
+        // Issues the compile of a shader of the given type and source code
         // Returns the shader identifier
-        unsigned int CompileShader(unsigned int type, std::string& shaderSource) const;
+        static unsigned int CompileShader(unsigned int type, const std::string& shaderSource);
 
-        // Attaches and link both shaders
+        // Attaches and issues the link of both shaders
         // Returns the program identifier
-        unsigned int CreateProgram(unsigned int vertexShader, unsigned int fragmentShader) const;
+        static unsigned int CreateProgram(unsigned int vertexShader, unsigned int fragmentShader);
 
-        // Read the plain string from the given file path and return it
-        std::string ParseShader(const std::string& filePath) const;
+        // Prints the compile logs of both shaders and the link log of the program, then deletes the shaders
+        // Returns true if the program is linked successfully
+        static bool CheckProgram(unsigned int programID, unsigned int vertexShader, unsigned int fragmentShader);
 
     };  // class Shader
 }  // namespace GLBasics
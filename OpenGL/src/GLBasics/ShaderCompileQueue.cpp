@@ -0,0 +1,70 @@
+#include "ShaderCompileQueue.h"
+
+#include <algorithm>
+
+#include "Shader.h"
+#include "../Utils/GLDebugHelper.h"
+
+namespace GLBasics
+{
+    ShaderCompileQueue::ShaderCompileQueue(unsigned int maxBlockingLinksPerUpdate)
+        : m_Fallback(nullptr), m_ParallelCompile(GLEW_KHR_parallel_shader_compile == GL_TRUE),
+          m_MaxBlockingLinksPerUpdate(maxBlockingLinksPerUpdate)
+    {
+        if (m_ParallelCompile)
+        {
+            // 0xFFFFFFFF lets the implementation pick the number of threads
+            GLCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+        }
+    }
+
+    void ShaderCompileQueue::Submit(Shader& shader)
+    {
+        m_Pending.push_back(&shader);
+    }
+
+    void ShaderCompileQueue::Cancel(Shader& shader)
+    {
+        m_Pending.erase(std::remove(m_Pending.begin(), m_Pending.end(), &shader), m_Pending.end());
+    }
+
+    void ShaderCompileQueue::Update()
+    {
+        // Without parallel compile every status query waits for the driver,
+        // so only a few programs are finished per frame to spread the cost
+        unsigned int blockingBudget = m_MaxBlockingLinksPerUpdate;
+
+        auto it = m_Pending.begin();
+        while (it != m_Pending.end())
+        {
+            Shader* shader = *it;
+            if (!m_ParallelCompile && blockingBudget == 0)
+            {
+                break;
+            }
+
+            if (shader->IsCompletionAvailable(m_ParallelCompile))
+            {
+                shader->FinishCompile();
+                it = m_Pending.erase(it);
+                if (!m_ParallelCompile)
+                {
+                    blockingBudget--;
+                }
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void ShaderCompileQueue::Flush()
+    {
+        for (Shader* shader : m_Pending)
+        {
+            shader->FinishCompile();
+        }
+        m_Pending.clear();
+    }
+}  // namespace GLBasics
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+
+namespace GLBasics
+{
+    class Shader;
+
+    /**
+     * \brief Collects Shader programs whose compile and link have been issued but not yet
+     * queried, and finishes them across frames so that loading many shaders doesn't freeze
+     * the frame. Uses GL_KHR_parallel_shader_compile when the driver exposes it
+     */
+    class ShaderCompileQueue
+    {
+    private:
+        std::vector<Shader*> m_Pending;
+        const Shader* m_Fallback;
+        bool m_ParallelCompile;
+        unsigned int m_MaxBlockingLinksPerUpdate;
+
+    public:
+        /**
+         * \brief Constructs an empty queue and asks the driver for as many compiler threads as it can use
+         * \param maxBlockingLinksPerUpdate How many programs Update may wait on when
+         * GL_KHR_parallel_shader_compile is not available
+         */
+        explicit ShaderCompileQueue(unsigned int maxBlockingLinksPerUpdate = 2);
+
+        ShaderCompileQueue(const ShaderCompileQueue&) = delete;
+        ShaderCompileQueue& operator=(const ShaderCompileQueue&) = delete;
+
+        /**
+         * \brief Set the shader that is bound in place of programs that are still compiling.
+         * Only affects shaders submitted afterwards
+         * \param fallback A Shader that is already ready, or nullptr to skip those draws' program
+         */
+        inline void SetFallback(const Shader* fallback) { m_Fallback = fallback; }
+
+        /**
+         * \brief Get the shader that is bound in place of programs that are still compiling
+         * \return The fallback Shader, nullptr if none is set
+         */
+        inline const Shader* GetFallback() const { return m_Fallback; }
+
+        /**
+         * \brief Add a shader whose compile and link have already been issued
+         * \param shader The Shader to be finished by this queue
+         */
+        void Submit(Shader& shader);
+
+        /**
+         * \brief Remove a shader that is being destroyed before it finished compiling
+         * \param shader The Shader to be removed
+         */
+        void Cancel(Shader& shader);
+
+        /**
+         * \brief Poll every pending program once and finish the ones the driver is done with.
+         * Should be called once per frame
+         */
+        void Update();
+
+        /**
+         * \brief Wait for every pending program to finish
+         */
+        void Flush();
+
+        /**
+         * \brief Get the number of programs that are still compiling
+         * \return The number of pending programs
+         */
+        inline unsigned int GetPendingCount() const { return static_cast<unsigned int>(m_Pending.size()); }
+
+        /**
+         * \brief Check whether the driver compiles shaders in the background
+         * \return true if GL_KHR_parallel_shader_compile is used; false otherwise
+         */
+        inline bool IsParallelCompileSupported() const { return m_ParallelCompile; }
+
+    };  // class ShaderCompileQueue
+}  // namespace GLBasics
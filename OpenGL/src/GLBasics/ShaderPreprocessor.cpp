@@ -0,0 +1,139 @@
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace GLBasics
+{
+    // guards against include cycles that slip through, e.g. through differently spelled paths
+    constexpr unsigned int MAX_INCLUDE_DEPTH = 32;
+
+    PreprocessedShader ShaderPreprocessor::Process(const std::string& filePath, const ShaderDefines& defines)
+    {
+        PreprocessedShader output;
+        size_t definesOffset = 0;
+        AppendFile(filePath, output, 0, definesOffset);
+
+        // defines the sources never mention can't change them, leaving them out gives define sets
+        // that only differ in those the same source
+        std::string defineLines;
+        for (const auto& [name, value] : defines)
+        {
+            if (Mentions(output.source, name))
+            {
+                // a define without a value is defined to 1, so it works in #if as well as #ifdef
+                defineLines += "#define " + name + ' ' + (value.empty() ? "1" : value) + '\n';
+            }
+        }
+        output.source.insert(definesOffset, defineLines);
+        return output;
+    }
+
+    std::string ShaderPreprocessor::ToString(const ShaderDefines& defines)
+    {
+        std::string result;
+        for (const auto& [name, value] : defines)
+        {
+            if (!result.empty())
+            {
+                result += ';';
+            }
+            result += value.empty() ? name : name + '=' + value;
+        }
+        return result;
+    }
+
+    bool ShaderPreprocessor::Mentions(const std::string& source, const std::string& name)
+    {
+        const auto isIdentifierCharacter = [](const char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+        for (size_t position = source.find(name); position != std::string::npos; position = source.find(name, position + 1))
+        {
+            const size_t end = position + name.size();
+            if ((position == 0 || !isIdentifierCharacter(source[position - 1])) && (end == source.size() || !isIdentifierCharacter(source[end])))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ShaderPreprocessor::AppendFile(const std::string& filePath, PreprocessedShader& output, const unsigned int depth,
+        size_t& definesOffset)
+    {
+        const std::string normalizedPath = std::filesystem::path(filePath).lexically_normal().generic_string();
+        if (depth > MAX_INCLUDE_DEPTH)
+        {
+            std::cout << "ERROR::SHADER::INCLUDE_TOO_DEEP " << normalizedPath << std::endl;
+            return;
+        }
+
+        auto& dependencies = output.dependencies;
+        if (std::find(dependencies.begin(), dependencies.end(), normalizedPath) != dependencies.end())
+        {
+            return;  // every file is included once
+        }
+        const size_t sourceIndex = dependencies.size();
+        dependencies.push_back(normalizedPath);
+
+        std::ifstream shaderFile(normalizedPath);
+        if (!shaderFile.is_open())
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ " << normalizedPath << std::endl;
+            return;
+        }
+
+        const std::string lineDirectiveSuffix = ' ' + std::to_string(sourceIndex) + '\n';
+        if (depth > 0)
+        {
+            output.source += "#line 1" + lineDirectiveSuffix;
+        }
+
+        const std::filesystem::path directory = std::filesystem::path(normalizedPath).parent_path();
+        bool versionFound = depth > 0;
+        unsigned int lineNumber = 0;
+        std::string line;
+        while (std::getline(shaderFile, line))
+        {
+            lineNumber++;
+            const size_t firstCharacter = line.find_first_not_of(" \t");
+            const std::string trimmed = firstCharacter == std::string::npos ? "" : line.substr(firstCharacter);
+
+            if (!versionFound && trimmed.rfind("#version", 0) == 0)
+            {
+                output.source += line + '\n';
+                definesOffset = output.source.size();
+                output.source += "#line " + std::to_string(lineNumber + 1) + lineDirectiveSuffix;
+                versionFound = true;
+                continue;
+            }
+
+            if (trimmed.rfind("#include", 0) == 0)
+            {
+                const size_t open = trimmed.find('"');
+                const size_t close = trimmed.find('"', open + 1);
+                if (open == std::string::npos || close == std::string::npos)
+                {
+                    std::cout << "ERROR::SHADER::MALFORMED_INCLUDE " << normalizedPath << ":" << lineNumber << std::endl;
+                    continue;
+                }
+
+                const std::string includePath = (directory / trimmed.substr(open + 1, close - open - 1)).generic_string();
+                AppendFile(includePath, output, depth + 1, definesOffset);
+                output.source += "#line " + std::to_string(lineNumber + 1) + lineDirectiveSuffix;
+                continue;
+            }
+
+            output.source += line + '\n';
+        }
+
+        // a root file without #version gets its defines at the very top
+        if (!versionFound)
+        {
+            output.source = "#line 1" + lineDirectiveSuffix + output.source;
+            definesOffset = 0;
+        }
+    }
+}  // namespace GLBasics
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace GLBasics
+{
+    // Macro name -> value injected into a shader, ordered so that equal sets compare and print equally
+    using ShaderDefines = std::map<std::string, std::string>;
+
+    /**
+     * \brief The result of preprocessing one shader stage
+     */
+    struct PreprocessedShader
+    {
+        std::string source;
+        std::vector<std::string> dependencies;  // the root file first, then every included file
+    };
+
+    /**
+     * \brief Resolves #include "file" directives and injects #define lines into a GLSL source.
+     * Every file is included at most once, defines the source never mentions are left out, and #line directives keep the compiler's line numbers
+     * pointing into the original files, using the index into the dependencies as source string number
+     */
+    class ShaderPreprocessor
+    {
+    public:
+        /**
+         * \brief Read a shader file and preprocess it
+         * \param filePath The path to the shader source file
+         * \param defines The macros to define right after the #version line, those with an empty value are defined to 1.
+         * Those whose name appears nowhere in the source, comments included, are left out
+         * \return The preprocessed source and all the files it depends on
+         */
+        static PreprocessedShader Process(const std::string& filePath, const ShaderDefines& defines);
+
+        /**
+         * \brief Turn a define set into a stable string, e.g. "ALPHA_TEST;TEXTURE_COUNT=1"
+         * \param defines The define set
+         * \return A string that is equal for equal define sets
+         */
+        static std::string ToString(const ShaderDefines& defines);
+
+    private:
+        // Checks whether a name appears in a source as a whole identifier
+        static bool Mentions(const std::string& source, const std::string& name);
+
+        // Appends one file to the output, recursing into its includes, and finds where the defines go
+        static void AppendFile(const std::string& filePath, PreprocessedShader& output, unsigned int depth,
+            size_t& definesOffset);
+
+    };  // class ShaderPreprocessor
+}  // namespace GLBasics
@@ -0,0 +1,199 @@
+#include "ShaderReloader.h"
+
+#include <algorithm>
+
+#include "../Utils/GLDebugHelper.h"
+#include <GLFW/glfw3.h>
+
+#include "Shader.h"
+
+namespace GLBasics
+{
+    ShaderReloader::ShaderReloader(GLFWwindow* mainWindow)
+        : m_WorkerContext(nullptr), m_Stopping(false)
+    {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        m_WorkerContext = glfwCreateWindow(1, 1, "ShaderReloader", nullptr, mainWindow);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+        if (!m_WorkerContext)
+        {
+            std::cout << "WARNING::SHADER_RELOADER::NO_SHARED_CONTEXT, reloading on the main thread" << std::endl;
+            return;
+        }
+
+        m_Worker = std::thread(&ShaderReloader::WorkerLoop, this);
+    }
+
+    ShaderReloader::~ShaderReloader()
+    {
+        if (m_Worker.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Stopping = true;
+            }
+            m_Condition.notify_one();
+            m_Worker.join();
+        }
+
+        for (const ReloadResult& result : m_Results)
+        {
+            GLCall(glDeleteProgram(result.programID));
+        }
+
+        if (m_WorkerContext)
+        {
+            glfwDestroyWindow(m_WorkerContext);
+        }
+    }
+
+    void ShaderReloader::Watch(Shader& shader)
+    {
+        if (m_WatchedShaders.insert(&shader).second)
+        {
+            RegisterFiles(shader);
+        }
+    }
+
+    void ShaderReloader::RegisterFiles(Shader& shader)
+    {
+        for (const std::string& path : shader.GetDependencies())
+        {
+            m_Watcher.AddFile(path);
+            auto& shaders = m_ShadersByFile[Utils::FileWatcher::NormalizePath(path)];
+            if (std::find(shaders.begin(), shaders.end(), &shader) == shaders.end())
+            {
+                shaders.push_back(&shader);
+            }
+        }
+    }
+
+    void ShaderReloader::Unwatch(Shader& shader)
+    {
+        m_WatchedShaders.erase(&shader);
+        for (auto& file : m_ShadersByFile)
+        {
+            auto& shaders = file.second;
+            shaders.erase(std::remove(shaders.begin(), shaders.end(), &shader), shaders.end());
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Jobs.erase(std::remove_if(m_Jobs.begin(), m_Jobs.end(),
+            [&shader](const ReloadJob& job) { return job.shader == &shader; }), m_Jobs.end());
+    }
+
+    void ShaderReloader::Update()
+    {
+        // a shader is reloaded once even if both of its files changed
+        std::vector<Shader*> changedShaders;
+        for (const std::string& path : m_Watcher.Poll())
+        {
+            const auto file = m_ShadersByFile.find(path);
+            if (file == m_ShadersByFile.end())
+            {
+                continue;
+            }
+            for (Shader* shader : file->second)
+            {
+                if (std::find(changedShaders.begin(), changedShaders.end(), shader) == changedShaders.end())
+                {
+                    changedShaders.push_back(shader);
+                }
+            }
+        }
+
+        if (!m_Worker.joinable())
+        {
+            for (Shader* shader : changedShaders)
+            {
+                ApplyResult(Recompile({ shader, shader->GetVertexShaderPath(), shader->GetFragmentShaderPath(), shader->GetDefines() }));
+            }
+            return;
+        }
+
+        std::vector<ReloadResult> results;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            for (Shader* shader : changedShaders)
+            {
+                m_Jobs.push_back({ shader, shader->GetVertexShaderPath(), shader->GetFragmentShaderPath(), shader->GetDefines() });
+            }
+            results.swap(m_Results);
+        }
+        if (!changedShaders.empty())
+        {
+            m_Condition.notify_one();
+        }
+
+        for (const ReloadResult& result : results)
+        {
+            ApplyResult(result);
+        }
+    }
+
+    void ShaderReloader::WorkerLoop()
+    {
+        glfwMakeContextCurrent(m_WorkerContext);
+
+        while (true)
+        {
+            ReloadJob job;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Condition.wait(lock, [this] { return m_Stopping || !m_Jobs.empty(); });
+                if (m_Stopping)
+                {
+                    break;
+                }
+                job = m_Jobs.front();
+                m_Jobs.pop_front();
+            }
+
+            ReloadResult result = Recompile(job);
+            // the program must be complete before another context uses it
+            GLCall(glFinish());
+
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Results.push_back(std::move(result));
+        }
+
+        glfwMakeContextCurrent(nullptr);
+    }
+
+    ShaderReloader::ReloadResult ShaderReloader::Recompile(const ReloadJob& job)
+    {
+        PreprocessedShader vertexShaderSource = ShaderPreprocessor::Process(job.vertexShaderPath, job.defines);
+        PreprocessedShader fragmentShaderSource = ShaderPreprocessor::Process(job.fragmentShaderPath, job.defines);
+        const unsigned int vertexShader = Shader::CompileShader(GL_VERTEX_SHADER, vertexShaderSource.source);
+        const unsigned int fragmentShader = Shader::CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource.source);
+        const unsigned int programID = Shader::CreateProgram(vertexShader, fragmentShader);
+        const bool success = Shader::CheckProgram(programID, vertexShader, fragmentShader);
+
+        // only the dependencies are needed from here on
+        vertexShaderSource.source.clear();
+        fragmentShaderSource.source.clear();
+        return { job.shader, programID, success, std::move(vertexShaderSource), std::move(fragmentShaderSource) };
+    }
+
+    void ShaderReloader::ApplyResult(const ReloadResult& result)
+    {
+        if (m_WatchedShaders.find(result.shader) == m_WatchedShaders.end())
+        {
+            GLCall(glDeleteProgram(result.programID));
+            return;
+        }
+
+        if (!result.success)
+        {
+            std::cout << "ERROR::SHADER_RELOADER::RELOAD_FAILED, keeping the previous program of "
+                << result.shader->GetVertexShaderPath() << " and " << result.shader->GetFragmentShaderPath() << std::endl;
+            GLCall(glDeleteProgram(result.programID));
+            return;
+        }
+
+        result.shader->SwapProgram(result.programID);
+        result.shader->SetDependencies(result.vertexShaderSource, result.fragmentShaderSource);
+        RegisterFiles(*result.shader);
+    }
+}  // namespace GLBasics
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ShaderPreprocessor.h"
+#include "../Utils/FileWatcher.h"
+
+struct GLFWwindow;
+
+namespace GLBasics
+{
+    class Shader;
+
+    /**
+     * \brief Watches the source files of shaders and recompiles the changed ones on a worker
+     * thread that owns a hidden context shared with the main window. Finished programs are
+     * swapped into the live Shader objects between frames, so editing a shader doesn't stall rendering
+     */
+    class ShaderReloader
+    {
+    private:
+        struct ReloadJob
+        {
+            Shader* shader;
+            std::string vertexShaderPath;
+            std::string fragmentShaderPath;
+            ShaderDefines defines;
+        };
+
+        struct ReloadResult
+        {
+            Shader* shader;
+            unsigned int programID;
+            bool success;
+            PreprocessedShader vertexShaderSource;
+            PreprocessedShader fragmentShaderSource;
+        };
+
+        Utils::FileWatcher m_Watcher;
+        std::unordered_map<std::string, std::vector<Shader*>> m_ShadersByFile;
+        std::unordered_set<Shader*> m_WatchedShaders;
+
+        GLFWwindow* m_WorkerContext;
+        std::thread m_Worker;
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        std::deque<ReloadJob> m_Jobs;
+        std::vector<ReloadResult> m_Results;
+        bool m_Stopping;
+
+    public:
+        /**
+         * \brief Creates the shared context and starts the worker thread. Must be called on the
+         * main thread. Falls back to recompiling on the main thread if no shared context can be made
+         * \param mainWindow The window whose context is shared with the worker
+         */
+        explicit ShaderReloader(GLFWwindow* mainWindow);
+
+        ShaderReloader(const ShaderReloader&) = delete;
+        ShaderReloader& operator=(const ShaderReloader&) = delete;
+
+        /**
+         * \brief Stops the worker thread and destroys the shared context
+         */
+        ~ShaderReloader();
+
+        /**
+         * \brief Start watching the source files of a shader, including the ones it includes. The shader must be
+         * unwatched before it is destroyed
+         * \param shader The Shader to be reloaded whenever one of its files changes
+         */
+        void Watch(Shader& shader);
+
+        /**
+         * \brief Stop watching a shader. A reload that is still in flight is discarded
+         * \param shader The Shader that will no longer be reloaded
+         */
+        void Unwatch(Shader& shader);
+
+        /**
+         * \brief Queue reloads for the changed files and swap in the programs the worker finished.
+         * Should be called once per frame on the main thread
+         */
+        void Update();
+
+    private:
+        // Waits for reload jobs and compiles them on the shared context
+        void WorkerLoop();
+
+        // Preprocesses, compiles and links the sources of a job on whatever context is current
+        static ReloadResult Recompile(const ReloadJob& job);
+
+        // Makes sure every dependency of a shader is watched and maps back to it
+        void RegisterFiles(Shader& shader);
+
+        // Hands a finished program to its shader, or deletes it if the shader is no longer watched
+        void ApplyResult(const ReloadResult& result);
+
+    };  // class ShaderReloader
+}  // namespace GLBasics
@@ -0,0 +1,57 @@
+#include "ShaderVariantCache.h"
+
+#include "Shader.h"
+
+namespace GLBasics
+{
+    ShaderVariantCache::ShaderVariantCache(ShaderCompileQueue* queue)
+        : m_Queue(queue)
+    {
+    }
+
+    std::shared_ptr<Shader> ShaderVariantCache::Get(const std::string& vertexShaderPath, const std::string& fragmentShaderPath,
+        const ShaderDefines& defines)
+    {
+        const std::string variantKey = vertexShaderPath + '|' + fragmentShaderPath + '|' + ShaderPreprocessor::ToString(defines);
+        if (const auto variant = m_Variants.find(variantKey); variant != m_Variants.end())
+        {
+            if (std::shared_ptr<Shader> shader = variant->second.lock())
+            {
+                return shader;
+            }
+        }
+
+        const PreprocessedShader vertexShaderSource = ShaderPreprocessor::Process(vertexShaderPath, defines);
+        const PreprocessedShader fragmentShaderSource = ShaderPreprocessor::Process(fragmentShaderPath, defines);
+
+        // the preprocessor leaves out defines the sources never mention, and the define set is ordered,
+        // so sets that can't make a difference produce the same text and share a program
+        std::string programKey = vertexShaderSource.source + '\0' + fragmentShaderSource.source;
+        std::shared_ptr<Shader> shader;
+        if (const auto program = m_Programs.find(programKey); program != m_Programs.end())
+        {
+            shader = program->second.lock();
+        }
+
+        if (!shader)
+        {
+            shader = std::shared_ptr<Shader>(new Shader(vertexShaderPath, fragmentShaderPath, defines,
+                vertexShaderSource, fragmentShaderSource, m_Queue));
+            m_Programs[std::move(programKey)] = shader;
+        }
+        m_Variants[variantKey] = shader;
+        return shader;
+    }
+
+    void ShaderVariantCache::Collect()
+    {
+        for (auto it = m_Variants.begin(); it != m_Variants.end();)
+        {
+            it = it->second.expired() ? m_Variants.erase(it) : std::next(it);
+        }
+        for (auto it = m_Programs.begin(); it != m_Programs.end();)
+        {
+            it = it->second.expired() ? m_Programs.erase(it) : std::next(it);
+        }
+    }
+}  // namespace GLBasics
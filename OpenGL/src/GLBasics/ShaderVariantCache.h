@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "ShaderPreprocessor.h"
+
+namespace GLBasics
+{
+    class Shader;
+    class ShaderCompileQueue;
+
+    /**
+     * \brief Hands out Shader permutations of the same source files built with different define sets.
+     * Permutations are created on demand, and permutations whose preprocessed sources are
+     * identical share one compiled program. A shared program keeps the define set it was first created with
+     */
+    class ShaderVariantCache
+    {
+    private:
+        ShaderCompileQueue* m_Queue;
+        // "vertex path|fragment path|defines" -> shader
+        std::unordered_map<std::string, std::weak_ptr<Shader>> m_Variants;
+        // both preprocessed sources -> shader, keyed by the whole text so only equal sources share
+        std::unordered_map<std::string, std::weak_ptr<Shader>> m_Programs;
+
+    public:
+        /**
+         * \brief Constructs an empty cache
+         * \param queue The ShaderCompileQueue new programs are submitted to, or nullptr to compile them blocking
+         */
+        explicit ShaderVariantCache(ShaderCompileQueue* queue = nullptr);
+
+        /**
+         * \brief Get the permutation of a shader for a define set, creating it if needed
+         * \param vertexShaderPath The path to the vertex shader source file
+         * \param fragmentShaderPath The path to the fragment shader source file
+         * \param defines The macros defined in both stages
+         * \return A shared Shader that stays cached for as long as someone holds it
+         */
+        std::shared_ptr<Shader> Get(const std::string& vertexShaderPath, const std::string& fragmentShaderPath,
+            const ShaderDefines& defines = ShaderDefines());
+
+        /**
+         * \brief Forget the permutations nobody holds anymore
+         */
+        void Collect();
+
+        /**
+         * \brief Get the number of define sets that were requested and are still alive
+         * \return The number of variants
+         */
+        inline unsigned int GetVariantCount() const { return static_cast<unsigned int>(m_Variants.size()); }
+
+        /**
+         * \brief Get the number of distinct programs the variants are compiled into
+         * \return The number of programs
+         */
+        inline unsigned int GetProgramCount() const { return static_cast<unsigned int>(m_Programs.size()); }
+
+    };  // class ShaderVariantCache
+}  // namespace GLBasics
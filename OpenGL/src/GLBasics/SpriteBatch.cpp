@@ -0,0 +1,173 @@
+#include "SpriteBatch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "TextureArray.h"
+
+namespace GLBasics
+{
+    SpriteBatch::SpriteBatch(const unsigned int capacity)
+        : m_LastTexture(0), m_Sorted(true), m_Begun(false),
+          m_InstanceStream(static_cast<size_t>(std::max(capacity, 1u)) * sizeof(SpriteInstance)),
+          m_VertexArray(std::make_unique<VertexArray>()), m_SpriteCount(0)
+    {
+        m_VertexArray->BindInstanceBuffer<SpriteInstance>(m_InstanceStream.GetRendererID());
+        m_VertexArray->UnBind();
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    }
+
+    void SpriteBatch::Begin()
+    {
+        m_Instances.clear();
+        m_Keys.clear();
+        // the textures may be gone by the next frame
+        m_Textures.clear();
+        m_LastTexture = 0;
+        m_Sorted = true;
+        m_Begun = true;
+    }
+
+    void SpriteBatch::Draw(const Sprite& sprite)
+    {
+        if (!m_Begun)
+        {
+            std::cout << "ERROR::SPRITE_BATCH::DRAW_WITHOUT_BEGIN" << std::endl;
+            return;
+        }
+        if (!sprite.texture)
+        {
+            return;
+        }
+
+        if (m_Textures.empty() || m_Textures[m_LastTexture] != sprite.texture)
+        {
+            const auto found = std::find(m_Textures.begin(), m_Textures.end(), sprite.texture);
+            m_LastTexture = static_cast<uint32_t>(found - m_Textures.begin());
+            if (found == m_Textures.end())
+            {
+                m_Textures.push_back(sprite.texture);
+            }
+        }
+        const auto drawLayer = static_cast<uint32_t>(std::clamp(sprite.drawLayer, -32768, 32767) + 32768);
+        const uint32_t key = drawLayer << 16 | std::min(m_LastTexture, 0xFFFFu);
+        m_Sorted = m_Sorted && (m_Keys.empty() || m_Keys.back() <= key);
+        m_Keys.push_back(key);
+
+        SpriteInstance instance;
+        instance.position = sprite.position;
+        instance.size = sprite.size;
+        instance.rotation = sprite.rotation;
+        instance.layer = static_cast<float>(sprite.textureLayer);
+        for (int i = 0; i < 4; i++)
+        {
+            instance.uvRect[i] = ToUnorm16(sprite.uvRect[i]);
+            instance.color[i] = ToUnorm8(sprite.color[i]);
+        }
+        m_Instances.push_back(instance);
+    }
+
+    void SpriteBatch::End()
+    {
+        m_Begun = false;
+        m_Batches.clear();
+        m_SpriteCount = 0;
+
+        const auto count = static_cast<unsigned int>(m_Instances.size());
+        if (count == 0)
+        {
+            return;
+        }
+        if (!m_Sorted)
+        {
+            SortByKey();
+        }
+
+        const size_t size = static_cast<size_t>(count) * sizeof(SpriteInstance);
+        size_t writeOffset = 0;
+        void* mapped = m_InstanceStream.Map(size, writeOffset);
+        if (mapped)
+        {
+            auto* instances = static_cast<SpriteInstance*>(mapped);
+            if (m_Sorted)
+            {
+                std::memcpy(instances, m_Instances.data(), size);
+            }
+            else
+            {
+                for (unsigned int i = 0; i < count; i++)
+                {
+                    instances[i] = m_Instances[m_Order[i]];
+                }
+            }
+
+            // the keys are in draw order now, a batch ends where the texture changes
+            const auto keyAt = [this](const unsigned int i) { return m_Sorted ? m_Keys[i] : m_Keys[m_Order[i]]; };
+            unsigned int first = 0;
+            for (unsigned int i = 1; i <= count; i++)
+            {
+                if (i == count || (keyAt(i) & 0xFFFF) != (keyAt(first) & 0xFFFF))
+                {
+                    m_Batches.push_back({ m_Textures[keyAt(first) & 0xFFFF], writeOffset + first * sizeof(SpriteInstance), i - first });
+                    first = i;
+                }
+            }
+
+            // the contents are lost if the storage was, nothing is drawn then
+            if (m_InstanceStream.Unmap())
+            {
+                m_SpriteCount = count;
+            }
+            else
+            {
+                m_Batches.clear();
+            }
+        }
+    }
+
+    void SpriteBatch::BindBatch(const size_t index, const unsigned int slot) const
+    {
+        const Batch& batch = m_Batches[index];
+        // pointing the attributes at the batch keeps to 3.3, drawing from a base instance needs 4.2
+        m_VertexArray->BindInstanceBuffer<SpriteInstance>(m_InstanceStream.GetRendererID(), batch.offset);
+        batch.texture->Bind(slot);
+    }
+
+    void SpriteBatch::SortByKey()
+    {
+        const size_t count = m_Keys.size();
+        m_Order.resize(count);
+        m_SortScratch.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            m_Order[i] = static_cast<uint32_t>(i);
+        }
+
+        // least significant byte first, each pass is a stable counting sort
+        for (unsigned int shift = 0; shift < 32; shift += 8)
+        {
+            size_t offsets[256] = {};
+            for (const uint32_t key : m_Keys)
+            {
+                offsets[key >> shift & 0xFF]++;
+            }
+            if (offsets[m_Keys[0] >> shift & 0xFF] == count)
+            {
+                continue;
+            }
+
+            size_t total = 0;
+            for (size_t& offset : offsets)
+            {
+                const size_t bucket = offset;
+                offset = total;
+                total += bucket;
+            }
+            for (const uint32_t index : m_Order)
+            {
+                m_SortScratch[offsets[m_Keys[index] >> shift & 0xFF]++] = index;
+            }
+            m_Order.swap(m_SortScratch);
+        }
+    }
+}  // namespace GLBasics
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <GLM/glm.hpp>
+
+#include "InstanceStream.h"
+#include "VertexArray.h"
+#include "VertexLayout.h"
+#include "../Utils/GLDebugHelper.h"
+
+namespace GLBasics
+{
+    class TextureArray;
+
+    /**
+     * \brief One textured quad to draw, in the units of the projection it is drawn with
+     */
+    struct Sprite
+    {
+        glm::vec2 position = glm::vec2(0.0f);    // the center, which the sprite rotates around
+        glm::vec2 size = glm::vec2(1.0f);
+        float rotation = 0.0f;                   // counterclockwise, in radians
+        glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);  // offset and scale within [0, 1], as TextureRegion::rect
+        glm::vec4 color = glm::vec4(1.0f);       // multiplies the texture
+        const TextureArray* texture = nullptr;
+        int textureLayer = 0;
+        int drawLayer = 0;                       // lower layers are drawn first, within [-32768, 32767]
+    };
+
+    /**
+     * \brief One sprite as it is drawn, a quad per instance
+     */
+    struct SpriteInstance
+    {
+        glm::vec2 position;
+        glm::vec2 size;
+        float rotation;
+        float layer;
+        uint16_t uvRect[4];  // offset and scale
+        uint8_t color[4];    // RGBA
+    };
+
+    template<>
+    struct VertexTraits<SpriteInstance>
+    {
+        static constexpr std::array<VertexAttribute, 6> attributes = {
+            VERTEX_ATTRIBUTE(SpriteInstance, position, Float),
+            VERTEX_ATTRIBUTE(SpriteInstance, size, Float),
+            VERTEX_ATTRIBUTE(SpriteInstance, rotation, Float),
+            VERTEX_ATTRIBUTE(SpriteInstance, layer, Float),
+            VERTEX_ATTRIBUTE(SpriteInstance, uvRect, Normalized),
+            VERTEX_ATTRIBUTE(SpriteInstance, color, Normalized)
+        };
+    };
+
+    /**
+     * \brief Collects sprites between Begin and End and draws them in as few instanced draws as
+     * possible: End sorts them by draw layer and texture, keeping the order they were added in
+     * otherwise, and writes them into a streaming instance buffer where every run of sprites
+     * sharing a texture array becomes one batch, drawn with one call. The buffer is appended to
+     * without waiting for the GPU and its storage is orphaned once it is full
+     */
+    class SpriteBatch
+    {
+    public:
+        /**
+         * \brief A run of sprites drawn with one call
+         */
+        struct Batch
+        {
+            const TextureArray* texture;
+            size_t offset;  // bytes into the instance buffer
+            unsigned int count;
+        };
+
+    private:
+        std::vector<SpriteInstance> m_Instances;
+        std::vector<uint32_t> m_Keys;  // draw layer and texture index, in the order the sprites were added
+        std::vector<uint32_t> m_Order, m_SortScratch;
+        std::vector<const TextureArray*> m_Textures;
+        uint32_t m_LastTexture;  // the index the last sprite's texture got
+        bool m_Sorted;
+        bool m_Begun;
+
+        InstanceStream m_InstanceStream;
+        std::unique_ptr<VertexArray> m_VertexArray;
+        std::vector<Batch> m_Batches;
+        unsigned int m_SpriteCount;
+
+    public:
+        /**
+         * \brief Constructs an empty batch and its instance buffer
+         * \param capacity The number of sprites the instance buffer holds, it grows when a batch doesn't fit
+         */
+        explicit SpriteBatch(unsigned int capacity = 65536);
+
+        SpriteBatch(const SpriteBatch&) = delete;
+        SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+        /**
+         * \brief Start collecting sprites, the ones uploaded by the last End stay drawable until the next End
+         */
+        void Begin();
+
+        /**
+         * \brief Add a sprite, sprites without a texture are skipped
+         * \param sprite The sprite
+         */
+        void Draw(const Sprite& sprite);
+
+        /**
+         * \brief Sort the sprites collected since Begin into batches and upload them
+         */
+        void End();
+
+        /**
+         * \brief Bind the VAO with the instances of one batch at attribute locations 0 to 5, and its texture array
+         * \param index Which batch, below GetBatches().size()
+         * \param slot Which sampler2DArray slot to bind the texture array to
+         */
+        void BindBatch(size_t index, unsigned int slot = 0) const;
+
+        /**
+         * \brief Get the batches uploaded by the last End, in the order they are drawn in
+         * \return The batches
+         */
+        inline const std::vector<Batch>& GetBatches() const { return m_Batches; }
+
+        /**
+         * \brief Get the number of sprites uploaded by the last End
+         * \return The number of sprites
+         */
+        inline unsigned int GetSpriteCount() const { return m_SpriteCount; }
+
+        /**
+         * \brief Get how often the instance buffer filled up and got new storage
+         * \return The number of orphaned buffers
+         */
+        inline unsigned int GetOrphanCount() const { return m_InstanceStream.GetOrphanCount(); }
+
+    private:
+        // Stable sorts m_Order by m_Keys, skipping the byte passes every key agrees on
+        void SortByKey();
+
+    };  // class SpriteBatch
+}  // namespace GLBasics
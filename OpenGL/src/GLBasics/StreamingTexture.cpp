@@ -0,0 +1,286 @@
+#include "StreamingTexture.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Shader.h"
+
+namespace GLBasics
+{
+    StreamingTexture::StreamingTexture(const int width, const int height, const StreamingFormat format, const unsigned int bufferCount)
+        : m_Format(format), m_Width(width), m_Height(height), m_PlaneIDs{ 0, 0, 0 },
+          m_Buffers(std::max(bufferCount, 1u), { 0, nullptr }), m_NextBuffer(0), m_BufferSize(0), m_OrphanCount(0)
+    {
+        const int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+        switch (m_Format)
+        {
+            case StreamingFormat::RGBA8: m_BufferSize = static_cast<size_t>(width) * height * 4; break;
+            case StreamingFormat::I420:  m_BufferSize = static_cast<size_t>(width) * height + static_cast<size_t>(chromaWidth) * chromaHeight * 2; break;
+            case StreamingFormat::NV12:  m_BufferSize = static_cast<size_t>(width) * height + static_cast<size_t>(chromaWidth) * chromaHeight * 2; break;
+        }
+
+        int previousTexture = 0;
+        GLCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
+
+        GLCall(glGenTextures(GetPlaneCount(), m_PlaneIDs));
+        for (unsigned int plane = 0; plane < GetPlaneCount(); plane++)
+        {
+            GLCall(glBindTexture(GL_TEXTURE_2D, m_PlaneIDs[plane]));
+            GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+            GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+            GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+            GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+            GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+
+            GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+            // filled with black so the texture doesn't show whatever the driver left in its memory
+            if (m_Format == StreamingFormat::RGBA8)
+            {
+                const std::vector<unsigned char> black(m_BufferSize, 0);
+                GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, black.data()));
+            }
+            else if (plane == 0)
+            {
+                // a Y of 16 is black in limited range
+                const std::vector<unsigned char> luma(static_cast<size_t>(width) * height, 16);
+                GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, luma.data()));
+            }
+            else
+            {
+                const std::vector<unsigned char> chroma(static_cast<size_t>(chromaWidth) * chromaHeight * 2, 128);
+                if (m_Format == StreamingFormat::NV12)
+                {
+                    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, chromaWidth, chromaHeight, 0, GL_RG, GL_UNSIGNED_BYTE, chroma.data()));
+                }
+                else
+                {
+                    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, chromaWidth, chromaHeight, 0, GL_RED, GL_UNSIGNED_BYTE, chroma.data()));
+                }
+            }
+            GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+        }
+        GLCall(glBindTexture(GL_TEXTURE_2D, previousTexture));
+
+        for (UploadBuffer& buffer : m_Buffers)
+        {
+            GLCall(glGenBuffers(1, &buffer.buffer));
+            GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.buffer));
+            GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, m_BufferSize, nullptr, GL_STREAM_DRAW));
+        }
+        GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+    }
+
+    StreamingTexture::~StreamingTexture()
+    {
+        for (UploadBuffer& buffer : m_Buffers)
+        {
+            if (buffer.fence)
+            {
+                GLCall(glDeleteSync(buffer.fence));
+            }
+            GLCall(glDeleteBuffers(1, &buffer.buffer));
+        }
+        GLCall(glDeleteTextures(GetPlaneCount(), m_PlaneIDs));
+    }
+
+    void StreamingTexture::Update(const Region& region, const void* rgbaPixels, const int rowLength)
+    {
+        if (m_Format != StreamingFormat::RGBA8)
+        {
+            std::cout << "ERROR::STREAMING_TEXTURE::NOT_RGBA8 use UpdateYUV" << std::endl;
+            return;
+        }
+
+        const int x = std::max(region.x, 0), y = std::max(region.y, 0);
+        const int width = std::min(region.x + region.width, m_Width) - x, height = std::min(region.y + region.height, m_Height) - y;
+        if (width <= 0 || height <= 0)
+        {
+            return;
+        }
+
+        const size_t sourceRow = static_cast<size_t>(rowLength > 0 ? rowLength : region.width) * 4;
+        const unsigned char* source = static_cast<const unsigned char*>(rgbaPixels) +
+                                      static_cast<size_t>(y - region.y) * sourceRow + static_cast<size_t>(x - region.x) * 4;
+        const size_t row = static_cast<size_t>(width) * 4;
+
+        int previousTexture = 0;
+        GLCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
+        GLCall(glBindTexture(GL_TEXTURE_2D, m_PlaneIDs[0]));
+
+        unsigned char* mapped = static_cast<unsigned char*>(MapNextBuffer(row * height));
+        if (mapped)
+        {
+            for (int line = 0; line < height; line++)
+            {
+                std::memcpy(mapped + line * row, source + line * sourceRow, row);
+            }
+            GLCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+            GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+            FinishUpload();
+        }
+        else
+        {
+            // uploading straight from memory still works, it just blocks the driver while it copies
+            GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+            GLCall(glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<int>(sourceRow / 4)));
+            GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, source));
+            GLCall(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+        }
+
+        GLCall(glBindTexture(GL_TEXTURE_2D, previousTexture));
+    }
+
+    void StreamingTexture::UpdateYUV(const unsigned char* const planes[], const int strides[])
+    {
+        if (m_Format == StreamingFormat::RGBA8)
+        {
+            std::cout << "ERROR::STREAMING_TEXTURE::NOT_YUV use Update" << std::endl;
+            return;
+        }
+
+        const int chromaWidth = (m_Width + 1) / 2, chromaHeight = (m_Height + 1) / 2;
+        const int widths[3] = { m_Width, chromaWidth * (m_Format == StreamingFormat::NV12 ? 2 : 1), chromaWidth };
+        const int heights[3] = { m_Height, chromaHeight, chromaHeight };
+
+        int previousTexture = 0;
+        GLCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
+
+        unsigned char* mapped = static_cast<unsigned char*>(MapNextBuffer(m_BufferSize));
+        size_t offset = 0;
+        GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+        for (unsigned int plane = 0; plane < GetPlaneCount(); plane++)
+        {
+            const size_t row = static_cast<size_t>(widths[plane]);
+            if (mapped)
+            {
+                for (int line = 0; line < heights[plane]; line++)
+                {
+                    std::memcpy(mapped + offset + line * row, planes[plane] + static_cast<size_t>(line) * strides[plane], row);
+                }
+            }
+            offset += row * heights[plane];
+        }
+        if (mapped)
+        {
+            GLCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+        }
+        else
+        {
+            GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+        }
+
+        // every plane is uploaded from its own part of the buffer, or from memory if it couldn't be mapped
+        offset = 0;
+        for (unsigned int plane = 0; plane < GetPlaneCount(); plane++)
+        {
+            const bool interleaved = plane == 1 && m_Format == StreamingFormat::NV12;
+            const int width = interleaved ? chromaWidth : widths[plane];
+            const void* data = mapped ? reinterpret_cast<const void*>(offset) : planes[plane];
+            if (!mapped)
+            {
+                GLCall(glPixelStorei(GL_UNPACK_ROW_LENGTH, strides[plane] / (interleaved ? 2 : 1)));
+            }
+
+            GLCall(glBindTexture(GL_TEXTURE_2D, m_PlaneIDs[plane]));
+            GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, heights[plane], interleaved ? GL_RG : GL_RED, GL_UNSIGNED_BYTE, data));
+            offset += static_cast<size_t>(widths[plane]) * heights[plane];
+        }
+        GLCall(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+        GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+
+        if (mapped)
+        {
+            FinishUpload();
+        }
+        GLCall(glBindTexture(GL_TEXTURE_2D, previousTexture));
+    }
+
+    void StreamingTexture::Bind(const unsigned int slot) const
+    {
+        for (unsigned int plane = 0; plane < GetPlaneCount(); plane++)
+        {
+            GLCall(glActiveTexture(GL_TEXTURE0 + slot + plane));
+            GLCall(glBindTexture(GL_TEXTURE_2D, m_PlaneIDs[plane]));
+        }
+        GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+    }
+
+    void StreamingTexture::UnBind(const unsigned int slot) const
+    {
+        for (unsigned int plane = 0; plane < GetPlaneCount(); plane++)
+        {
+            GLCall(glActiveTexture(GL_TEXTURE0 + slot + plane));
+            GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+        }
+        GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+    }
+
+    void StreamingTexture::SetUniforms(const Shader& shader, const unsigned int slot) const
+    {
+        switch (m_Format)
+        {
+            case StreamingFormat::RGBA8:
+                shader.SetUniform1i("sampler0", static_cast<int>(slot));
+                break;
+            case StreamingFormat::I420:
+                shader.SetUniform1i("yuvPlaneY", static_cast<int>(slot));
+                shader.SetUniform1i("yuvPlaneU", static_cast<int>(slot + 1));
+                shader.SetUniform1i("yuvPlaneV", static_cast<int>(slot + 2));
+                break;
+            case StreamingFormat::NV12:
+                shader.SetUniform1i("yuvPlaneY", static_cast<int>(slot));
+                shader.SetUniform1i("yuvPlaneUV", static_cast<int>(slot + 1));
+                break;
+        }
+    }
+
+    unsigned int StreamingTexture::GetPlaneCount() const
+    {
+        switch (m_Format)
+        {
+            case StreamingFormat::I420: return 3;
+            case StreamingFormat::NV12: return 2;
+            default:                    return 1;
+        }
+    }
+
+    void* StreamingTexture::MapNextBuffer(const size_t size)
+    {
+        UploadBuffer& buffer = m_Buffers[m_NextBuffer];
+        GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.buffer));
+
+        unsigned int access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+        if (buffer.fence)
+        {
+            GLCall(const unsigned int state = glClientWaitSync(buffer.fence, 0, 0));
+            if (state == GL_ALREADY_SIGNALED || state == GL_CONDITION_SATISFIED)
+            {
+                // the GPU is done with it, no need for the driver to check again
+                access |= GL_MAP_UNSYNCHRONIZED_BIT;
+            }
+            else
+            {
+                // fresh storage to write to while the driver keeps the old one until the upload from it is done
+                GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, m_BufferSize, nullptr, GL_STREAM_DRAW));
+                m_OrphanCount++;
+            }
+            GLCall(glDeleteSync(buffer.fence));
+            buffer.fence = nullptr;
+        }
+        else
+        {
+            access |= GL_MAP_UNSYNCHRONIZED_BIT;
+        }
+
+        GLCall(void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, access));
+        return mapped;
+    }
+
+    void StreamingTexture::FinishUpload()
+    {
+        UploadBuffer& buffer = m_Buffers[m_NextBuffer];
+        GLCall(buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+        m_NextBuffer = (m_NextBuffer + 1) % m_Buffers.size();
+    }
+}  // namespace GLBasics
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <vector>
+
+#include "../Utils/GLDebugHelper.h"
+
+namespace GLBasics
+{
+    class Shader;
+
+    /**
+     * \brief The layouts a StreamingTexture accepts its frames in
+     */
+    enum class StreamingFormat
+    {
+        RGBA8,  // four bytes per texel
+        I420,   // full size Y plane, then U and V planes of half the width and height
+        NV12    // full size Y plane, then one plane of interleaved U and V of half the width and height
+    };
+
+    /**
+     * \brief A texture whose contents change every frame, such as video or camera images. Data is
+     * copied into a ring of pixel unpack buffers and uploaded from there, a buffer is only written
+     * again once the fence after its last upload has passed and its storage is orphaned otherwise,
+     * so updating never waits for the GPU. YUV frames are uploaded as separate planes and turned
+     * into RGB by the YUV_TEXTURE variant of the shaders
+     */
+    class StreamingTexture
+    {
+    public:
+        struct Region
+        {
+            int x, y, width, height;
+        };
+
+    private:
+        struct UploadBuffer
+        {
+            unsigned int buffer;
+            GLsync fence;  // nullptr once the upload from the buffer is known to be finished
+        };
+
+        StreamingFormat m_Format;
+        int m_Width, m_Height;
+        unsigned int m_PlaneIDs[3];  // Y, U and V; or Y and UV; or just RGBA
+        std::vector<UploadBuffer> m_Buffers;
+        unsigned int m_NextBuffer;
+        size_t m_BufferSize;
+        unsigned int m_OrphanCount;
+
+    public:
+        /**
+         * \brief Constructs the texture and its ring of pixel unpack buffers, the contents start out black
+         * \param width The width of the frames
+         * \param height The height of the frames, even for the YUV formats
+         * \param format The layout of the frames
+         * \param bufferCount The number of pixel unpack buffers used in turn
+         */
+        StreamingTexture(int width, int height, StreamingFormat format = StreamingFormat::RGBA8, unsigned int bufferCount = 3);
+
+        StreamingTexture(const StreamingTexture&) = delete;
+        StreamingTexture& operator=(const StreamingTexture&) = delete;
+
+        /**
+         * \brief Deletes the textures, the buffers and their fences
+         */
+        ~StreamingTexture();
+
+        /**
+         * \brief Replace part of an RGBA8 texture
+         * \param region The texels to replace, x and y count from the bottom left
+         * \param rgbaPixels Four bytes per texel, starting with the bottom row
+         * \param rowLength The number of texels from one row of rgbaPixels to the next, 0 if the rows are packed
+         */
+        void Update(const Region& region, const void* rgbaPixels, int rowLength = 0);
+
+        /**
+         * \brief Replace the whole frame of an I420 or NV12 texture
+         * \param planes The Y plane, then the U and V planes or the interleaved UV plane, starting with the bottom row
+         * \param strides The bytes from one row of each plane to the next
+         */
+        void UpdateYUV(const unsigned char* const planes[], const int strides[]);
+
+        /**
+         * \brief Bind the planes of this texture
+         * \param slot The texture unit of the first plane, the others follow on the next units
+         */
+        void Bind(unsigned int slot = 0) const;
+
+        /**
+         * \brief Unbind this texture
+         * \param slot The texture unit it was bound to
+         */
+        void UnBind(unsigned int slot = 0) const;
+
+        /**
+         * \brief Set the samplers of the YUV_TEXTURE variant, or sampler0 for RGBA8
+         * \param shader The shader to set them on
+         * \param slot The texture unit the first plane is bound to
+         */
+        void SetUniforms(const Shader& shader, unsigned int slot = 0) const;
+
+        /**
+         * \brief Get the width of the frames
+         * \return An integer that is the width
+         */
+        inline int GetWidth() const { return m_Width; }
+
+        /**
+         * \brief Get the height of the frames
+         * \return An integer that is the height
+         */
+        inline int GetHeight() const { return m_Height; }
+
+        /**
+         * \brief Get how often a buffer was still in use and had to get new storage instead, a
+         * number that keeps growing means the ring is too small for the update rate
+         * \return The number of orphaned buffers
+         */
+        inline unsigned int GetOrphanCount() const { return m_OrphanCount; }
+
+    private:
+        // Returns the number of planes the format has
+        unsigned int GetPlaneCount() const;
+
+        // Maps the next buffer in the ring for writing size bytes, orphaning it if the GPU may still read it
+        void* MapNextBuffer(size_t size);
+
+        // Unmaps the current buffer and fences the uploads made from it, which must be issued in between
+        void FinishUpload();
+
+    };  // class StreamingTexture
+}  // namespace GLBasics
@@ -0,0 +1,170 @@
+#include "TextBatch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Texture.h"
+
+namespace GLBasics
+{
+    TextBatch::TextBatch(const unsigned int capacity, const size_t maxCachedLayouts)
+        : m_CachedCount(0), m_MaxCached(maxCachedLayouts), m_Frame(0), m_LayoutsBuilt(0), m_LastFont(0), m_Begun(false),
+          m_InstanceStream(static_cast<size_t>(std::max(capacity, 1u)) * sizeof(GlyphInstance)),
+          m_VertexArray(std::make_unique<VertexArray>()), m_GlyphCount(0)
+    {
+        m_VertexArray->BindInstanceBuffer<GlyphInstance>(m_InstanceStream.GetRendererID());
+        m_VertexArray->UnBind();
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    }
+
+    void TextBatch::Begin()
+    {
+        for (FontGlyphs& glyphs : m_Fonts)
+        {
+            glyphs.instances.clear();
+        }
+        m_Frame++;
+        m_LayoutsBuilt = 0;
+        m_Begun = true;
+    }
+
+    void TextBatch::Draw(const Font& font, const std::string& text, const glm::vec3& position, const float size, const glm::vec4& color,
+                         const TextSpace space, const glm::vec2& pivot)
+    {
+        if (!m_Begun)
+        {
+            std::cout << "ERROR::TEXT_BATCH::DRAW_WITHOUT_BEGIN" << std::endl;
+            return;
+        }
+        if (!font.IsLoaded() || text.empty())
+        {
+            return;
+        }
+
+        auto& layouts = m_Layouts[&font];
+        auto cached = layouts.find(text);
+        if (cached == layouts.end())
+        {
+            cached = layouts.emplace(text, CachedLayout{}).first;
+            font.Layout(text, cached->second.layout);
+            m_CachedCount++;
+            m_LayoutsBuilt++;
+        }
+        cached->second.lastUsed = m_Frame;
+        const TextLayout& layout = cached->second.layout;
+
+        if (m_LastFont >= m_Fonts.size() || m_Fonts[m_LastFont].font != &font)
+        {
+            const auto found = std::find_if(m_Fonts.begin(), m_Fonts.end(), [&font](const FontGlyphs& glyphs) { return glyphs.font == &font; });
+            m_LastFont = static_cast<size_t>(found - m_Fonts.begin());
+            if (found == m_Fonts.end())
+            {
+                m_Fonts.push_back({ &font, {} });
+            }
+        }
+        std::vector<GlyphInstance>& instances = m_Fonts[m_LastFont].instances;
+
+        // the layout is in pixels of the atlas, scaled to size with the pivot moved to the anchor
+        const float scale = size / font.GetPixelHeight();
+        const glm::vec2 origin = layout.min + (layout.max - layout.min) * pivot;
+        GlyphInstance instance;
+        instance.anchor = position;
+        instance.space = static_cast<uint32_t>(space);
+        for (int i = 0; i < 4; i++)
+        {
+            instance.color[i] = ToUnorm8(color[i]);
+        }
+        for (const LaidGlyph& glyph : layout.glyphs)
+        {
+            instance.offset = (glyph.position - origin) * scale;
+            instance.size = glyph.size * scale;
+            for (int i = 0; i < 4; i++)
+            {
+                instance.uvRect[i] = ToUnorm16(glyph.uvRect[i]);
+            }
+            instances.push_back(instance);
+        }
+    }
+
+    void TextBatch::End()
+    {
+        m_Begun = false;
+        m_Batches.clear();
+        m_GlyphCount = 0;
+
+        if (m_CachedCount > m_MaxCached)
+        {
+            for (auto fontLayouts = m_Layouts.begin(); fontLayouts != m_Layouts.end();)
+            {
+                auto& layouts = fontLayouts->second;
+                for (auto layout = layouts.begin(); layout != layouts.end();)
+                {
+                    if (layout->second.lastUsed != m_Frame)
+                    {
+                        layout = layouts.erase(layout);
+                        m_CachedCount--;
+                    }
+                    else
+                    {
+                        ++layout;
+                    }
+                }
+                fontLayouts = layouts.empty() ? m_Layouts.erase(fontLayouts) : std::next(fontLayouts);
+            }
+        }
+
+        size_t count = 0;
+        for (const FontGlyphs& glyphs : m_Fonts)
+        {
+            count += glyphs.instances.size();
+        }
+        if (count == 0)
+        {
+            return;
+        }
+
+        const size_t size = count * sizeof(GlyphInstance);
+        size_t writeOffset = 0;
+        void* mapped = m_InstanceStream.Map(size, writeOffset);
+        if (mapped)
+        {
+            size_t offset = writeOffset;
+            for (const FontGlyphs& glyphs : m_Fonts)
+            {
+                if (glyphs.instances.empty())
+                {
+                    continue;
+                }
+                const size_t bytes = glyphs.instances.size() * sizeof(GlyphInstance);
+                std::memcpy(static_cast<unsigned char*>(mapped) + (offset - writeOffset), glyphs.instances.data(), bytes);
+                m_Batches.push_back({ glyphs.font, offset, static_cast<unsigned int>(glyphs.instances.size()) });
+                offset += bytes;
+            }
+
+            // the contents are lost if the storage was, nothing is drawn then
+            if (m_InstanceStream.Unmap())
+            {
+                m_GlyphCount = static_cast<unsigned int>(count);
+            }
+            else
+            {
+                m_Batches.clear();
+            }
+        }
+    }
+
+    void TextBatch::ClearCache()
+    {
+        m_Layouts.clear();
+        m_CachedCount = 0;
+        m_Fonts.clear();
+        m_LastFont = 0;
+    }
+
+    void TextBatch::BindBatch(const size_t index, const unsigned int slot) const
+    {
+        const Batch& batch = m_Batches[index];
+        m_VertexArray->BindInstanceBuffer<GlyphInstance>(m_InstanceStream.GetRendererID(), batch.offset);
+        batch.font->GetAtlas().Bind(slot);
+    }
+}  // namespace GLBasics
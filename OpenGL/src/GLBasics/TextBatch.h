@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <GLM/glm.hpp>
+
+#include "Font.h"
+#include "InstanceStream.h"
+#include "VertexArray.h"
+#include "VertexLayout.h"
+#include "../Utils/GLDebugHelper.h"
+
+namespace GLBasics
+{
+    /**
+     * \brief What the position and size of drawn text are measured in
+     */
+    enum class TextSpace : uint32_t
+    {
+        Screen,   // pixels from the bottom left of the viewport
+        World,    // world units, facing the camera
+        Overlay   // pixels, around a point in the world projected to the screen, as for labels
+    };
+
+    /**
+     * \brief One glyph as it is drawn, a quad per instance
+     */
+    struct GlyphInstance
+    {
+        glm::vec3 anchor;
+        uint32_t space;      // a TextSpace
+        glm::vec2 offset;    // of the bottom left corner from the anchor
+        glm::vec2 size;
+        uint16_t uvRect[4];  // offset and scale
+        uint8_t color[4];    // RGBA
+    };
+
+    template<>
+    struct VertexTraits<GlyphInstance>
+    {
+        static constexpr std::array<VertexAttribute, 6> attributes = {
+            VERTEX_ATTRIBUTE(GlyphInstance, anchor, Float),
+            VERTEX_ATTRIBUTE(GlyphInstance, space, Integer),
+            VERTEX_ATTRIBUTE(GlyphInstance, offset, Float),
+            VERTEX_ATTRIBUTE(GlyphInstance, size, Float),
+            VERTEX_ATTRIBUTE(GlyphInstance, uvRect, Normalized),
+            VERTEX_ATTRIBUTE(GlyphInstance, color, Normalized)
+        };
+    };
+
+    /**
+     * \brief Collects text between Begin and End and draws it as instanced glyph quads, one draw
+     * per font however many strings there are. The layout of every string is cached per font and
+     * only rebuilt when the text changes, so a label drawn every frame costs a hash lookup and a copy
+     * of its glyphs. Layouts that went a frame without being drawn are dropped once the cache is full.
+     * The instances are streamed the same way as SpriteBatch's
+     */
+    class TextBatch
+    {
+    public:
+        /**
+         * \brief The glyphs of one font, drawn with one call
+         */
+        struct Batch
+        {
+            const Font* font;
+            size_t offset;  // bytes into the instance buffer
+            unsigned int count;
+        };
+
+    private:
+        struct CachedLayout
+        {
+            TextLayout layout;
+            uint64_t lastUsed;
+        };
+
+        struct FontGlyphs
+        {
+            const Font* font;
+            std::vector<GlyphInstance> instances;
+        };
+
+        std::unordered_map<const Font*, std::unordered_map<std::string, CachedLayout>> m_Layouts;
+        size_t m_CachedCount;
+        size_t m_MaxCached;
+        uint64_t m_Frame;
+        unsigned int m_LayoutsBuilt;
+
+        std::vector<FontGlyphs> m_Fonts;  // kept between frames so the vectors keep their capacity
+        size_t m_LastFont;
+        bool m_Begun;
+
+        InstanceStream m_InstanceStream;
+        std::unique_ptr<VertexArray> m_VertexArray;
+        std::vector<Batch> m_Batches;
+        unsigned int m_GlyphCount;
+
+    public:
+        /**
+         * \brief Constructs an empty batch and its instance buffer
+         * \param capacity The number of glyphs the instance buffer holds, it grows when a frame doesn't fit
+         * \param maxCachedLayouts The number of layouts kept before unused ones are dropped
+         */
+        explicit TextBatch(unsigned int capacity = 16384, size_t maxCachedLayouts = 4096);
+
+        TextBatch(const TextBatch&) = delete;
+        TextBatch& operator=(const TextBatch&) = delete;
+
+        /**
+         * \brief Start collecting text, the glyphs uploaded by the last End stay drawable until the next End
+         */
+        void Begin();
+
+        /**
+         * \brief Add a string, nothing is added for a font that failed to load
+         * \param font The font, which must outlive the cached layouts or be followed by ClearCache
+         * \param text UTF-8 text, lines are broken at '\n'
+         * \param position Where the pivot of the text box goes, in the units of space
+         * \param size The height of a line from the highest ascender to the lowest descender, in the units of space
+         * \param color The color of the glyphs
+         * \param space What position and size are measured in
+         * \param pivot The point of the text box placed at position, (0, 0) for its bottom left and (1, 1) for its top right
+         */
+        void Draw(const Font& font, const std::string& text, const glm::vec3& position, float size, const glm::vec4& color,
+                  TextSpace space = TextSpace::Screen, const glm::vec2& pivot = glm::vec2(0.0f));
+
+        /**
+         * \brief Upload the glyphs collected since Begin, grouped by font
+         */
+        void End();
+
+        /**
+         * \brief Drop every cached layout
+         */
+        void ClearCache();
+
+        /**
+         * \brief Bind the VAO with the instances of one batch at attribute locations 0 to 5, and its atlas
+         * \param index Which batch, below GetBatches().size()
+         * \param slot Which sampler2D slot to bind the atlas to
+         */
+        void BindBatch(size_t index, unsigned int slot = 0) const;
+
+        /**
+         * \brief Get the batches uploaded by the last End
+         * \return The batches
+         */
+        inline const std::vector<Batch>& GetBatches() const { return m_Batches; }
+
+        /**
+         * \brief Get the number of glyphs uploaded by the last End
+         * \return The number of glyphs
+         */
+        inline unsigned int GetGlyphCount() const { return m_GlyphCount; }
+
+        /**
+         * \brief Get the number of strings laid out since Begin because they weren't cached
+         * \return The number of layouts built
+         */
+        inline unsigned int GetLayoutsBuilt() const { return m_LayoutsBuilt; }
+
+        /**
+         * \brief Get the number of cached layouts
+         * \return The number of layouts
+         */
+        inline size_t GetCachedLayoutCount() const { return m_CachedCount; }
+
+        /**
+         * \brief Get how often the instance buffer filled up and got new storage
+         * \return The number of orphaned buffers
+         */
+        inline unsigned int GetOrphanCount() const { return m_InstanceStream.GetOrphanCount(); }
+
+    };  // class TextBatch
+}  // namespace GLBasics
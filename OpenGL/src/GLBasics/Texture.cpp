@@ -1,8 +1,11 @@
 #include "Texture.h"
 
+#include "CompressedImage.h"
+
 #include <stb_image/stb_image.h>
 
 #include "../Utils/GLDebugHelper.h"
+#include "../Utils/MipGenerator.h"
 
 namespace GLBasics
 {
@@ -10,29 +13,46 @@ namespace GLBasics
         : m_RendererID(0), m_LocalBuffer(nullptr), m_Width(0),
           m_Height(0), m_BPP(0)
     {
-        stbi_set_flip_vertically_on_load(1);
-        m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+        if (CompressedImage::IsCompressedFile(path))
+        {
+            CreateTexture();
 
-        GLCall(glGenTextures(1, &m_RendererID));
-        GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+            CompressedImage image;
+            if (CompressedImage::Load(path, image))
+            {
+                SetCompressedImage(image, image.data.data());
+            }
+            return;
+        }
 
-        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
-        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
-        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
+        stbi_set_flip_vertically_on_load(1);
+        m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
 
-        GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
-        GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+        CreateTexture();
 
         if (m_LocalBuffer)
         {
+            const Utils::MipChain chain = Utils::MipGenerator::Generate(m_Width, m_Height, m_LocalBuffer, {});
+            SetMipChain(chain, chain.pixels.data());
             stbi_image_free(m_LocalBuffer);
+            m_LocalBuffer = nullptr;
         }
     }
 
+    Texture::Texture(const int width, const int height, const unsigned char* rgbaPixels)
+        : m_RendererID(0), m_LocalBuffer(nullptr), m_Width(0),
+          m_Height(0), m_BPP(4)
+    {
+        CreateTexture();
+        SetImage(width, height, rgbaPixels);
+    }
+
     Texture::~Texture()
     {
-        GLCall(glDeleteTextures(1, &m_RendererID));
+        if (!m_SharedImage)
+        {
+            GLCall(glDeleteTextures(1, &m_RendererID));
+        }
     }
 
     void Texture::Bind(unsigned slot) const
@@ -45,4 +65,86 @@ namespace GLBasics
     {
         GLCall(glBindTexture(GL_TEXTURE_2D, 0));
     }
+
+    void Texture::SetSampling(const int minFilter, const int magFilter, const int wrap)
+    {
+        GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap));
+    }
+
+    void Texture::CreateTexture()
+    {
+        GLCall(glGenTextures(1, &m_RendererID));
+        GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
+    }
+
+    void Texture::SetImage(const int width, const int height, const void* rgbaPixels)
+    {
+        m_Width = width;
+        m_Height = height;
+
+        GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+        GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgbaPixels));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000));
+        GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+    }
+
+    void Texture::SetMipChain(const Utils::MipChain& chain, const unsigned char* data)
+    {
+        m_Width = chain.levels[0].width;
+        m_Height = chain.levels[0].height;
+
+        GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<int>(chain.levels.size()) - 1));
+        for (size_t level = 0; level < chain.levels.size(); level++)
+        {
+            const Utils::MipChain::Level& mip = chain.levels[level];
+            GLCall(glTexImage2D(GL_TEXTURE_2D, static_cast<int>(level), GL_RGBA8, mip.width, mip.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data + mip.offset));
+        }
+    }
+
+    void Texture::SetCompressedImage(const CompressedImage& image, const unsigned char* data)
+    {
+        if (!CompressedImage::IsFormatSupported(image.internalFormat))
+        {
+            std::cout << "ERROR::TEXTURE::COMPRESSED_FORMAT_NOT_SUPPORTED 0x" << std::hex << image.internalFormat << std::dec << std::endl;
+            return;
+        }
+
+        m_Width = image.width;
+        m_Height = image.height;
+        m_BPP = 0;
+
+        GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+        // the file brings its own mip chain, the texture is complete without any more levels
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<int>(image.levels.size()) - 1));
+        for (size_t level = 0; level < image.levels.size(); level++)
+        {
+            const CompressedImage::Level& mip = image.levels[level];
+            GLCall(glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<int>(level), image.internalFormat, mip.width, mip.height, 0,
+                                          static_cast<int>(mip.size), data + mip.offset));
+        }
+    }
+
+    void Texture::ShareImage(const std::shared_ptr<Texture>& source)
+    {
+        if (!m_SharedImage)
+        {
+            GLCall(glDeleteTextures(1, &m_RendererID));
+        }
+
+        m_RendererID = source->m_RendererID;
+        m_Width = source->m_Width;
+        m_Height = source->m_Height;
+        m_BPP = source->m_BPP;
+        m_SharedImage = source;
+    }
 }  // namespace GLBasics
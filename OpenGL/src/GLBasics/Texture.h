@@ -1,9 +1,17 @@
 #pragma once
 
+#include <memory>
 #include <string>
 
+namespace Utils
+{
+    struct MipChain;
+}
+
 namespace GLBasics
 {
+    struct CompressedImage;
+
     /**
      * \brief Texture class that handles extracting data from a file and binding it
      */
@@ -13,14 +21,31 @@ namespace GLBasics
         unsigned int m_RendererID;
         unsigned char* m_LocalBuffer;
         int m_Width, m_Height, m_BPP;
+        std::shared_ptr<Texture> m_SharedImage;  // owns the OpenGL object when this texture has none of its own
+
+        friend class TextureLoader;
+        friend class TextureStreamer;
 
     public:
         /**
-         * \brief Constructs a texture class with the given file path
-         * \param path A string that is the path to a PNG file that will be used as texture
+         * \brief Constructs a texture class with the given file path. DDS and KTX2 files are uploaded
+         * block-compressed with the mip chain they carry, everything else is decoded to RGBA8 and its
+         * mip chain is filtered on the CPU
+         * \param path A string that is the path to an image file that will be used as texture
          */
         Texture(const std::string& path);
 
+        /**
+         * \brief Constructs a texture from pixels already in memory. Client is responsible for freeing the data
+         * \param width The width of the image
+         * \param height The height of the image
+         * \param rgbaPixels Four bytes per texel, starting with the bottom row
+         */
+        Texture(int width, int height, const unsigned char* rgbaPixels);
+
+        Texture(const Texture&) = delete;
+        Texture& operator=(const Texture&) = delete;
+
         /**
          * \brief Calls the underlying OpenGL function to delete the texture
          */
@@ -37,6 +62,14 @@ namespace GLBasics
          */
         void UnBind() const;
 
+        /**
+         * \brief Change how this texture is sampled
+         * \param minFilter The minification filter, such as GL_LINEAR_MIPMAP_LINEAR
+         * \param magFilter The magnification filter, GL_LINEAR or GL_NEAREST
+         * \param wrap The wrap mode used for both directions, such as GL_REPEAT
+         */
+        void SetSampling(int minFilter, int magFilter, int wrap);
+
         /**
          * \brief Get the width of the input PNG file
          * \return An integer that is the width
@@ -48,5 +81,26 @@ namespace GLBasics
          * \return An integer that is the height
          */
         inline int GetHeight() const { return m_Height; }
+
+    private:
+        // Creates the OpenGL texture object and sets its sampling parameters
+        void CreateTexture();
+
+        // Specifies the base level and generates the mip chain. rgbaPixels is an offset
+        // instead of a pointer while a pixel unpack buffer is bound
+        void SetImage(int width, int height, const void* rgbaPixels);
+
+        // Specifies every level of a chain built on the CPU. data is an offset instead
+        // of a pointer while a pixel unpack buffer is bound
+        void SetMipChain(const Utils::MipChain& chain, const unsigned char* data);
+
+        // Specifies every level of a compressed image. data is an offset instead
+        // of a pointer while a pixel unpack buffer is bound
+        void SetCompressedImage(const CompressedImage& image, const unsigned char* data);
+
+        // Deletes this texture's own OpenGL object and draws from the source's instead, keeping the
+        // source alive. Both then share one sampling state
+        void ShareImage(const std::shared_ptr<Texture>& source);
+
     };  // class Texture
 }  // namespace GLBasics
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include "TextureArray.h"
+
+#include "../Utils/GLDebugHelper.h"
+
+namespace GLBasics
+{
+    TextureArray::TextureArray(const int width, const int height, const int layers, const int maxMipLevel,
+                               const bool clampToEdge)
+        : m_RendererID(0), m_Width(width), m_Height(height), m_Layers(layers)
+    {
+        GLCall(glGenTextures(1, &m_RendererID));
+        GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+
+        GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+        GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        const GLint wrapMode = clampToEdge ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+        GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, wrapMode));
+        GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, wrapMode));
+        GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, maxMipLevel));
+
+        GLCall(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, m_Width, m_Height, m_Layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+    }
+
+    TextureArray::~TextureArray()
+    {
+        GLCall(glDeleteTextures(1, &m_RendererID));
+    }
+
+    void TextureArray::SetLayer(const int layer, const unsigned char* rgbaPixels)
+    {
+        GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+        GLCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, m_Width, m_Height, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgbaPixels));
+    }
+
+    void TextureArray::GenerateMipmaps()
+    {
+        GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+        GLCall(glGenerateMipmap(GL_TEXTURE_2D_ARRAY));
+    }
+
+    void TextureArray::Bind(const unsigned slot) const
+    {
+        GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+        GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+    }
+
+    void TextureArray::UnBind() const
+    {
+        GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+    }
+}  // namespace GLBasics
@@ -0,0 +1,76 @@
+#pragma once
+
+namespace GLBasics
+{
+    /**
+     * \brief TextureArray class representing one GL_TEXTURE_2D_ARRAY whose layers
+     * all share the same size and RGBA8 format
+     */
+    class TextureArray
+    {
+    private:
+        unsigned int m_RendererID;
+        int m_Width, m_Height, m_Layers;
+
+    public:
+        /**
+         * \brief Constructs a texture array with uninitialized layers
+         * \param width The width of every layer
+         * \param height The height of every layer
+         * \param layers The number of layers
+         * \param maxMipLevel The last mip level sampling may use
+         * \param clampToEdge true to clamp coordinates to the edge texels; false to repeat the layers
+         */
+        TextureArray(int width, int height, int layers, int maxMipLevel = 1000, bool clampToEdge = false);
+
+        TextureArray(const TextureArray&) = delete;
+        TextureArray& operator=(const TextureArray&) = delete;
+
+        /**
+         * \brief Calls the underlying OpenGL function to delete the texture
+         */
+        ~TextureArray();
+
+        /**
+         * \brief Replace the pixels of one layer. Client is responsible for freeing the data
+         * \param layer Which layer to replace
+         * \param rgbaPixels Four bytes per texel, starting with the bottom row
+         */
+        void SetLayer(int layer, const unsigned char* rgbaPixels);
+
+        /**
+         * \brief Rebuild the mip chain of every layer, should be called after the layers are set
+         */
+        void GenerateMipmaps();
+
+        /**
+         * \brief Bind this texture array
+         * \param slot which sampler2DArray slot to use
+         */
+        void Bind(unsigned int slot = 0) const;
+
+        /**
+         * \brief Unbind this texture array
+         */
+        void UnBind() const;
+
+        /**
+         * \brief Get the width of every layer
+         * \return An integer that is the width
+         */
+        inline int GetWidth() const { return m_Width; }
+
+        /**
+         * \brief Get the height of every layer
+         * \return An integer that is the height
+         */
+        inline int GetHeight() const { return m_Height; }
+
+        /**
+         * \brief Get the number of layers
+         * \return An integer that is the layer count
+         */
+        inline int GetLayerCount() const { return m_Layers; }
+
+    };  // class TextureArray
+}  // namespace GLBasics
@@ -0,0 +1,148 @@
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+
+#include "TextureLoader.h"
+
+namespace GLBasics
+{
+    std::string TextureSettings::ToString() const
+    {
+        std::ostringstream text;
+        text << minFilter << ',' << magFilter << ',' << wrap << ',' << static_cast<int>(mips.filter) << ','
+             << mips.srgb << ',' << mips.alphaCoverageReference;
+        return text.str();
+    }
+
+    TextureCache::TextureCache(TextureLoader& loader, const unsigned int evictAfterFrames)
+        : m_Loader(loader), m_EvictAfterFrames(evictAfterFrames), m_Frame(0)
+    {
+        m_Loader.SetDuplicateResolver([this](const std::shared_ptr<Texture>& texture, const uint64_t contentHash,
+                                             const std::function<bool(const Texture&)>& isSameImage)
+        {
+            return ResolveDuplicate(texture, contentHash, isSameImage);
+        });
+    }
+
+    TextureCache::~TextureCache()
+    {
+        m_Loader.SetDuplicateResolver(nullptr);
+    }
+
+    std::shared_ptr<Texture> TextureCache::Get(const std::string& path, const TextureSettings& settings)
+    {
+        std::error_code error;
+        std::string canonicalPath = std::filesystem::weakly_canonical(path, error).generic_string();
+        if (error)
+        {
+            canonicalPath = path;
+        }
+
+        // the size and time stand in for the bytes, reading them would stall the render thread
+        std::ostringstream key;
+        key << canonicalPath << '|';
+        const uintmax_t size = std::filesystem::file_size(canonicalPath, error);
+        if (!error)
+        {
+            const auto time = std::filesystem::last_write_time(canonicalPath, error);
+            if (!error)
+            {
+                key << size << '|' << time.time_since_epoch().count() << '|';
+            }
+        }
+        const std::string settingsText = settings.ToString();
+        key << settingsText;  // a file that can't be read is keyed by path, the loader reports it
+
+        const auto found = m_Entries.find(key.str());
+        if (found != m_Entries.end())
+        {
+            found->second.lastUsedFrame = m_Frame;
+            return found->second.texture;
+        }
+
+        std::shared_ptr<Texture> texture = m_Loader.Load(path, settings.mips);
+        texture->SetSampling(settings.minFilter, settings.magFilter, settings.wrap);
+        m_Entries[key.str()] = { texture, m_Frame, settingsText };
+        return texture;
+    }
+
+    void TextureCache::Update()
+    {
+        m_Frame++;
+        const std::unordered_map<const Texture*, long> entryCounts = CountEntries();
+        for (auto entry = m_Entries.begin(); entry != m_Entries.end();)
+        {
+            if (entry->second.texture.use_count() > entryCounts.at(entry->second.texture.get()))
+            {
+                entry->second.lastUsedFrame = m_Frame;
+                ++entry;
+            }
+            else if (m_Frame - entry->second.lastUsedFrame > m_EvictAfterFrames)
+            {
+                entry = m_Entries.erase(entry);
+            }
+            else
+            {
+                ++entry;
+            }
+        }
+    }
+
+    void TextureCache::EvictUnused()
+    {
+        const std::unordered_map<const Texture*, long> entryCounts = CountEntries();
+        for (auto entry = m_Entries.begin(); entry != m_Entries.end();)
+        {
+            const bool isHeld = entry->second.texture.use_count() > entryCounts.at(entry->second.texture.get());
+            entry = isHeld ? std::next(entry) : m_Entries.erase(entry);
+        }
+    }
+
+    unsigned int TextureCache::GetTextureCount() const
+    {
+        return static_cast<unsigned int>(CountEntries().size());
+    }
+
+    std::shared_ptr<Texture> TextureCache::ResolveDuplicate(const std::shared_ptr<Texture>& texture, const uint64_t contentHash,
+                                                            const std::function<bool(const Texture&)>& isSameImage)
+    {
+        const auto entry = std::find_if(m_Entries.begin(), m_Entries.end(),
+                                        [&texture](const auto& candidate) { return candidate.second.texture == texture; });
+        if (entry == m_Entries.end())
+        {
+            return nullptr;  // loaded without the cache
+        }
+
+        std::ostringstream contentKey;
+        contentKey << std::hex << contentHash << '|' << entry->second.settings;
+        std::vector<std::weak_ptr<Texture>>& uploaded = m_Contents[contentKey.str()];
+        uploaded.erase(std::remove_if(uploaded.begin(), uploaded.end(), [](const std::weak_ptr<Texture>& other) { return other.expired(); }),
+                       uploaded.end());
+
+        // the hash only picks the candidates, the pixels decide
+        for (const std::weak_ptr<Texture>& candidate : uploaded)
+        {
+            std::shared_ptr<Texture> original = candidate.lock();
+            if (original != texture && isSameImage(*original))
+            {
+                entry->second.texture = original;
+                return original;
+            }
+        }
+
+        uploaded.push_back(texture);
+        return nullptr;
+    }
+
+    std::unordered_map<const Texture*, long> TextureCache::CountEntries() const
+    {
+        std::unordered_map<const Texture*, long> entryCounts;
+        for (const auto& entry : m_Entries)
+        {
+            entryCounts[entry.second.texture.get()]++;
+        }
+        return entryCounts;
+    }
+}  // namespace GLBasics
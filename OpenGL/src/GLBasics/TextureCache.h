@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Texture.h"
+#include "../Utils/GLDebugHelper.h"
+#include "../Utils/MipGenerator.h"
+
+namespace GLBasics
+{
+    class TextureLoader;
+
+    /**
+     * \brief Everything besides the image that decides what a texture looks like
+     */
+    struct TextureSettings
+    {
+        int minFilter = GL_LINEAR_MIPMAP_LINEAR;
+        int magFilter = GL_LINEAR;
+        int wrap = GL_REPEAT;
+        Utils::MipGenerator::Options mips;
+
+        /**
+         * \brief Get a string that is equal for equal settings, used in the cache keys
+         * \return The settings as a string
+         */
+        std::string ToString() const;
+    };
+
+    /**
+     * \brief Hands out shared textures so every image is decoded and uploaded once. Textures are
+     * found by canonical path, file size, modification time and settings, so a file that changed on
+     * disk is loaded again. Files that decode to the same pixels share one texture even under
+     * different paths, which is found out from the loader's content hash once they are decoded.
+     * Textures nobody holds any more are kept for a while in case they are asked for again
+     */
+    class TextureCache
+    {
+    private:
+        struct Entry
+        {
+            std::shared_ptr<Texture> texture;
+            uint64_t lastUsedFrame;
+            std::string settings;
+        };
+
+        TextureLoader& m_Loader;
+        unsigned int m_EvictAfterFrames;
+        uint64_t m_Frame;
+
+        std::unordered_map<std::string, Entry> m_Entries;                                // "path|size|time|settings" -> texture
+        std::unordered_map<std::string, std::vector<std::weak_ptr<Texture>>> m_Contents;  // "hash|settings" -> uploaded textures
+
+    public:
+        /**
+         * \brief Constructs an empty cache
+         * \param loader Loads the textures that aren't cached yet. Must outlive the cache
+         * \param evictAfterFrames How many calls to Update a texture nobody holds is kept for
+         */
+        explicit TextureCache(TextureLoader& loader, unsigned int evictAfterFrames = 600);
+
+        TextureCache(const TextureCache&) = delete;
+        TextureCache& operator=(const TextureCache&) = delete;
+
+        /**
+         * \brief Stops the loader from asking the cache about duplicates
+         */
+        ~TextureCache();
+
+        /**
+         * \brief Get the texture for an image, starting to load it if it isn't cached
+         * \param path A string that is the path to an image file
+         * \param settings How the texture is sampled and its mips are built
+         * \return The shared texture, a placeholder until the image is uploaded
+         */
+        std::shared_ptr<Texture> Get(const std::string& path, const TextureSettings& settings = {});
+
+        /**
+         * \brief Release the textures nobody has held for evictAfterFrames calls. Should be called once per frame
+         */
+        void Update();
+
+        /**
+         * \brief Release every texture nobody holds right now
+         */
+        void EvictUnused();
+
+        /**
+         * \brief Get the number of textures the cache keeps alive
+         * \return The number of textures
+         */
+        unsigned int GetTextureCount() const;
+
+        /**
+         * \brief Get the number of path and settings pairs that resolve to a cached texture
+         * \return The number of paths
+         */
+        inline unsigned int GetPathCount() const { return static_cast<unsigned int>(m_Entries.size()); }
+
+    private:
+        // Points the entry of a texture that finished decoding at an uploaded texture with the same
+        // pixels and settings, or remembers it as the texture for its pixels
+        std::shared_ptr<Texture> ResolveDuplicate(const std::shared_ptr<Texture>& texture, uint64_t contentHash,
+                                                  const std::function<bool(const Texture&)>& isSameImage);
+
+        // Counts how many entries hold each texture, several do once duplicates are shared
+        std::unordered_map<const Texture*, long> CountEntries() const;
+
+    };  // class TextureCache
+}  // namespace GLBasics
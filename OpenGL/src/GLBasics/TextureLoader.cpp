@@ -0,0 +1,301 @@
+#include "TextureLoader.h"
+
+#include <cstring>
+
+#include <stb_image/stb_image.h>
+
+#include "../Utils/GLDebugHelper.h"
+#include "../Utils/Hash.h"
+#include "../Utils/ThreadPool.h"
+
+namespace GLBasics
+{
+    // mid grey, shown until the image is uploaded
+    constexpr unsigned char PLACEHOLDER_PIXEL[4] = { 128, 128, 128, 255 };
+
+    TextureLoader::TextureLoader(Utils::ThreadPool& threadPool, const size_t uploadBudgetBytes, const unsigned int bufferCount)
+        : m_ThreadPool(threadPool), m_UploadBudget(uploadBudgetBytes), m_PixelUnpackBuffers(bufferCount, 0),
+          m_NextBuffer(0), m_DecodesInFlight(0), m_Cancelled(false)
+    {
+        GLCall(glGenBuffers(bufferCount, m_PixelUnpackBuffers.data()));
+    }
+
+    TextureLoader::~TextureLoader()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Cancelled = true;
+            m_DecodeFinished.wait(lock, [this] { return m_DecodesInFlight == 0; });
+        }
+
+        GLCall(glDeleteBuffers(static_cast<int>(m_PixelUnpackBuffers.size()), m_PixelUnpackBuffers.data()));
+    }
+
+    std::shared_ptr<Texture> TextureLoader::Load(const std::string& path)
+    {
+        return Load(path, m_MipOptions);
+    }
+
+    std::shared_ptr<Texture> TextureLoader::Load(const std::string& path, const Utils::MipGenerator::Options& mipOptions)
+    {
+        auto texture = std::make_shared<Texture>(1, 1, PLACEHOLDER_PIXEL);
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_DecodesInFlight++;
+        }
+
+        std::weak_ptr<Texture> target = texture;
+        m_ThreadPool.Enqueue([this, path, target, mipOptions, cacheDirectory = m_MipCacheDirectory]
+        {
+            Decode(path, target, mipOptions, cacheDirectory);
+        });
+        return texture;
+    }
+
+    void TextureLoader::SetMipGeneration(const Utils::MipGenerator::Options& options, const std::string& cacheDirectory)
+    {
+        m_MipOptions = options;
+        m_MipCacheDirectory = cacheDirectory;
+    }
+
+    void TextureLoader::Update()
+    {
+        size_t uploadedBytes = 0;
+        while (true)
+        {
+            DecodedImage image;
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (m_Decoded.empty())
+                {
+                    break;
+                }
+
+                const size_t imageBytes = m_Decoded.front().GetSize();
+                if (uploadedBytes > 0 && uploadedBytes + imageBytes > m_UploadBudget)
+                {
+                    break;
+                }
+                uploadedBytes += imageBytes;
+
+                image = m_Decoded.front();
+                m_Decoded.pop_front();
+            }
+
+            Upload(image);
+        }
+    }
+
+    unsigned int TextureLoader::GetPendingCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_DecodesInFlight + static_cast<unsigned int>(m_Decoded.size());
+    }
+
+    void TextureLoader::Decode(const std::string& path, const std::weak_ptr<Texture>& texture,
+                               const Utils::MipGenerator::Options& mipOptions, const std::string& mipCacheDirectory)
+    {
+        DecodedImage image{ texture, {}, {}, 0 };
+        bool loaded = false;
+
+        bool cancelled;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            cancelled = m_Cancelled;
+        }
+
+        // nothing to do if the texture was released before its turn came
+        if (!cancelled && !texture.expired())
+        {
+            loaded = DecodeFile(path, mipOptions, mipCacheDirectory, image.mips, image.compressed, &image.contentHash);
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (loaded)
+        {
+            m_Decoded.push_back(std::move(image));
+        }
+        m_DecodesInFlight--;
+        m_DecodeFinished.notify_all();
+    }
+
+    bool TextureLoader::DecodeFile(const std::string& path, const Utils::MipGenerator::Options& mipOptions,
+                                   const std::string& mipCacheDirectory, Utils::MipChain& mips, CompressedImage& compressed,
+                                   uint64_t* contentHash)
+    {
+        if (!DecodeLevels(path, mipOptions, mipCacheDirectory, mips, compressed))
+        {
+            return false;
+        }
+
+        if (contentHash)
+        {
+            // the layout is hashed with the bytes so images that only differ in shape don't collide
+            uint64_t hash = Utils::HashFNV1a(nullptr, 0);
+            if (!mips.levels.empty())
+            {
+                hash = Utils::HashFNV1a(mips.levels.data(), mips.levels.size() * sizeof(Utils::MipChain::Level), hash);
+                hash = Utils::HashFNV1a(mips.pixels.data(), mips.pixels.size(), hash);
+            }
+            else
+            {
+                hash = Utils::HashFNV1a(&compressed.internalFormat, sizeof(compressed.internalFormat), hash);
+                hash = Utils::HashFNV1a(compressed.levels.data(), compressed.levels.size() * sizeof(CompressedImage::Level), hash);
+                hash = Utils::HashFNV1a(compressed.data.data(), compressed.data.size(), hash);
+            }
+            *contentHash = hash;
+        }
+        return true;
+    }
+
+    bool TextureLoader::DecodeLevels(const std::string& path, const Utils::MipGenerator::Options& mipOptions,
+                                     const std::string& mipCacheDirectory, Utils::MipChain& mips, CompressedImage& compressed)
+    {
+        if (CompressedImage::IsCompressedFile(path))
+        {
+            return CompressedImage::Load(path, compressed);
+        }
+
+        const std::string cachePath = mipCacheDirectory.empty() ? "" : Utils::MipGenerator::GetCachePath(mipCacheDirectory, path, mipOptions);
+        if (!cachePath.empty() && Utils::MipGenerator::LoadCache(cachePath, mips))
+        {
+            return true;
+        }
+
+        int width = 0, height = 0, channels = 0;
+        stbi_set_flip_vertically_on_load_thread(1);
+        unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+        if (!pixels)
+        {
+            std::cout << "ERROR::TEXTURE::DECODE_FAILED " << path << ": " << stbi_failure_reason() << std::endl;
+            return false;
+        }
+
+        mips = Utils::MipGenerator::Generate(width, height, pixels, mipOptions);
+        stbi_image_free(pixels);
+        if (!cachePath.empty())
+        {
+            Utils::MipGenerator::SaveCache(cachePath, mips);
+        }
+        return true;
+    }
+
+    void TextureLoader::Upload(const DecodedImage& image)
+    {
+        const std::shared_ptr<Texture> texture = image.texture.lock();
+        if (!texture)
+        {
+            return;
+        }
+
+        int previousTexture = 0;
+        GLCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
+
+        if (m_DuplicateResolver)
+        {
+            const auto isSameImage = [&image](const Texture& other) { return HasImage(other, image); };
+            const std::shared_ptr<Texture> original = m_DuplicateResolver(texture, image.contentHash, isSameImage);
+            if (original && original != texture)
+            {
+                texture->ShareImage(original);
+                GLCall(glBindTexture(GL_TEXTURE_2D, previousTexture));
+                return;
+            }
+        }
+
+        const size_t imageBytes = image.GetSize();
+        const unsigned char* source = image.mips.levels.empty() ? image.compressed.data.data() : image.mips.pixels.data();
+        const unsigned int buffer = m_PixelUnpackBuffers[m_NextBuffer];
+        m_NextBuffer = (m_NextBuffer + 1) % m_PixelUnpackBuffers.size();
+
+        // Orphaning the storage lets the driver keep transferring the previous contents while we write
+        GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer));
+        GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, imageBytes, nullptr, GL_STREAM_DRAW));
+        GLCall(void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, imageBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        if (mapped)
+        {
+            std::memcpy(mapped, source, imageBytes);
+            GLCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+            SetImage(*texture, image, nullptr);  // offsets into the buffer
+            GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+        }
+        else
+        {
+            GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+            SetImage(*texture, image, source);
+        }
+
+        GLCall(glBindTexture(GL_TEXTURE_2D, previousTexture));
+    }
+
+    void TextureLoader::SetImage(Texture& texture, const DecodedImage& image, const unsigned char* data)
+    {
+        if (!image.mips.levels.empty())
+        {
+            texture.SetMipChain(image.mips, data);
+        }
+        else
+        {
+            texture.SetCompressedImage(image.compressed, data);
+        }
+    }
+
+    bool TextureLoader::HasImage(const Texture& texture, const DecodedImage& image)
+    {
+        const bool isCompressed = image.mips.levels.empty();
+        const int width = isCompressed ? image.compressed.width : image.mips.levels[0].width;
+        const int height = isCompressed ? image.compressed.height : image.mips.levels[0].height;
+        const size_t levelCount = isCompressed ? image.compressed.levels.size() : image.mips.levels.size();
+        if (texture.m_Width != width || texture.m_Height != height)
+        {
+            return false;
+        }
+
+        GLCall(glBindTexture(GL_TEXTURE_2D, texture.m_RendererID));
+        int maxLevel = 0, internalFormat = 0;
+        GLCall(glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &maxLevel));
+        GLCall(glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat));
+        const int expectedFormat = isCompressed ? static_cast<int>(image.compressed.internalFormat) : GL_RGBA8;
+        if (maxLevel != static_cast<int>(levelCount) - 1 || internalFormat != expectedFormat)
+        {
+            return false;
+        }
+
+        std::vector<unsigned char> pixels;
+        for (size_t level = 0; level < levelCount; level++)
+        {
+            const unsigned char* expected;
+            if (isCompressed)
+            {
+                const CompressedImage::Level& mip = image.compressed.levels[level];
+                int size = 0;
+                GLCall(glGetTexLevelParameteriv(GL_TEXTURE_2D, static_cast<int>(level), GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size));
+                if (static_cast<size_t>(size) != mip.size)
+                {
+                    return false;
+                }
+                pixels.resize(mip.size);
+                GLCall(glGetCompressedTexImage(GL_TEXTURE_2D, static_cast<int>(level), pixels.data()));
+                expected = image.compressed.data.data() + mip.offset;
+            }
+            else
+            {
+                const Utils::MipChain::Level& mip = image.mips.levels[level];
+                pixels.resize(static_cast<size_t>(mip.width) * mip.height * 4);
+                GLCall(glGetTexImage(GL_TEXTURE_2D, static_cast<int>(level), GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+                expected = image.mips.pixels.data() + mip.offset;
+            }
+
+            if (std::memcmp(pixels.data(), expected, pixels.size()) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t TextureLoader::DecodedImage::GetSize() const
+    {
+        return mips.levels.empty() ? compressed.data.size() : mips.pixels.size();
+    }
+}  // namespace GLBasics
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CompressedImage.h"
+#include "Texture.h"
+#include "../Utils/MipGenerator.h"
+
+namespace Utils
+{
+    class ThreadPool;
+}
+
+namespace GLBasics
+{
+    /**
+     * \brief Loads textures without blocking the render thread. Images are decoded on a thread pool
+     * while a placeholder is shown, then streamed to the GPU through pixel unpack buffers with a
+     * limit on how many bytes are uploaded per frame
+     */
+    class TextureLoader
+    {
+    public:
+        /**
+         * \brief Decides whether an image that finished decoding is already on the GPU
+         * \param texture The texture the image was loaded for
+         * \param contentHash The hash of the decoded image, equal for equal images
+         * \param isSameImage Compares the pixels of a texture with the decoded image
+         * \return A texture holding the same image that texture will share instead of uploading it, or nullptr to upload
+         */
+        using DuplicateResolver = std::function<std::shared_ptr<Texture>(const std::shared_ptr<Texture>& texture, uint64_t contentHash,
+                                                                         const std::function<bool(const Texture&)>& isSameImage)>;
+
+    private:
+        struct DecodedImage
+        {
+            std::weak_ptr<Texture> texture;
+            Utils::MipChain mips;  // empty when the image is compressed
+            CompressedImage compressed;
+            uint64_t contentHash;
+
+            size_t GetSize() const;
+        };
+
+        Utils::ThreadPool& m_ThreadPool;
+        size_t m_UploadBudget;
+        Utils::MipGenerator::Options m_MipOptions;
+        std::string m_MipCacheDirectory;
+        std::vector<unsigned int> m_PixelUnpackBuffers;
+        unsigned int m_NextBuffer;
+        DuplicateResolver m_DuplicateResolver;
+
+        mutable std::mutex m_Mutex;
+        std::condition_variable m_DecodeFinished;
+        std::deque<DecodedImage> m_Decoded;
+        unsigned int m_DecodesInFlight;
+        bool m_Cancelled;
+
+    public:
+        /**
+         * \brief Constructs a loader and its ring of pixel unpack buffers
+         * \param threadPool The workers the images are decoded on. Must outlive the loader
+         * \param uploadBudgetBytes How many bytes Update may upload, one image is always allowed
+         * \param bufferCount The number of pixel unpack buffers used in turn
+         */
+        TextureLoader(Utils::ThreadPool& threadPool, size_t uploadBudgetBytes = 16 * 1024 * 1024, unsigned int bufferCount = 3);
+
+        TextureLoader(const TextureLoader&) = delete;
+        TextureLoader& operator=(const TextureLoader&) = delete;
+
+        /**
+         * \brief Waits for the decodes in flight and deletes the pixel unpack buffers
+         */
+        ~TextureLoader();
+
+        /**
+         * \brief Set how the mip chains of the textures loaded from now on are built
+         * \param options How the levels are filtered
+         * \param cacheDirectory Where generated chains are kept between runs, empty to always generate them
+         */
+        void SetMipGeneration(const Utils::MipGenerator::Options& options, const std::string& cacheDirectory = "");
+
+        /**
+         * \brief Start loading a texture. Returns right away with a 1x1 placeholder
+         * that receives the image and its mip chain once they are ready and uploaded
+         * \param path A string that is the path to an image file, DDS and KTX2 files stay compressed
+         * \return The texture, whose OpenGL object stays the same after the upload
+         */
+        std::shared_ptr<Texture> Load(const std::string& path);
+
+        /**
+         * \brief Start loading a texture with its own mip settings instead of the ones set with SetMipGeneration
+         * \param path A string that is the path to an image file, DDS and KTX2 files stay compressed
+         * \param mipOptions How the levels are filtered
+         * \return The texture, whose OpenGL object stays the same after the upload
+         */
+        std::shared_ptr<Texture> Load(const std::string& path, const Utils::MipGenerator::Options& mipOptions);
+
+        /**
+         * \brief Set what is asked before each upload whether the image is already on the GPU
+         * \param resolver Called on the render thread, empty to always upload
+         */
+        inline void SetDuplicateResolver(DuplicateResolver resolver) { m_DuplicateResolver = std::move(resolver); }
+
+        /**
+         * \brief Upload the decoded images within the budget. Should be called once per frame
+         */
+        void Update();
+
+        /**
+         * \brief Get the number of textures that are still decoding or waiting for upload
+         * \return The number of pending textures
+         */
+        unsigned int GetPendingCount() const;
+
+        /**
+         * \brief Decode an image file on the calling thread. DDS and KTX2 files are read as they are,
+         * everything else is decoded to RGBA8 and gets a mip chain, read from the cache when it has one
+         * \param path A string that is the path to an image file
+         * \param mipOptions How the levels are filtered
+         * \param mipCacheDirectory Where generated chains are kept between runs, empty to always generate them
+         * \param mips Receives the mip chain of an uncompressed image
+         * \param compressed Receives a compressed image
+         * \param contentHash Receives the hash of the decoded levels if not nullptr
+         * \return true if the file was decoded; false otherwise
+         */
+        static bool DecodeFile(const std::string& path, const Utils::MipGenerator::Options& mipOptions,
+                               const std::string& mipCacheDirectory, Utils::MipChain& mips, CompressedImage& compressed,
+                               uint64_t* contentHash = nullptr);
+
+    private:
+        // Decodes one image and builds its mip chain on a worker thread, then queues it for upload
+        void Decode(const std::string& path, const std::weak_ptr<Texture>& texture,
+                    const Utils::MipGenerator::Options& mipOptions, const std::string& mipCacheDirectory);
+
+        // Does the work of DecodeFile besides hashing
+        static bool DecodeLevels(const std::string& path, const Utils::MipGenerator::Options& mipOptions,
+                                 const std::string& mipCacheDirectory, Utils::MipChain& mips, CompressedImage& compressed);
+
+        // Copies one image into the next pixel unpack buffer and specifies the texture from it
+        void Upload(const DecodedImage& image);
+
+        // Specifies the texture from an image, data is the pixels or the offset of the first level
+        // into a bound pixel unpack buffer
+        static void SetImage(Texture& texture, const DecodedImage& image, const unsigned char* data);
+
+        // Reads every level of the texture back and compares it with the image
+        static bool HasImage(const Texture& texture, const DecodedImage& image);
+
+    };  // class TextureLoader
+}  // namespace GLBasics
@@ -0,0 +1,192 @@
+#include "TexturePacker.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <utility>
+
+#include <stb_image/stb_image.h>
+
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <ImGui/imstb_rectpack.h>
+
+#include "../Utils/GLDebugHelper.h"
+
+namespace GLBasics
+{
+    TexturePacker::TexturePacker(const int atlasSize, const int padding, const int maxAtlasImageSize)
+        : m_AtlasSize(atlasSize), m_Padding(1), m_MaxAtlasImageSize(maxAtlasImageSize), m_MaxLayers(1)
+    {
+        // a power of two keeps every packed rectangle aligned to the texel blocks of the last mip level
+        while (m_Padding * 2 <= padding)
+        {
+            m_Padding *= 2;
+        }
+        m_AtlasSize -= m_AtlasSize % m_Padding;
+    }
+
+    int TexturePacker::Add(const std::string& path)
+    {
+        int width = 0, height = 0, channels = 0;
+        stbi_set_flip_vertically_on_load_thread(1);
+        unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+        if (!pixels)
+        {
+            std::cout << "ERROR::TEXTURE_PACKER::LOAD_FAILED " << path << ": " << stbi_failure_reason() << std::endl;
+            return -1;
+        }
+
+        const int id = Add(width, height, pixels);
+        stbi_image_free(pixels);
+        return id;
+    }
+
+    int TexturePacker::Add(const int width, const int height, const unsigned char* rgbaPixels)
+    {
+        Image image{ width, height, {} };
+        image.pixels.assign(rgbaPixels, rgbaPixels + static_cast<size_t>(width) * height * 4);
+        m_Images.push_back(std::move(image));
+        m_Regions.push_back({ 0, 0, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f) });
+        return static_cast<int>(m_Images.size()) - 1;
+    }
+
+    void TexturePacker::Build()
+    {
+        m_Arrays.clear();
+
+        GLCall(glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &m_MaxLayers));
+        m_MaxLayers = std::max(m_MaxLayers, 1);  // a broken driver reporting 0 would never finish an array
+
+        std::vector<int> large, small;
+        for (int i = 0; i < static_cast<int>(m_Images.size()); i++)
+        {
+            const Image& image = m_Images[i];
+            if (image.width > m_MaxAtlasImageSize || image.height > m_MaxAtlasImageSize
+                || image.width + 2 * m_Padding > m_AtlasSize || image.height + 2 * m_Padding > m_AtlasSize)
+            {
+                large.push_back(i);
+            }
+            else
+            {
+                small.push_back(i);
+            }
+        }
+
+        BuildSameSizeArrays(large);
+        BuildAtlas(small);
+
+        m_Images.clear();
+        m_Images.shrink_to_fit();
+    }
+
+    void TexturePacker::BuildSameSizeArrays(const std::vector<int>& ids)
+    {
+        std::map<std::pair<int, int>, std::vector<int>> bySize;
+        for (const int id : ids)
+        {
+            bySize[{ m_Images[id].width, m_Images[id].height }].push_back(id);
+        }
+
+        for (const auto& [size, group] : bySize)
+        {
+            for (size_t first = 0; first < group.size(); first += m_MaxLayers)
+            {
+                const int layers = static_cast<int>(std::min(group.size() - first, static_cast<size_t>(m_MaxLayers)));
+                const auto arrayIndex = static_cast<unsigned int>(m_Arrays.size());
+                m_Arrays.push_back(std::make_unique<TextureArray>(size.first, size.second, layers));
+
+                for (int layer = 0; layer < layers; layer++)
+                {
+                    const int id = group[first + layer];
+                    m_Arrays.back()->SetLayer(layer, m_Images[id].pixels.data());
+                    m_Regions[id] = { arrayIndex, layer, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f) };
+                }
+                m_Arrays.back()->GenerateMipmaps();
+            }
+        }
+    }
+
+    void TexturePacker::BuildAtlas(const std::vector<int>& ids)
+    {
+        if (ids.empty())
+        {
+            return;
+        }
+
+        std::vector<stbrp_rect> remaining(ids.size());
+        for (size_t i = 0; i < ids.size(); i++)
+        {
+            const Image& image = m_Images[ids[i]];
+            remaining[i].id = ids[i];
+            // rounding the sizes up keeps the skyline, and so every position, on multiples of the padding
+            remaining[i].w = (image.width + 2 * m_Padding + m_Padding - 1) / m_Padding * m_Padding;
+            remaining[i].h = (image.height + 2 * m_Padding + m_Padding - 1) / m_Padding * m_Padding;
+        }
+
+        std::vector<stbrp_node> nodes(m_AtlasSize);
+        std::vector<std::vector<stbrp_rect>> pages;
+        while (!remaining.empty())
+        {
+            stbrp_context context;
+            stbrp_init_target(&context, m_AtlasSize, m_AtlasSize, nodes.data(), static_cast<int>(nodes.size()));
+            stbrp_pack_rects(&context, remaining.data(), static_cast<int>(remaining.size()));
+
+            std::vector<stbrp_rect> packed, unpacked;
+            for (const stbrp_rect& rect : remaining)
+            {
+                (rect.was_packed ? packed : unpacked).push_back(rect);
+            }
+            pages.push_back(std::move(packed));
+            remaining = std::move(unpacked);
+        }
+
+        int maxMipLevel = 0;
+        while ((1 << maxMipLevel) < m_Padding)
+        {
+            maxMipLevel++;
+        }
+
+        const float size = static_cast<float>(m_AtlasSize);
+        std::vector<unsigned char> page(static_cast<size_t>(m_AtlasSize) * m_AtlasSize * 4);
+        for (size_t firstPage = 0; firstPage < pages.size(); firstPage += m_MaxLayers)
+        {
+            const int layers = static_cast<int>(std::min(pages.size() - firstPage, static_cast<size_t>(m_MaxLayers)));
+            const auto arrayIndex = static_cast<unsigned int>(m_Arrays.size());
+            // the extruded borders already repeat the edges, wrapping around would pull in the opposite side of the page
+            m_Arrays.push_back(std::make_unique<TextureArray>(m_AtlasSize, m_AtlasSize, layers, maxMipLevel, true));
+
+            for (int layer = 0; layer < layers; layer++)
+            {
+                std::fill(page.begin(), page.end(), static_cast<unsigned char>(0));
+                for (const stbrp_rect& rect : pages[firstPage + layer])
+                {
+                    const Image& image = m_Images[rect.id];
+                    CopyExtruded(image, rect.x, rect.y, rect.w, rect.h, page.data());
+                    m_Regions[rect.id] = { arrayIndex, layer, glm::vec4((rect.x + m_Padding) / size, (rect.y + m_Padding) / size,
+                                                                       image.width / size, image.height / size) };
+                }
+                m_Arrays.back()->SetLayer(layer, page.data());
+            }
+            m_Arrays.back()->GenerateMipmaps();
+        }
+    }
+
+    void TexturePacker::CopyExtruded(const Image& image, const int rectX, const int rectY, const int rectWidth, const int rectHeight,
+                                     unsigned char* page) const
+    {
+        for (int y = 0; y < rectHeight; y++)
+        {
+            const int sourceY = std::clamp(y - m_Padding, 0, image.height - 1);
+            const unsigned char* sourceRow = image.pixels.data() + static_cast<size_t>(sourceY) * image.width * 4;
+            unsigned char* destinationRow = page + (static_cast<size_t>(rectY + y) * m_AtlasSize + rectX) * 4;
+
+            for (int x = 0; x < rectWidth; x++)
+            {
+                const int sourceX = std::clamp(x - m_Padding, 0, image.width - 1);
+                std::memcpy(destinationRow + x * 4, sourceRow + sourceX * 4, 4);
+            }
+        }
+    }
+}  // namespace GLBasics
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GLM/glm.hpp>
+
+#include "TextureArray.h"
+
+namespace GLBasics
+{
+    /**
+     * \brief Where a packed image ended up. Sample it with
+     * texture(samplerArray, vec3(rect.xy + uv * rect.zw, layer))
+     */
+    struct TextureRegion
+    {
+        unsigned int arrayIndex;
+        int layer;
+        glm::vec4 rect;
+    };
+
+    /**
+     * \brief Packs many images into a few texture arrays so objects with different textures can be
+     * drawn without rebinding. Images of the same size become layers of one array, small images are
+     * bin-packed into atlas pages that are layers of another. Arrays with more layers than the
+     * driver allows are split
+     */
+    class TexturePacker
+    {
+    private:
+        struct Image
+        {
+            int width, height;
+            std::vector<unsigned char> pixels;
+        };
+
+        int m_AtlasSize;
+        int m_Padding;
+        int m_MaxAtlasImageSize;
+        int m_MaxLayers;
+
+        std::vector<Image> m_Images;
+        std::vector<TextureRegion> m_Regions;
+        std::vector<std::unique_ptr<TextureArray>> m_Arrays;
+
+    public:
+        /**
+         * \brief Constructs an empty packer
+         * \param atlasSize The width and height of an atlas page
+         * \param padding The texels of extruded border around every atlas image, rounded down to a power of two.
+         * Atlas pages only get mip levels up to log2(padding) so neighbours never bleed into each other
+         * \param maxAtlasImageSize Images with a side longer than this go into a same-size array instead of an atlas
+         */
+        TexturePacker(int atlasSize = 2048, int padding = 8, int maxAtlasImageSize = 256);
+
+        TexturePacker(const TexturePacker&) = delete;
+        TexturePacker& operator=(const TexturePacker&) = delete;
+
+        /**
+         * \brief Add an image from a file
+         * \param path A string that is the path to an image file
+         * \return The id to look the region up with after Build, or -1 if the file could not be loaded
+         */
+        int Add(const std::string& path);
+
+        /**
+         * \brief Add an image already in memory, the pixels are copied
+         * \param width The width of the image
+         * \param height The height of the image
+         * \param rgbaPixels Four bytes per texel, starting with the bottom row
+         * \return The id to look the region up with after Build
+         */
+        int Add(int width, int height, const unsigned char* rgbaPixels);
+
+        /**
+         * \brief Pack every image added so far into texture arrays and upload them.
+         * Previously built arrays are released and the pixels kept on the CPU are freed
+         */
+        void Build();
+
+        /**
+         * \brief Get where an image was packed, only valid after Build
+         * \param id The id returned by Add
+         * \return The region of the image
+         */
+        inline const TextureRegion& GetRegion(int id) const { return m_Regions[id]; }
+
+        /**
+         * \brief Get one of the built texture arrays
+         * \param index The arrayIndex of a region
+         * \return The texture array
+         */
+        inline const TextureArray& GetArray(unsigned int index) const { return *m_Arrays[index]; }
+
+        /**
+         * \brief Get the number of texture arrays, and so the number of binds needed to draw everything
+         * \return The number of texture arrays
+         */
+        inline unsigned int GetArrayCount() const { return static_cast<unsigned int>(m_Arrays.size()); }
+
+    private:
+        // Groups the large images by size, one array per size
+        void BuildSameSizeArrays(const std::vector<int>& ids);
+
+        // Bin-packs the small images into as many atlas pages as needed, in as few arrays as the layer limit allows
+        void BuildAtlas(const std::vector<int>& ids);
+
+        // Copies an image into the middle of its packed rectangle on an atlas page
+        // and repeats its edge texels out to the rectangle's border
+        void CopyExtruded(const Image& image, int rectX, int rectY, int rectWidth, int rectHeight, unsigned char* page) const;
+
+    };  // class TexturePacker
+}  // namespace GLBasics
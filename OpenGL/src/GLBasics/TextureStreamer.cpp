@@ -0,0 +1,332 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <GLM/glm.hpp>
+
+#include "TextureLoader.h"
+#include "../Utils/GLDebugHelper.h"
+#include "../Utils/MainUtils.h"
+#include "../Utils/ThreadPool.h"
+
+namespace GLBasics
+{
+    // mid grey, shown until the smallest levels are uploaded
+    constexpr unsigned char PLACEHOLDER_PIXEL[4] = { 128, 128, 128, 255 };
+
+    TextureStreamer::TextureStreamer(Utils::ThreadPool& threadPool, const size_t budgetBytes,
+                                     const size_t uploadBudgetBytes, const int tailSize)
+        : m_ThreadPool(threadPool), m_Budget(budgetBytes), m_UploadBudget(uploadBudgetBytes), m_TailSize(tailSize),
+          m_Frame(1), m_ResidentBytes(0), m_DecodesInFlight(0), m_Cancelled(false)
+    {
+    }
+
+    TextureStreamer::~TextureStreamer()
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Cancelled = true;
+        m_DecodeFinished.wait(lock, [this] { return m_DecodesInFlight == 0; });
+    }
+
+    void TextureStreamer::SetMipGeneration(const Utils::MipGenerator::Options& options, const std::string& cacheDirectory)
+    {
+        m_MipOptions = options;
+        m_MipCacheDirectory = cacheDirectory;
+    }
+
+    std::shared_ptr<Texture> TextureStreamer::Load(const std::string& path)
+    {
+        auto texture = std::make_shared<Texture>(1, 1, PLACEHOLDER_PIXEL);
+        // a texture freed since the last Update may have left its entry at the same address
+        Entry& entry = m_Entries[texture.get()];
+        m_ResidentBytes -= entry.residentBytes;
+        entry = Entry{};
+        entry.texture = texture;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_DecodesInFlight++;
+        }
+
+        std::weak_ptr<Texture> target = texture;
+        m_ThreadPool.Enqueue([this, path, target, mipOptions = m_MipOptions, cacheDirectory = m_MipCacheDirectory]
+        {
+            Decode(path, target, mipOptions, cacheDirectory);
+        });
+        return texture;
+    }
+
+    void TextureStreamer::RequestMip(const Texture& texture, const int level)
+    {
+        const auto found = m_Entries.find(&texture);
+        if (found == m_Entries.end())
+        {
+            return;
+        }
+
+        Entry& entry = found->second;
+        if (entry.lastRequestedFrame != m_Frame)
+        {
+            entry.lastRequestedFrame = m_Frame;
+            entry.wantedLevel = std::max(level, 0);
+        }
+        else
+        {
+            entry.wantedLevel = std::min(entry.wantedLevel, std::max(level, 0));
+        }
+    }
+
+    void TextureStreamer::RequestMip(const Texture& texture, const float objectRadius, const float distance)
+    {
+        const int textureSize = std::max(texture.GetWidth(), texture.GetHeight());
+        RequestMip(texture, EstimateRequiredMip(textureSize, objectRadius, distance, Utils::fieldOfView, Utils::windowHeight));
+    }
+
+    int TextureStreamer::EstimateRequiredMip(const int textureSize, const float objectRadius, const float distance,
+                                             const float fieldOfView, const int screenHeight)
+    {
+        // the camera is inside the object or the object covers the screen
+        if (distance <= objectRadius || screenHeight <= 0)
+        {
+            return 0;
+        }
+
+        const float screenSize = 2.0f * distance * std::tan(glm::radians(fieldOfView) * 0.5f);
+        const float pixels = 2.0f * objectRadius / screenSize * static_cast<float>(screenHeight);
+        if (pixels <= 1.0f)
+        {
+            return static_cast<int>(std::log2(static_cast<float>(std::max(textureSize, 1))));
+        }
+
+        const float texelsPerPixel = static_cast<float>(textureSize) / pixels;
+        return texelsPerPixel <= 1.0f ? 0 : static_cast<int>(std::floor(std::log2(texelsPerPixel)));
+    }
+
+    void TextureStreamer::Update()
+    {
+        int previousTexture = 0;
+        GLCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
+
+        // the texture's own destructor released its levels
+        for (auto entry = m_Entries.begin(); entry != m_Entries.end();)
+        {
+            if (entry->second.texture.expired())
+            {
+                m_ResidentBytes -= entry->second.residentBytes;
+                entry = m_Entries.erase(entry);
+            }
+            else
+            {
+                ++entry;
+            }
+        }
+
+        std::deque<DecodedImage> decoded;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            decoded.swap(m_Decoded);
+        }
+        for (DecodedImage& image : decoded)
+        {
+            const std::shared_ptr<Texture> texture = image.texture.lock();
+            const auto found = texture ? m_Entries.find(texture.get()) : m_Entries.end();
+            if (found != m_Entries.end())
+            {
+                Begin(found->second, *texture, image);
+            }
+        }
+
+        // the textures furthest from what they were asked for go first, one level at a time
+        std::vector<Entry*> candidates;
+        for (auto& [key, entry] : m_Entries)
+        {
+            if (entry.decoded && entry.lastRequestedFrame == m_Frame && entry.wantedLevel < entry.residentLevel)
+            {
+                candidates.push_back(&entry);
+            }
+        }
+
+        size_t uploadedBytes = 0;
+        while (!candidates.empty())
+        {
+            const auto neediest = std::max_element(candidates.begin(), candidates.end(), [](const Entry* a, const Entry* b)
+            {
+                return a->residentLevel - a->wantedLevel < b->residentLevel - b->wantedLevel;
+            });
+            Entry& entry = **neediest;
+
+            const size_t levelBytes = GetLevelSize(entry, entry.residentLevel - 1);
+            if (uploadedBytes > 0 && uploadedBytes + levelBytes > m_UploadBudget)
+            {
+                break;
+            }
+
+            const bool fits = MakeRoom(levelBytes, &entry);
+            if (fits)
+            {
+                UploadLevel(entry, *entry.texture.lock());
+                uploadedBytes += levelBytes;
+            }
+
+            if (!fits || entry.residentLevel <= entry.wantedLevel)
+            {
+                candidates.erase(neediest);
+            }
+        }
+
+        // the budget may have been lowered since the last frame
+        MakeRoom(0, nullptr);
+
+        GLCall(glBindTexture(GL_TEXTURE_2D, previousTexture));
+        m_Frame++;
+    }
+
+    unsigned int TextureStreamer::GetPendingCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_DecodesInFlight + static_cast<unsigned int>(m_Decoded.size());
+    }
+
+    void TextureStreamer::Decode(const std::string& path, const std::weak_ptr<Texture>& texture,
+                                 const Utils::MipGenerator::Options& mipOptions, const std::string& mipCacheDirectory)
+    {
+        DecodedImage image{ texture, {}, {} };
+        bool loaded = false;
+
+        bool cancelled;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            cancelled = m_Cancelled;
+        }
+
+        // nothing to do if the texture was released before its turn came
+        if (!cancelled && !texture.expired())
+        {
+            loaded = TextureLoader::DecodeFile(path, mipOptions, mipCacheDirectory, image.mips, image.compressed);
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (loaded)
+        {
+            m_Decoded.push_back(std::move(image));
+        }
+        m_DecodesInFlight--;
+        m_DecodeFinished.notify_all();
+    }
+
+    void TextureStreamer::Begin(Entry& entry, Texture& texture, DecodedImage& image)
+    {
+        if (image.mips.levels.empty() && !CompressedImage::IsFormatSupported(image.compressed.internalFormat))
+        {
+            std::cout << "ERROR::TEXTURE::COMPRESSED_FORMAT_NOT_SUPPORTED 0x" << std::hex << image.compressed.internalFormat << std::dec << std::endl;
+            return;
+        }
+
+        entry.mips = std::move(image.mips);
+        entry.compressed = std::move(image.compressed);
+        entry.decoded = true;
+
+        const bool compressed = entry.mips.levels.empty();
+        entry.levelCount = static_cast<int>(compressed ? entry.compressed.levels.size() : entry.mips.levels.size());
+        texture.m_Width = compressed ? entry.compressed.width : entry.mips.levels[0].width;
+        texture.m_Height = compressed ? entry.compressed.height : entry.mips.levels[0].height;
+        texture.m_BPP = compressed ? 0 : 4;
+
+        entry.tailLevel = entry.levelCount - 1;
+        while (entry.tailLevel > 0)
+        {
+            const int size = std::max(texture.m_Width >> (entry.tailLevel - 1), texture.m_Height >> (entry.tailLevel - 1));
+            if (size > m_TailSize)
+            {
+                break;
+            }
+            entry.tailLevel--;
+        }
+
+        // the placeholder's 1x1 image sits on level 0 until the real one is streamed in
+        entry.residentLevel = entry.levelCount;
+
+        GLCall(glBindTexture(GL_TEXTURE_2D, texture.m_RendererID));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, entry.levelCount - 1));
+        if (entry.tailLevel > 0)
+        {
+            GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+        }
+        while (entry.residentLevel > entry.tailLevel)
+        {
+            UploadLevel(entry, texture);
+        }
+    }
+
+    bool TextureStreamer::MakeRoom(const size_t bytes, const Entry* keep)
+    {
+        while (m_ResidentBytes + bytes > m_Budget)
+        {
+            // a level is fair game if its texture wasn't asked for this frame or it is finer than needed
+            Entry* victim = nullptr;
+            for (auto& [key, entry] : m_Entries)
+            {
+                const bool unused = entry.lastRequestedFrame != m_Frame || entry.residentLevel < entry.wantedLevel;
+                if (&entry != keep && entry.decoded && entry.residentLevel < entry.tailLevel && unused &&
+                    (!victim || entry.lastRequestedFrame < victim->lastRequestedFrame))
+                {
+                    victim = &entry;
+                }
+            }
+
+            if (!victim)
+            {
+                return false;
+            }
+            DropLevel(*victim);
+        }
+        return true;
+    }
+
+    void TextureStreamer::UploadLevel(Entry& entry, Texture& texture)
+    {
+        const int level = entry.residentLevel - 1;
+
+        GLCall(glBindTexture(GL_TEXTURE_2D, texture.m_RendererID));
+        if (entry.mips.levels.empty())
+        {
+            const CompressedImage::Level& mip = entry.compressed.levels[level];
+            GLCall(glCompressedTexImage2D(GL_TEXTURE_2D, level, entry.compressed.internalFormat, mip.width, mip.height, 0,
+                                          static_cast<int>(mip.size), entry.compressed.data.data() + mip.offset));
+        }
+        else
+        {
+            const Utils::MipChain::Level& mip = entry.mips.levels[level];
+            GLCall(glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, mip.width, mip.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                                entry.mips.pixels.data() + mip.offset));
+        }
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level));
+
+        entry.residentLevel = level;
+        entry.residentBytes += GetLevelSize(entry, level);
+        m_ResidentBytes += GetLevelSize(entry, level);
+    }
+
+    void TextureStreamer::DropLevel(Entry& entry)
+    {
+        const int level = entry.residentLevel;
+        const std::shared_ptr<Texture> texture = entry.texture.lock();
+
+        // Raise the base level before the image goes away so the texture is never incomplete. Levels
+        // outside BASE_LEVEL..MAX_LEVEL don't count for completeness, so an empty RGBA8 image frees a
+        // compressed level just as well
+        GLCall(glBindTexture(GL_TEXTURE_2D, texture->m_RendererID));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1));
+        GLCall(glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+
+        entry.residentLevel = level + 1;
+        entry.residentBytes -= GetLevelSize(entry, level);
+        m_ResidentBytes -= GetLevelSize(entry, level);
+    }
+
+    size_t TextureStreamer::GetLevelSize(const Entry& entry, const int level)
+    {
+        return entry.mips.levels.empty() ? entry.compressed.levels[level].size : entry.mips.GetLevelSize(level);
+    }
+}  // namespace GLBasics
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "CompressedImage.h"
+#include "Texture.h"
+#include "../Utils/MipGenerator.h"
+
+namespace Utils
+{
+    class ThreadPool;
+}
+
+namespace GLBasics
+{
+    /**
+     * \brief Keeps more texture data usable than fits in video memory. Only the smallest levels of a
+     * texture are uploaded at first, finer levels are streamed in as objects ask for them and the
+     * least recently asked for levels are dropped again whenever the budget is exceeded. The whole
+     * chain stays in system memory so dropped levels come back without touching the disk, and
+     * GL_TEXTURE_BASE_LEVEL is clamped to the finest level on the GPU so sampling never sees a hole
+     */
+    class TextureStreamer
+    {
+    private:
+        struct Entry
+        {
+            std::weak_ptr<Texture> texture;
+            bool decoded = false;
+            Utils::MipChain mips;  // empty when the image is compressed
+            CompressedImage compressed;
+
+            int levelCount = 0;
+            int tailLevel = 0;       // this level and the coarser ones are always resident
+            int residentLevel = 0;   // finest level on the GPU
+            int wantedLevel = 0;     // finest level asked for in lastRequestedFrame
+            uint64_t lastRequestedFrame = 0;
+            size_t residentBytes = 0;
+        };
+
+        struct DecodedImage
+        {
+            std::weak_ptr<Texture> texture;
+            Utils::MipChain mips;
+            CompressedImage compressed;
+        };
+
+        Utils::ThreadPool& m_ThreadPool;
+        size_t m_Budget;
+        size_t m_UploadBudget;
+        int m_TailSize;
+        Utils::MipGenerator::Options m_MipOptions;
+        std::string m_MipCacheDirectory;
+
+        uint64_t m_Frame;
+        size_t m_ResidentBytes;
+        std::unordered_map<const Texture*, Entry> m_Entries;
+
+        mutable std::mutex m_Mutex;
+        std::condition_variable m_DecodeFinished;
+        std::deque<DecodedImage> m_Decoded;
+        unsigned int m_DecodesInFlight;
+        bool m_Cancelled;
+
+    public:
+        /**
+         * \brief Constructs a streamer with nothing resident
+         * \param threadPool The workers the images are decoded on. Must outlive the streamer
+         * \param budgetBytes How much video memory the streamed textures may take together
+         * \param uploadBudgetBytes How many bytes Update may upload, one level is always allowed
+         * \param tailSize Levels whose larger side is at most this many texels are uploaded right away and never dropped
+         */
+        TextureStreamer(Utils::ThreadPool& threadPool, size_t budgetBytes = 256 * 1024 * 1024,
+                        size_t uploadBudgetBytes = 8 * 1024 * 1024, int tailSize = 64);
+
+        TextureStreamer(const TextureStreamer&) = delete;
+        TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+        /**
+         * \brief Waits for the decodes in flight
+         */
+        ~TextureStreamer();
+
+        /**
+         * \brief Set how the mip chains of the textures loaded from now on are built
+         * \param options How the levels are filtered
+         * \param cacheDirectory Where generated chains are kept between runs, empty to always generate them
+         */
+        void SetMipGeneration(const Utils::MipGenerator::Options& options, const std::string& cacheDirectory = "");
+
+        /**
+         * \brief Start streaming a texture. Returns right away with a 1x1 placeholder that
+         * receives the smallest levels of the image once it is decoded
+         * \param path A string that is the path to an image file, DDS and KTX2 files stay compressed
+         * \return The texture, which stops being streamed once nobody holds it
+         */
+        std::shared_ptr<Texture> Load(const std::string& path);
+
+        /**
+         * \brief Ask for a level of a streamed texture to be resident. Every object using the texture
+         * should ask once per frame, the finest level asked for wins
+         * \param texture A texture returned by Load
+         * \param level The finest level needed, 0 is the full size image
+         */
+        void RequestMip(const Texture& texture, int level);
+
+        /**
+         * \brief Ask for the level an object needs from how large it appears on screen
+         * \param texture A texture returned by Load
+         * \param objectRadius The radius of the object's bounding sphere in world units
+         * \param distance The distance from the camera to the object's centre
+         */
+        void RequestMip(const Texture& texture, float objectRadius, float distance);
+
+        /**
+         * \brief Estimate the finest level that is still seen, assuming the texture spans the object once
+         * \param textureSize The larger side of the texture's full size image
+         * \param objectRadius The radius of the object's bounding sphere in world units
+         * \param distance The distance from the camera to the object's centre
+         * \param fieldOfView The vertical field of view in degrees
+         * \param screenHeight The height of the viewport in pixels
+         * \return The level whose texels are about as large as the pixels covering the object
+         */
+        static int EstimateRequiredMip(int textureSize, float objectRadius, float distance, float fieldOfView, int screenHeight);
+
+        /**
+         * \brief Upload newly decoded textures and the levels asked for within the upload budget,
+         * dropping the least recently used levels to stay within the budget. Should be called once per frame
+         */
+        void Update();
+
+        /**
+         * \brief Change how much video memory the streamed textures may take, takes effect on the next Update
+         * \param budgetBytes The budget in bytes
+         */
+        inline void SetBudget(const size_t budgetBytes) { m_Budget = budgetBytes; }
+
+        /**
+         * \brief Get how much video memory the streamed textures may take
+         * \return The budget in bytes
+         */
+        inline size_t GetBudget() const { return m_Budget; }
+
+        /**
+         * \brief Get how much video memory the resident levels take
+         * \return The resident bytes
+         */
+        inline size_t GetResidentBytes() const { return m_ResidentBytes; }
+
+        /**
+         * \brief Get the number of textures being streamed
+         * \return The number of textures
+         */
+        inline unsigned int GetTextureCount() const { return static_cast<unsigned int>(m_Entries.size()); }
+
+        /**
+         * \brief Get the number of textures that are still decoding or waiting for their first upload
+         * \return The number of pending textures
+         */
+        unsigned int GetPendingCount() const;
+
+    private:
+        // Decodes one image on a worker thread and queues it for Update
+        void Decode(const std::string& path, const std::weak_ptr<Texture>& texture,
+                    const Utils::MipGenerator::Options& mipOptions, const std::string& mipCacheDirectory);
+
+        // Takes a decoded image and uploads its tail, the levels that are always resident
+        void Begin(Entry& entry, Texture& texture, DecodedImage& image);
+
+        // Drops least recently used levels of other textures until bytes more fit in the budget
+        bool MakeRoom(size_t bytes, const Entry* keep);
+
+        // Uploads the level above the finest resident one
+        void UploadLevel(Entry& entry, Texture& texture);
+
+        // Releases the finest resident level
+        void DropLevel(Entry& entry);
+
+        // Returns the bytes one level takes on the GPU
+        static size_t GetLevelSize(const Entry& entry, int level);
+
+    };  // class TextureStreamer
+}  // namespace GLBasics
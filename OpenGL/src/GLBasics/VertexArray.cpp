@@ -27,11 +27,18 @@ namespace GLBasics
         {
             const auto& element = elements[index];
 
-            GLCall(glVertexAttribPointer(index, element.count, element.type, element.normalized,
-                layout.GetStride(), (const void*)offset));
+            if (element.integer)
+            {
+                GLCall(glVertexAttribIPointer(index, element.count, element.type, layout.GetStride(), (const void*)offset));
+            }
+            else
+            {
+                GLCall(glVertexAttribPointer(index, element.count, element.type, element.normalized,
+                    layout.GetStride(), (const void*)offset));
+            }
             GLCall(glEnableVertexAttribArray(index));
 
-            offset += element.count * VertexBufferElement::GetTypeSize(element.type);
+            offset += element.GetSize();
         }
     }
 
@@ -47,11 +54,38 @@ namespace GLBasics
         {
             const auto& element = elements[index];
 
-            GLCall(glVertexAttribPointer(index, element.count, element.type, element.normalized,
-                layout.GetStride(), (const void*)offset));
+            if (element.integer)
+            {
+                GLCall(glVertexAttribIPointer(index, element.count, element.type, layout.GetStride(), (const void*)offset));
+            }
+            else
+            {
+                GLCall(glVertexAttribPointer(index, element.count, element.type, element.normalized,
+                    layout.GetStride(), (const void*)offset));
+            }
             GLCall(glEnableVertexAttribArray(index));
 
-            offset += element.count * VertexBufferElement::GetTypeSize(element.type);
+            offset += element.GetSize();
+        }
+    }
+
+    void VertexArray::SetAttributes(const VertexAttribute* attributes, const size_t count, const unsigned int stride, const unsigned int divisor,
+                                    const size_t baseOffset)
+    {
+        for (unsigned int index = 0; index < count; index++)
+        {
+            const VertexAttribute& attribute = attributes[index];
+            const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(baseOffset + attribute.offset));
+            if (attribute.integer)
+            {
+                GLCall(glVertexAttribIPointer(index, attribute.count, attribute.type, stride, offset));
+            }
+            else
+            {
+                GLCall(glVertexAttribPointer(index, attribute.count, attribute.type, attribute.normalized, stride, offset));
+            }
+            GLCall(glEnableVertexAttribArray(index));
+            GLCall(glVertexAttribDivisor(index, divisor));
         }
     }
 
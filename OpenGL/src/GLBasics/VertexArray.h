@@ -3,6 +3,7 @@
 #include "IndexBuffer.h"
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
+#include "VertexLayout.h"
 
 namespace GLBasics
 {
@@ -40,6 +41,43 @@ namespace GLBasics
          */
         void BindBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, const IndexBuffer& ib) const;
 
+        /**
+         * \brief Bind Vertexbuffer and its IndexBuffer to this VAO, with the attributes of a vertex
+         * struct's VertexTraits. The layout is checked at compile time and set up without allocating
+         * \tparam Vertex The struct the vb is an array of
+         * \param vb A VertexBuffer class object
+         * \param ib A IndexBuffer class object that corresponds to the vb passed in
+         */
+        template<typename Vertex>
+        void BindBuffer(const VertexBuffer& vb, const IndexBuffer& ib) const
+        {
+            static_assert(IsValidVertexLayout<Vertex>(), "vertex attributes must fit in the vertex, not overlap and be aligned to their components");
+            static_assert(sizeof(Vertex) <= 2048, "vertices can't be larger than the smallest GL_MAX_VERTEX_ATTRIB_STRIDE");
+
+            Bind();  // current VAO will automatically include all subsequent VBO and IBO bind
+            vb.Bind();
+            ib.Bind();
+            SetAttributes(VertexTraits<Vertex>::attributes.data(), VertexTraits<Vertex>::attributes.size(), sizeof(Vertex));
+        }
+
+        /**
+         * \brief Bind a buffer of per-instance data to this VAO, with the attributes of a struct's
+         * VertexTraits advancing once per instance instead of once per vertex
+         * \tparam Instance The struct the buffer is an array of
+         * \param buffer The name of the buffer, such as one of a ring the data is streamed through
+         * \param offset The byte the first instance starts at, to draw a range of the buffer
+         */
+        template<typename Instance>
+        void BindInstanceBuffer(const unsigned int buffer, const size_t offset = 0) const
+        {
+            static_assert(IsValidVertexLayout<Instance>(), "instance attributes must fit in the instance, not overlap and be aligned to their components");
+            static_assert(sizeof(Instance) <= 2048, "instances can't be larger than the smallest GL_MAX_VERTEX_ATTRIB_STRIDE");
+
+            Bind();
+            GLCall(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+            SetAttributes(VertexTraits<Instance>::attributes.data(), VertexTraits<Instance>::attributes.size(), sizeof(Instance), 1, offset);
+        }
+
         /**
          * \brief Bind this VAO
          */
@@ -50,5 +88,10 @@ namespace GLBasics
          */
         void UnBind() const;
 
+    private:
+        // Points attribute 0 and up at the bound VBO from baseOffset on, advancing every divisor instances or every vertex if 0
+        static void SetAttributes(const VertexAttribute* attributes, size_t count, unsigned int stride, unsigned int divisor = 0,
+                                  size_t baseOffset = 0);
+
     };  // class VertexArray
 }  // namespace GLBasics
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "VertexArrayCache.h"
+
+#include "../Utils/GLDebugHelper.h"
+#include "../Utils/Hash.h"
+
+namespace GLBasics
+{
+    VertexArrayCache::VertexArrayCache()
+        : m_Supported(GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding), m_BoundVertexArray(0),
+          m_VertexArrayBinds(0), m_BufferBinds(0), m_LastVertexArrayBinds(0), m_LastBufferBinds(0)
+    {
+    }
+
+    VertexArrayCache::~VertexArrayCache()
+    {
+        for (const Format& format : m_Formats)
+        {
+            GLCall(glDeleteVertexArrays(1, &format.vertexArray));
+        }
+    }
+
+    unsigned int VertexArrayCache::GetFormat(const VertexAttribute* attributes, const size_t count)
+    {
+        ASSERT(m_Supported);
+
+        // Field by field, the padding in VertexAttribute isn't guaranteed to be zero
+        uint64_t hash = Utils::HashFNV1a(&count, sizeof(count));
+        for (size_t i = 0; i < count; i++)
+        {
+            const unsigned int fields[] = { attributes[i].type, attributes[i].count, attributes[i].offset,
+                                            attributes[i].normalized, attributes[i].integer };
+            hash = Utils::HashFNV1a(fields, sizeof(fields), hash);
+        }
+        const auto candidates = m_FormatIndices.equal_range(hash);
+        for (auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+        {
+            if (IsSameFormat(m_Formats[candidate->second].attributes, attributes, count))
+            {
+                return candidate->second;
+            }
+        }
+
+        Format format;
+        format.attributes.assign(attributes, attributes + count);
+        GLCall(glGenVertexArrays(1, &format.vertexArray));
+        GLCall(glBindVertexArray(format.vertexArray));
+        m_BoundVertexArray = format.vertexArray;
+        for (unsigned int index = 0; index < count; index++)
+        {
+            const VertexAttribute& attribute = attributes[index];
+            if (attribute.integer)
+            {
+                GLCall(glVertexAttribIFormat(index, attribute.count, attribute.type, attribute.offset));
+            }
+            else
+            {
+                GLCall(glVertexAttribFormat(index, attribute.count, attribute.type, attribute.normalized, attribute.offset));
+            }
+            GLCall(glVertexAttribBinding(index, 0));
+            GLCall(glEnableVertexAttribArray(index));
+        }
+
+        const auto handle = static_cast<unsigned int>(m_Formats.size());
+        m_Formats.push_back(format);
+        m_FormatIndices.emplace(hash, handle);
+        return handle;
+    }
+
+    void VertexArrayCache::Bind(const unsigned int format, const VertexBuffer& vb, const unsigned int stride, const IndexBuffer& ib)
+    {
+        Bind(format, vb.GetRendererID(), stride, ib.GetRendererID());
+    }
+
+    void VertexArrayCache::Bind(const unsigned int format, const unsigned int vertexBuffer, const unsigned int stride, const unsigned int indexBuffer)
+    {
+        Format& bound = m_Formats[format];
+        if (m_BoundVertexArray != bound.vertexArray)
+        {
+            GLCall(glBindVertexArray(bound.vertexArray));
+            m_BoundVertexArray = bound.vertexArray;
+            m_VertexArrayBinds++;
+        }
+        // The buffer bindings are part of the VAO, so they are still there when it comes back
+        if (bound.vertexBuffer != vertexBuffer || bound.stride != stride)
+        {
+            GLCall(glBindVertexBuffer(0, vertexBuffer, 0, stride));
+            bound.vertexBuffer = vertexBuffer;
+            bound.stride = stride;
+            m_BufferBinds++;
+        }
+        if (bound.indexBuffer != indexBuffer)
+        {
+            GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
+            bound.indexBuffer = indexBuffer;
+        }
+    }
+
+    void VertexArrayCache::Release(const VertexBuffer& vb, const IndexBuffer& ib)
+    {
+        Release(vb.GetRendererID());
+        Release(ib.GetRendererID());
+    }
+
+    void VertexArrayCache::Release(const unsigned int buffer)
+    {
+        for (Format& format : m_Formats)
+        {
+            if (format.vertexBuffer == buffer)
+            {
+                format.vertexBuffer = 0;
+            }
+            if (format.indexBuffer == buffer)
+            {
+                format.indexBuffer = 0;
+            }
+        }
+    }
+
+    void VertexArrayCache::Invalidate()
+    {
+        GLCall(glBindVertexArray(0));
+        m_BoundVertexArray = 0;
+    }
+
+    void VertexArrayCache::Update()
+    {
+        Invalidate();
+        m_LastVertexArrayBinds = m_VertexArrayBinds;
+        m_LastBufferBinds = m_BufferBinds;
+        m_VertexArrayBinds = 0;
+        m_BufferBinds = 0;
+    }
+
+    bool VertexArrayCache::IsSameFormat(const std::vector<VertexAttribute>& known, const VertexAttribute* attributes, const size_t count)
+    {
+        if (known.size() != count)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            if (known[i].type != attributes[i].type || known[i].count != attributes[i].count || known[i].offset != attributes[i].offset ||
+                known[i].normalized != attributes[i].normalized || known[i].integer != attributes[i].integer)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}  // namespace GLBasics
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "IndexBuffer.h"
+#include "VertexBuffer.h"
+#include "VertexLayout.h"
+
+namespace GLBasics
+{
+    /**
+     * \brief Shares one VAO between every mesh with the same vertex format. The attribute formats are
+     * set once per VAO with glVertexAttribFormat and read from binding point 0, so switching meshes
+     * only rebinds the buffers and a frame binds a VAO once per format instead of once per object.
+     * Needs ARB_vertex_attrib_binding (OpenGL 4.3); without it IsSupported is false and meshes keep
+     * their own VAO
+     */
+    class VertexArrayCache
+    {
+    private:
+        struct Format
+        {
+            unsigned int vertexArray = 0;
+            unsigned int vertexBuffer = 0;  // bound to binding point 0 of vertexArray
+            unsigned int stride = 0;
+            unsigned int indexBuffer = 0;
+            std::vector<VertexAttribute> attributes;  // compared on a hash hit
+        };
+
+        bool m_Supported;
+        std::vector<Format> m_Formats;
+        std::unordered_multimap<uint64_t, unsigned int> m_FormatIndices;  // layout hash -> indices into m_Formats
+        unsigned int m_BoundVertexArray;
+
+        unsigned int m_VertexArrayBinds;
+        unsigned int m_BufferBinds;
+        unsigned int m_LastVertexArrayBinds;
+        unsigned int m_LastBufferBinds;
+
+    public:
+        /**
+         * \brief Constructs an empty cache, checking whether the driver supports it
+         */
+        VertexArrayCache();
+
+        VertexArrayCache(const VertexArrayCache&) = delete;
+        VertexArrayCache& operator=(const VertexArrayCache&) = delete;
+
+        /**
+         * \brief Deletes every shared VAO
+         */
+        ~VertexArrayCache();
+
+        /**
+         * \brief Whether VAOs can be shared on this driver
+         * \return true if ARB_vertex_attrib_binding is available; false otherwise
+         */
+        inline bool IsSupported() const { return m_Supported; }
+
+        /**
+         * \brief Get the format of a vertex struct, creating its VAO the first time
+         * \tparam Vertex A struct with VertexTraits
+         * \return A handle to pass to Bind
+         */
+        template<typename Vertex>
+        unsigned int GetFormat()
+        {
+            static_assert(IsValidVertexLayout<Vertex>(), "vertex attributes must fit in the vertex, not overlap and be aligned to their components");
+            return GetFormat(VertexTraits<Vertex>::attributes.data(), VertexTraits<Vertex>::attributes.size());
+        }
+
+        /**
+         * \brief Get the format of a list of attributes, creating its VAO the first time
+         * \param attributes The attributes in the order of their locations
+         * \param count The number of attributes
+         * \return A handle to pass to Bind
+         */
+        unsigned int GetFormat(const VertexAttribute* attributes, size_t count);
+
+        /**
+         * \brief Bind the VAO of a format with a mesh's buffers, skipping whatever is already bound
+         * \param format A handle from GetFormat
+         * \param vb The vertices
+         * \param stride The size of one vertex
+         * \param ib The indices
+         */
+        void Bind(unsigned int format, const VertexBuffer& vb, unsigned int stride, const IndexBuffer& ib);
+
+        /**
+         * \brief Bind the VAO of a format with buffers given by name, such as the arenas of a MeshBufferPool
+         * \param format A handle from GetFormat
+         * \param vertexBuffer The name of the buffer holding the vertices
+         * \param stride The size of one vertex
+         * \param indexBuffer The name of the buffer holding the indices
+         */
+        void Bind(unsigned int format, unsigned int vertexBuffer, unsigned int stride, unsigned int indexBuffer);
+
+        /**
+         * \brief Forget a mesh's buffers, must be called before they are deleted since a new buffer may
+         * get the same name while a VAO still holds the old one
+         * \param vb The vertices
+         * \param ib The indices
+         */
+        void Release(const VertexBuffer& vb, const IndexBuffer& ib);
+
+        /**
+         * \brief Forget a buffer given by name, must be called before it is deleted
+         * \param buffer The name of a vertex or index buffer
+         */
+        void Release(unsigned int buffer);
+
+        /**
+         * \brief Unbind the shared VAOs, so creating a buffer can't change their index buffer. Must be
+         * called before buffers are created or other VAOs are used after Bind
+         */
+        void Invalidate();
+
+        /**
+         * \brief Invalidate and start counting the binds of a new frame. Should be called once per frame after drawing
+         */
+        void Update();
+
+        /**
+         * \brief Get the number of formats, which is the number of shared VAOs
+         * \return The number of formats
+         */
+        inline unsigned int GetFormatCount() const { return static_cast<unsigned int>(m_Formats.size()); }
+
+        /**
+         * \brief Get the number of times a VAO was bound during the last frame
+         * \return The number of binds
+         */
+        inline unsigned int GetVertexArrayBinds() const { return m_LastVertexArrayBinds; }
+
+        /**
+         * \brief Get the number of times a vertex buffer was bound during the last frame
+         * \return The number of binds
+         */
+        inline unsigned int GetBufferBinds() const { return m_LastBufferBinds; }
+
+    private:
+        // Compares the fields that make up a vertex format, the padding and size don't matter
+        static bool IsSameFormat(const std::vector<VertexAttribute>& known, const VertexAttribute* attributes, size_t count);
+
+    };  // class VertexArrayCache
+}  // namespace GLBasics
@@ -24,6 +24,12 @@ namespace GLBasics
          */
         ~VertexBuffer();
 
+        /**
+         * \brief Get the OpenGL name of the buffer
+         * \return The buffer name
+         */
+        inline unsigned int GetRendererID() const { return m_RendererID; }
+
         /**
          * \brief Bind the buffer stored in this VBO
          */
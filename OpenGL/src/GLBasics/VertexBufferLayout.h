@@ -2,6 +2,7 @@
 
 #include <vector>
 
+#include "../Maths/Half.h"
 #include "../Utils/GLDebugHelper.h"
 
 namespace GLBasics
@@ -15,11 +16,12 @@ namespace GLBasics
 	    unsigned int type;
 	    unsigned int count;
 	    unsigned int normalized;  // (boolean but int for memory alignment)
+	    unsigned int integer;     // read as integers by the shader through glVertexAttribIPointer
 
         /**
 	     * \brief Get the type size from a GL type
-	     * \param type An OpenGL type that is one of GL_FLOAT, GL_UNSIGNED_INT, and GL_UNSIGNED_BYTE 
-	     * \return An unsigned integer that is the size of the OpenGL type 
+	     * \param type An OpenGL type such as GL_FLOAT, GL_HALF_FLOAT, GL_SHORT or GL_UNSIGNED_BYTE
+	     * \return An unsigned integer that is the size of the OpenGL type, packed types are counted whole
 	     */
 	    static unsigned int GetTypeSize(unsigned int type)
         {
@@ -27,11 +29,28 @@ namespace GLBasics
 	        {
 		        case GL_FLOAT:			return sizeof(GLfloat);
 		        case GL_UNSIGNED_INT:	return sizeof(GLuint);
+		        case GL_INT:			return sizeof(GLint);
+		        case GL_HALF_FLOAT:		return sizeof(GLhalf);
+		        case GL_UNSIGNED_SHORT:	return sizeof(GLushort);
+		        case GL_SHORT:			return sizeof(GLshort);
 		        case GL_UNSIGNED_BYTE:	return sizeof(GLubyte);
+		        case GL_BYTE:			return sizeof(GLbyte);
+		        case GL_INT_2_10_10_10_REV:
+		        case GL_UNSIGNED_INT_2_10_10_10_REV:	return sizeof(GLuint);
                 default:                ASSERT(false);  // other types are unsupported;
             }
 		    return 0;
 	    }
+
+        /**
+	     * \brief Get the bytes this property takes in a vertex
+	     * \return The size of all its components
+	     */
+	    unsigned int GetSize() const
+        {
+		    const bool packed = type == GL_INT_2_10_10_10_REV || type == GL_UNSIGNED_INT_2_10_10_10_REV;
+		    return packed ? GetTypeSize(type) : count * GetTypeSize(type);
+	    }
     };  // struct VertexBufferElement
 
     /**
@@ -62,7 +81,7 @@ namespace GLBasics
 		template<>
 		void Push<float>(unsigned int count)
 	    {
-			m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
+			m_Elements.push_back({ GL_FLOAT, count, GL_FALSE, GL_FALSE });
 			m_Stride += count * VertexBufferElement::GetTypeSize(GL_FLOAT);
 		}
 
@@ -73,7 +92,7 @@ namespace GLBasics
 		template<>
 		void Push<unsigned int>(unsigned int count)
 	    {
-			m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
+			m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE, GL_FALSE });
 			m_Stride += count * VertexBufferElement::GetTypeSize(GL_UNSIGNED_INT);
 		}
 
@@ -84,10 +103,115 @@ namespace GLBasics
 		template<>
 		void Push<unsigned char>(unsigned int count)
 	    {
-			m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
+			m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE, GL_FALSE });
+			m_Stride += count * VertexBufferElement::GetTypeSize(GL_UNSIGNED_BYTE);
+		}
+
+		/**
+		 * \brief Add a new property to a layout with the type half float
+		 * \param count The number of halves
+		 */
+		template<>
+		void Push<Maths::Half>(unsigned int count)
+	    {
+			m_Elements.push_back({ GL_HALF_FLOAT, count, GL_FALSE, GL_FALSE });
+			m_Stride += count * VertexBufferElement::GetTypeSize(GL_HALF_FLOAT);
+		}
+
+		/**
+		 * \brief Add a new property to a layout with the type unsigned short, read as unorm16 in [0, 1]
+		 * \param count The number of unsigned shorts
+		 */
+		template<>
+		void Push<unsigned short>(unsigned int count)
+	    {
+			m_Elements.push_back({ GL_UNSIGNED_SHORT, count, GL_TRUE, GL_FALSE });
+			m_Stride += count * VertexBufferElement::GetTypeSize(GL_UNSIGNED_SHORT);
+		}
+
+		/**
+		 * \brief Add a new property to a layout with the type short, read as snorm16 in [-1, 1]
+		 * \param count The number of shorts
+		 */
+		template<>
+		void Push<short>(unsigned int count)
+	    {
+			m_Elements.push_back({ GL_SHORT, count, GL_TRUE, GL_FALSE });
+			m_Stride += count * VertexBufferElement::GetTypeSize(GL_SHORT);
+		}
+
+		/**
+		 * \brief Add a new property to a layout with the type signed char, read as snorm8 in [-1, 1]
+		 * \param count The number of signed chars
+		 */
+		template<>
+		void Push<signed char>(unsigned int count)
+	    {
+			m_Elements.push_back({ GL_BYTE, count, GL_TRUE, GL_FALSE });
+			m_Stride += count * VertexBufferElement::GetTypeSize(GL_BYTE);
+		}
+
+		/**
+		 * \brief Add a new property of four components packed into 32 bits, 10 bits each for xyz and 2 for w
+		 * \param isSigned true for GL_INT_2_10_10_10_REV read in [-1, 1]; false for the unsigned type read in [0, 1]
+		 */
+		void PushPacked2101010(const bool isSigned = true)
+	    {
+			const unsigned int type = isSigned ? GL_INT_2_10_10_10_REV : GL_UNSIGNED_INT_2_10_10_10_REV;
+			m_Elements.push_back({ type, 4, GL_TRUE, GL_FALSE });
+			m_Stride += VertexBufferElement::GetTypeSize(type);
+		}
+
+		template<typename T>
+		void PushInteger(unsigned int count)
+	    {
+			ASSERT(false);  // other types unsupported
+		}
+
+		/**
+		 * \brief Add a new property the shader reads as unsigned integers, such as indices or bit flags
+		 * \param count The number of unsigned ints
+		 */
+		template<>
+		void PushInteger<unsigned int>(unsigned int count)
+	    {
+			m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE, GL_TRUE });
+			m_Stride += count * VertexBufferElement::GetTypeSize(GL_UNSIGNED_INT);
+		}
+
+		/**
+		 * \brief Add a new property the shader reads as unsigned integers, stored in 16 bits each
+		 * \param count The number of unsigned shorts
+		 */
+		template<>
+		void PushInteger<unsigned short>(unsigned int count)
+	    {
+			m_Elements.push_back({ GL_UNSIGNED_SHORT, count, GL_FALSE, GL_TRUE });
+			m_Stride += count * VertexBufferElement::GetTypeSize(GL_UNSIGNED_SHORT);
+		}
+
+		/**
+		 * \brief Add a new property the shader reads as unsigned integers, stored in 8 bits each
+		 * \param count The number of unsigned chars
+		 */
+		template<>
+		void PushInteger<unsigned char>(unsigned int count)
+	    {
+			m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_FALSE, GL_TRUE });
 			m_Stride += count * VertexBufferElement::GetTypeSize(GL_UNSIGNED_BYTE);
 		}
 
+		/**
+		 * \brief Add a new property the shader reads as signed integers
+		 * \param count The number of ints
+		 */
+		template<>
+		void PushInteger<int>(unsigned int count)
+	    {
+			m_Elements.push_back({ GL_INT, count, GL_FALSE, GL_TRUE });
+			m_Stride += count * VertexBufferElement::GetTypeSize(GL_INT);
+		}
+
         /**
 		 * \brief Get the stride of all the properties added
 		 * \return An unsigned int representing the stride
@@ -98,7 +222,7 @@ namespace GLBasics
 		 * \brief Get all the properties added in this layout if needed
 		 * \return A vector of all the elements stored as VertexBufferElement
 		 */
-		inline std::vector<VertexBufferElement> GetElements() const
+		inline const std::vector<VertexBufferElement>& GetElements() const
 	    {
 			return m_Elements;
 		}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <GLM/glm.hpp>
+
+#include "../Maths/Half.h"
+#include "../Utils/GLDebugHelper.h"
+
+namespace GLBasics
+{
+    /**
+     * \brief How the shader reads an attribute
+     */
+    enum class AttributeRead
+    {
+        Float,       // as stored, floats and halves only
+        Normalized,  // integers mapped to [0, 1], or [-1, 1] when signed
+        Integer      // integers passed on as ints or uints, through glVertexAttribIPointer
+    };
+
+    /**
+     * \brief Four components packed into 32 bits, 10 each for xyz and 2 for w, read normalized to [-1, 1]
+     */
+    struct PackedSnorm2101010
+    {
+        uint32_t bits;
+    };
+
+    /**
+     * \brief Everything glVertexAttribPointer needs to know about one attribute
+     */
+    struct VertexAttribute
+    {
+        unsigned int type;
+        unsigned int count;
+        unsigned int offset;
+        bool normalized;
+        bool integer;
+        unsigned int size;  // bytes in the vertex
+    };
+
+    /**
+     * \brief Describes the attributes of a vertex struct, in the order of their locations. Specialize
+     * it next to the struct with a static constexpr std::array<VertexAttribute, N> named attributes,
+     * built with VERTEX_ATTRIBUTE
+     */
+    template<typename Vertex>
+    struct VertexTraits;
+
+    namespace Detail
+    {
+        template<typename T> struct ComponentType { static constexpr unsigned int value = 0; };
+        template<> struct ComponentType<float> { static constexpr unsigned int value = GL_FLOAT; };
+        template<> struct ComponentType<Maths::Half> { static constexpr unsigned int value = GL_HALF_FLOAT; };
+        template<> struct ComponentType<uint32_t> { static constexpr unsigned int value = GL_UNSIGNED_INT; };
+        template<> struct ComponentType<int32_t> { static constexpr unsigned int value = GL_INT; };
+        template<> struct ComponentType<uint16_t> { static constexpr unsigned int value = GL_UNSIGNED_SHORT; };
+        template<> struct ComponentType<int16_t> { static constexpr unsigned int value = GL_SHORT; };
+        template<> struct ComponentType<uint8_t> { static constexpr unsigned int value = GL_UNSIGNED_BYTE; };
+        template<> struct ComponentType<int8_t> { static constexpr unsigned int value = GL_BYTE; };
+        template<> struct ComponentType<PackedSnorm2101010> { static constexpr unsigned int value = GL_INT_2_10_10_10_REV; };
+
+        // Splits a member type into its component type and count
+        template<typename T> struct MemberType { using Component = T; static constexpr unsigned int count = 1; };
+        template<typename T, size_t N> struct MemberType<T[N]> { using Component = T; static constexpr unsigned int count = N; };
+        template<glm::length_t L, typename T, glm::qualifier Q> struct MemberType<glm::vec<L, T, Q>> { using Component = T; static constexpr unsigned int count = L; };
+        template<> struct MemberType<PackedSnorm2101010> { using Component = PackedSnorm2101010; static constexpr unsigned int count = 4; };
+    }  // namespace Detail
+
+    /**
+     * \brief Describe one member of a vertex struct, use VERTEX_ATTRIBUTE rather than calling this
+     * \tparam Member The member's type, a scalar, an array of up to four scalars, a glm vector or PackedSnorm2101010
+     * \tparam Read How the shader reads it
+     * \param offset offsetof the member
+     * \return The attribute
+     */
+    template<typename Member, AttributeRead Read>
+    constexpr VertexAttribute MakeVertexAttribute(const size_t offset)
+    {
+        using Component = typename Detail::MemberType<Member>::Component;
+        constexpr unsigned int type = Detail::ComponentType<Component>::value;
+        constexpr unsigned int count = Detail::MemberType<Member>::count;
+        constexpr bool isFloat = type == GL_FLOAT || type == GL_HALF_FLOAT;
+        constexpr bool isPacked = type == GL_INT_2_10_10_10_REV;
+
+        static_assert(type != 0, "vertex attributes must be made of floats, halves, 8, 16 or 32-bit integers or PackedSnorm2101010");
+        static_assert(count >= 1 && count <= 4, "vertex attributes have one to four components");
+        static_assert(Read != AttributeRead::Float || isFloat, "integer components must be read Normalized or as Integer");
+        static_assert(Read != AttributeRead::Normalized || !isFloat, "float components can't be normalized");
+        static_assert(Read != AttributeRead::Integer || (!isFloat && !isPacked), "only plain integers can be read as Integer");
+
+        return { type, count, static_cast<unsigned int>(offset), Read == AttributeRead::Normalized, Read == AttributeRead::Integer,
+                 static_cast<unsigned int>(sizeof(Member)) };
+    }
+
+    /**
+     * \brief Check at compile time that the attributes of a vertex fit in it, don't overlap and are
+     * aligned to their components, as glVertexAttribPointer expects
+     * \tparam Vertex A struct with VertexTraits
+     * \return true if the layout is valid; false otherwise
+     */
+    template<typename Vertex>
+    constexpr bool IsValidVertexLayout()
+    {
+        const auto& attributes = VertexTraits<Vertex>::attributes;
+        for (size_t i = 0; i < attributes.size(); i++)
+        {
+            const VertexAttribute& a = attributes[i];
+            const unsigned int alignment = a.type == GL_FLOAT || a.type == GL_INT || a.type == GL_UNSIGNED_INT || a.type == GL_INT_2_10_10_10_REV ? 4
+                                         : a.type == GL_HALF_FLOAT || a.type == GL_SHORT || a.type == GL_UNSIGNED_SHORT ? 2 : 1;
+            if (a.offset % alignment != 0 || a.offset + a.size > sizeof(Vertex))
+            {
+                return false;
+            }
+            for (size_t j = 0; j < i; j++)
+            {
+                const VertexAttribute& b = attributes[j];
+                if (a.offset < b.offset + b.size && b.offset < a.offset + a.size)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}  // namespace GLBasics
+
+/**
+ * \brief Describe a member of a vertex struct for its VertexTraits
+ * \param Vertex The struct
+ * \param member The member's name
+ * \param read Float, Normalized or Integer, see AttributeRead
+ */
+#define VERTEX_ATTRIBUTE(Vertex, member, read) \
+    ::GLBasics::MakeVertexAttribute<decltype(Vertex::member), ::GLBasics::AttributeRead::read>(offsetof(Vertex, member))
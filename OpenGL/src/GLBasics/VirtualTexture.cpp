@@ -0,0 +1,352 @@
+#include "VirtualTexture.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "Shader.h"
+#include "../Utils/GLDebugHelper.h"
+#include "../Utils/ThreadPool.h"
+
+namespace GLBasics
+{
+    namespace
+    {
+        constexpr uint32_t NO_PAGE = std::numeric_limits<uint32_t>::max();
+        constexpr uint64_t PINNED = std::numeric_limits<uint64_t>::max();
+
+        // pages are packed into 32 bits and cache slots into 8 bits per axis of the indirection texels
+        constexpr int MAX_PAGES_PER_SIDE = 4096;
+        constexpr int MAX_CACHE_PAGES_PER_SIDE = 256;
+
+        int GetLevel(const uint32_t page) { return static_cast<int>(page >> 24); }
+        int GetX(const uint32_t page) { return static_cast<int>(page & 0xFFF); }
+        int GetY(const uint32_t page) { return static_cast<int>(page >> 12 & 0xFFF); }
+    }  // namespace
+
+    VirtualTexture::VirtualTexture(Utils::ThreadPool& threadPool, const std::string& path, const int cachePagesPerSide, const unsigned int uploadsPerFrame)
+        : m_ThreadPool(threadPool), m_CacheID(0), m_IndirectionID(0), m_CachePagesPerSide(0), m_UploadsPerFrame(uploadsPerFrame),
+          m_FeedbackID(0), m_Frame(1), m_LoadsInFlight(0), m_Cancelled(false)
+    {
+        if (!VirtualTextureFile::Open(path, m_File))
+        {
+            return;
+        }
+        if (m_File.pagesPerSide > MAX_PAGES_PER_SIDE)
+        {
+            std::cout << "ERROR::VIRTUAL_TEXTURE::TOO_MANY_PAGES " << path << ": " << m_File.pagesPerSide << " per side" << std::endl;
+            m_File.levelCount = 0;
+            return;
+        }
+
+        int maxTextureSize = 0;
+        GLCall(glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize));
+        if (m_File.GetSlotSize() > maxTextureSize)
+        {
+            std::cout << "ERROR::VIRTUAL_TEXTURE::PAGE_TOO_LARGE " << path << ": " << m_File.GetSlotSize() << " texels" << std::endl;
+            m_File.levelCount = 0;
+            return;
+        }
+        m_CachePagesPerSide = std::max(1, std::min({ cachePagesPerSide, MAX_CACHE_PAGES_PER_SIDE, maxTextureSize / m_File.GetSlotSize() }));
+        m_Slots.assign(static_cast<size_t>(m_CachePagesPerSide) * m_CachePagesPerSide, { NO_PAGE, 0 });
+
+        int previousTexture = 0;
+        GLCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
+
+        // the borders make filtering within a page correct, so the cache needs no mips
+        const int cacheSize = m_CachePagesPerSide * m_File.GetSlotSize();
+        GLCall(glGenTextures(1, &m_CacheID));
+        GLCall(glBindTexture(GL_TEXTURE_2D, m_CacheID));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+        GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, cacheSize, cacheSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+
+        GLCall(glGenTextures(1, &m_IndirectionID));
+        GLCall(glBindTexture(GL_TEXTURE_2D, m_IndirectionID));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_File.levelCount - 1));
+        m_Indirection.resize(m_File.levelCount);
+        for (int level = 0; level < m_File.levelCount; level++)
+        {
+            const int pages = m_File.GetPagesPerSide(level);
+            m_Indirection[level].resize(static_cast<size_t>(pages) * pages);
+            GLCall(glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, pages, pages, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+        }
+
+        // the single page of the coarsest level is what everything falls back to
+        LoadedPage root{ PackPage(m_File.levelCount - 1, 0, 0), std::vector<unsigned char>(m_File.GetPageBytes()) };
+        if (!m_File.ReadPage(m_File.levelCount - 1, 0, 0, root.pixels.data()))
+        {
+            std::cout << "ERROR::VIRTUAL_TEXTURE::PAGE_NOT_READ " << path << std::endl;
+        }
+        UploadPage(root);
+        m_Slots[m_PageTable[root.page]].lastUsedFrame = PINNED;
+        UpdateIndirection();
+
+        GLCall(glBindTexture(GL_TEXTURE_2D, previousTexture));
+    }
+
+    VirtualTexture::~VirtualTexture()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Cancelled = true;
+            m_LoadFinished.wait(lock, [this] { return m_LoadsInFlight == 0; });
+        }
+
+        GLCall(glDeleteTextures(1, &m_CacheID));
+        GLCall(glDeleteTextures(1, &m_IndirectionID));
+    }
+
+    void VirtualTexture::RequestPage(const int level, const int x, const int y)
+    {
+        if (!IsValid() || level < 0 || level >= m_File.levelCount)
+        {
+            return;
+        }
+
+        // the coarser pages are touched too so the fallbacks of pages in use are evicted last
+        for (int parent = level; parent < m_File.levelCount; parent++)
+        {
+            const int shift = parent - level;
+            const int pages = m_File.GetPagesPerSide(parent);
+            const uint32_t page = PackPage(parent, std::min(x >> shift, pages - 1), std::min(y >> shift, pages - 1));
+
+            const auto resident = m_PageTable.find(page);
+            if (resident == m_PageTable.end())
+            {
+                m_Requested.insert(page);
+            }
+            else if (m_Slots[resident->second].lastUsedFrame != PINNED)
+            {
+                m_Slots[resident->second].lastUsedFrame = m_Frame;
+            }
+        }
+    }
+
+    void VirtualTexture::Update()
+    {
+        if (!IsValid())
+        {
+            return;
+        }
+
+        int previousTexture = 0;
+        GLCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
+
+        for (unsigned int uploads = 0; uploads < m_UploadsPerFrame; uploads++)
+        {
+            LoadedPage page;
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (m_Loaded.empty())
+                {
+                    break;
+                }
+                page = std::move(m_Loaded.front());
+                m_Loaded.pop_front();
+            }
+
+            // when every slot holds a page in use this frame the page waits for the next one
+            if (!UploadPage(page))
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Loaded.push_front(std::move(page));
+                break;
+            }
+            m_Loading.erase(page.page);
+        }
+
+        // coarse pages first, they stand in for the most finer ones while those are on their way
+        std::vector<uint32_t> missing;
+        for (const uint32_t page : m_Requested)
+        {
+            if (m_Loading.find(page) == m_Loading.end())
+            {
+                missing.push_back(page);
+            }
+        }
+        std::sort(missing.begin(), missing.end(), [](const uint32_t a, const uint32_t b) { return GetLevel(a) > GetLevel(b); });
+        m_Requested.clear();
+
+        // a few frames of uploads in flight at most, the feedback is stale by then anyway
+        const size_t maxLoading = static_cast<size_t>(m_UploadsPerFrame) * 4;
+        for (const uint32_t page : missing)
+        {
+            if (m_Loading.size() >= maxLoading)
+            {
+                break;
+            }
+            m_Loading.insert(page);
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_LoadsInFlight++;
+            }
+            m_ThreadPool.Enqueue([this, page] { LoadPage(page); });
+        }
+
+        if (!m_ChangedPages.empty())
+        {
+            UpdateIndirection();
+        }
+
+        GLCall(glBindTexture(GL_TEXTURE_2D, previousTexture));
+        m_Frame++;
+    }
+
+    void VirtualTexture::Bind(const unsigned int cacheSlot, const unsigned int indirectionSlot) const
+    {
+        GLCall(glActiveTexture(GL_TEXTURE0 + cacheSlot));
+        GLCall(glBindTexture(GL_TEXTURE_2D, m_CacheID));
+        GLCall(glActiveTexture(GL_TEXTURE0 + indirectionSlot));
+        GLCall(glBindTexture(GL_TEXTURE_2D, m_IndirectionID));
+    }
+
+    void VirtualTexture::SetUniforms(const Shader& shader, const unsigned int cacheSlot, const unsigned int indirectionSlot, const float mipBias) const
+    {
+        const float cacheSize = static_cast<float>(m_CachePagesPerSide * m_File.GetSlotSize());
+        shader.SetUniform1i("vtCache", static_cast<int>(cacheSlot));
+        shader.SetUniform1i("vtIndirection", static_cast<int>(indirectionSlot));
+        shader.SetUniform4f("vtInfo", static_cast<float>(m_File.pagesPerSide), static_cast<float>(m_File.levelCount),
+                            static_cast<float>(m_File.pageSize), static_cast<float>(m_FeedbackID));
+        shader.SetUniform4f("vtCacheInfo", m_File.GetSlotSize() / cacheSize, m_File.border / cacheSize, m_File.pageSize / cacheSize, mipBias);
+    }
+
+    size_t VirtualTexture::GetMemoryBytes() const
+    {
+        size_t bytes = m_Slots.size() * m_File.GetPageBytes();
+        for (const std::vector<uint32_t>& level : m_Indirection)
+        {
+            bytes += level.size() * sizeof(uint32_t);
+        }
+        return bytes;
+    }
+
+    void VirtualTexture::LoadPage(const uint32_t page)
+    {
+        LoadedPage loaded{ page, {} };
+        bool read = false;
+
+        bool cancelled;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            cancelled = m_Cancelled;
+        }
+        if (!cancelled)
+        {
+            loaded.pixels.resize(m_File.GetPageBytes());
+            read = m_File.ReadPage(GetLevel(page), GetX(page), GetY(page), loaded.pixels.data());
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!read)
+        {
+            loaded.pixels.clear();  // still queued so Update forgets it is loading
+        }
+        m_Loaded.push_back(std::move(loaded));
+        m_LoadsInFlight--;
+        m_LoadFinished.notify_all();
+    }
+
+    bool VirtualTexture::UploadPage(const LoadedPage& page)
+    {
+        if (page.pixels.empty() || m_PageTable.find(page.page) != m_PageTable.end())
+        {
+            return true;
+        }
+
+        // a free slot if there is one, otherwise the one that has gone unused the longest
+        unsigned int slot = 0;
+        for (unsigned int i = 1; i < m_Slots.size() && m_Slots[slot].page != NO_PAGE; i++)
+        {
+            if (m_Slots[i].page == NO_PAGE || m_Slots[i].lastUsedFrame < m_Slots[slot].lastUsedFrame)
+            {
+                slot = i;
+            }
+        }
+        if (m_Slots[slot].page != NO_PAGE && m_Slots[slot].lastUsedFrame >= m_Frame)
+        {
+            return false;
+        }
+
+        if (m_Slots[slot].page != NO_PAGE)
+        {
+            m_PageTable.erase(m_Slots[slot].page);
+            m_ChangedPages.insert(m_Slots[slot].page);
+        }
+        m_Slots[slot] = { page.page, m_Frame };
+        m_PageTable[page.page] = slot;
+        m_ChangedPages.insert(page.page);
+
+        const int slotSize = m_File.GetSlotSize();
+        const int slotX = static_cast<int>(slot) % m_CachePagesPerSide, slotY = static_cast<int>(slot) / m_CachePagesPerSide;
+        GLCall(glBindTexture(GL_TEXTURE_2D, m_CacheID));
+        GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, slotX * slotSize, slotY * slotSize, slotSize, slotSize, GL_RGBA, GL_UNSIGNED_BYTE, page.pixels.data()));
+        return true;
+    }
+
+    void VirtualTexture::UpdateIndirection()
+    {
+        GLCall(glBindTexture(GL_TEXTURE_2D, m_IndirectionID));
+        for (const uint32_t page : m_ChangedPages)
+        {
+            // the texels under a page are rebuilt with those of a changed page covering it
+            const int pageLevel = GetLevel(page);
+            bool covered = false;
+            for (int parent = pageLevel + 1; parent < m_File.levelCount && !covered; parent++)
+            {
+                const int shift = parent - pageLevel;
+                covered = m_ChangedPages.find(PackPage(parent, GetX(page) >> shift, GetY(page) >> shift)) != m_ChangedPages.end();
+            }
+            if (covered)
+            {
+                continue;
+            }
+
+            // the page sizes are powers of two, so a page covers a whole square of texels on every finer level
+            for (int level = pageLevel; level >= 0; level--)
+            {
+                const int shift = pageLevel - level;
+                UpdateIndirectionRect(level, GetX(page) << shift, GetY(page) << shift, 1 << shift);
+            }
+        }
+        m_ChangedPages.clear();
+    }
+
+    void VirtualTexture::UpdateIndirectionRect(const int level, const int left, const int bottom, const int size)
+    {
+        const int pages = m_File.GetPagesPerSide(level);
+        const int parentPages = level + 1 < m_File.levelCount ? m_File.GetPagesPerSide(level + 1) : 0;
+        std::vector<uint32_t>& texels = m_Indirection[level];
+
+        for (int y = bottom; y < bottom + size; y++)
+        {
+            for (int x = left; x < left + size; x++)
+            {
+                const auto resident = m_PageTable.find(PackPage(level, x, y));
+                if (resident != m_PageTable.end())
+                {
+                    const uint32_t slotX = resident->second % m_CachePagesPerSide, slotY = resident->second / m_CachePagesPerSide;
+                    texels[static_cast<size_t>(y) * pages + x] = slotX | slotY << 8 | static_cast<uint32_t>(level) << 16 | 0xFF000000u;
+                }
+                else if (parentPages > 0)
+                {
+                    texels[static_cast<size_t>(y) * pages + x] = m_Indirection[level + 1][static_cast<size_t>(y / 2) * parentPages + x / 2];
+                }
+            }
+        }
+
+        GLCall(glPixelStorei(GL_UNPACK_ROW_LENGTH, pages));
+        GLCall(glTexSubImage2D(GL_TEXTURE_2D, level, left, bottom, size, size, GL_RGBA, GL_UNSIGNED_BYTE,
+                               texels.data() + static_cast<size_t>(bottom) * pages + left));
+        GLCall(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+    }
+
+    uint32_t VirtualTexture::PackPage(const int level, const int x, const int y)
+    {
+        return static_cast<uint32_t>(level) << 24 | static_cast<uint32_t>(y) << 12 | static_cast<uint32_t>(x);
+    }
+}  // namespace GLBasics
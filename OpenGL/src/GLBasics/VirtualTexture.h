@@ -0,0 +1,158 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "VirtualTextureFile.h"
+
+namespace Utils
+{
+    class ThreadPool;
+}
+
+namespace GLBasics
+{
+    class Shader;
+
+    /**
+     * \brief A texture far larger than video memory, sampled through a fixed size cache of pages.
+     * The pages a frame needs are found by VirtualTextureFeedback, read from a VirtualTextureFile on
+     * a thread pool and copied into a free or least recently used slot of the cache. An indirection
+     * texture with one texel per page points every page at the finest resident page that covers it,
+     * so shaders sampling with include/VirtualTexture.glsl always find something to show
+     */
+    class VirtualTexture
+    {
+    private:
+        struct Slot
+        {
+            uint32_t page;           // NO_PAGE while the slot is free
+            uint64_t lastUsedFrame;  // PINNED for the page that is never evicted
+        };
+
+        struct LoadedPage
+        {
+            uint32_t page;
+            std::vector<unsigned char> pixels;
+        };
+
+        Utils::ThreadPool& m_ThreadPool;
+        VirtualTextureFile m_File;
+        unsigned int m_CacheID, m_IndirectionID;
+        int m_CachePagesPerSide;
+        unsigned int m_UploadsPerFrame;
+        unsigned int m_FeedbackID;
+        uint64_t m_Frame;
+
+        std::vector<Slot> m_Slots;
+        std::unordered_map<uint32_t, unsigned int> m_PageTable;  // page -> slot
+        std::unordered_set<uint32_t> m_Requested;                // pages asked for since the last Update
+        std::unordered_set<uint32_t> m_Loading;                  // pages read or waiting for a slot
+        std::vector<std::vector<uint32_t>> m_Indirection;        // RGBA8 texels, one vector per level
+        std::unordered_set<uint32_t> m_ChangedPages;             // pages added or evicted since the indirection was updated
+
+        std::mutex m_Mutex;
+        std::condition_variable m_LoadFinished;
+        std::deque<LoadedPage> m_Loaded;
+        unsigned int m_LoadsInFlight;
+        bool m_Cancelled;
+
+        friend class VirtualTextureFeedback;
+
+    public:
+        /**
+         * \brief Opens a page file and creates the cache and indirection textures. The coarsest
+         * level is read right away and stays resident
+         * \param threadPool The workers the pages are read on. Must outlive the texture
+         * \param path A string that is the path to a page file written by VirtualTextureFile::Cook
+         * \param cachePagesPerSide How many pages the cache holds on each side, at most 256
+         * \param uploadsPerFrame How many pages Update may copy into the cache
+         */
+        VirtualTexture(Utils::ThreadPool& threadPool, const std::string& path, int cachePagesPerSide = 32, unsigned int uploadsPerFrame = 16);
+
+        VirtualTexture(const VirtualTexture&) = delete;
+        VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+        /**
+         * \brief Waits for the reads in flight and deletes the textures
+         */
+        ~VirtualTexture();
+
+        /**
+         * \brief Check whether the page file was opened
+         * \return true if the texture can be sampled; false otherwise
+         */
+        inline bool IsValid() const { return m_File.levelCount > 0; }
+
+        /**
+         * \brief Ask for a page and the coarser ones covering it to be resident
+         * \param level Which level the page is on
+         * \param x The column of the page
+         * \param y The row of the page, 0 is the bottom
+         */
+        void RequestPage(int level, int x, int y);
+
+        /**
+         * \brief Copy the pages read so far into the cache, start reading the ones asked for and
+         * update the indirection texture. Should be called once per frame
+         */
+        void Update();
+
+        /**
+         * \brief Bind the cache and the indirection texture
+         * \param cacheSlot Which texture unit vtCache samples
+         * \param indirectionSlot Which texture unit vtIndirection samples
+         */
+        void Bind(unsigned int cacheSlot, unsigned int indirectionSlot) const;
+
+        /**
+         * \brief Set the uniforms include/VirtualTexture.glsl reads
+         * \param shader The shader to set them on
+         * \param cacheSlot Which texture unit the cache is bound to
+         * \param indirectionSlot Which texture unit the indirection texture is bound to
+         * \param mipBias Added to the level the shader picks, VirtualTextureFeedback::GetMipBias in the feedback pass
+         */
+        void SetUniforms(const Shader& shader, unsigned int cacheSlot, unsigned int indirectionSlot, float mipBias = 0.0f) const;
+
+        /**
+         * \brief Get the number of pages in the cache
+         * \return The number of resident pages
+         */
+        inline unsigned int GetResidentPageCount() const { return static_cast<unsigned int>(m_PageTable.size()); }
+
+        /**
+         * \brief Get the number of pages being read or waiting for a slot
+         * \return The number of pending pages
+         */
+        inline unsigned int GetPendingCount() const { return static_cast<unsigned int>(m_Loading.size()); }
+
+        /**
+         * \brief Get how much video memory the cache and the indirection texture take, which doesn't
+         * depend on the size of the virtual texture beyond the indirection texture
+         * \return The size in bytes
+         */
+        size_t GetMemoryBytes() const;
+
+    private:
+        // Reads one page on a worker thread and queues it for Update
+        void LoadPage(uint32_t page);
+
+        // Copies a page into a free slot or the least recently used one, returns false if every slot is in use
+        bool UploadPage(const LoadedPage& page);
+
+        // Rebuilds the indirection texels under the changed pages, on their own level and every finer one
+        void UpdateIndirection();
+
+        // Rebuilds and uploads a square of indirection texels on one level from the level above
+        void UpdateIndirectionRect(int level, int left, int bottom, int size);
+
+        static uint32_t PackPage(int level, int x, int y);
+
+    };  // class VirtualTexture
+}  // namespace GLBasics
@@ -0,0 +1,179 @@
+#include "VirtualTextureFeedback.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_set>
+
+#include "VirtualTexture.h"
+
+namespace GLBasics
+{
+    VirtualTextureFeedback::VirtualTextureFeedback(const int scale, const unsigned int bufferCount)
+        : m_Scale(std::max(scale, 1)), m_FramebufferID(0), m_ColorID(0), m_DepthID(0), m_Width(0), m_Height(0),
+          m_Readbacks(std::max(bufferCount, 1u), { 0, nullptr, 0, 0 }), m_NextReadback(0),
+          m_PreviousFramebuffer(0), m_PreviousViewport{ 0, 0, 0, 0 }
+    {
+        for (Readback& readback : m_Readbacks)
+        {
+            GLCall(glGenBuffers(1, &readback.buffer));
+        }
+    }
+
+    VirtualTextureFeedback::~VirtualTextureFeedback()
+    {
+        for (Readback& readback : m_Readbacks)
+        {
+            if (readback.fence)
+            {
+                GLCall(glDeleteSync(readback.fence));
+            }
+            GLCall(glDeleteBuffers(1, &readback.buffer));
+        }
+        GLCall(glDeleteFramebuffers(1, &m_FramebufferID));
+        GLCall(glDeleteTextures(1, &m_ColorID));
+        GLCall(glDeleteRenderbuffers(1, &m_DepthID));
+    }
+
+    void VirtualTextureFeedback::Add(VirtualTexture& texture)
+    {
+        const auto free = std::find(m_Textures.begin(), m_Textures.end(), nullptr);
+        if (free != m_Textures.end())
+        {
+            *free = &texture;
+            texture.m_FeedbackID = static_cast<unsigned int>(free - m_Textures.begin()) + 1;
+        }
+        else
+        {
+            m_Textures.push_back(&texture);
+            texture.m_FeedbackID = static_cast<unsigned int>(m_Textures.size());
+        }
+    }
+
+    void VirtualTextureFeedback::Remove(VirtualTexture& texture)
+    {
+        // ids stay as they are, readbacks in flight may still carry them
+        std::replace(m_Textures.begin(), m_Textures.end(), &texture, static_cast<VirtualTexture*>(nullptr));
+        texture.m_FeedbackID = 0;
+    }
+
+    void VirtualTextureFeedback::Begin(const int screenWidth, const int screenHeight)
+    {
+        const int width = std::max(screenWidth / m_Scale, 1), height = std::max(screenHeight / m_Scale, 1);
+
+        GLCall(glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_PreviousFramebuffer));
+        GLCall(glGetIntegerv(GL_VIEWPORT, m_PreviousViewport));
+
+        if (width != m_Width || height != m_Height)
+        {
+            m_Width = width;
+            m_Height = height;
+
+            if (!m_FramebufferID)
+            {
+                GLCall(glGenFramebuffers(1, &m_FramebufferID));
+                GLCall(glGenTextures(1, &m_ColorID));
+                GLCall(glGenRenderbuffers(1, &m_DepthID));
+            }
+
+            int previousTexture = 0;
+            GLCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
+            GLCall(glBindTexture(GL_TEXTURE_2D, m_ColorID));
+            GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+            GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+            // x, y, level and feedback id of the page, 0 where nothing virtual was drawn
+            GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16UI, m_Width, m_Height, 0, GL_RGBA_INTEGER, GL_UNSIGNED_SHORT, nullptr));
+            GLCall(glBindTexture(GL_TEXTURE_2D, previousTexture));
+
+            GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_DepthID));
+            GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, m_Width, m_Height));
+            GLCall(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+
+            GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferID));
+            GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_ColorID, 0));
+            GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_DepthID));
+            GLCall(const unsigned int status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+            if (status != GL_FRAMEBUFFER_COMPLETE)
+            {
+                std::cout << "ERROR::VIRTUAL_TEXTURE::FEEDBACK_FRAMEBUFFER_INCOMPLETE 0x" << std::hex << status << std::dec << std::endl;
+            }
+        }
+
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferID));
+        GLCall(glViewport(0, 0, m_Width, m_Height));
+        const unsigned int nothing[4] = { 0, 0, 0, 0 };
+        GLCall(glClearBufferuiv(GL_COLOR, 0, nothing));
+        GLCall(glClear(GL_DEPTH_BUFFER_BIT));
+    }
+
+    void VirtualTextureFeedback::End()
+    {
+        // a buffer that hasn't been collected yet is skipped rather than waited for
+        Readback& readback = m_Readbacks[m_NextReadback];
+        if (!readback.fence)
+        {
+            m_NextReadback = (m_NextReadback + 1) % m_Readbacks.size();
+            readback.width = m_Width;
+            readback.height = m_Height;
+
+            GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer));
+            GLCall(glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<size_t>(m_Width) * m_Height * 4 * sizeof(uint16_t), nullptr, GL_STREAM_READ));
+            GLCall(glReadPixels(0, 0, m_Width, m_Height, GL_RGBA_INTEGER, GL_UNSIGNED_SHORT, nullptr));
+            GLCall(readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+            GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+        }
+
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_PreviousFramebuffer));
+        GLCall(glViewport(m_PreviousViewport[0], m_PreviousViewport[1], m_PreviousViewport[2], m_PreviousViewport[3]));
+    }
+
+    void VirtualTextureFeedback::Collect()
+    {
+        std::unordered_set<uint64_t> seen;
+        for (Readback& readback : m_Readbacks)
+        {
+            if (!readback.fence)
+            {
+                continue;
+            }
+            GLCall(const unsigned int state = glClientWaitSync(readback.fence, 0, 0));
+            if (state != GL_ALREADY_SIGNALED && state != GL_CONDITION_SATISFIED)
+            {
+                continue;
+            }
+            GLCall(glDeleteSync(readback.fence));
+            readback.fence = nullptr;
+
+            const size_t pixelCount = static_cast<size_t>(readback.width) * readback.height;
+            GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer));
+            GLCall(const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, pixelCount * 4 * sizeof(uint16_t), GL_MAP_READ_BIT));
+            if (mapped)
+            {
+                // neighbouring pixels mostly want the same page, each is passed on once
+                const uint16_t* pixels = static_cast<const uint16_t*>(mapped);
+                for (size_t i = 0; i < pixelCount; i++)
+                {
+                    const uint16_t* pixel = pixels + i * 4;
+                    if (pixel[3] == 0 || pixel[3] > m_Textures.size() || !m_Textures[pixel[3] - 1])
+                    {
+                        continue;
+                    }
+                    const uint64_t key = static_cast<uint64_t>(pixel[3]) << 48 | static_cast<uint64_t>(pixel[2]) << 32 |
+                                         static_cast<uint64_t>(pixel[1]) << 16 | pixel[0];
+                    if (seen.insert(key).second)
+                    {
+                        m_Textures[pixel[3] - 1]->RequestPage(pixel[2], pixel[0], pixel[1]);
+                    }
+                }
+                GLCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+            }
+            GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+        }
+    }
+
+    float VirtualTextureFeedback::GetMipBias() const
+    {
+        // the pass is drawn scale times smaller, so its derivatives pick a level log2(scale) too coarse
+        return -std::log2(static_cast<float>(m_Scale));
+    }
+}  // namespace GLBasics
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+
+#include "../Utils/GLDebugHelper.h"
+
+namespace GLBasics
+{
+    class VirtualTexture;
+
+    /**
+     * \brief Finds the pages of virtual textures a frame samples. The scene is drawn once more at a
+     * fraction of the resolution with the VIRTUAL_TEXTURE_FEEDBACK variant of the shaders, which
+     * writes the page and level every pixel needs. The result is read back through pixel pack
+     * buffers and only looked at frames later when its fence has passed, so the pass never stalls
+     */
+    class VirtualTextureFeedback
+    {
+    private:
+        struct Readback
+        {
+            unsigned int buffer;
+            GLsync fence;  // nullptr when the buffer holds nothing to collect
+            int width, height;
+        };
+
+        std::vector<VirtualTexture*> m_Textures;  // index + 1 is the feedback id
+        int m_Scale;
+        unsigned int m_FramebufferID, m_ColorID, m_DepthID;
+        int m_Width, m_Height;
+        std::vector<Readback> m_Readbacks;
+        unsigned int m_NextReadback;
+
+        int m_PreviousFramebuffer;
+        int m_PreviousViewport[4];
+
+    public:
+        /**
+         * \brief Constructs the feedback pass, the framebuffer is created on the first Begin
+         * \param scale How many times smaller than the screen the pass is drawn on each side
+         * \param bufferCount The number of readbacks that may be in flight
+         */
+        explicit VirtualTextureFeedback(int scale = 8, unsigned int bufferCount = 3);
+
+        VirtualTextureFeedback(const VirtualTextureFeedback&) = delete;
+        VirtualTextureFeedback& operator=(const VirtualTextureFeedback&) = delete;
+
+        /**
+         * \brief Deletes the framebuffer, the pixel pack buffers and their fences
+         */
+        ~VirtualTextureFeedback();
+
+        /**
+         * \brief Give a virtual texture the id its feedback is written with
+         * \param texture The texture, which has to be removed before it is destroyed
+         */
+        void Add(VirtualTexture& texture);
+
+        /**
+         * \brief Stop sending feedback to a virtual texture
+         * \param texture A texture that was added
+         */
+        void Remove(VirtualTexture& texture);
+
+        /**
+         * \brief Bind and clear the feedback framebuffer, the scene is drawn after this
+         * \param screenWidth The width of the screen the scene is drawn to
+         * \param screenHeight The height of the screen the scene is drawn to
+         */
+        void Begin(int screenWidth, int screenHeight);
+
+        /**
+         * \brief Start reading the feedback back and bind the previous framebuffer and viewport again
+         */
+        void End();
+
+        /**
+         * \brief Pass the pages of every finished readback on to their virtual textures. Should be
+         * called once per frame before the textures are updated
+         */
+        void Collect();
+
+        /**
+         * \brief Get what the feedback pass adds to the level the shaders pick, so it asks for the
+         * level the full resolution pass will sample
+         * \return The mip bias to pass to VirtualTexture::SetUniforms
+         */
+        float GetMipBias() const;
+
+    };  // class VirtualTextureFeedback
+}  // namespace GLBasics
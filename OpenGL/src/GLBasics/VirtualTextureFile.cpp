@@ -0,0 +1,183 @@
+#include "VirtualTextureFile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <stb_image/stb_image.h>
+
+#include "../Utils/MipGenerator.h"
+
+namespace GLBasics
+{
+    namespace
+    {
+        constexpr uint32_t PAGE_FILE_MAGIC = 0x58545456;  // "VTTX"
+        constexpr uint32_t PAGE_FILE_VERSION = 1;
+        constexpr size_t HEADER_SIZE = 6 * sizeof(uint32_t);
+
+        // far beyond any real file, keeps the sizes computed from the header from overflowing
+        constexpr uint32_t MAX_PAGE_SIZE = 4096;
+        constexpr uint32_t MAX_PAGES_PER_SIDE = 65536;
+
+        bool IsPowerOfTwo(const int value)
+        {
+            return value > 0 && (value & (value - 1)) == 0;
+        }
+    }  // namespace
+
+    bool VirtualTextureFile::Open(const std::string& path, VirtualTextureFile& file)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        uint32_t header[6] = {};
+        if (!stream.read(reinterpret_cast<char*>(header), sizeof(header)))
+        {
+            std::cout << "ERROR::VIRTUAL_TEXTURE::FILE_NOT_READ " << path << std::endl;
+            return false;
+        }
+        if (header[0] != PAGE_FILE_MAGIC || header[1] != PAGE_FILE_VERSION)
+        {
+            std::cout << "ERROR::VIRTUAL_TEXTURE::NOT_A_PAGE_FILE " << path << std::endl;
+            return false;
+        }
+
+        VirtualTextureFile opened;
+        opened.path = path;
+        opened.pageSize = static_cast<int>(std::min(header[2], MAX_PAGE_SIZE + 1));
+        opened.border = static_cast<int>(std::min(header[3], MAX_PAGE_SIZE + 1));
+        opened.pagesPerSide = static_cast<int>(std::min(header[4], MAX_PAGES_PER_SIDE + 1));
+        opened.levelCount = static_cast<int>(std::min<uint32_t>(header[5], 64));
+
+        // Cook stores every level down to the one that fits in a single page
+        int fullLevelCount = 1;
+        while (opened.pagesPerSide >> fullLevelCount > 0)
+        {
+            fullLevelCount++;
+        }
+        if (opened.pageSize == 0 || static_cast<uint32_t>(opened.pageSize) > MAX_PAGE_SIZE || opened.border > opened.pageSize ||
+            !IsPowerOfTwo(opened.pagesPerSide) || static_cast<uint32_t>(opened.pagesPerSide) > MAX_PAGES_PER_SIDE ||
+            opened.levelCount != fullLevelCount)
+        {
+            std::cout << "ERROR::VIRTUAL_TEXTURE::INVALID_HEADER " << path << std::endl;
+            return false;
+        }
+
+        std::error_code error;
+        const uintmax_t fileSize = std::filesystem::file_size(path, error);
+        const size_t expectedSize = opened.GetPageOffset(opened.levelCount - 1, 0, 0) + opened.GetPageBytes();
+        if (error || fileSize < expectedSize)
+        {
+            std::cout << "ERROR::VIRTUAL_TEXTURE::TRUNCATED " << path << ": " << fileSize << " of " << expectedSize << " bytes" << std::endl;
+            return false;
+        }
+
+        file = opened;
+        return true;
+    }
+
+    bool VirtualTextureFile::ReadPage(const int level, const int x, const int y, unsigned char* pixels) const
+    {
+        if (level < 0 || level >= levelCount || x < 0 || y < 0 || x >= GetPagesPerSide(level) || y >= GetPagesPerSide(level))
+        {
+            return false;
+        }
+
+        // every call opens its own stream so workers never share a file position
+        std::ifstream stream(path, std::ios::binary);
+        stream.seekg(static_cast<std::streamoff>(GetPageOffset(level, x, y)));
+        return static_cast<bool>(stream.read(reinterpret_cast<char*>(pixels), static_cast<std::streamsize>(GetPageBytes())));
+    }
+
+    bool VirtualTextureFile::Cook(const std::string& imagePath, const std::string& outputPath, const int pageSize, const int border)
+    {
+        int width = 0, height = 0, channels = 0;
+        stbi_set_flip_vertically_on_load_thread(1);
+        unsigned char* pixels = stbi_load(imagePath.c_str(), &width, &height, &channels, 4);
+        if (!pixels)
+        {
+            std::cout << "ERROR::VIRTUAL_TEXTURE::LOAD_FAILED " << imagePath << ": " << stbi_failure_reason() << std::endl;
+            return false;
+        }
+        if (width != height || pageSize <= 0 || width % pageSize != 0 || !IsPowerOfTwo(width / pageSize))
+        {
+            std::cout << "ERROR::VIRTUAL_TEXTURE::SIZE_NOT_SUPPORTED " << imagePath << ": " << width << "x" << height << std::endl;
+            stbi_image_free(pixels);
+            return false;
+        }
+
+        const Utils::MipChain chain = Utils::MipGenerator::Generate(width, height, pixels, {});
+        stbi_image_free(pixels);
+
+        VirtualTextureFile file;
+        file.pageSize = pageSize;
+        file.border = border;
+        file.pagesPerSide = width / pageSize;
+        file.levelCount = 1;
+        while (file.pagesPerSide >> file.levelCount > 0)
+        {
+            file.levelCount++;
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(outputPath).parent_path(), error);
+
+        // written aside and renamed so a reader never sees half a file
+        const std::string temporaryPath = outputPath + ".tmp";
+        {
+            std::ofstream stream(temporaryPath, std::ios::binary);
+            const uint32_t header[6] = { PAGE_FILE_MAGIC, PAGE_FILE_VERSION, static_cast<uint32_t>(pageSize), static_cast<uint32_t>(border),
+                                         static_cast<uint32_t>(file.pagesPerSide), static_cast<uint32_t>(file.levelCount) };
+            stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+            const int slotSize = file.GetSlotSize();
+            std::vector<unsigned char> page(file.GetPageBytes());
+            for (int level = 0; level < file.levelCount; level++)
+            {
+                const Utils::MipChain::Level& mip = chain.levels[level];
+                const unsigned char* source = chain.pixels.data() + mip.offset;
+                const int pages = file.GetPagesPerSide(level);
+                for (int pageY = 0; pageY < pages; pageY++)
+                {
+                    for (int pageX = 0; pageX < pages; pageX++)
+                    {
+                        // the border wraps around like the texture does when sampled with repeat
+                        for (int y = 0; y < slotSize; y++)
+                        {
+                            const int sourceY = ((pageY * pageSize + y - border) % mip.height + mip.height) % mip.height;
+                            for (int x = 0; x < slotSize; x++)
+                            {
+                                const int sourceX = ((pageX * pageSize + x - border) % mip.width + mip.width) % mip.width;
+                                std::memcpy(page.data() + (static_cast<size_t>(y) * slotSize + x) * 4,
+                                            source + (static_cast<size_t>(sourceY) * mip.width + sourceX) * 4, 4);
+                            }
+                        }
+                        stream.write(reinterpret_cast<const char*>(page.data()), static_cast<std::streamsize>(page.size()));
+                    }
+                }
+            }
+            if (!stream)
+            {
+                std::cout << "ERROR::VIRTUAL_TEXTURE::WRITE_FAILED " << outputPath << std::endl;
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temporaryPath, outputPath, error);
+        return !error;
+    }
+
+    size_t VirtualTextureFile::GetPageOffset(const int level, const int x, const int y) const
+    {
+        size_t pagesBefore = 0;
+        for (int finer = 0; finer < level; finer++)
+        {
+            pagesBefore += static_cast<size_t>(GetPagesPerSide(finer)) * GetPagesPerSide(finer);
+        }
+        pagesBefore += static_cast<size_t>(y) * GetPagesPerSide(level) + x;
+        return HEADER_SIZE + pagesBefore * GetPageBytes();
+    }
+}  // namespace GLBasics
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace GLBasics
+{
+    /**
+     * \brief A texture cut into square pages with a border, level by level, so single pages can be
+     * read without loading the rest. Pages are RGBA8, bottom row first, and only the level that
+     * fits in one page and the finer ones are stored. The full size image has to be a page size
+     * times a power of two texels on each side
+     */
+    struct VirtualTextureFile
+    {
+        std::string path;
+        int pageSize = 0;      // texels on each side of a page, without the border
+        int border = 0;        // texels repeated from the neighbouring pages for filtering
+        int pagesPerSide = 0;  // on level 0
+        int levelCount = 0;
+
+        /**
+         * \brief Get the texels on each side of a page with its border
+         * \return The page size plus twice the border
+         */
+        inline int GetSlotSize() const { return pageSize + 2 * border; }
+
+        /**
+         * \brief Get the bytes one page takes
+         * \return Four bytes per texel of a page with its border
+         */
+        inline size_t GetPageBytes() const { return static_cast<size_t>(GetSlotSize()) * GetSlotSize() * 4; }
+
+        /**
+         * \brief Get how many pages a level has on each side
+         * \param level Which level, 0 is the full size image
+         * \return The number of pages per side
+         */
+        inline int GetPagesPerSide(const int level) const { return pagesPerSide >> level > 0 ? pagesPerSide >> level : 1; }
+
+        /**
+         * \brief Read the header of a page file, the pages stay on disk
+         * \param path A string that is the path to the page file
+         * \param file The file to fill in
+         * \return true if the header was read; false otherwise, with the reason printed
+         */
+        static bool Open(const std::string& path, VirtualTextureFile& file);
+
+        /**
+         * \brief Read one page, may be called from several threads at once
+         * \param level Which level the page is on
+         * \param x The column of the page
+         * \param y The row of the page, 0 is the bottom
+         * \param pixels Receives GetPageBytes bytes
+         * \return true if the page was read; false otherwise
+         */
+        bool ReadPage(int level, int x, int y, unsigned char* pixels) const;
+
+        /**
+         * \brief Cut an image into a page file, building its mip chain first
+         * \param imagePath A string that is the path to the source image
+         * \param outputPath A string that is the path the page file is written to
+         * \param pageSize Texels on each side of a page without the border
+         * \param border Texels repeated from the neighbouring pages
+         * \return true if the file was written; false otherwise, with the reason printed
+         */
+        static bool Cook(const std::string& imagePath, const std::string& outputPath, int pageSize = 128, int border = 4);
+
+    private:
+        // Returns where a page starts in the file
+        size_t GetPageOffset(int level, int x, int y) const;
+
+    };  // struct VirtualTextureFile
+}  // namespace GLBasics
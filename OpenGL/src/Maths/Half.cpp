@@ -0,0 +1,65 @@
+#include "Half.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace Maths
+{
+    Half Half::FromFloat(const float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        const auto sign = static_cast<uint16_t>(bits >> 16 & 0x8000);
+        const uint32_t magnitude = bits & 0x7FFFFFFF;
+
+        if (magnitude > 0x7F800000)
+        {
+            return { static_cast<uint16_t>(sign | 0x7E00) };  // NaN stays NaN
+        }
+        if (magnitude >= 0x47800000)
+        {
+            return { static_cast<uint16_t>(sign | 0x7C00) };  // 65536 and up, infinity included
+        }
+        if (magnitude < 0x38800000)
+        {
+            // Below the smallest normal half, counted in steps of 2^-24 and rounded to even
+            const float steps = std::nearbyint(std::fabs(value) * 16777216.0f);
+            return { static_cast<uint16_t>(sign | static_cast<uint16_t>(steps)) };
+        }
+
+        // Rebias the exponent from 127 to 15 and round the dropped 13 bits to even. A carry out of the
+        // mantissa correctly moves on to the next exponent, or to infinity past 65504
+        uint32_t half = (magnitude - 0x38000000) >> 13;
+        const uint32_t dropped = magnitude & 0x1FFF;
+        if (dropped > 0x1000 || (dropped == 0x1000 && (half & 1)))
+        {
+            half++;
+        }
+        return { static_cast<uint16_t>(sign | half) };
+    }
+
+    float Half::ToFloat() const
+    {
+        const uint32_t sign = static_cast<uint32_t>(bits & 0x8000) << 16;
+        const uint32_t exponent = bits >> 10 & 0x1F;
+        const uint32_t mantissa = bits & 0x3FF;
+
+        uint32_t result;
+        if (exponent == 0)
+        {
+            const float magnitude = mantissa / 16777216.0f;
+            return sign ? -magnitude : magnitude;
+        }
+        if (exponent == 31)
+        {
+            result = sign | 0x7F800000 | mantissa << 13;
+        }
+        else
+        {
+            result = sign | (exponent + 112) << 23 | mantissa << 13;
+        }
+        float value;
+        std::memcpy(&value, &result, sizeof(value));
+        return value;
+    }
+}  // namespace Maths
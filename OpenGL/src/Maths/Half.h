@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Maths
+{
+    /**
+     * \brief A 16-bit IEEE float as stored in vertex and texture data, 1 sign, 5 exponent and 10
+     * mantissa bits. Only converts, arithmetic is done in float
+     */
+    struct Half
+    {
+        uint16_t bits;
+
+        /**
+         * \brief Convert a float, rounding to the nearest half. Values beyond 65504 become infinity
+         * \param value The float to convert
+         * \return The half closest to value
+         */
+        static Half FromFloat(float value);
+
+        /**
+         * \brief Convert back to a float, which holds every half exactly
+         * \return The value as a float
+         */
+        float ToFloat() const;
+    };
+}  // namespace Maths
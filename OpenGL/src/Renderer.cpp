@@ -8,12 +8,90 @@ void Renderer::DrawArrays(const unsigned mode, const VertexBuffer& vb, const Sha
 	GLCall(glDrawArrays(mode, 0, numTriangles));
 }
 
-void Renderer::DrawElements(const unsigned mode, const VertexArray& va, const Shader& shader, const unsigned numIndices)
+void Renderer::DrawElements(const unsigned mode, const VertexArray& va, const IndexBuffer& ib, const Shader& shader)
 {
 	va.Bind();
 	shader.Bind();
 
-	GLCall(glDrawElements(mode, numIndices, GL_UNSIGNED_INT, nullptr));
+	if (ib.HasPrimitiveRestart())
+	{
+		GLCall(glEnable(GL_PRIMITIVE_RESTART));
+		GLCall(glPrimitiveRestartIndex(ib.GetRestartIndex()));
+	}
+	GLCall(glDrawElements(mode, ib.GetCount(), ib.GetType(), nullptr));
+	if (ib.HasPrimitiveRestart())
+	{
+		GLCall(glDisable(GL_PRIMITIVE_RESTART));
+	}
+}
+
+void Renderer::DrawMesh(const Mesh& mesh, const Shader& shader)
+{
+	mesh.Bind();
+	shader.Bind();
+
+	const size_t indexOffset = mesh.GetIndexOffset();
+	const int baseVertex = mesh.GetBaseVertex();
+	for (const GLBasics::MeshPart& part : mesh.GetParts())
+	{
+		GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, part.indexCount, mesh.GetIndexType(),
+			reinterpret_cast<void*>(indexOffset + part.indexOffset), baseVertex + part.baseVertex));
+	}
+}
+
+void Renderer::DrawParticles(const ParticleBuffer& particles, const Shader& shader)
+{
+	if (particles.GetInstanceCount() == 0)
+	{
+		return;
+	}
+	particles.Bind();
+	shader.Bind();
+
+	GLCall(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, particles.GetInstanceCount()));
+}
+
+void Renderer::DrawParticles(const GpuParticleSystem& particles, const Shader& shader)
+{
+	if (!particles.HasParticles())
+	{
+		return;
+	}
+	particles.Bind();
+	shader.Bind();
+
+	GLCall(glEnable(GL_PROGRAM_POINT_SIZE));
+	if (particles.GetTransformFeedbackID() != 0)
+	{
+		GLCall(glDrawTransformFeedback(GL_POINTS, particles.GetTransformFeedbackID()));
+	}
+	else
+	{
+		GLCall(glDrawArrays(GL_POINTS, 0, particles.GetParticleCount()));
+	}
+	GLCall(glDisable(GL_PROGRAM_POINT_SIZE));
+}
+
+void Renderer::DrawSprites(const SpriteBatch& sprites, const Shader& shader)
+{
+	shader.Bind();
+	const auto& batches = sprites.GetBatches();
+	for (size_t i = 0; i < batches.size(); i++)
+	{
+		sprites.BindBatch(i, 0);
+		GLCall(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, batches[i].count));
+	}
+}
+
+void Renderer::DrawGlyphs(const TextBatch& text, const Shader& shader)
+{
+	shader.Bind();
+	const auto& batches = text.GetBatches();
+	for (size_t i = 0; i < batches.size(); i++)
+	{
+		text.BindBatch(i, 0);
+		GLCall(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, batches[i].count));
+	}
 }
 
 void Renderer::Clear(const glm::vec4& color)
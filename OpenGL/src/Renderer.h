@@ -1,12 +1,24 @@
 #pragma once
 
+#include "GLBasics/IndexBuffer.h"
 #include "GLBasics/VertexBuffer.h"
 #include "GLBasics/VertexArray.h"
+#include "GLBasics/GpuParticleSystem.h"
+#include "GLBasics/Mesh.h"
+#include "GLBasics/ParticleBuffer.h"
 #include "GLBasics/Shader.h"
+#include "GLBasics/SpriteBatch.h"
+#include "GLBasics/TextBatch.h"
 
+using GLBasics::IndexBuffer;
 using GLBasics::VertexBuffer;
 using GLBasics::VertexArray;
+using GLBasics::GpuParticleSystem;
+using GLBasics::Mesh;
+using GLBasics::ParticleBuffer;
 using GLBasics::Shader;
+using GLBasics::SpriteBatch;
+using GLBasics::TextBatch;
 
 /**
  * \brief Handles all the draw calls and clearing the buffer
@@ -24,13 +36,48 @@ public:
 	void DrawArrays(unsigned int mode, const VertexBuffer& vb, const Shader& shader, unsigned int numTriangles);
 
     /**
-	 * \brief Draw with VertexArray
+	 * \brief Draw every index of an IndexBuffer, as the type it is stored as and with primitive restart when it uses it
 	 * \param mode An enum specifies the mode for this draw call
-	 * \param va The VertexArray that contains all the vertices data and indices data
+	 * \param va The VertexArray that contains all the vertices data, with ib bound to it
+	 * \param ib The IndexBuffer to draw
 	 * \param shader Shader program that will be used for this draw call
-	 * \param numIndices The number of unsigned int inside the IndexBuffer bound to the VertexArray
 	 */
-	void DrawElements(unsigned int mode, const VertexArray& va, const Shader& shader, unsigned int numIndices);
+	void DrawElements(unsigned int mode, const VertexArray& va, const IndexBuffer& ib, const Shader& shader);
+
+    /**
+	 * \brief Draw every triangle of a Mesh
+	 * \param mesh The Mesh, bound through its own or a shared VertexArray, drawn part by part from its base vertex and index offset
+	 * \param shader Shader program that will be used for this draw call
+	 */
+	void DrawMesh(const Mesh& mesh, const Shader& shader);
+
+    /**
+	 * \brief Draw the particles uploaded last as instanced billboards, four vertices each
+	 * \param particles The ParticleBuffer holding the instances
+	 * \param shader Shader program that will be used for this draw call, one that places the corners from gl_VertexID
+	 */
+	void DrawParticles(const ParticleBuffer& particles, const Shader& shader);
+
+    /**
+	 * \brief Draw the particles of a GpuParticleSystem as point sprites, as many as the GPU captured
+	 * \param particles The GpuParticleSystem, updated at least once
+	 * \param shader Shader program that will be used for this draw call, one that sets gl_PointSize
+	 */
+	void DrawParticles(const GpuParticleSystem& particles, const Shader& shader);
+
+    /**
+	 * \brief Draw the sprites uploaded by the last SpriteBatch::End, one instanced draw per batch
+	 * \param sprites The SpriteBatch holding the instances
+	 * \param shader Shader program that will be used for this draw call, one that samples the texture arrays from slot 0
+	 */
+	void DrawSprites(const SpriteBatch& sprites, const Shader& shader);
+
+    /**
+	 * \brief Draw the glyphs uploaded by the last TextBatch::End, one instanced draw per font
+	 * \param text The TextBatch holding the instances
+	 * \param shader Shader program that will be used for this draw call, one that samples the atlas from slot 0
+	 */
+	void DrawGlyphs(const TextBatch& text, const Shader& shader);
 
     /**
 	 * \brief Clear the screen buffer with a given color
@@ -0,0 +1,101 @@
+#include "BuddyAllocator.h"
+
+namespace Utils
+{
+    BuddyAllocator::BuddyAllocator(const size_t size, const size_t minBlockSize)
+        : m_Size(1), m_MinBlockSize(1), m_TopOrder(0), m_UsedBytes(0)
+    {
+        // Anything else is rounded up to the next power of two
+        while (m_MinBlockSize < minBlockSize)
+        {
+            m_MinBlockSize <<= 1;
+        }
+        while (m_Size < size || m_Size < m_MinBlockSize)
+        {
+            m_Size <<= 1;
+        }
+        while ((m_MinBlockSize << m_TopOrder) < m_Size)
+        {
+            m_TopOrder++;
+        }
+        m_FreeBlocks.resize(m_TopOrder + 1);
+        m_FreeBlocks[m_TopOrder].insert(0);
+    }
+
+    bool BuddyAllocator::Allocate(const size_t size, size_t& offset)
+    {
+        unsigned int order = 0;
+        while ((m_MinBlockSize << order) < size)
+        {
+            if (++order > m_TopOrder)
+            {
+                return false;
+            }
+        }
+
+        unsigned int source = order;
+        while (source <= m_TopOrder && m_FreeBlocks[source].empty())
+        {
+            source++;
+        }
+        if (source > m_TopOrder)
+        {
+            return false;
+        }
+
+        offset = *m_FreeBlocks[source].begin();
+        m_FreeBlocks[source].erase(m_FreeBlocks[source].begin());
+        // Split down to the size needed, keeping the lower half and freeing the upper one
+        while (source > order)
+        {
+            source--;
+            m_FreeBlocks[source].insert(offset + (m_MinBlockSize << source));
+        }
+        m_UsedBlocks.emplace(offset, order);
+        m_UsedBytes += m_MinBlockSize << order;
+        return true;
+    }
+
+    void BuddyAllocator::Free(size_t offset)
+    {
+        const auto used = m_UsedBlocks.find(offset);
+        if (used == m_UsedBlocks.end())
+        {
+            return;
+        }
+        unsigned int order = used->second;
+        m_UsedBlocks.erase(used);
+        m_UsedBytes -= m_MinBlockSize << order;
+
+        // Merge with the buddy for as long as it is free too
+        while (order < m_TopOrder)
+        {
+            const size_t buddy = offset ^ (m_MinBlockSize << order);
+            if (m_FreeBlocks[order].erase(buddy) == 0)
+            {
+                break;
+            }
+            offset = offset < buddy ? offset : buddy;
+            order++;
+        }
+        m_FreeBlocks[order].insert(offset);
+    }
+
+    size_t BuddyAllocator::GetBlockSize(const size_t offset) const
+    {
+        const auto used = m_UsedBlocks.find(offset);
+        return used != m_UsedBlocks.end() ? m_MinBlockSize << used->second : 0;
+    }
+
+    size_t BuddyAllocator::GetLargestFreeBlock() const
+    {
+        for (unsigned int order = m_TopOrder + 1; order-- > 0;)
+        {
+            if (!m_FreeBlocks[order].empty())
+            {
+                return m_MinBlockSize << order;
+            }
+        }
+        return 0;
+    }
+}  // namespace Utils
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace Utils
+{
+    /**
+     * \brief Hands out power of two blocks of a range of offsets. A freed block merges with its buddy,
+     * the other half of the block both were split from, so free space never stays chopped up for
+     * long. Blocks are taken from the lowest offsets first. Only manages offsets, never touches memory
+     */
+    class BuddyAllocator
+    {
+    private:
+        size_t m_Size;
+        size_t m_MinBlockSize;
+        unsigned int m_TopOrder;                         // the order of a block spanning m_Size
+        std::vector<std::set<size_t>> m_FreeBlocks;      // offsets of the free blocks of every order
+        std::unordered_map<size_t, unsigned int> m_UsedBlocks;  // offset -> order
+        size_t m_UsedBytes;
+
+    public:
+        /**
+         * \brief Constructs an allocator with the whole range free
+         * \param size The size of the range, rounded up to a power of two
+         * \param minBlockSize The smallest block handed out, rounded up to a power of two. Every offset is a multiple of it
+         */
+        BuddyAllocator(size_t size, size_t minBlockSize);
+
+        /**
+         * \brief Take the smallest block that fits
+         * \param size The number of bytes needed
+         * \param offset Receives where the block starts
+         * \return true if a block was free; false otherwise
+         */
+        bool Allocate(size_t size, size_t& offset);
+
+        /**
+         * \brief Give back a block
+         * \param offset Where the block starts, as returned by Allocate. Other offsets are ignored
+         */
+        void Free(size_t offset);
+
+        /**
+         * \brief Get the size of a block that is in use
+         * \param offset Where the block starts
+         * \return The block size, which Allocate rounded up to a power of two
+         */
+        size_t GetBlockSize(size_t offset) const;
+
+        /**
+         * \brief Get the size of the largest free block, the most one Allocate can still take
+         * \return The size in bytes, 0 if the range is full
+         */
+        size_t GetLargestFreeBlock() const;
+
+        inline size_t GetSize() const { return m_Size; }
+        inline size_t GetUsedBytes() const { return m_UsedBytes; }
+        inline bool IsEmpty() const { return m_UsedBlocks.empty(); }
+
+    };  // class BuddyAllocator
+}  // namespace Utils
@@ -0,0 +1,127 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace Utils
+{
+    FileWatcher::FileWatcher()
+#ifdef __linux__
+        : m_InotifyFD(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+#endif
+    {
+#ifdef __linux__
+        if (m_InotifyFD < 0)
+        {
+            std::cout << "ERROR::FILE_WATCHER::INOTIFY_INIT_FAILED" << std::endl;
+        }
+#endif
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+#ifdef __linux__
+        if (m_InotifyFD >= 0)
+        {
+            close(m_InotifyFD);
+        }
+#endif
+    }
+
+    void FileWatcher::AddFile(const std::string& path)
+    {
+        const std::string normalizedPath = NormalizePath(path);
+        if (m_Files.find(normalizedPath) != m_Files.end())
+        {
+            return;
+        }
+
+        std::error_code error;
+        m_Files[normalizedPath] = std::filesystem::last_write_time(normalizedPath, error);
+
+#ifdef __linux__
+        // Directories are watched instead of files since most editors save by renaming a temporary file
+        std::string directory = std::filesystem::path(normalizedPath).parent_path().generic_string();
+        if (directory.empty())
+        {
+            directory = ".";
+        }
+
+        for (const auto& watched : m_WatchedDirectories)
+        {
+            if (watched.second == directory)
+            {
+                return;
+            }
+        }
+
+        const int watchDescriptor = inotify_add_watch(m_InotifyFD, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (watchDescriptor < 0)
+        {
+            std::cout << "ERROR::FILE_WATCHER::CANNOT_WATCH " << directory << std::endl;
+            return;
+        }
+        m_WatchedDirectories[watchDescriptor] = directory;
+#endif
+    }
+
+    std::vector<std::string> FileWatcher::Poll()
+    {
+        std::vector<std::string> changedFiles;
+        const auto addChangedFile = [&changedFiles](const std::string& path)
+        {
+            if (std::find(changedFiles.begin(), changedFiles.end(), path) == changedFiles.end())
+            {
+                changedFiles.push_back(path);
+            }
+        };
+
+#ifdef __linux__
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(m_InotifyFD, buffer, sizeof(buffer))) > 0)
+        {
+            for (char* pointer = buffer; pointer < buffer + length;)
+            {
+                const auto event = reinterpret_cast<const inotify_event*>(pointer);
+                pointer += sizeof(inotify_event) + event->len;
+
+                const auto directory = m_WatchedDirectories.find(event->wd);
+                if (event->len == 0 || directory == m_WatchedDirectories.end())
+                {
+                    continue;
+                }
+
+                const std::string path = NormalizePath(directory->second + "/" + event->name);
+                if (m_Files.find(path) != m_Files.end())
+                {
+                    addChangedFile(path);
+                }
+            }
+        }
+#else
+        for (auto& [path, lastWriteTime] : m_Files)
+        {
+            std::error_code error;
+            const auto writeTime = std::filesystem::last_write_time(path, error);
+            if (!error && writeTime != lastWriteTime)
+            {
+                lastWriteTime = writeTime;
+                addChangedFile(path);
+            }
+        }
+#endif
+
+        return changedFiles;
+    }
+
+    std::string FileWatcher::NormalizePath(const std::string& path)
+    {
+        return std::filesystem::path(path).lexically_normal().generic_string();
+    }
+}  // namespace Utils
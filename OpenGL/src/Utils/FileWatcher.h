@@ -0,0 +1,58 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Utils
+{
+    /**
+     * \brief Reports files that were modified on disk. Uses inotify on Linux and
+     * compares last write times on other platforms
+     */
+    class FileWatcher
+    {
+    private:
+        // normalized path -> last write time seen
+        std::unordered_map<std::string, std::filesystem::file_time_type> m_Files;
+#ifdef __linux__
+        int m_InotifyFD;
+        std::unordered_map<int, std::string> m_WatchedDirectories;  // watch descriptor -> directory
+#endif
+
+    public:
+        /**
+         * \brief Constructs a watcher that doesn't watch any file yet
+         */
+        FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        /**
+         * \brief Release the underlying OS resources
+         */
+        ~FileWatcher();
+
+        /**
+         * \brief Start watching a file. Adding the same file twice has no effect
+         * \param path The path to the file
+         */
+        void AddFile(const std::string& path);
+
+        /**
+         * \brief Get all the watched files that changed since the last poll. Never blocks
+         * \return The normalized paths of the changed files, each listed once
+         */
+        std::vector<std::string> Poll();
+
+        /**
+         * \brief Normalize a path the same way the watcher reports it
+         * \param path The path to be normalized
+         * \return A normalized path with forward slashes
+         */
+        static std::string NormalizePath(const std::string& path);
+
+    };  // class FileWatcher
+}  // namespace Utils
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Utils
+{
+    /**
+     * \brief 64-bit FNV-1a hash, fast enough for cache keys and file contents
+     * \param data The bytes to hash
+     * \param size The number of bytes
+     * \param hash The hash to continue from, so several buffers can be hashed as one
+     * \return The hash of the bytes
+     */
+    inline uint64_t HashFNV1a(const void* data, const size_t size, uint64_t hash = 14695981039346656037ull)
+    {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+}  // namespace Utils
@@ -0,0 +1,130 @@
+#include "ImageWriter.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+namespace Utils
+{
+    namespace
+    {
+        constexpr size_t MAX_STORED_BLOCK = 65535;
+
+        uint32_t UpdateCRC32(uint32_t crc, const unsigned char* data, const size_t size)
+        {
+            static const std::array<uint32_t, 256> table = []
+            {
+                std::array<uint32_t, 256> entries{};
+                for (uint32_t i = 0; i < 256; i++)
+                {
+                    uint32_t value = i;
+                    for (int bit = 0; bit < 8; bit++)
+                    {
+                        value = value & 1 ? 0xEDB88320u ^ value >> 1 : value >> 1;
+                    }
+                    entries[i] = value;
+                }
+                return entries;
+            }();
+
+            crc = ~crc;
+            for (size_t i = 0; i < size; i++)
+            {
+                crc = table[(crc ^ data[i]) & 0xFF] ^ crc >> 8;
+            }
+            return ~crc;
+        }
+
+        void AppendBigEndian(std::vector<unsigned char>& output, const uint32_t value)
+        {
+            output.push_back(static_cast<unsigned char>(value >> 24));
+            output.push_back(static_cast<unsigned char>(value >> 16));
+            output.push_back(static_cast<unsigned char>(value >> 8));
+            output.push_back(static_cast<unsigned char>(value));
+        }
+
+        void AppendChunk(std::vector<unsigned char>& output, const char* type, const std::vector<unsigned char>& data)
+        {
+            AppendBigEndian(output, static_cast<uint32_t>(data.size()));
+            const size_t typeOffset = output.size();
+            output.insert(output.end(), type, type + 4);
+            output.insert(output.end(), data.begin(), data.end());
+            AppendBigEndian(output, UpdateCRC32(0, output.data() + typeOffset, output.size() - typeOffset));
+        }
+    }  // namespace
+
+    bool ImageWriter::WritePNG(const std::string& path, const int width, const int height, const unsigned char* rgbaPixels, const bool bottomRowFirst)
+    {
+        const size_t row = static_cast<size_t>(width) * 4;
+        const size_t filteredSize = (row + 1) * height;
+
+        std::vector<unsigned char> header;
+        AppendBigEndian(header, static_cast<uint32_t>(width));
+        AppendBigEndian(header, static_cast<uint32_t>(height));
+        header.insert(header.end(), { 8, 6, 0, 0, 0 });  // 8 bits per channel, RGBA, deflate, no filter, no interlace
+
+        // a zlib stream of stored blocks over the rows, each starting with filter type 0
+        std::vector<unsigned char> data;
+        data.reserve(filteredSize + filteredSize / MAX_STORED_BLOCK * 5 + 16);
+        data.push_back(0x78);
+        data.push_back(0x01);
+
+        uint32_t adlerA = 1, adlerB = 0;
+        size_t blockLeft = 0;
+        size_t written = 0;
+        auto append = [&](const unsigned char* bytes, size_t size)
+        {
+            while (size > 0)
+            {
+                if (blockLeft == 0)
+                {
+                    blockLeft = std::min(MAX_STORED_BLOCK, filteredSize - written);
+                    data.push_back(written + blockLeft == filteredSize ? 1 : 0);
+                    data.push_back(static_cast<unsigned char>(blockLeft));
+                    data.push_back(static_cast<unsigned char>(blockLeft >> 8));
+                    data.push_back(static_cast<unsigned char>(~blockLeft));
+                    data.push_back(static_cast<unsigned char>(~blockLeft >> 8));
+                }
+                const size_t count = std::min(size, blockLeft);
+                data.insert(data.end(), bytes, bytes + count);
+                for (size_t i = 0; i < count; i++)
+                {
+                    adlerA = (adlerA + bytes[i]) % 65521;
+                    adlerB = (adlerB + adlerA) % 65521;
+                }
+                bytes += count;
+                size -= count;
+                blockLeft -= count;
+                written += count;
+            }
+        };
+
+        const unsigned char filter = 0;
+        for (int y = 0; y < height; y++)
+        {
+            const int sourceRow = bottomRowFirst ? height - 1 - y : y;
+            append(&filter, 1);
+            append(rgbaPixels + sourceRow * row, row);
+        }
+        AppendBigEndian(data, adlerB << 16 | adlerA);
+
+        std::vector<unsigned char> file = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        file.reserve(data.size() + 64);
+        AppendChunk(file, "IHDR", header);
+        AppendChunk(file, "IDAT", data);
+        AppendChunk(file, "IEND", {});
+
+        std::ofstream stream(path, std::ios::binary);
+        stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+        return static_cast<bool>(stream);
+    }
+
+    bool ImageWriter::WriteRaw(const std::string& path, const int width, const int height, const unsigned char* rgbaPixels)
+    {
+        std::ofstream stream(path, std::ios::binary);
+        stream.write(reinterpret_cast<const char*>(rgbaPixels), static_cast<std::streamsize>(width) * height * 4);
+        return static_cast<bool>(stream);
+    }
+}  // namespace Utils
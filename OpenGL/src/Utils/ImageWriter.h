@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+
+namespace Utils
+{
+    /**
+     * \brief Writes RGBA8 images to disk without any dependencies. PNGs are written with stored
+     * deflate blocks, which makes them as large as the raw pixels but keeps writing them about as
+     * cheap as a copy, what frame dumps at full frame rate need
+     */
+    class ImageWriter
+    {
+    public:
+        /**
+         * \brief Write an uncompressed PNG
+         * \param path A string that is the path of the file
+         * \param width The width of the image
+         * \param height The height of the image
+         * \param rgbaPixels Four bytes per texel
+         * \param bottomRowFirst Whether the rows start at the bottom as OpenGL reads them, PNGs start at the top
+         * \return true if the file was written; false otherwise
+         */
+        static bool WritePNG(const std::string& path, int width, int height, const unsigned char* rgbaPixels, bool bottomRowFirst = true);
+
+        /**
+         * \brief Write the pixels as they are, without any header
+         * \param path A string that is the path of the file
+         * \param width The width of the image
+         * \param height The height of the image
+         * \param rgbaPixels Four bytes per texel
+         * \return true if the file was written; false otherwise
+         */
+        static bool WriteRaw(const std::string& path, int width, int height, const unsigned char* rgbaPixels);
+
+    };  // class ImageWriter
+}  // namespace Utils
@@ -0,0 +1,307 @@
+#include "Json.h"
+
+#include <cstdlib>
+
+namespace Utils
+{
+    namespace
+    {
+        // deep enough for any glTF file, shallow enough that the stack never runs out
+        constexpr int MAX_DEPTH = 128;
+
+        void SkipWhitespace(const std::string& text, size_t& position)
+        {
+            while (position < text.size() && (text[position] == ' ' || text[position] == '\t' || text[position] == '\n' || text[position] == '\r'))
+            {
+                position++;
+            }
+        }
+
+        bool ParseHex4(const std::string& text, const size_t position, unsigned int& value)
+        {
+            if (position + 4 > text.size())
+            {
+                return false;
+            }
+            value = 0;
+            for (size_t i = position; i < position + 4; i++)
+            {
+                const char digit = text[i];
+                value <<= 4;
+                if (digit >= '0' && digit <= '9') value |= digit - '0';
+                else if (digit >= 'a' && digit <= 'f') value |= digit - 'a' + 10;
+                else if (digit >= 'A' && digit <= 'F') value |= digit - 'A' + 10;
+                else return false;
+            }
+            return true;
+        }
+
+        void AppendUTF8(std::string& output, const unsigned int codePoint)
+        {
+            if (codePoint < 0x80)
+            {
+                output += static_cast<char>(codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                output += static_cast<char>(0xC0 | codePoint >> 6);
+                output += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000)
+            {
+                output += static_cast<char>(0xE0 | codePoint >> 12);
+                output += static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+                output += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                output += static_cast<char>(0xF0 | codePoint >> 18);
+                output += static_cast<char>(0x80 | (codePoint >> 12 & 0x3F));
+                output += static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+                output += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+        }
+    }  // namespace
+
+    JsonValue::JsonValue()
+        : m_Type(Type::Null), m_Bool(false), m_Number(0.0)
+    {
+    }
+
+    bool JsonValue::Parse(const std::string& text, JsonValue& value, std::string& error)
+    {
+        value = JsonValue();
+        size_t position = 0;
+        if (!value.ParseValue(text, position, error, 0))
+        {
+            return false;
+        }
+
+        SkipWhitespace(text, position);
+        if (position != text.size())
+        {
+            error = "unexpected text after the document at " + std::to_string(position);
+            return false;
+        }
+        return true;
+    }
+
+    size_t JsonValue::Size() const
+    {
+        switch (m_Type)
+        {
+            case Type::Array:  return m_Array.size();
+            case Type::Object: return m_Object.size();
+            default:           return 0;
+        }
+    }
+
+    const JsonValue& JsonValue::operator[](const size_t index) const
+    {
+        static const JsonValue null;
+        return m_Type == Type::Array && index < m_Array.size() ? m_Array[index] : null;
+    }
+
+    const JsonValue& JsonValue::operator[](const std::string& key) const
+    {
+        static const JsonValue null;
+        for (const auto& [name, member] : m_Object)
+        {
+            if (name == key)
+            {
+                return member;
+            }
+        }
+        return null;
+    }
+
+    bool JsonValue::ParseValue(const std::string& text, size_t& position, std::string& error, const int depth)
+    {
+        SkipWhitespace(text, position);
+        if (position >= text.size())
+        {
+            error = "unexpected end of the document";
+            return false;
+        }
+        if (depth > MAX_DEPTH)
+        {
+            error = "nested too deep at " + std::to_string(position);
+            return false;
+        }
+
+        const char first = text[position];
+        if (first == '{')
+        {
+            m_Type = Type::Object;
+            position++;
+            SkipWhitespace(text, position);
+            if (position < text.size() && text[position] == '}')
+            {
+                position++;
+                return true;
+            }
+            while (true)
+            {
+                SkipWhitespace(text, position);
+                std::string key;
+                if (!ParseString(text, position, key, error))
+                {
+                    return false;
+                }
+                SkipWhitespace(text, position);
+                if (position >= text.size() || text[position] != ':')
+                {
+                    error = "expected ':' at " + std::to_string(position);
+                    return false;
+                }
+                position++;
+
+                m_Object.emplace_back(std::move(key), JsonValue());
+                if (!m_Object.back().second.ParseValue(text, position, error, depth + 1))
+                {
+                    return false;
+                }
+
+                SkipWhitespace(text, position);
+                if (position < text.size() && text[position] == ',')
+                {
+                    position++;
+                }
+                else if (position < text.size() && text[position] == '}')
+                {
+                    position++;
+                    return true;
+                }
+                else
+                {
+                    error = "expected ',' or '}' at " + std::to_string(position);
+                    return false;
+                }
+            }
+        }
+        if (first == '[')
+        {
+            m_Type = Type::Array;
+            position++;
+            SkipWhitespace(text, position);
+            if (position < text.size() && text[position] == ']')
+            {
+                position++;
+                return true;
+            }
+            while (true)
+            {
+                m_Array.emplace_back();
+                if (!m_Array.back().ParseValue(text, position, error, depth + 1))
+                {
+                    return false;
+                }
+
+                SkipWhitespace(text, position);
+                if (position < text.size() && text[position] == ',')
+                {
+                    position++;
+                }
+                else if (position < text.size() && text[position] == ']')
+                {
+                    position++;
+                    return true;
+                }
+                else
+                {
+                    error = "expected ',' or ']' at " + std::to_string(position);
+                    return false;
+                }
+            }
+        }
+        if (first == '"')
+        {
+            m_Type = Type::String;
+            return ParseString(text, position, m_String, error);
+        }
+        if (text.compare(position, 4, "true") == 0 || text.compare(position, 5, "false") == 0)
+        {
+            m_Type = Type::Bool;
+            m_Bool = first == 't';
+            position += m_Bool ? 4 : 5;
+            return true;
+        }
+        if (text.compare(position, 4, "null") == 0)
+        {
+            m_Type = Type::Null;
+            position += 4;
+            return true;
+        }
+
+        char* end = nullptr;
+        m_Number = std::strtod(text.c_str() + position, &end);
+        if (end == text.c_str() + position)
+        {
+            error = "unexpected character at " + std::to_string(position);
+            return false;
+        }
+        m_Type = Type::Number;
+        position = static_cast<size_t>(end - text.c_str());
+        return true;
+    }
+
+    bool JsonValue::ParseString(const std::string& text, size_t& position, std::string& output, std::string& error)
+    {
+        if (position >= text.size() || text[position] != '"')
+        {
+            error = "expected a string at " + std::to_string(position);
+            return false;
+        }
+        position++;
+
+        while (position < text.size())
+        {
+            const char character = text[position++];
+            if (character == '"')
+            {
+                return true;
+            }
+            if (character != '\\')
+            {
+                output += character;
+                continue;
+            }
+            if (position >= text.size())
+            {
+                break;
+            }
+
+            const char escaped = text[position++];
+            switch (escaped)
+            {
+                case 'b': output += '\b'; break;
+                case 'f': output += '\f'; break;
+                case 'n': output += '\n'; break;
+                case 'r': output += '\r'; break;
+                case 't': output += '\t'; break;
+                case 'u':
+                {
+                    unsigned int codePoint = 0, low = 0;
+                    if (!ParseHex4(text, position, codePoint))
+                    {
+                        error = "bad escape at " + std::to_string(position);
+                        return false;
+                    }
+                    position += 4;
+                    // a surrogate pair spells one code point with two escapes
+                    if (codePoint >= 0xD800 && codePoint < 0xDC00 && text.compare(position, 2, "\\u") == 0 && ParseHex4(text, position + 2, low))
+                    {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        position += 6;
+                    }
+                    AppendUTF8(output, codePoint);
+                    break;
+                }
+                default: output += escaped; break;  // quotes, slashes and backslashes
+            }
+        }
+
+        error = "unterminated string";
+        return false;
+    }
+}  // namespace Utils
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Utils
+{
+    /**
+     * \brief A parsed JSON document, just enough for reading glTF files. Looking up a member or
+     * element that doesn't exist gives a null value instead of failing, so optional fields can be
+     * read with a fallback in one go
+     */
+    class JsonValue
+    {
+    public:
+        enum class Type
+        {
+            Null, Bool, Number, String, Array, Object
+        };
+
+    private:
+        Type m_Type;
+        bool m_Bool;
+        double m_Number;
+        std::string m_String;
+        std::vector<JsonValue> m_Array;
+        std::vector<std::pair<std::string, JsonValue>> m_Object;
+
+    public:
+        JsonValue();
+
+        /**
+         * \brief Parse a JSON document
+         * \param text The document
+         * \param value Receives the root value
+         * \param error Receives what went wrong and where
+         * \return true if the document was parsed; false otherwise
+         */
+        static bool Parse(const std::string& text, JsonValue& value, std::string& error);
+
+        inline Type GetType() const { return m_Type; }
+        inline bool IsNull() const { return m_Type == Type::Null; }
+
+        /**
+         * \brief Get the value as a number
+         * \param fallback Returned if the value isn't a number
+         * \return The number
+         */
+        inline double AsNumber(const double fallback = 0.0) const { return m_Type == Type::Number ? m_Number : fallback; }
+
+        /**
+         * \brief Get the value as an integer
+         * \param fallback Returned if the value isn't a number
+         * \return The number cut to an integer
+         */
+        inline int AsInt(const int fallback = 0) const { return m_Type == Type::Number ? static_cast<int>(m_Number) : fallback; }
+
+        /**
+         * \brief Get the value as a bool
+         * \param fallback Returned if the value isn't a bool
+         * \return The bool
+         */
+        inline bool AsBool(const bool fallback = false) const { return m_Type == Type::Bool ? m_Bool : fallback; }
+
+        /**
+         * \brief Get the value as a string
+         * \return The string, empty if the value isn't one
+         */
+        inline const std::string& AsString() const { return m_String; }
+
+        /**
+         * \brief Get the number of elements of an array or members of an object
+         * \return The size, 0 for every other type
+         */
+        size_t Size() const;
+
+        /**
+         * \brief Get an element of an array
+         * \param index Which element
+         * \return The element, or a null value if there is none
+         */
+        const JsonValue& operator[](size_t index) const;
+
+        /**
+         * \brief Get a member of an object
+         * \param key The name of the member
+         * \return The member, or a null value if there is none
+         */
+        const JsonValue& operator[](const std::string& key) const;
+
+        /**
+         * \brief Get the members of an object in the order they were written
+         * \return The members, empty if the value isn't an object
+         */
+        inline const std::vector<std::pair<std::string, JsonValue>>& GetMembers() const { return m_Object; }
+
+    private:
+        // Parses one value starting at position, leaving position after it
+        bool ParseValue(const std::string& text, size_t& position, std::string& error, int depth);
+
+        static bool ParseString(const std::string& text, size_t& position, std::string& output, std::string& error);
+
+    };  // class JsonValue
+}  // namespace Utils
@@ -0,0 +1,1118 @@
+#include "MeshImporter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+#include "Json.h"
+#include "ThreadPool.h"
+
+namespace Utils
+{
+    namespace
+    {
+        // OBJ files are split into chunks of about this many bytes, one per parallel task
+        constexpr size_t OBJ_CHUNK_SIZE = 512 * 1024;
+
+        // glTF node hierarchies deeper than this are treated as cycles
+        constexpr int MAX_NODE_DEPTH = 64;
+
+        constexpr unsigned int EMPTY_SLOT = std::numeric_limits<unsigned int>::max();
+
+        static_assert(sizeof(MeshVertex) == 8 * sizeof(float), "MeshVertex is welded bit for bit and must not have padding");
+
+        void ParallelFor(ThreadPool* threadPool, const unsigned int count, const std::function<void(unsigned int)>& body)
+        {
+            if (threadPool)
+            {
+                threadPool->ParallelFor(count, body);
+                return;
+            }
+            for (unsigned int i = 0; i < count; i++)
+            {
+                body(i);
+            }
+        }
+
+        bool ReadFile(const std::string& path, std::string& contents)
+        {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file.is_open())
+            {
+                return false;
+            }
+            const std::streamoff size = file.tellg();
+            if (size < 0)
+            {
+                return false;
+            }
+            contents.resize(static_cast<size_t>(size));
+            file.seekg(0);
+            return size == 0 || file.read(&contents[0], size).good();
+        }
+
+        uint64_t Mix(uint64_t hash)
+        {
+            hash ^= hash >> 33;
+            hash *= 0xff51afd7ed558ccdull;
+            hash ^= hash >> 33;
+            hash *= 0xc4ceb9fe1a85ec53ull;
+            hash ^= hash >> 33;
+            return hash;
+        }
+
+        // Gives every key the index of the first equal key in unique, through an open addressing
+        // table that is kept under two thirds full. remap receives the index into unique of every key
+        template<typename Key, typename Hasher, typename Equal>
+        void WeldKeys(const Key* keys, const size_t count, Hasher hash, Equal equal,
+                      std::vector<unsigned int>& remap, std::vector<unsigned int>& unique)
+        {
+            size_t capacity = 16;
+            while (capacity < count + count / 2)
+            {
+                capacity <<= 1;
+            }
+            const size_t mask = capacity - 1;
+            std::vector<unsigned int> table(capacity, EMPTY_SLOT);
+
+            remap.resize(count);
+            unique.clear();
+            for (size_t i = 0; i < count; i++)
+            {
+                size_t slot = static_cast<size_t>(hash(keys[i])) & mask;
+                while (true)
+                {
+                    const unsigned int candidate = table[slot];
+                    if (candidate == EMPTY_SLOT)
+                    {
+                        table[slot] = static_cast<unsigned int>(unique.size());
+                        remap[i] = table[slot];
+                        unique.push_back(static_cast<unsigned int>(i));
+                        break;
+                    }
+                    if (equal(keys[unique[candidate]], keys[i]))
+                    {
+                        remap[i] = candidate;
+                        break;
+                    }
+                    slot = (slot + 1) & mask;
+                }
+            }
+        }
+
+        // OBJ ------------------------------------------------------------------------------------
+
+        struct ObjCorner
+        {
+            int index[3];          // position, texture coordinate and normal, -1 if missing
+            unsigned int relative; // bit per index that still counts back from the end of its chunk
+        };
+
+        struct ObjChunk
+        {
+            const char* begin = nullptr;
+            const char* end = nullptr;
+
+            std::vector<glm::vec3> positions;
+            std::vector<glm::vec2> texCoords;
+            std::vector<glm::vec3> normals;
+            std::vector<ObjCorner> corners;  // three per triangle
+            std::vector<ObjCorner> polygon;
+
+            unsigned int lineCount = 0;
+            unsigned int errorLine = 0;      // 1 based within the chunk, 0 if the chunk parsed
+            const char* error = nullptr;
+        };
+
+        inline bool IsDigit(const char c)
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        inline const char* SkipSpaces(const char* p, const char* end)
+        {
+            while (p < end && (*p == ' ' || *p == '\t'))
+            {
+                p++;
+            }
+            return p;
+        }
+
+        double PowerOf10(const int exponent)
+        {
+            static const double table[] = {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+            return exponent < 23 ? table[exponent] : std::pow(10.0, exponent);
+        }
+
+        // Much faster than strtod, which also looks up the locale on every call. Exact to the
+        // precision of a float, returns nullptr if there is no number at p
+        const char* ParseFloat(const char* p, const char* end, float& value)
+        {
+            p = SkipSpaces(p, end);
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+'))
+            {
+                negative = *p == '-';
+                p++;
+            }
+
+            uint64_t mantissa = 0;
+            int digits = 0;
+            int exponent = 0;
+            bool any = false;
+            for (; p < end && IsDigit(*p); p++, any = true)
+            {
+                if (digits < 19)
+                {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    digits += mantissa != 0;
+                }
+                else
+                {
+                    exponent++;
+                }
+            }
+            if (p < end && *p == '.')
+            {
+                for (p++; p < end && IsDigit(*p); p++, any = true)
+                {
+                    if (digits < 19)
+                    {
+                        mantissa = mantissa * 10 + (*p - '0');
+                        digits += mantissa != 0;
+                        exponent--;
+                    }
+                }
+            }
+            if (!any)
+            {
+                return nullptr;
+            }
+            if (p < end && (*p == 'e' || *p == 'E'))
+            {
+                p++;
+                bool negativeExponent = false;
+                if (p < end && (*p == '-' || *p == '+'))
+                {
+                    negativeExponent = *p == '-';
+                    p++;
+                }
+                int written = 0;
+                for (; p < end && IsDigit(*p); p++)
+                {
+                    written = std::min(written * 10 + (*p - '0'), 10000);
+                }
+                exponent += negativeExponent ? -written : written;
+            }
+
+            double result = static_cast<double>(mantissa);
+            result = exponent < 0 ? result / PowerOf10(-exponent) : result * PowerOf10(exponent);
+            value = static_cast<float>(negative ? -result : result);
+            return p;
+        }
+
+        const char* ParseInt(const char* p, const char* end, int& value)
+        {
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+'))
+            {
+                negative = *p == '-';
+                p++;
+            }
+            if (p >= end || !IsDigit(*p))
+            {
+                return nullptr;
+            }
+            int64_t result = 0;
+            for (; p < end && IsDigit(*p); p++)
+            {
+                result = std::min<int64_t>(result * 10 + (*p - '0'), std::numeric_limits<int>::max());
+            }
+            value = static_cast<int>(negative ? -result : result);
+            return p;
+        }
+
+        // Parses "v", "v/vt", "v//vn" or "v/vt/vn". Indices are 1 based and negative ones count
+        // back from the last element read so far, which a chunk only knows relative to itself
+        const char* ParseCorner(const char* p, const char* end, const ObjChunk& chunk, ObjCorner& corner)
+        {
+            const size_t counts[3] = { chunk.positions.size(), chunk.texCoords.size(), chunk.normals.size() };
+            corner.index[0] = corner.index[1] = corner.index[2] = -1;
+            corner.relative = 0;
+
+            for (int slot = 0; slot < 3; slot++)
+            {
+                if (slot > 0)
+                {
+                    if (p >= end || *p != '/')
+                    {
+                        break;
+                    }
+                    p++;
+                    if (slot == 1 && p < end && *p == '/')
+                    {
+                        continue;
+                    }
+                }
+                int value;
+                p = ParseInt(p, end, value);
+                if (!p || value == 0)
+                {
+                    return nullptr;
+                }
+                if (value > 0)
+                {
+                    corner.index[slot] = value - 1;
+                }
+                else
+                {
+                    corner.index[slot] = static_cast<int>(counts[slot]) + value;
+                    corner.relative |= 1u << slot;
+                }
+            }
+            return p;
+        }
+
+        bool ParseObjLine(const char* p, const char* end, ObjChunk& chunk)
+        {
+            p = SkipSpaces(p, end);
+            if (end - p < 2 || (p[0] != 'v' && p[0] != 'f'))
+            {
+                return true;  // comments, groups, materials and smoothing groups are skipped
+            }
+
+            if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+            {
+                glm::vec3 position;
+                for (int i = 0; i < 3; i++)
+                {
+                    if (!(p = ParseFloat(i == 0 ? p + 1 : p, end, position[i])))
+                    {
+                        return false;
+                    }
+                }
+                chunk.positions.push_back(position);  // vertex colours after the position are ignored
+            }
+            else if (p[0] == 'v' && p[1] == 't')
+            {
+                glm::vec2 texCoord(0.0f);
+                if (!(p = ParseFloat(p + 2, end, texCoord.x)))
+                {
+                    return false;
+                }
+                ParseFloat(p, end, texCoord.y);  // the second and third coordinate are optional
+                chunk.texCoords.push_back(texCoord);
+            }
+            else if (p[0] == 'v' && p[1] == 'n')
+            {
+                glm::vec3 normal;
+                p += 2;
+                for (int i = 0; i < 3; i++)
+                {
+                    if (!(p = ParseFloat(p, end, normal[i])))
+                    {
+                        return false;
+                    }
+                }
+                chunk.normals.push_back(normal);
+            }
+            else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+            {
+                chunk.polygon.clear();
+                for (p = SkipSpaces(p + 1, end); p < end && *p != '#'; p = SkipSpaces(p, end))
+                {
+                    ObjCorner corner;
+                    if (!(p = ParseCorner(p, end, chunk, corner)) || (p < end && *p != ' ' && *p != '\t'))
+                    {
+                        return false;
+                    }
+                    chunk.polygon.push_back(corner);
+                }
+                if (chunk.polygon.size() < 3)
+                {
+                    return false;
+                }
+                // Polygons are assumed to be convex, as every exporter writes them
+                for (size_t i = 1; i + 1 < chunk.polygon.size(); i++)
+                {
+                    chunk.corners.push_back(chunk.polygon[0]);
+                    chunk.corners.push_back(chunk.polygon[i]);
+                    chunk.corners.push_back(chunk.polygon[i + 1]);
+                }
+            }
+            return true;
+        }
+
+        void ParseObjChunk(ObjChunk& chunk)
+        {
+            // A rough guess from the size of a typical line saves most of the reallocations
+            const size_t size = chunk.end - chunk.begin;
+            chunk.positions.reserve(size / 64);
+            chunk.corners.reserve(size / 16);
+
+            for (const char* line = chunk.begin; line < chunk.end;)
+            {
+                const char* newline = static_cast<const char*>(std::memchr(line, '\n', chunk.end - line));
+                const char* lineEnd = newline ? newline : chunk.end;
+                const char* trimmedEnd = lineEnd > line && lineEnd[-1] == '\r' ? lineEnd - 1 : lineEnd;
+                chunk.lineCount++;
+
+                if (!ParseObjLine(line, trimmedEnd, chunk))
+                {
+                    chunk.errorLine = chunk.lineCount;
+                    chunk.error = "malformed line";
+                    return;
+                }
+                line = lineEnd + 1;
+            }
+        }
+
+        // glTF -----------------------------------------------------------------------------------
+
+        enum ComponentType
+        {
+            BYTE = 5120, UNSIGNED_BYTE = 5121, SHORT = 5122, UNSIGNED_SHORT = 5123, UNSIGNED_INT = 5125, FLOAT = 5126
+        };
+
+        enum PrimitiveMode
+        {
+            TRIANGLES = 4, TRIANGLE_STRIP = 5, TRIANGLE_FAN = 6
+        };
+
+        struct Accessor
+        {
+            const unsigned char* data = nullptr;
+            size_t count = 0;
+            size_t stride = 0;
+            int componentType = 0;
+            int components = 0;
+            bool normalized = false;
+        };
+
+        struct GLTFPrimitive
+        {
+            const JsonValue* primitive;
+            glm::mat4 transform;
+            std::vector<MeshVertex> vertices;
+            std::vector<unsigned int> indices;
+            std::string error;
+        };
+
+        bool DecodeBase64(const char* text, const size_t size, std::string& output)
+        {
+            static const auto table = []
+            {
+                std::vector<int> values(256, -1);
+                const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+                for (int i = 0; i < 64; i++)
+                {
+                    values[static_cast<unsigned char>(alphabet[i])] = i;
+                }
+                return values;
+            }();
+
+            output.clear();
+            output.reserve(size / 4 * 3);
+            unsigned int bits = 0;
+            int bitCount = 0;
+            for (size_t i = 0; i < size && text[i] != '='; i++)
+            {
+                const int value = table[static_cast<unsigned char>(text[i])];
+                if (value < 0)
+                {
+                    return false;
+                }
+                bits = bits << 6 | value;
+                bitCount += 6;
+                if (bitCount >= 8)
+                {
+                    bitCount -= 8;
+                    output += static_cast<char>(bits >> bitCount & 0xFF);
+                }
+            }
+            return true;
+        }
+
+        std::string DecodeURI(const std::string& uri)
+        {
+            std::string output;
+            for (size_t i = 0; i < uri.size(); i++)
+            {
+                unsigned int value;
+                if (uri[i] == '%' && i + 2 < uri.size() && std::sscanf(uri.c_str() + i + 1, "%2x", &value) == 1)
+                {
+                    output += static_cast<char>(value);
+                    i += 2;
+                }
+                else
+                {
+                    output += uri[i];
+                }
+            }
+            return output;
+        }
+
+        size_t GetComponentSize(const int componentType)
+        {
+            switch (componentType)
+            {
+            case BYTE: case UNSIGNED_BYTE: return 1;
+            case SHORT: case UNSIGNED_SHORT: return 2;
+            case UNSIGNED_INT: case FLOAT: return 4;
+            default: return 0;
+            }
+        }
+
+        bool GetAccessor(const JsonValue& gltf, const std::vector<std::string>& buffers, const int index, Accessor& accessor, std::string& error)
+        {
+            const JsonValue& json = gltf["accessors"][index];
+            if (json.IsNull())
+            {
+                error = "accessor " + std::to_string(index) + " doesn't exist";
+                return false;
+            }
+            if (!json["sparse"].IsNull())
+            {
+                error = "sparse accessors aren't supported";
+                return false;
+            }
+            const JsonValue& bufferView = gltf["bufferViews"][json["bufferView"].AsInt(-1)];
+            const int buffer = bufferView["buffer"].AsInt(-1);
+            if (bufferView.IsNull() || buffer < 0 || buffer >= static_cast<int>(buffers.size()))
+            {
+                error = "accessor " + std::to_string(index) + " has no buffer";
+                return false;
+            }
+
+            const std::string& type = json["type"].AsString();
+            accessor.components = type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3 : type == "VEC4" ? 4 : 0;
+            accessor.componentType = json["componentType"].AsInt();
+            accessor.normalized = json["normalized"].AsBool();
+            accessor.count = static_cast<size_t>(std::max(json["count"].AsNumber(), 0.0));
+            const size_t elementSize = accessor.components * GetComponentSize(accessor.componentType);
+            if (elementSize == 0)
+            {
+                error = "accessor " + std::to_string(index) + " has an unknown type";
+                return false;
+            }
+            accessor.stride = std::max<size_t>(bufferView["byteStride"].AsInt(0), elementSize);
+
+            const size_t viewOffset = static_cast<size_t>(std::max(bufferView["byteOffset"].AsNumber(), 0.0));
+            const size_t viewLength = static_cast<size_t>(std::max(bufferView["byteLength"].AsNumber(), 0.0));
+            const size_t offset = static_cast<size_t>(std::max(json["byteOffset"].AsNumber(), 0.0));
+            const size_t size = accessor.count == 0 ? 0 : offset + accessor.stride * (accessor.count - 1) + elementSize;
+            if (viewOffset + viewLength > buffers[buffer].size() || size > viewLength)
+            {
+                error = "accessor " + std::to_string(index) + " reaches past its buffer";
+                return false;
+            }
+            accessor.data = reinterpret_cast<const unsigned char*>(buffers[buffer].data()) + viewOffset + offset;
+            return true;
+        }
+
+        float ReadComponent(const Accessor& accessor, const size_t element, const int component)
+        {
+            const unsigned char* data = accessor.data + element * accessor.stride + component * GetComponentSize(accessor.componentType);
+            switch (accessor.componentType)
+            {
+            case FLOAT:
+            {
+                float value;
+                std::memcpy(&value, data, sizeof(value));
+                return value;
+            }
+            case UNSIGNED_BYTE:
+                return accessor.normalized ? *data / 255.0f : *data;
+            case BYTE:
+            {
+                const float value = static_cast<signed char>(*data);
+                return accessor.normalized ? std::max(value / 127.0f, -1.0f) : value;
+            }
+            case UNSIGNED_SHORT:
+            {
+                uint16_t value;
+                std::memcpy(&value, data, sizeof(value));
+                return accessor.normalized ? value / 65535.0f : value;
+            }
+            case SHORT:
+            {
+                int16_t value;
+                std::memcpy(&value, data, sizeof(value));
+                return accessor.normalized ? std::max(value / 32767.0f, -1.0f) : value;
+            }
+            default:
+                return 0.0f;
+            }
+        }
+
+        unsigned int ReadIndex(const Accessor& accessor, const size_t element)
+        {
+            const unsigned char* data = accessor.data + element * accessor.stride;
+            switch (accessor.componentType)
+            {
+            case UNSIGNED_BYTE:
+                return *data;
+            case UNSIGNED_SHORT:
+            {
+                uint16_t value;
+                std::memcpy(&value, data, sizeof(value));
+                return value;
+            }
+            default:
+            {
+                uint32_t value;
+                std::memcpy(&value, data, sizeof(value));
+                return value;
+            }
+            }
+        }
+
+        glm::mat4 GetNodeTransform(const JsonValue& node)
+        {
+            const JsonValue& matrix = node["matrix"];
+            if (matrix.Size() == 16)
+            {
+                glm::mat4 transform;
+                for (int i = 0; i < 16; i++)
+                {
+                    transform[i / 4][i % 4] = static_cast<float>(matrix[i].AsNumber());  // column major, like GLM
+                }
+                return transform;
+            }
+
+            const JsonValue& t = node["translation"];
+            const JsonValue& r = node["rotation"];
+            const JsonValue& s = node["scale"];
+            const glm::vec3 translation(t[0].AsNumber(), t[1].AsNumber(), t[2].AsNumber());
+            const glm::quat rotation(static_cast<float>(r[3].AsNumber(1.0)), static_cast<float>(r[0].AsNumber()),
+                                     static_cast<float>(r[1].AsNumber()), static_cast<float>(r[2].AsNumber()));
+            const glm::vec3 scale(s[0].AsNumber(1.0), s[1].AsNumber(1.0), s[2].AsNumber(1.0));
+            return glm::scale(glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation), scale);
+        }
+
+        void CollectNode(const JsonValue& gltf, const int index, const glm::mat4& parent, const int depth, std::vector<GLTFPrimitive>& primitives)
+        {
+            const JsonValue& node = gltf["nodes"][index];
+            if (node.IsNull() || depth > MAX_NODE_DEPTH)
+            {
+                return;
+            }
+            const glm::mat4 transform = parent * GetNodeTransform(node);
+
+            const JsonValue& mesh = gltf["meshes"][node["mesh"].AsInt(-1)];
+            for (size_t i = 0; i < mesh["primitives"].Size(); i++)
+            {
+                primitives.push_back({ &mesh["primitives"][i], transform, {}, {}, {} });
+            }
+            const JsonValue& children = node["children"];
+            for (size_t i = 0; i < children.Size(); i++)
+            {
+                CollectNode(gltf, children[i].AsInt(-1), transform, depth + 1, primitives);
+            }
+        }
+
+        bool ReadPrimitive(const JsonValue& gltf, const std::vector<std::string>& buffers, GLTFPrimitive& output)
+        {
+            const JsonValue& primitive = *output.primitive;
+            const int mode = primitive["mode"].AsInt(TRIANGLES);
+            if (mode != TRIANGLES && mode != TRIANGLE_STRIP && mode != TRIANGLE_FAN)
+            {
+                return true;  // points and lines have no place in a triangle mesh
+            }
+
+            const JsonValue& attributes = primitive["attributes"];
+            Accessor positions, texCoords, normals;
+            if (!GetAccessor(gltf, buffers, attributes["POSITION"].AsInt(-1), positions, output.error))
+            {
+                return false;
+            }
+            if (positions.components != 3 || positions.componentType != FLOAT)
+            {
+                output.error = "positions must be float vec3";
+                return false;
+            }
+            const bool hasTexCoords = !attributes["TEXCOORD_0"].IsNull();
+            if (hasTexCoords && (!GetAccessor(gltf, buffers, attributes["TEXCOORD_0"].AsInt(), texCoords, output.error) ||
+                                 texCoords.components != 2 || texCoords.count < positions.count))
+            {
+                output.error = output.error.empty() ? "texture coordinates don't match the positions" : output.error;
+                return false;
+            }
+            const bool hasNormals = !attributes["NORMAL"].IsNull();
+            if (hasNormals && (!GetAccessor(gltf, buffers, attributes["NORMAL"].AsInt(), normals, output.error) ||
+                               normals.components != 3 || normals.count < positions.count))
+            {
+                output.error = output.error.empty() ? "normals don't match the positions" : output.error;
+                return false;
+            }
+
+            const glm::mat3 normalTransform = glm::transpose(glm::inverse(glm::mat3(output.transform)));
+            output.vertices.resize(positions.count);
+            for (size_t i = 0; i < positions.count; i++)
+            {
+                MeshVertex& vertex = output.vertices[i];
+                const glm::vec3 position(ReadComponent(positions, i, 0), ReadComponent(positions, i, 1), ReadComponent(positions, i, 2));
+                vertex.position = glm::vec3(output.transform * glm::vec4(position, 1.0f));
+                // glTF puts (0, 0) at the top left of the image, the textures here are uploaded bottom up
+                vertex.texCoord = hasTexCoords ? glm::vec2(ReadComponent(texCoords, i, 0), 1.0f - ReadComponent(texCoords, i, 1)) : glm::vec2(0.0f);
+                vertex.normal = glm::vec3(0.0f);
+                if (hasNormals)
+                {
+                    const glm::vec3 normal = normalTransform * glm::vec3(ReadComponent(normals, i, 0), ReadComponent(normals, i, 1), ReadComponent(normals, i, 2));
+                    const float length = glm::length(normal);
+                    vertex.normal = length > 0.0f ? normal / length : normal;
+                }
+            }
+
+            std::vector<unsigned int> elements;
+            if (!primitive["indices"].IsNull())
+            {
+                Accessor indices;
+                if (!GetAccessor(gltf, buffers, primitive["indices"].AsInt(), indices, output.error))
+                {
+                    return false;
+                }
+                if (indices.components != 1 || indices.componentType == BYTE || indices.componentType == SHORT || indices.componentType == FLOAT)
+                {
+                    output.error = "indices must be unsigned integers";
+                    return false;
+                }
+                elements.resize(indices.count);
+                for (size_t i = 0; i < indices.count; i++)
+                {
+                    elements[i] = ReadIndex(indices, i);
+                    if (elements[i] >= positions.count)
+                    {
+                        output.error = "index out of range";
+                        return false;
+                    }
+                }
+            }
+            else
+            {
+                elements.resize(positions.count);
+                for (size_t i = 0; i < positions.count; i++)
+                {
+                    elements[i] = static_cast<unsigned int>(i);
+                }
+            }
+
+            if (mode == TRIANGLES)
+            {
+                elements.resize(elements.size() / 3 * 3);
+                output.indices = std::move(elements);
+            }
+            else
+            {
+                for (size_t i = 2; i < elements.size(); i++)
+                {
+                    const bool odd = mode == TRIANGLE_STRIP && (i & 1);
+                    const unsigned int first = mode == TRIANGLE_FAN ? elements[0] : elements[i - 2];
+                    output.indices.push_back(odd ? elements[i - 1] : first);
+                    output.indices.push_back(odd ? first : elements[i - 1]);
+                    output.indices.push_back(elements[i]);
+                }
+            }
+
+            // A mirroring transform turns counter-clockwise triangles clockwise
+            if (glm::determinant(glm::mat3(output.transform)) < 0.0f)
+            {
+                for (size_t i = 0; i < output.indices.size(); i += 3)
+                {
+                    std::swap(output.indices[i + 1], output.indices[i + 2]);
+                }
+            }
+            return true;
+        }
+    }
+
+    bool MeshImporter::Import(const std::string& path, MeshData& mesh, ThreadPool* threadPool)
+    {
+        mesh = MeshData();
+
+        std::string extension = path.substr(std::min(path.find_last_of('.'), path.size()));
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        std::string file, error;
+        bool imported = false;
+        if (!ReadFile(path, file))
+        {
+            error = "can't read the file";
+        }
+        else if (extension == ".obj")
+        {
+            imported = ImportOBJ(file, mesh, threadPool, error);
+        }
+        else if (extension == ".gltf" || extension == ".glb")
+        {
+            imported = ImportGLTF(path, file, mesh, threadPool, error);
+        }
+        else
+        {
+            error = "unknown extension";
+        }
+
+        if (!imported)
+        {
+            std::cout << "ERROR::MESH_IMPORTER::IMPORT_FAILED " << path << ": " << error << std::endl;
+            mesh = MeshData();
+            return false;
+        }
+        ComputeBounds(mesh);
+        return true;
+    }
+
+    void MeshImporter::Weld(MeshData& mesh)
+    {
+        std::vector<unsigned int> remap, unique;
+        WeldKeys(mesh.vertices.data(), mesh.vertices.size(),
+                 [](const MeshVertex& vertex)
+                 {
+                     uint32_t words[8];
+                     std::memcpy(words, &vertex, sizeof(words));
+                     uint64_t hash = 0;
+                     for (const uint32_t word : words)
+                     {
+                         hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+                     }
+                     return Mix(hash);
+                 },
+                 [](const MeshVertex& a, const MeshVertex& b) { return std::memcmp(&a, &b, sizeof(MeshVertex)) == 0; },
+                 remap, unique);
+
+        std::vector<MeshVertex> vertices(unique.size());
+        for (size_t i = 0; i < unique.size(); i++)
+        {
+            vertices[i] = mesh.vertices[unique[i]];
+        }
+        for (unsigned int& index : mesh.indices)
+        {
+            index = remap[index];
+        }
+        mesh.vertices = std::move(vertices);
+    }
+
+    void MeshImporter::ComputeNormals(MeshData& mesh)
+    {
+        std::vector<glm::vec3> sums(mesh.vertices.size(), glm::vec3(0.0f));
+        std::vector<bool> missing(mesh.vertices.size());
+        bool any = false;
+        for (size_t i = 0; i < mesh.vertices.size(); i++)
+        {
+            missing[i] = mesh.vertices[i].normal == glm::vec3(0.0f);
+            any = any || missing[i];
+        }
+        if (!any)
+        {
+            return;
+        }
+
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        {
+            const unsigned int* triangle = &mesh.indices[i];
+            const glm::vec3& a = mesh.vertices[triangle[0]].position;
+            // Not normalized, so larger triangles weigh more
+            const glm::vec3 normal = glm::cross(mesh.vertices[triangle[1]].position - a, mesh.vertices[triangle[2]].position - a);
+            for (int corner = 0; corner < 3; corner++)
+            {
+                if (missing[triangle[corner]])
+                {
+                    sums[triangle[corner]] += normal;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < mesh.vertices.size(); i++)
+        {
+            if (missing[i])
+            {
+                const float length = glm::length(sums[i]);
+                mesh.vertices[i].normal = length > 0.0f ? sums[i] / length : glm::vec3(0.0f, 0.0f, 1.0f);
+            }
+        }
+    }
+
+    void MeshImporter::ComputeBounds(MeshData& mesh)
+    {
+        if (mesh.vertices.empty())
+        {
+            mesh.boundsMin = mesh.boundsMax = glm::vec3(0.0f);
+            return;
+        }
+        mesh.boundsMin = mesh.boundsMax = mesh.vertices[0].position;
+        for (const MeshVertex& vertex : mesh.vertices)
+        {
+            mesh.boundsMin = glm::min(mesh.boundsMin, vertex.position);
+            mesh.boundsMax = glm::max(mesh.boundsMax, vertex.position);
+        }
+    }
+
+    bool MeshImporter::ImportOBJ(const std::string& text, MeshData& mesh, ThreadPool* threadPool, std::string& error)
+    {
+        // Chunks end after a newline so no line is split between two of them
+        std::vector<ObjChunk> chunks(std::max<size_t>(text.size() / OBJ_CHUNK_SIZE, 1));
+        const char* begin = text.data();
+        const char* end = text.data() + text.size();
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            chunks[i].begin = i == 0 ? begin : chunks[i - 1].end;
+            const char* split = i + 1 == chunks.size() ? end : std::max(begin + text.size() / chunks.size() * (i + 1), chunks[i].begin);
+            const char* newline = split < end ? static_cast<const char*>(std::memchr(split, '\n', end - split)) : nullptr;
+            chunks[i].end = i + 1 == chunks.size() || !newline ? end : newline + 1;
+        }
+
+        ParallelFor(threadPool, static_cast<unsigned int>(chunks.size()), [&chunks](const unsigned int i) { ParseObjChunk(chunks[i]); });
+
+        // Where each chunk's elements start in the whole file, to resolve the indices against
+        std::vector<glm::ivec3> bases(chunks.size());
+        glm::ivec3 totals(0);
+        unsigned int lines = 0;
+        size_t cornerCount = 0;
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            if (chunks[i].error)
+            {
+                error = std::string(chunks[i].error) + " at line " + std::to_string(lines + chunks[i].errorLine);
+                return false;
+            }
+            bases[i] = totals;
+            totals += glm::ivec3(chunks[i].positions.size(), chunks[i].texCoords.size(), chunks[i].normals.size());
+            lines += chunks[i].lineCount;
+            cornerCount += chunks[i].corners.size();
+        }
+        if (cornerCount > std::numeric_limits<unsigned int>::max())
+        {
+            error = "too many triangles";
+            return false;
+        }
+
+        std::vector<ObjCorner> corners(cornerCount);
+        std::vector<size_t> cornerOffsets(chunks.size(), 0);
+        for (size_t i = 1; i < chunks.size(); i++)
+        {
+            cornerOffsets[i] = cornerOffsets[i - 1] + chunks[i - 1].corners.size();
+        }
+        std::atomic<bool> outOfRange(false);
+        ParallelFor(threadPool, static_cast<unsigned int>(chunks.size()), [&](const unsigned int i)
+        {
+            ObjCorner* output = corners.data() + cornerOffsets[i];
+            for (ObjCorner corner : chunks[i].corners)
+            {
+                for (int slot = 0; slot < 3; slot++)
+                {
+                    if (corner.relative & 1u << slot)
+                    {
+                        corner.index[slot] += bases[i][slot];
+                    }
+                    const bool required = slot == 0;
+                    if ((required || corner.index[slot] != -1) && (corner.index[slot] < 0 || corner.index[slot] >= totals[slot]))
+                    {
+                        outOfRange = true;
+                    }
+                }
+                corner.relative = 0;
+                *output++ = corner;
+            }
+            chunks[i].corners = std::vector<ObjCorner>();
+        });
+        if (outOfRange)
+        {
+            error = "index out of range";
+            return false;
+        }
+
+        // Equal index triples are the same vertex, so they can be welded without looking at the data
+        std::vector<unsigned int> unique;
+        WeldKeys(corners.data(), corners.size(),
+                 [](const ObjCorner& corner)
+                 {
+                     return Mix(static_cast<uint64_t>(corner.index[0]) << 42 ^ static_cast<uint64_t>(corner.index[1] + 1) << 21 ^
+                                static_cast<uint64_t>(corner.index[2] + 1));
+                 },
+                 [](const ObjCorner& a, const ObjCorner& b)
+                 {
+                     return a.index[0] == b.index[0] && a.index[1] == b.index[1] && a.index[2] == b.index[2];
+                 },
+                 mesh.indices, unique);
+
+        std::vector<glm::vec3> positions, normals;
+        std::vector<glm::vec2> texCoords;
+        positions.reserve(totals.x);
+        texCoords.reserve(totals.y);
+        normals.reserve(totals.z);
+        for (const ObjChunk& chunk : chunks)
+        {
+            positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+            texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+            normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+        }
+
+        mesh.vertices.resize(unique.size());
+        for (size_t i = 0; i < unique.size(); i++)
+        {
+            const ObjCorner& corner = corners[unique[i]];
+            MeshVertex& vertex = mesh.vertices[i];
+            vertex.position = positions[corner.index[0]];
+            vertex.texCoord = corner.index[1] >= 0 ? texCoords[corner.index[1]] : glm::vec2(0.0f);
+            vertex.normal = corner.index[2] >= 0 ? normals[corner.index[2]] : glm::vec3(0.0f);
+        }
+        ComputeNormals(mesh);
+        return true;
+    }
+
+    bool MeshImporter::ImportGLTF(const std::string& path, const std::string& file, MeshData& mesh, ThreadPool* threadPool, std::string& error)
+    {
+        // A .glb file is a header, a JSON chunk and optionally a binary chunk used as the first buffer
+        std::string json, binary;
+        bool hasBinary = false;
+        if (file.size() >= 12 && file.compare(0, 4, "glTF") == 0)
+        {
+            uint32_t header[3];
+            std::memcpy(header, file.data(), sizeof(header));
+            const size_t length = std::min<size_t>(header[2], file.size());
+            for (size_t offset = 12; offset + 8 <= length;)
+            {
+                uint32_t chunk[2];
+                std::memcpy(chunk, file.data() + offset, sizeof(chunk));
+                offset += 8;
+                if (chunk[0] > length - offset)
+                {
+                    error = "truncated chunk";
+                    return false;
+                }
+                if (chunk[1] == 0x4E4F534A)  // "JSON"
+                {
+                    json.assign(file, offset, chunk[0]);
+                }
+                else if (chunk[1] == 0x004E4942 && !hasBinary)  // "BIN\0"
+                {
+                    binary.assign(file, offset, chunk[0]);
+                    hasBinary = true;
+                }
+                offset += (chunk[0] + 3) & ~3u;
+            }
+        }
+        else
+        {
+            json = file;
+        }
+
+        JsonValue gltf;
+        if (!JsonValue::Parse(json, gltf, error))
+        {
+            return false;
+        }
+
+        const size_t slash = path.find_last_of("/\\");
+        const std::string directory = slash == std::string::npos ? "" : path.substr(0, slash + 1);
+        std::vector<std::string> buffers(gltf["buffers"].Size());
+        for (size_t i = 0; i < buffers.size(); i++)
+        {
+            const std::string& uri = gltf["buffers"][i]["uri"].AsString();
+            if (uri.empty() && i == 0 && hasBinary)
+            {
+                buffers[i] = std::move(binary);
+            }
+            else if (uri.compare(0, 5, "data:") == 0)
+            {
+                const size_t comma = uri.find(',');
+                if (comma == std::string::npos || uri.rfind(";base64", comma) == std::string::npos ||
+                    !DecodeBase64(uri.data() + comma + 1, uri.size() - comma - 1, buffers[i]))
+                {
+                    error = "buffer " + std::to_string(i) + " has an invalid data uri";
+                    return false;
+                }
+            }
+            else if (uri.empty() || !ReadFile(directory + DecodeURI(uri), buffers[i]))
+            {
+                error = "can't read buffer " + std::to_string(i);
+                return false;
+            }
+        }
+
+        std::vector<GLTFPrimitive> primitives;
+        const JsonValue& scenes = gltf["scenes"];
+        if (scenes.Size() > 0)
+        {
+            const JsonValue& nodes = scenes[gltf["scene"].AsInt(0)]["nodes"];
+            for (size_t i = 0; i < nodes.Size(); i++)
+            {
+                CollectNode(gltf, nodes[i].AsInt(-1), glm::mat4(1.0f), 0, primitives);
+            }
+        }
+        else
+        {
+            // Without a scene there is nothing to place the meshes, so each is taken as it is
+            for (size_t i = 0; i < gltf["meshes"].Size(); i++)
+            {
+                const JsonValue& meshPrimitives = gltf["meshes"][i]["primitives"];
+                for (size_t j = 0; j < meshPrimitives.Size(); j++)
+                {
+                    primitives.push_back({ &meshPrimitives[j], glm::mat4(1.0f), {}, {}, {} });
+                }
+            }
+        }
+
+        std::atomic<bool> failed(false);
+        ParallelFor(threadPool, static_cast<unsigned int>(primitives.size()), [&](const unsigned int i)
+        {
+            if (!ReadPrimitive(gltf, buffers, primitives[i]))
+            {
+                failed = true;
+            }
+        });
+        if (failed)
+        {
+            for (size_t i = 0; i < primitives.size(); i++)
+            {
+                if (!primitives[i].error.empty())
+                {
+                    error = "primitive " + std::to_string(i) + ": " + primitives[i].error;
+                    break;
+                }
+            }
+            return false;
+        }
+
+        size_t vertexCount = 0, indexCount = 0;
+        for (const GLTFPrimitive& primitive : primitives)
+        {
+            vertexCount += primitive.vertices.size();
+            indexCount += primitive.indices.size();
+        }
+        if (vertexCount > std::numeric_limits<unsigned int>::max())
+        {
+            error = "too many vertices";
+            return false;
+        }
+        mesh.vertices.reserve(vertexCount);
+        mesh.indices.reserve(indexCount);
+        for (const GLTFPrimitive& primitive : primitives)
+        {
+            const auto offset = static_cast<unsigned int>(mesh.vertices.size());
+            mesh.vertices.insert(mesh.vertices.end(), primitive.vertices.begin(), primitive.vertices.end());
+            for (const unsigned int index : primitive.indices)
+            {
+                mesh.indices.push_back(offset + index);
+            }
+        }
+
+        // Exporters often split vertices that are equal, and every primitive has its own
+        Weld(mesh);
+        ComputeNormals(mesh);
+        return true;
+    }
+}  // namespace Utils
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <GLM/glm.hpp>
+
+namespace Utils
+{
+    class ThreadPool;
+
+    /**
+     * \brief One vertex of an imported mesh
+     */
+    struct MeshVertex
+    {
+        glm::vec3 position;
+        glm::vec2 texCoord;  // (0, 0) is the bottom left of the image, as the textures are uploaded
+        glm::vec3 normal;
+    };
+
+    /**
+     * \brief An indexed triangle mesh with every duplicate vertex merged
+     */
+    struct MeshData
+    {
+        std::vector<MeshVertex> vertices;
+        std::vector<unsigned int> indices;  // three per triangle, counter-clockwise
+        glm::vec3 boundsMin = glm::vec3(0.0f);
+        glm::vec3 boundsMax = glm::vec3(0.0f);
+
+        /**
+         * \brief Get the number of triangles
+         * \return The number of indices over three
+         */
+        inline size_t GetTriangleCount() const { return indices.size() / 3; }
+    };
+
+    /**
+     * \brief Reads OBJ and glTF 2.0 meshes into one MeshData. OBJ files are split into chunks of
+     * lines that are parsed in parallel, glTF primitives are read in parallel. Vertices are then
+     * welded through a hash table, normals are computed where the file has none and the bounds
+     * are measured. glTF node transforms are applied, materials are ignored
+     */
+    class MeshImporter
+    {
+    public:
+        /**
+         * \brief Import every triangle of a file, the format is picked from the extension
+         * \param path A string that is the path to a .obj, .gltf or .glb file
+         * \param mesh Receives the mesh
+         * \param threadPool The workers that parse in parallel, nullptr to parse on the calling thread only
+         * \return true if the file was imported; false otherwise, with the reason printed
+         */
+        static bool Import(const std::string& path, MeshData& mesh, ThreadPool* threadPool = nullptr);
+
+        /**
+         * \brief Merge vertices that are exactly equal and rewrite the indices to match
+         * \param mesh The mesh to weld
+         */
+        static void Weld(MeshData& mesh);
+
+        /**
+         * \brief Give every vertex without a normal the area weighted average of its triangles' normals
+         * \param mesh The mesh whose normals are filled in
+         */
+        static void ComputeNormals(MeshData& mesh);
+
+        /**
+         * \brief Measure the box around every vertex
+         * \param mesh The mesh whose bounds are set
+         */
+        static void ComputeBounds(MeshData& mesh);
+
+    private:
+        static bool ImportOBJ(const std::string& text, MeshData& mesh, ThreadPool* threadPool, std::string& error);
+
+        static bool ImportGLTF(const std::string& path, const std::string& file, MeshData& mesh, ThreadPool* threadPool, std::string& error);
+
+    };  // class MeshImporter
+}  // namespace Utils
@@ -0,0 +1,344 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Utils
+{
+    namespace
+    {
+        constexpr unsigned int UNUSED = std::numeric_limits<unsigned int>::max();
+
+        struct TriangleCluster
+        {
+            unsigned int begin;  // first triangle
+            unsigned int end;
+            float facing;        // how far the cluster faces away from the centre of the mesh
+        };
+    }
+
+    MeshOptimizationReport MeshOptimizer::Optimize(MeshData& mesh, const unsigned int cacheSize, const float overdrawThreshold)
+    {
+        MeshOptimizationReport report;
+        report.before = AnalyzeVertexCache(mesh, cacheSize);
+        OptimizeVertexCache(mesh, cacheSize);
+        OptimizeOverdraw(mesh, cacheSize, overdrawThreshold);
+        OptimizeVertexFetch(mesh);
+        report.after = AnalyzeVertexCache(mesh, cacheSize);
+        return report;
+    }
+
+    void MeshOptimizer::OptimizeVertexCache(MeshData& mesh, const unsigned int cacheSize)
+    {
+        const std::vector<unsigned int>& indices = mesh.indices;
+        const size_t triangleCount = indices.size() / 3;
+        const size_t vertexCount = mesh.vertices.size();
+        if (triangleCount == 0)
+        {
+            return;
+        }
+
+        // The triangles around every vertex, and how many of them are still to be emitted
+        std::vector<unsigned int> liveCounts(vertexCount, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+        {
+            liveCounts[indices[i]]++;
+        }
+        std::vector<unsigned int> offsets(vertexCount + 1, 0);
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            offsets[i + 1] = offsets[i] + liveCounts[i];
+        }
+        std::vector<unsigned int> adjacency(triangleCount * 3);
+        std::vector<unsigned int> filled(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+        {
+            adjacency[filled[indices[i]]++] = static_cast<unsigned int>(i / 3);
+        }
+
+        std::vector<unsigned int> timestamps(vertexCount, 0);
+        unsigned int time = cacheSize + 1;
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<unsigned int> deadEnds;
+        std::vector<unsigned int> candidates;
+        std::vector<unsigned int> output;
+        output.reserve(triangleCount * 3);
+        size_t cursor = 0;  // vertices before this one have no triangles left
+
+        // Tipsify: emit every triangle around the fanning vertex, then fan around the candidate that
+        // has been in the cache the longest yet stays in it while its own triangles are emitted
+        for (int fanning = 0; fanning >= 0;)
+        {
+            candidates.clear();
+            for (unsigned int i = offsets[fanning]; i < offsets[fanning + 1]; i++)
+            {
+                const unsigned int triangle = adjacency[i];
+                if (emitted[triangle])
+                {
+                    continue;
+                }
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    const unsigned int vertex = indices[triangle * 3 + corner];
+                    output.push_back(vertex);
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+                    liveCounts[vertex]--;
+                    if (time - timestamps[vertex] > cacheSize)
+                    {
+                        timestamps[vertex] = time++;
+                    }
+                }
+                emitted[triangle] = true;
+            }
+
+            int next = -1;
+            int bestPriority = -1;
+            for (const unsigned int vertex : candidates)
+            {
+                if (liveCounts[vertex] == 0)
+                {
+                    continue;
+                }
+                const unsigned int age = time - timestamps[vertex];
+                const int priority = age + 2 * liveCounts[vertex] <= cacheSize ? static_cast<int>(age) : 0;
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    next = static_cast<int>(vertex);
+                }
+            }
+
+            // Dead end: go back to a recently used vertex, or else to the first one with triangles left
+            while (next < 0 && !deadEnds.empty())
+            {
+                const unsigned int vertex = deadEnds.back();
+                deadEnds.pop_back();
+                next = liveCounts[vertex] > 0 ? static_cast<int>(vertex) : -1;
+            }
+            for (; next < 0 && cursor < vertexCount; cursor++)
+            {
+                next = liveCounts[cursor] > 0 ? static_cast<int>(cursor) : -1;
+            }
+            fanning = next;
+        }
+
+        mesh.indices = std::move(output);
+    }
+
+    void MeshOptimizer::OptimizeOverdraw(MeshData& mesh, const unsigned int cacheSize, const float threshold)
+    {
+        const std::vector<unsigned int>& indices = mesh.indices;
+        const auto triangleCount = static_cast<unsigned int>(indices.size() / 3);
+        if (triangleCount == 0)
+        {
+            return;
+        }
+        std::vector<unsigned int> timestamps(mesh.vertices.size(), 0);
+        unsigned int time = cacheSize + 1;
+
+        // A triangle that misses the cache three times starts a new patch of the mesh, splitting
+        // the order there costs nothing
+        std::vector<unsigned int> patches;
+        for (unsigned int i = 0; i < triangleCount; i++)
+        {
+            if (UpdateCache(&indices[i * 3], cacheSize, timestamps, time) == 3 || i == 0)
+            {
+                patches.push_back(i);
+            }
+        }
+        patches.push_back(triangleCount);
+
+        // Patches are split further wherever the misses so far are within the threshold of the
+        // patch's average, so the clusters can be sorted without losing more than that
+        std::vector<TriangleCluster> clusters;
+        for (size_t patch = 0; patch + 1 < patches.size(); patch++)
+        {
+            unsigned int begin = patches[patch];
+            const unsigned int end = patches[patch + 1];
+
+            time += cacheSize + 1;
+            unsigned int patchMisses = 0;
+            for (unsigned int i = begin; i < end; i++)
+            {
+                patchMisses += UpdateCache(&indices[i * 3], cacheSize, timestamps, time);
+            }
+            const float limit = threshold * patchMisses / (end - begin);
+
+            time += cacheSize + 1;
+            unsigned int misses = 0;
+            for (unsigned int i = begin; i < end; i++)
+            {
+                misses += UpdateCache(&indices[i * 3], cacheSize, timestamps, time);
+                if (misses <= limit * (i + 1 - begin))
+                {
+                    clusters.push_back({ begin, i + 1, 0.0f });
+                    begin = i + 1;
+                    misses = 0;
+                    time += cacheSize + 1;  // the next cluster may be drawn after any other
+                }
+            }
+            if (begin != end)
+            {
+                clusters.push_back({ begin, end, 0.0f });
+            }
+        }
+
+        glm::vec3 meshCentroid(0.0f);
+        for (const unsigned int index : indices)
+        {
+            meshCentroid += mesh.vertices[index].position;
+        }
+        meshCentroid /= static_cast<float>(indices.size());
+
+        for (TriangleCluster& cluster : clusters)
+        {
+            glm::vec3 centroid(0.0f);
+            glm::vec3 normal(0.0f);
+            float area = 0.0f;
+            for (unsigned int i = cluster.begin; i < cluster.end; i++)
+            {
+                const glm::vec3& a = mesh.vertices[indices[i * 3 + 0]].position;
+                const glm::vec3& b = mesh.vertices[indices[i * 3 + 1]].position;
+                const glm::vec3& c = mesh.vertices[indices[i * 3 + 2]].position;
+                const glm::vec3 cross = glm::cross(b - a, c - a);
+                const float triangleArea = glm::length(cross);
+                centroid += (a + b + c) * (triangleArea / 3.0f);
+                normal += cross;
+                area += triangleArea;
+            }
+            const float normalLength = glm::length(normal);
+            if (area > 0.0f && normalLength > 0.0f)
+            {
+                cluster.facing = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+            }
+        }
+
+        // Clusters facing outwards are the likeliest to cover the others, so they go first
+        std::stable_sort(clusters.begin(), clusters.end(),
+                         [](const TriangleCluster& a, const TriangleCluster& b) { return a.facing > b.facing; });
+
+        std::vector<unsigned int> output;
+        output.reserve(indices.size());
+        for (const TriangleCluster& cluster : clusters)
+        {
+            output.insert(output.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+        }
+        mesh.indices = std::move(output);
+    }
+
+    void MeshOptimizer::OptimizeVertexFetch(MeshData& mesh)
+    {
+        std::vector<unsigned int> remap(mesh.vertices.size(), UNUSED);
+        unsigned int vertexCount = 0;
+        for (unsigned int& index : mesh.indices)
+        {
+            if (remap[index] == UNUSED)
+            {
+                remap[index] = vertexCount++;
+            }
+            index = remap[index];
+        }
+
+        std::vector<MeshVertex> vertices(vertexCount);
+        for (size_t i = 0; i < mesh.vertices.size(); i++)
+        {
+            if (remap[i] != UNUSED)
+            {
+                vertices[remap[i]] = mesh.vertices[i];
+            }
+        }
+        mesh.vertices = std::move(vertices);
+    }
+
+    std::vector<MeshData> MeshOptimizer::Split(const MeshData& mesh, const unsigned int maxVertices)
+    {
+        std::vector<MeshData> parts;
+        if (mesh.vertices.size() <= maxVertices)
+        {
+            parts.push_back(mesh);
+            return parts;
+        }
+
+        // remap holds a vertex's index in the part that last used it, part holds which part that was
+        std::vector<unsigned int> remap(mesh.vertices.size());
+        std::vector<unsigned int> part(mesh.vertices.size(), UNUSED);
+        for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+        {
+            const unsigned int* triangle = &mesh.indices[t];
+            unsigned int newVertices = 0;
+            for (int i = 0; i < 3; i++)
+            {
+                newVertices += parts.empty() || part[triangle[i]] != parts.size() - 1 ? 1 : 0;
+            }
+            if (parts.empty() || parts.back().vertices.size() + newVertices > maxVertices)
+            {
+                parts.emplace_back();
+                parts.back().boundsMin = mesh.boundsMin;
+                parts.back().boundsMax = mesh.boundsMax;
+            }
+
+            MeshData& current = parts.back();
+            const unsigned int currentPart = static_cast<unsigned int>(parts.size() - 1);
+            for (int i = 0; i < 3; i++)
+            {
+                const unsigned int index = triangle[i];
+                if (part[index] != currentPart)
+                {
+                    part[index] = currentPart;
+                    remap[index] = static_cast<unsigned int>(current.vertices.size());
+                    current.vertices.push_back(mesh.vertices[index]);
+                }
+                current.indices.push_back(remap[index]);
+            }
+        }
+        return parts;
+    }
+
+    VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const MeshData& mesh, const unsigned int cacheSize)
+    {
+        VertexCacheStatistics statistics;
+        const size_t triangleCount = mesh.indices.size() / 3;
+        if (triangleCount == 0)
+        {
+            return statistics;
+        }
+
+        std::vector<unsigned int> timestamps(mesh.vertices.size(), 0);
+        unsigned int time = cacheSize + 1;
+        size_t misses = 0;
+        for (size_t i = 0; i < triangleCount; i++)
+        {
+            misses += UpdateCache(&mesh.indices[i * 3], cacheSize, timestamps, time);
+        }
+
+        std::vector<bool> referenced(mesh.vertices.size(), false);
+        size_t referencedCount = 0;
+        for (const unsigned int index : mesh.indices)
+        {
+            referencedCount += !referenced[index];
+            referenced[index] = true;
+        }
+
+        statistics.acmr = static_cast<float>(misses) / triangleCount;
+        statistics.atvr = static_cast<float>(misses) / referencedCount;
+        return statistics;
+    }
+
+    unsigned int MeshOptimizer::UpdateCache(const unsigned int* triangle, const unsigned int cacheSize,
+                                            std::vector<unsigned int>& timestamps, unsigned int& time)
+    {
+        unsigned int misses = 0;
+        for (int corner = 0; corner < 3; corner++)
+        {
+            // A FIFO cache only takes in vertices on a miss, so a vertex is cached while fewer
+            // than cacheSize others were taken in after it
+            if (time - timestamps[triangle[corner]] > cacheSize)
+            {
+                timestamps[triangle[corner]] = time++;
+                misses++;
+            }
+        }
+        return misses;
+    }
+}  // namespace Utils
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+
+#include "MeshImporter.h"
+
+namespace Utils
+{
+    /**
+     * \brief How well an index order uses the post-transform vertex cache
+     */
+    struct VertexCacheStatistics
+    {
+        float acmr = 0.0f;  // vertices transformed per triangle, 0.5 at best and 3 at worst
+        float atvr = 0.0f;  // vertices transformed per vertex referenced, 1 at best
+    };
+
+    /**
+     * \brief The cache statistics of a mesh before and after it was optimized
+     */
+    struct MeshOptimizationReport
+    {
+        VertexCacheStatistics before;
+        VertexCacheStatistics after;
+    };
+
+    /**
+     * \brief Reorders the triangles and vertices of a mesh so the GPU does less work drawing it. The
+     * triangles are ordered with Tipsify so recently transformed vertices are reused from the cache,
+     * then clusters of them are sorted so the outward facing ones come first and hide more of what is
+     * drawn after them, and finally the vertices are stored in the order they are first used. The
+     * mesh looks the same afterwards, every pass keeps the winding of every triangle
+     */
+    class MeshOptimizer
+    {
+    public:
+        /**
+         * \brief Run every pass on a mesh
+         * \param mesh The mesh to reorder
+         * \param cacheSize The number of vertices the cache is assumed to hold
+         * \param overdrawThreshold How much worse the cache use may get to let the triangles be sorted for less overdraw, 1 for no loss
+         * \return The cache statistics before and after
+         */
+        static MeshOptimizationReport Optimize(MeshData& mesh, unsigned int cacheSize = 16, float overdrawThreshold = 1.05f);
+
+        /**
+         * \brief Reorder the triangles to reuse the vertices in the cache as much as possible
+         * \param mesh The mesh whose indices are reordered
+         * \param cacheSize The number of vertices the cache is assumed to hold
+         */
+        static void OptimizeVertexCache(MeshData& mesh, unsigned int cacheSize = 16);
+
+        /**
+         * \brief Sort clusters of triangles so the ones facing away from the centre are drawn first.
+         * Should follow OptimizeVertexCache, which leaves the clusters this splits the mesh into
+         * \param mesh The mesh whose indices are reordered
+         * \param cacheSize The number of vertices the cache is assumed to hold
+         * \param threshold How much worse the cache use may get in return for smaller clusters, 1 for no loss
+         */
+        static void OptimizeOverdraw(MeshData& mesh, unsigned int cacheSize = 16, float threshold = 1.05f);
+
+        /**
+         * \brief Store the vertices in the order the indices first use them, dropping unused ones
+         * \param mesh The mesh whose vertices are reordered
+         */
+        static void OptimizeVertexFetch(MeshData& mesh);
+
+        /**
+         * \brief Split a mesh into parts with few enough vertices for 16-bit indices, in triangle order
+         * so an optimized mesh stays optimized. Vertices shared by two parts are stored in both
+         * \param mesh The mesh to split
+         * \param maxVertices The most vertices a part may have, 65535 leaves the largest 16-bit index for primitive restart
+         * \return The parts, with the bounds of the whole mesh. Just a copy of the mesh when it is small enough
+         */
+        static std::vector<MeshData> Split(const MeshData& mesh, unsigned int maxVertices = 65535);
+
+        /**
+         * \brief Simulate a first in first out vertex cache drawing a mesh
+         * \param mesh The mesh to draw
+         * \param cacheSize The number of vertices the cache holds
+         * \return How many vertices had to be transformed
+         */
+        static VertexCacheStatistics AnalyzeVertexCache(const MeshData& mesh, unsigned int cacheSize = 16);
+
+    private:
+        // Returns how many of a triangle's vertices missed a FIFO cache, timestamps and time are updated
+        static unsigned int UpdateCache(const unsigned int* triangle, unsigned int cacheSize,
+                                        std::vector<unsigned int>& timestamps, unsigned int& time);
+
+    };  // class MeshOptimizer
+}  // namespace Utils
@@ -0,0 +1,399 @@
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "Hash.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MIP_GENERATOR_SSE 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define MIP_GENERATOR_NEON 1
+#endif
+
+namespace Utils
+{
+    namespace
+    {
+        // One RGBA texel per register, so the filters are written once for every target
+#if defined(MIP_GENERATOR_SSE)
+        using Vec4 = __m128;
+        inline Vec4 Load(const float* p) { return _mm_loadu_ps(p); }
+        inline void Store(float* p, const Vec4 v) { _mm_storeu_ps(p, v); }
+        inline Vec4 Splat(const float f) { return _mm_set1_ps(f); }
+        inline Vec4 Zero() { return _mm_setzero_ps(); }
+        inline Vec4 MultiplyAdd(const Vec4 sum, const Vec4 a, const Vec4 b) { return _mm_add_ps(sum, _mm_mul_ps(a, b)); }
+#elif defined(MIP_GENERATOR_NEON)
+        using Vec4 = float32x4_t;
+        inline Vec4 Load(const float* p) { return vld1q_f32(p); }
+        inline void Store(float* p, const Vec4 v) { vst1q_f32(p, v); }
+        inline Vec4 Splat(const float f) { return vdupq_n_f32(f); }
+        inline Vec4 Zero() { return vdupq_n_f32(0.0f); }
+        inline Vec4 MultiplyAdd(const Vec4 sum, const Vec4 a, const Vec4 b) { return vmlaq_f32(sum, a, b); }
+#else
+        struct Vec4
+        {
+            float v[4];
+        };
+        inline Vec4 Load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+        inline void Store(float* p, const Vec4 v) { std::memcpy(p, v.v, sizeof(v.v)); }
+        inline Vec4 Splat(const float f) { return { { f, f, f, f } }; }
+        inline Vec4 Zero() { return Splat(0.0f); }
+        inline Vec4 MultiplyAdd(const Vec4 sum, const Vec4 a, const Vec4 b)
+        {
+            return { { sum.v[0] + a.v[0] * b.v[0], sum.v[1] + a.v[1] * b.v[1], sum.v[2] + a.v[2] * b.v[2], sum.v[3] + a.v[3] * b.v[3] } };
+        }
+#endif
+
+        struct FloatImage
+        {
+            int width, height;
+            std::vector<float> texels;  // RGBA
+        };
+
+        struct Kernel
+        {
+            int firstOffset;  // relative to twice the destination coordinate
+            std::vector<float> weights;
+        };
+
+        constexpr float PI = 3.14159265358979f;
+        constexpr size_t MAX_TAPS = 6;
+        constexpr uint32_t CACHE_MAGIC = 0x4350494D;  // "MIPC"
+        constexpr uint32_t CACHE_VERSION = 1;
+        constexpr uint32_t MAX_CACHE_LEVELS = 32;  // a full chain of the largest int sized image
+
+        // numbers the temporary files so that concurrent saves of the same entry don't write into each other
+        std::atomic<unsigned int> temporaryFileCounter{ 0 };
+
+        float BesselI0(const float x)
+        {
+            float sum = 1.0f, term = 1.0f;
+            for (int k = 1; k < 16; k++)
+            {
+                term *= (x / (2.0f * k)) * (x / (2.0f * k));
+                sum += term;
+            }
+            return sum;
+        }
+
+        Kernel MakeKernel(const MipGenerator::Filter filter)
+        {
+            if (filter == MipGenerator::Filter::Box)
+            {
+                return { 0, { 0.5f, 0.5f } };
+            }
+
+            // a sinc cut off at half the source rate, shaped by a Kaiser window three source texels wide
+            constexpr float radius = 3.0f, alpha = 4.0f;
+            Kernel kernel{ -2, {} };
+            float total = 0.0f;
+            for (size_t tap = 0; tap < MAX_TAPS; tap++)
+            {
+                const float distance = static_cast<float>(tap) - 2.5f;
+                const float x = distance / 2.0f;
+                const float sinc = std::sin(PI * x) / (PI * x);
+                const float ratio = distance / radius;
+                const float window = BesselI0(alpha * std::sqrt(std::max(0.0f, 1.0f - ratio * ratio))) / BesselI0(alpha);
+                kernel.weights.push_back(sinc * window);
+                total += sinc * window;
+            }
+            for (float& weight : kernel.weights)
+            {
+                weight /= total;
+            }
+            return kernel;
+        }
+
+        const float* GetSRGBToLinearTable()
+        {
+            static const std::vector<float> table = []
+            {
+                std::vector<float> values(256);
+                for (int i = 0; i < 256; i++)
+                {
+                    const float c = i / 255.0f;
+                    values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                }
+                return values;
+            }();
+            return table.data();
+        }
+
+        // Indexed by a linear value in 1/65535 steps, fine enough to round every sRGB code correctly
+        const unsigned char* GetLinearToSRGBTable()
+        {
+            static const std::vector<unsigned char> table = []
+            {
+                std::vector<unsigned char> values(65536);
+                for (int i = 0; i < 65536; i++)
+                {
+                    const float l = i / 65535.0f;
+                    const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                    values[i] = static_cast<unsigned char>(std::lround(std::min(1.0f, std::max(0.0f, c)) * 255.0f));
+                }
+                return values;
+            }();
+            return table.data();
+        }
+
+        FloatImage ToFloat(const int width, const int height, const unsigned char* rgbaPixels, const bool srgb)
+        {
+            const float* toLinear = GetSRGBToLinearTable();
+            FloatImage image{ width, height, std::vector<float>(static_cast<size_t>(width) * height * 4) };
+            for (size_t i = 0; i < image.texels.size(); i++)
+            {
+                const bool colour = (i & 3) != 3;
+                image.texels[i] = srgb && colour ? toLinear[rgbaPixels[i]] : rgbaPixels[i] / 255.0f;
+            }
+            return image;
+        }
+
+        // Halves the width, or returns a copy when the image is already one texel wide
+        FloatImage DownsampleX(const FloatImage& source, const Kernel& kernel)
+        {
+            if (source.width == 1)
+            {
+                return source;
+            }
+
+            FloatImage destination{ std::max(1, source.width / 2), source.height, {} };
+            destination.texels.resize(static_cast<size_t>(destination.width) * destination.height * 4);
+
+            Vec4 weights[MAX_TAPS];
+            const size_t tapCount = kernel.weights.size();
+            for (size_t tap = 0; tap < tapCount; tap++)
+            {
+                weights[tap] = Splat(kernel.weights[tap]);
+            }
+
+            for (int y = 0; y < source.height; y++)
+            {
+                const float* row = source.texels.data() + static_cast<size_t>(y) * source.width * 4;
+                float* output = destination.texels.data() + static_cast<size_t>(y) * destination.width * 4;
+                for (int x = 0; x < destination.width; x++)
+                {
+                    Vec4 sum = Zero();
+                    for (size_t tap = 0; tap < tapCount; tap++)
+                    {
+                        const int sourceX = std::clamp(2 * x + kernel.firstOffset + static_cast<int>(tap), 0, source.width - 1);
+                        sum = MultiplyAdd(sum, Load(row + sourceX * 4), weights[tap]);
+                    }
+                    Store(output + x * 4, sum);
+                }
+            }
+            return destination;
+        }
+
+        // Halves the height, or returns a copy when the image is already one texel high
+        FloatImage DownsampleY(const FloatImage& source, const Kernel& kernel)
+        {
+            if (source.height == 1)
+            {
+                return source;
+            }
+
+            FloatImage destination{ source.width, std::max(1, source.height / 2), {} };
+            destination.texels.resize(static_cast<size_t>(destination.width) * destination.height * 4);
+
+            Vec4 weights[MAX_TAPS];
+            const size_t tapCount = kernel.weights.size();
+            for (size_t tap = 0; tap < tapCount; tap++)
+            {
+                weights[tap] = Splat(kernel.weights[tap]);
+            }
+
+            const size_t rowFloats = static_cast<size_t>(source.width) * 4;
+            for (int y = 0; y < destination.height; y++)
+            {
+                float* output = destination.texels.data() + y * rowFloats;
+                for (int x = 0; x < destination.width; x++)
+                {
+                    Vec4 sum = Zero();
+                    for (size_t tap = 0; tap < tapCount; tap++)
+                    {
+                        const int sourceY = std::clamp(2 * y + kernel.firstOffset + static_cast<int>(tap), 0, source.height - 1);
+                        sum = MultiplyAdd(sum, Load(source.texels.data() + sourceY * rowFloats + x * 4), weights[tap]);
+                    }
+                    Store(output + x * 4, sum);
+                }
+            }
+            return destination;
+        }
+
+        float Coverage(const FloatImage& image, const float scale, const float reference)
+        {
+            size_t covered = 0;
+            for (size_t i = 3; i < image.texels.size(); i += 4)
+            {
+                covered += image.texels[i] * scale > reference ? 1 : 0;
+            }
+            return static_cast<float>(covered) / (image.texels.size() / 4);
+        }
+
+        // Finds the alpha scale that brings a level's coverage closest to the base level's
+        float FindAlphaScale(const FloatImage& image, const float targetCoverage, const float reference)
+        {
+            float low = 0.0f, high = 4.0f;
+            for (int step = 0; step < 10; step++)
+            {
+                const float middle = (low + high) * 0.5f;
+                if (Coverage(image, middle, reference) < targetCoverage)
+                {
+                    low = middle;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+            return (low + high) * 0.5f;
+        }
+
+        void AppendLevel(const FloatImage& image, const bool srgb, const float alphaScale, MipChain& chain)
+        {
+            const unsigned char* toSRGB = GetLinearToSRGBTable();
+            const size_t offset = chain.pixels.size();
+            chain.levels.push_back({ image.width, image.height, offset });
+            chain.pixels.resize(offset + image.texels.size());
+
+            unsigned char* output = chain.pixels.data() + offset;
+            for (size_t i = 0; i < image.texels.size(); i++)
+            {
+                const bool colour = (i & 3) != 3;
+                const float value = std::min(1.0f, std::max(0.0f, colour ? image.texels[i] : image.texels[i] * alphaScale));
+                output[i] = srgb && colour ? toSRGB[static_cast<int>(value * 65535.0f + 0.5f)] : static_cast<unsigned char>(value * 255.0f + 0.5f);
+            }
+        }
+    }  // namespace
+
+    MipChain MipGenerator::Generate(const int width, const int height, const unsigned char* rgbaPixels, const Options& options)
+    {
+        MipChain chain;
+        const size_t baseSize = static_cast<size_t>(width) * height * 4;
+        chain.pixels.reserve(baseSize + baseSize / 3 + 64);
+        chain.levels.push_back({ width, height, 0 });
+        chain.pixels.assign(rgbaPixels, rgbaPixels + baseSize);
+
+        const Kernel kernel = MakeKernel(options.filter);
+        FloatImage current = ToFloat(width, height, rgbaPixels, options.srgb);
+        const bool preserveCoverage = options.alphaCoverageReference > 0.0f;
+        const float targetCoverage = preserveCoverage ? Coverage(current, 1.0f, options.alphaCoverageReference) : 0.0f;
+
+        while (current.width > 1 || current.height > 1)
+        {
+            // each level is filtered from the unscaled one above, so coverage fixes don't compound
+            current = DownsampleY(DownsampleX(current, kernel), kernel);
+            const float alphaScale = preserveCoverage ? FindAlphaScale(current, targetCoverage, options.alphaCoverageReference) : 1.0f;
+            AppendLevel(current, options.srgb, alphaScale, chain);
+        }
+        return chain;
+    }
+
+    std::string MipGenerator::GetCachePath(const std::string& cacheDirectory, const std::string& sourcePath, const Options& options)
+    {
+        std::error_code error;
+        const std::filesystem::path source = std::filesystem::absolute(sourcePath, error);
+        const uintmax_t size = std::filesystem::file_size(source, error);
+        if (error)
+        {
+            return "";
+        }
+        const auto writeTime = std::filesystem::last_write_time(source, error).time_since_epoch().count();
+
+        std::ostringstream key;
+        key << source.generic_string() << '|' << size << '|' << writeTime << '|' << static_cast<int>(options.filter)
+            << '|' << options.srgb << '|' << options.alphaCoverageReference;
+
+        const std::string keyText = key.str();
+        std::ostringstream name;
+        name << source.stem().string() << '-' << std::hex << HashFNV1a(keyText.data(), keyText.size()) << ".mips";
+        return (std::filesystem::path(cacheDirectory) / name.str()).string();
+    }
+
+    bool MipGenerator::LoadCache(const std::string& path, MipChain& chain)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        uint32_t header[3] = {};
+        if (!stream.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != CACHE_MAGIC || header[1] != CACHE_VERSION
+            || header[2] == 0 || header[2] > MAX_CACHE_LEVELS)
+        {
+            return false;
+        }
+
+        // a damaged file is a miss, the chain must halve down level by level and fill the file exactly
+        chain.levels.clear();
+        size_t totalSize = 0;
+        for (uint32_t level = 0; level < header[2]; level++)
+        {
+            int32_t size[2];
+            if (!stream.read(reinterpret_cast<char*>(size), sizeof(size)) || size[0] <= 0 || size[1] <= 0)
+            {
+                return false;
+            }
+            if (level > 0 && (size[0] != std::max(1, chain.levels.back().width / 2) || size[1] != std::max(1, chain.levels.back().height / 2)))
+            {
+                return false;
+            }
+            chain.levels.push_back({ size[0], size[1], totalSize });
+            totalSize += static_cast<size_t>(size[0]) * size[1] * 4;
+        }
+
+        std::error_code error;
+        const uintmax_t fileSize = std::filesystem::file_size(path, error);
+        const size_t headerSize = sizeof(header) + header[2] * sizeof(int32_t) * 2;
+        if (error || fileSize != headerSize + totalSize)
+        {
+            chain.levels.clear();
+            return false;
+        }
+
+        chain.pixels.resize(totalSize);
+        return static_cast<bool>(stream.read(reinterpret_cast<char*>(chain.pixels.data()), static_cast<std::streamsize>(totalSize)));
+    }
+
+    bool MipGenerator::SaveCache(const std::string& path, const MipChain& chain)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+        // written aside and renamed so a reader never sees half a file
+        std::ostringstream temporaryPath;
+        temporaryPath << path << '.' << std::hash<std::thread::id>()(std::this_thread::get_id())
+                      << '.' << temporaryFileCounter++ << ".tmp";
+        {
+            std::ofstream stream(temporaryPath.str(), std::ios::binary);
+            const uint32_t header[3] = { CACHE_MAGIC, CACHE_VERSION, static_cast<uint32_t>(chain.levels.size()) };
+            stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+            for (const MipChain::Level& level : chain.levels)
+            {
+                const int32_t size[2] = { level.width, level.height };
+                stream.write(reinterpret_cast<const char*>(size), sizeof(size));
+            }
+            stream.write(reinterpret_cast<const char*>(chain.pixels.data()), static_cast<std::streamsize>(chain.pixels.size()));
+            if (!stream)
+            {
+                stream.close();
+                std::filesystem::remove(temporaryPath.str(), error);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temporaryPath.str(), path, error);
+        if (error)
+        {
+            std::filesystem::remove(temporaryPath.str(), error);
+            return false;
+        }
+        return true;
+    }
+}  // namespace Utils
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+    /**
+     * \brief A full mip chain of RGBA8 images, base level first, stored one after the other
+     */
+    struct MipChain
+    {
+        struct Level
+        {
+            int width, height;
+            size_t offset;  // into pixels
+        };
+
+        std::vector<Level> levels;
+        std::vector<unsigned char> pixels;
+
+        /**
+         * \brief Get the bytes one level takes
+         * \param level Which level, 0 is the base
+         * \return Four bytes per texel of that level
+         */
+        inline size_t GetLevelSize(const size_t level) const { return static_cast<size_t>(levels[level].width) * levels[level].height * 4; }
+    };
+
+    /**
+     * \brief Builds mip chains on the CPU so they are ready before the upload. Filtering runs on
+     * whole RGBA texels at once with SSE or NEON, falling back to scalar code elsewhere
+     */
+    class MipGenerator
+    {
+    public:
+        enum class Filter
+        {
+            Box,    // averages 2x2 texels
+            Kaiser  // windowed sinc over 6x6 texels, sharper with less aliasing
+        };
+
+        struct Options
+        {
+            Filter filter = Filter::Kaiser;
+            // filter colours in linear space and store them sRGB encoded again
+            bool srgb = true;
+            // keep the share of texels above this alpha the same on every level so alpha tested
+            // cut-outs don't thin out in the distance, 0 turns it off
+            float alphaCoverageReference = 0.0f;
+        };
+
+        /**
+         * \brief Build every level down to 1x1
+         * \param width The width of the base level
+         * \param height The height of the base level
+         * \param rgbaPixels Four bytes per texel, the base level is copied as is
+         * \param options How to filter
+         * \return The mip chain
+         */
+        static MipChain Generate(int width, int height, const unsigned char* rgbaPixels, const Options& options);
+
+        /**
+         * \brief Get where the chain of a source file would be cached. The name changes whenever
+         * the file's size, its last write time or the options change
+         * \param cacheDirectory The directory that holds the cached chains
+         * \param sourcePath A string that is the path to the source image
+         * \param options How the chain is filtered
+         * \return The path of the cache file, or an empty string if the source doesn't exist
+         */
+        static std::string GetCachePath(const std::string& cacheDirectory, const std::string& sourcePath, const Options& options);
+
+        /**
+         * \brief Read a chain written by SaveCache
+         * \param path A string that is the path to the cache file
+         * \param chain The chain to fill in
+         * \return true if the file was read; false if it is missing or damaged
+         */
+        static bool LoadCache(const std::string& path, MipChain& chain);
+
+        /**
+         * \brief Write a chain so later runs can skip generating it, creating the directory if needed
+         * \param path A string that is the path to the cache file
+         * \param chain The chain to write
+         * \return true if the file was written; false otherwise
+         */
+        static bool SaveCache(const std::string& path, const MipChain& chain);
+
+    };  // class MipGenerator
+}  // namespace Utils
@@ -0,0 +1,439 @@
+#include "ParticleSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "ThreadPool.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PARTICLES_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC emits AVX2 intrinsics in any function, it's up to the caller to check the CPU
+#define PARTICLES_AVX2
+#else
+#define PARTICLES_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace Utils
+{
+    namespace
+    {
+        uint32_t NextRandom(uint32_t& state)
+        {
+            // xorshift32, state must not be 0
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+
+        float RandomSigned(uint32_t& state)
+        {
+            return static_cast<float>(NextRandom(state) >> 8) * (2.0f / 16777216.0f) - 1.0f;
+        }
+
+        float RandomUnsigned(uint32_t& state)
+        {
+            return static_cast<float>(NextRandom(state) >> 8) * (1.0f / 16777216.0f);
+        }
+
+        uint32_t MixSeed(uint32_t a, const uint32_t b)
+        {
+            a = (a ^ 61u) ^ (b * 0x9E3779B9u);
+            a += a << 3;
+            a ^= a >> 4;
+            a *= 0x27D4EB2Du;
+            a ^= a >> 15;
+            return a | 1u;
+        }
+
+        uint8_t ToUnorm8(const float value)
+        {
+            return static_cast<uint8_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+        }
+
+#ifdef PARTICLES_X86
+        // For every mask of alive lanes, the lanes to gather so the alive ones come first
+        struct CompactTable
+        {
+            alignas(32) uint32_t lanes[256][8];
+            uint8_t counts[256];
+        };
+
+        const CompactTable& GetCompactTable()
+        {
+            static const CompactTable table = []
+            {
+                CompactTable t{};
+                for (unsigned int mask = 0; mask < 256; mask++)
+                {
+                    unsigned int count = 0;
+                    for (unsigned int lane = 0; lane < 8; lane++)
+                    {
+                        if (mask & (1u << lane))
+                        {
+                            t.lanes[mask][count++] = lane;
+                        }
+                    }
+                    t.counts[mask] = static_cast<uint8_t>(count);
+                }
+                return t;
+            }();
+            return table;
+        }
+#endif
+    }
+
+    ParticleSystem::ParticleSystem(const unsigned int capacity)
+        : m_Capacity((std::max(capacity, 1u) + CHUNK_SIZE - 1) / CHUNK_SIZE * CHUNK_SIZE),
+          m_PositionX(m_Capacity), m_PositionY(m_Capacity), m_PositionZ(m_Capacity),
+          m_VelocityX(m_Capacity), m_VelocityY(m_Capacity), m_VelocityZ(m_Capacity),
+          m_Age(m_Capacity), m_Lifetime(m_Capacity),
+          m_ChunkCounts(m_Capacity / CHUNK_SIZE, 0), m_ChunkEmits(m_Capacity / CHUNK_SIZE, 0),
+          m_EmitRemainder(0.0f), m_Frame(0), m_AliveCount(0), m_UseSimd(IsSimdSupported())
+    {
+        // Warm the table up here rather than on a worker in the first update
+#ifdef PARTICLES_X86
+        GetCompactTable();
+#endif
+    }
+
+    void ParticleSystem::Update(const float deltaTime, ThreadPool* threadPool)
+    {
+        // Hand the new particles out to the chunks with room, the earlier chunks first
+        const float emitted = m_Settings.emitRate * deltaTime + m_EmitRemainder;
+        unsigned int emitCount = static_cast<unsigned int>(std::min(std::max(emitted, 0.0f), static_cast<float>(m_Capacity - m_AliveCount)));
+        m_EmitRemainder = emitCount < m_Capacity - m_AliveCount ? emitted - static_cast<float>(emitCount) : 0.0f;
+        for (size_t chunk = 0; chunk < m_ChunkCounts.size(); chunk++)
+        {
+            m_ChunkEmits[chunk] = std::min(emitCount, CHUNK_SIZE - m_ChunkCounts[chunk]);
+            emitCount -= m_ChunkEmits[chunk];
+        }
+
+        const uint32_t frame = m_Frame++;
+        ForEachChunk(static_cast<unsigned int>(m_ChunkCounts.size()), threadPool, [this, deltaTime, frame](const unsigned int chunk)
+        {
+            const unsigned int first = chunk * CHUNK_SIZE;
+            const unsigned int end = first + m_ChunkCounts[chunk];
+            const unsigned int write = m_UseSimd ? SimulateAvx2(first, end, first, deltaTime) : Simulate(first, end, first, deltaTime);
+            // New particles go after the survivors and don't move until the next update
+            const uint32_t seed = MixSeed(frame, chunk);
+            if (m_UseSimd)
+            {
+                EmitAvx2(write, m_ChunkEmits[chunk], seed);
+            }
+            else
+            {
+                Emit(write, m_ChunkEmits[chunk], seed);
+            }
+            m_ChunkCounts[chunk] = write - first + m_ChunkEmits[chunk];
+        });
+
+        m_AliveCount = 0;
+        for (const unsigned int count : m_ChunkCounts)
+        {
+            m_AliveCount += count;
+        }
+    }
+
+    unsigned int ParticleSystem::WriteInstances(ParticleInstance* instances, ThreadPool* threadPool) const
+    {
+        std::vector<unsigned int> offsets(m_ChunkCounts.size());
+        unsigned int total = 0;
+        for (size_t chunk = 0; chunk < m_ChunkCounts.size(); chunk++)
+        {
+            offsets[chunk] = total;
+            total += m_ChunkCounts[chunk];
+        }
+
+        ForEachChunk(static_cast<unsigned int>(m_ChunkCounts.size()), threadPool, [this, instances, &offsets](const unsigned int chunk)
+        {
+            const ParticleSettings& settings = m_Settings;
+            const unsigned int first = chunk * CHUNK_SIZE;
+            ParticleInstance* out = instances + offsets[chunk];
+            for (unsigned int i = first; i < first + m_ChunkCounts[chunk]; i++, out++)
+            {
+                const float t = m_Age[i] / m_Lifetime[i];
+                const glm::vec4 color = settings.startColor + (settings.endColor - settings.startColor) * t;
+                out->position = glm::vec3(m_PositionX[i], m_PositionY[i], m_PositionZ[i]);
+                out->size = settings.startSize + (settings.endSize - settings.startSize) * t;
+                out->color[0] = ToUnorm8(color.r);
+                out->color[1] = ToUnorm8(color.g);
+                out->color[2] = ToUnorm8(color.b);
+                out->color[3] = ToUnorm8(color.a);
+            }
+        });
+        return total;
+    }
+
+    void ParticleSystem::Clear()
+    {
+        std::fill(m_ChunkCounts.begin(), m_ChunkCounts.end(), 0);
+        m_AliveCount = 0;
+        m_EmitRemainder = 0.0f;
+    }
+
+    bool ParticleSystem::IsSimdSupported()
+    {
+#if defined(PARTICLES_X86) && defined(_MSC_VER)
+        static const bool supported = []
+        {
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+            {
+                return false;
+            }
+            // AVX needs the OS to save the upper halves of the registers
+            __cpuid(info, 1);
+            if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6)
+            {
+                return false;
+            }
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+        }();
+        return supported;
+#elif defined(PARTICLES_X86)
+        return __builtin_cpu_supports("avx2") != 0;
+#else
+        return false;
+#endif
+    }
+
+    double ParticleSystem::Benchmark(const unsigned int particleCount, const unsigned int updateCount, const bool useSimd, ThreadPool* threadPool)
+    {
+        constexpr float deltaTime = 1.0f / 60.0f;
+        ParticleSystem system(particleCount);
+        system.SetSimdEnabled(useSimd);
+        system.AddPlane({ glm::vec3(0.0f, 1.0f, 0.0f), -1.0f });
+        system.GetSettings().minLifetime = system.GetSettings().maxLifetime = 1e9f;
+        system.GetSettings().emitRate = static_cast<float>(particleCount) / deltaTime;
+        system.Update(deltaTime, threadPool);
+        system.GetSettings().emitRate = 0.0f;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < updateCount; i++)
+        {
+            system.Update(deltaTime, threadPool);
+        }
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return updateCount > 0 ? elapsed.count() / updateCount : 0.0;
+    }
+
+    void ParticleSystem::ForEachChunk(const unsigned int chunkCount, ThreadPool* threadPool, const std::function<void(unsigned int)>& body)
+    {
+        if (threadPool)
+        {
+            threadPool->ParallelFor(chunkCount, body);
+            return;
+        }
+        for (unsigned int chunk = 0; chunk < chunkCount; chunk++)
+        {
+            body(chunk);
+        }
+    }
+
+    unsigned int ParticleSystem::Simulate(const unsigned int begin, const unsigned int end, unsigned int write, const float deltaTime)
+    {
+        const float damping = std::max(1.0f - m_Settings.drag * deltaTime, 0.0f);
+        const glm::vec3 gravity = m_Settings.gravity * deltaTime;
+        const float bounce = 1.0f + m_Settings.restitution;
+        for (unsigned int i = begin; i < end; i++)
+        {
+            const float age = m_Age[i] + deltaTime;
+            if (age >= m_Lifetime[i])
+            {
+                continue;
+            }
+
+            glm::vec3 velocity = glm::vec3(m_VelocityX[i], m_VelocityY[i], m_VelocityZ[i]) * damping + gravity;
+            glm::vec3 position = glm::vec3(m_PositionX[i], m_PositionY[i], m_PositionZ[i]) + velocity * deltaTime;
+            for (const ParticlePlane& plane : m_Planes)
+            {
+                const float distance = glm::dot(plane.normal, position) - plane.distance;
+                if (distance < 0.0f)
+                {
+                    position -= plane.normal * distance;
+                    const float speed = glm::dot(plane.normal, velocity);
+                    if (speed < 0.0f)
+                    {
+                        velocity -= plane.normal * (speed * bounce);
+                    }
+                }
+            }
+
+            m_PositionX[write] = position.x;
+            m_PositionY[write] = position.y;
+            m_PositionZ[write] = position.z;
+            m_VelocityX[write] = velocity.x;
+            m_VelocityY[write] = velocity.y;
+            m_VelocityZ[write] = velocity.z;
+            m_Age[write] = age;
+            m_Lifetime[write] = m_Lifetime[i];
+            write++;
+        }
+        return write;
+    }
+
+#ifdef PARTICLES_X86
+    PARTICLES_AVX2 unsigned int ParticleSystem::SimulateAvx2(const unsigned int begin, const unsigned int end, unsigned int write, const float deltaTime)
+    {
+        const CompactTable& table = GetCompactTable();
+        const __m256 dt = _mm256_set1_ps(deltaTime);
+        const __m256 damping = _mm256_set1_ps(std::max(1.0f - m_Settings.drag * deltaTime, 0.0f));
+        const __m256 gravityX = _mm256_set1_ps(m_Settings.gravity.x * deltaTime);
+        const __m256 gravityY = _mm256_set1_ps(m_Settings.gravity.y * deltaTime);
+        const __m256 gravityZ = _mm256_set1_ps(m_Settings.gravity.z * deltaTime);
+        const __m256 bounce = _mm256_set1_ps(1.0f + m_Settings.restitution);
+        const __m256 zero = _mm256_setzero_ps();
+
+        float* const px = m_PositionX.data();
+        float* const py = m_PositionY.data();
+        float* const pz = m_PositionZ.data();
+        float* const vx = m_VelocityX.data();
+        float* const vy = m_VelocityY.data();
+        float* const vz = m_VelocityZ.data();
+        float* const ages = m_Age.data();
+        float* const lifetimes = m_Lifetime.data();
+
+        unsigned int i = begin;
+        for (; i + 8 <= end; i += 8)
+        {
+            const __m256 age = _mm256_add_ps(_mm256_loadu_ps(ages + i), dt);
+            const __m256 lifetime = _mm256_loadu_ps(lifetimes + i);
+            const int alive = _mm256_movemask_ps(_mm256_cmp_ps(age, lifetime, _CMP_LT_OQ));
+            if (alive == 0)
+            {
+                continue;
+            }
+
+            __m256 velocityX = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(vx + i), damping), gravityX);
+            __m256 velocityY = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(vy + i), damping), gravityY);
+            __m256 velocityZ = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(vz + i), damping), gravityZ);
+            __m256 positionX = _mm256_add_ps(_mm256_loadu_ps(px + i), _mm256_mul_ps(velocityX, dt));
+            __m256 positionY = _mm256_add_ps(_mm256_loadu_ps(py + i), _mm256_mul_ps(velocityY, dt));
+            __m256 positionZ = _mm256_add_ps(_mm256_loadu_ps(pz + i), _mm256_mul_ps(velocityZ, dt));
+
+            for (const ParticlePlane& plane : m_Planes)
+            {
+                const __m256 normalX = _mm256_set1_ps(plane.normal.x);
+                const __m256 normalY = _mm256_set1_ps(plane.normal.y);
+                const __m256 normalZ = _mm256_set1_ps(plane.normal.z);
+                const __m256 distance = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(normalX, positionX), _mm256_mul_ps(normalY, positionY)),
+                                                                    _mm256_mul_ps(normalZ, positionZ)), _mm256_set1_ps(plane.distance));
+                const __m256 behind = _mm256_cmp_ps(distance, zero, _CMP_LT_OQ);
+                if (_mm256_movemask_ps(behind) == 0)
+                {
+                    continue;
+                }
+
+                // Pushed back onto the plane, and the speed into it reflected
+                const __m256 push = _mm256_and_ps(behind, distance);
+                positionX = _mm256_sub_ps(positionX, _mm256_mul_ps(normalX, push));
+                positionY = _mm256_sub_ps(positionY, _mm256_mul_ps(normalY, push));
+                positionZ = _mm256_sub_ps(positionZ, _mm256_mul_ps(normalZ, push));
+                const __m256 speed = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(normalX, velocityX), _mm256_mul_ps(normalY, velocityY)),
+                                                   _mm256_mul_ps(normalZ, velocityZ));
+                const __m256 reflect = _mm256_and_ps(_mm256_and_ps(behind, _mm256_cmp_ps(speed, zero, _CMP_LT_OQ)), _mm256_mul_ps(speed, bounce));
+                velocityX = _mm256_sub_ps(velocityX, _mm256_mul_ps(normalX, reflect));
+                velocityY = _mm256_sub_ps(velocityY, _mm256_mul_ps(normalY, reflect));
+                velocityZ = _mm256_sub_ps(velocityZ, _mm256_mul_ps(normalZ, reflect));
+            }
+
+            // Gathering the alive lanes to the front and storing all eight only overwrites lanes
+            // already loaded, since write never passes i
+            const __m256i lanes = _mm256_load_si256(reinterpret_cast<const __m256i*>(table.lanes[alive]));
+            _mm256_storeu_ps(px + write, _mm256_permutevar8x32_ps(positionX, lanes));
+            _mm256_storeu_ps(py + write, _mm256_permutevar8x32_ps(positionY, lanes));
+            _mm256_storeu_ps(pz + write, _mm256_permutevar8x32_ps(positionZ, lanes));
+            _mm256_storeu_ps(vx + write, _mm256_permutevar8x32_ps(velocityX, lanes));
+            _mm256_storeu_ps(vy + write, _mm256_permutevar8x32_ps(velocityY, lanes));
+            _mm256_storeu_ps(vz + write, _mm256_permutevar8x32_ps(velocityZ, lanes));
+            _mm256_storeu_ps(ages + write, _mm256_permutevar8x32_ps(age, lanes));
+            _mm256_storeu_ps(lifetimes + write, _mm256_permutevar8x32_ps(lifetime, lanes));
+            write += table.counts[alive];
+        }
+        return Simulate(i, end, write, deltaTime);
+    }
+
+    PARTICLES_AVX2 void ParticleSystem::EmitAvx2(const unsigned int first, const unsigned int count, const uint32_t seed)
+    {
+        const ParticleSettings& settings = m_Settings;
+        const unsigned int blockEnd = first + count / 8 * 8;
+
+        // Eight xorshift32 generators side by side, floats are made from their upper 23 bits
+        __m256i state = _mm256_set_epi32(static_cast<int>(MixSeed(seed, 7)), static_cast<int>(MixSeed(seed, 6)),
+                                         static_cast<int>(MixSeed(seed, 5)), static_cast<int>(MixSeed(seed, 4)),
+                                         static_cast<int>(MixSeed(seed, 3)), static_cast<int>(MixSeed(seed, 2)),
+                                         static_cast<int>(MixSeed(seed, 1)), static_cast<int>(MixSeed(seed, 0)));
+        const __m256i exponent = _mm256_set1_epi32(0x3F800000);
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 two = _mm256_set1_ps(2.0f);
+        const __m256 three = _mm256_set1_ps(3.0f);
+
+        const __m256 positionX = _mm256_set1_ps(settings.emitterPosition.x), extentX = _mm256_set1_ps(settings.emitterExtent.x);
+        const __m256 positionY = _mm256_set1_ps(settings.emitterPosition.y), extentY = _mm256_set1_ps(settings.emitterExtent.y);
+        const __m256 positionZ = _mm256_set1_ps(settings.emitterPosition.z), extentZ = _mm256_set1_ps(settings.emitterExtent.z);
+        const __m256 velocityX = _mm256_set1_ps(settings.velocity.x), spreadX = _mm256_set1_ps(settings.velocitySpread.x);
+        const __m256 velocityY = _mm256_set1_ps(settings.velocity.y), spreadY = _mm256_set1_ps(settings.velocitySpread.y);
+        const __m256 velocityZ = _mm256_set1_ps(settings.velocity.z), spreadZ = _mm256_set1_ps(settings.velocitySpread.z);
+        const __m256 minLifetime = _mm256_set1_ps(settings.minLifetime);
+        const __m256 lifetimeRange = _mm256_set1_ps(settings.maxLifetime - settings.minLifetime);
+
+        __m256 random[7];
+        for (unsigned int i = first; i < blockEnd; i += 8)
+        {
+            for (__m256& value : random)
+            {
+                state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 13));
+                state = _mm256_xor_si256(state, _mm256_srli_epi32(state, 17));
+                state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 5));
+                // [1, 2) from the mantissa, then mapped to [-1, 1)
+                value = _mm256_sub_ps(_mm256_mul_ps(_mm256_castsi256_ps(_mm256_or_si256(_mm256_srli_epi32(state, 9), exponent)), two), three);
+            }
+            _mm256_storeu_ps(&m_PositionX[i], _mm256_add_ps(positionX, _mm256_mul_ps(random[0], extentX)));
+            _mm256_storeu_ps(&m_PositionY[i], _mm256_add_ps(positionY, _mm256_mul_ps(random[1], extentY)));
+            _mm256_storeu_ps(&m_PositionZ[i], _mm256_add_ps(positionZ, _mm256_mul_ps(random[2], extentZ)));
+            _mm256_storeu_ps(&m_VelocityX[i], _mm256_add_ps(velocityX, _mm256_mul_ps(random[3], spreadX)));
+            _mm256_storeu_ps(&m_VelocityY[i], _mm256_add_ps(velocityY, _mm256_mul_ps(random[4], spreadY)));
+            _mm256_storeu_ps(&m_VelocityZ[i], _mm256_add_ps(velocityZ, _mm256_mul_ps(random[5], spreadZ)));
+            _mm256_storeu_ps(&m_Age[i], _mm256_setzero_ps());
+            const __m256 unit = _mm256_mul_ps(_mm256_add_ps(random[6], one), _mm256_set1_ps(0.5f));
+            _mm256_storeu_ps(&m_Lifetime[i], _mm256_add_ps(minLifetime, _mm256_mul_ps(unit, lifetimeRange)));
+        }
+        Emit(blockEnd, first + count - blockEnd, MixSeed(seed, 8));
+    }
+#else
+    unsigned int ParticleSystem::SimulateAvx2(const unsigned int begin, const unsigned int end, const unsigned int write, const float deltaTime)
+    {
+        return Simulate(begin, end, write, deltaTime);
+    }
+
+    void ParticleSystem::EmitAvx2(const unsigned int first, const unsigned int count, const uint32_t seed)
+    {
+        Emit(first, count, seed);
+    }
+#endif
+
+    void ParticleSystem::Emit(const unsigned int first, const unsigned int count, const uint32_t seed)
+    {
+        const ParticleSettings& settings = m_Settings;
+        uint32_t state = seed;
+        for (unsigned int i = first; i < first + count; i++)
+        {
+            m_PositionX[i] = settings.emitterPosition.x + RandomSigned(state) * settings.emitterExtent.x;
+            m_PositionY[i] = settings.emitterPosition.y + RandomSigned(state) * settings.emitterExtent.y;
+            m_PositionZ[i] = settings.emitterPosition.z + RandomSigned(state) * settings.emitterExtent.z;
+            m_VelocityX[i] = settings.velocity.x + RandomSigned(state) * settings.velocitySpread.x;
+            m_VelocityY[i] = settings.velocity.y + RandomSigned(state) * settings.velocitySpread.y;
+            m_VelocityZ[i] = settings.velocity.z + RandomSigned(state) * settings.velocitySpread.z;
+            m_Age[i] = 0.0f;
+            m_Lifetime[i] = settings.minLifetime + RandomUnsigned(state) * (settings.maxLifetime - settings.minLifetime);
+        }
+    }
+}  // namespace Utils
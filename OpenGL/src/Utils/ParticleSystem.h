@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <GLM/glm.hpp>
+
+namespace Utils
+{
+    class ThreadPool;
+
+    /**
+     * \brief How particles are emitted and how they move
+     */
+    struct ParticleSettings
+    {
+        glm::vec3 emitterPosition = glm::vec3(0.0f);
+        glm::vec3 emitterExtent = glm::vec3(0.1f);    // half the size of the box particles start in
+        glm::vec3 velocity = glm::vec3(0.0f, 5.0f, 0.0f);
+        glm::vec3 velocitySpread = glm::vec3(2.0f);   // the most each component of the start velocity differs from velocity
+        float emitRate = 100000.0f;                   // particles per second
+        float minLifetime = 2.0f;
+        float maxLifetime = 4.0f;
+
+        glm::vec3 gravity = glm::vec3(0.0f, -9.81f, 0.0f);
+        float drag = 0.1f;                            // fraction of the velocity lost per second
+        float restitution = 0.5f;                     // fraction of the speed into a plane that bounces back
+
+        float startSize = 0.05f;
+        float endSize = 0.01f;
+        glm::vec4 startColor = glm::vec4(1.0f, 0.8f, 0.3f, 1.0f);
+        glm::vec4 endColor = glm::vec4(1.0f, 0.2f, 0.1f, 0.0f);
+    };
+
+    /**
+     * \brief A plane particles bounce off, they are kept on the side the normal points to
+     */
+    struct ParticlePlane
+    {
+        glm::vec3 normal;  // unit length
+        float distance;    // from the origin along the normal
+    };
+
+    /**
+     * \brief One particle as it is drawn, a billboard at a position
+     */
+    struct ParticleInstance
+    {
+        glm::vec3 position;
+        float size;
+        uint8_t color[4];  // RGBA
+    };
+
+    /**
+     * \brief Simulates particles on the CPU. The particles are stored as structure of arrays in
+     * chunks of fixed capacity, each chunk is updated on its own worker: new particles are emitted
+     * into it, the others are moved, bounced off the planes and the dead ones are squeezed out, so
+     * the alive particles of a chunk always come first. The kernels use AVX2 when the CPU has it
+     */
+    class ParticleSystem
+    {
+    public:
+        static constexpr unsigned int CHUNK_SIZE = 16384;
+
+    private:
+        ParticleSettings m_Settings;
+        std::vector<ParticlePlane> m_Planes;
+
+        unsigned int m_Capacity;
+        std::vector<float> m_PositionX, m_PositionY, m_PositionZ;
+        std::vector<float> m_VelocityX, m_VelocityY, m_VelocityZ;
+        std::vector<float> m_Age, m_Lifetime;
+        std::vector<unsigned int> m_ChunkCounts;
+        std::vector<unsigned int> m_ChunkEmits;  // particles to emit into each chunk this update
+
+        float m_EmitRemainder;
+        uint32_t m_Frame;
+        unsigned int m_AliveCount;
+        bool m_UseSimd;
+
+    public:
+        /**
+         * \brief Constructs a system without particles
+         * \param capacity The most particles alive at once, rounded up to a multiple of CHUNK_SIZE
+         */
+        explicit ParticleSystem(unsigned int capacity);
+
+        /**
+         * \brief Emit, move and bounce the particles and drop the ones that outlived their lifetime
+         * \param deltaTime The time since the last update in seconds
+         * \param threadPool The workers the chunks are updated on, nullptr to update them on the calling thread
+         */
+        void Update(float deltaTime, ThreadPool* threadPool = nullptr);
+
+        /**
+         * \brief Write the alive particles as instances, with their size and color for their age
+         * \param instances Room for GetAliveCount instances, such as a mapped instance buffer
+         * \param threadPool The workers the chunks are written on, nullptr to write them on the calling thread
+         * \return The number of instances written
+         */
+        unsigned int WriteInstances(ParticleInstance* instances, ThreadPool* threadPool = nullptr) const;
+
+        /**
+         * \brief Kill every particle
+         */
+        void Clear();
+
+        /**
+         * \brief Add a plane for the particles to bounce off
+         * \param plane The plane
+         */
+        inline void AddPlane(const ParticlePlane& plane) { m_Planes.push_back(plane); }
+
+        /**
+         * \brief Remove every plane
+         */
+        inline void ClearPlanes() { m_Planes.clear(); }
+
+        /**
+         * \brief Get the emitter and physics settings, changes take effect on the next Update
+         * \return The settings
+         */
+        inline ParticleSettings& GetSettings() { return m_Settings; }
+
+        /**
+         * \brief Choose between the AVX2 and the scalar kernels, AVX2 is only used if the CPU has it
+         * \param useSimd Whether to use AVX2
+         */
+        inline void SetSimdEnabled(const bool useSimd) { m_UseSimd = useSimd && IsSimdSupported(); }
+
+        /**
+         * \brief Get whether the AVX2 kernels are used
+         * \return true if they are; false otherwise
+         */
+        inline bool IsSimdEnabled() const { return m_UseSimd; }
+
+        /**
+         * \brief Get the number of particles alive
+         * \return The number of particles
+         */
+        inline unsigned int GetAliveCount() const { return m_AliveCount; }
+
+        /**
+         * \brief Get the most particles alive at once
+         * \return The capacity
+         */
+        inline unsigned int GetCapacity() const { return m_Capacity; }
+
+        /**
+         * \brief Get whether the CPU and OS support AVX2
+         * \return true if they do; false otherwise
+         */
+        static bool IsSimdSupported();
+
+        /**
+         * \brief Time Update on a full system bouncing off a floor
+         * \param particleCount The number of particles, kept alive throughout
+         * \param updateCount The number of updates timed, after one to warm up
+         * \param useSimd Whether to use AVX2
+         * \param threadPool The workers, nullptr for the calling thread only
+         * \return The average time of one update in milliseconds
+         */
+        static double Benchmark(unsigned int particleCount, unsigned int updateCount, bool useSimd, ThreadPool* threadPool = nullptr);
+
+    private:
+        // Runs body for every chunk, on the workers if there are any
+        static void ForEachChunk(unsigned int chunkCount, ThreadPool* threadPool, const std::function<void(unsigned int)>& body);
+
+        // Moves and bounces the particles in [begin, end) and packs the alive ones from write on, returns where the next one goes
+        unsigned int Simulate(unsigned int begin, unsigned int end, unsigned int write, float deltaTime);
+        unsigned int SimulateAvx2(unsigned int begin, unsigned int end, unsigned int write, float deltaTime);
+
+        // Initializes count new particles starting at first
+        void Emit(unsigned int first, unsigned int count, uint32_t seed);
+        void EmitAvx2(unsigned int first, unsigned int count, uint32_t seed);
+
+    };  // class ParticleSystem
+}  // namespace Utils
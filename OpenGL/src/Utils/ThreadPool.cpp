@@ -0,0 +1,105 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace Utils
+{
+    ThreadPool::ThreadPool(unsigned int threadCount)
+        : m_Stopping(false)
+    {
+        if (threadCount == 0)
+        {
+            // leave one hardware thread to the render thread
+            threadCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        }
+
+        m_Workers.reserve(threadCount);
+        for (unsigned int i = 0; i < threadCount; i++)
+        {
+            m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stopping = true;
+            m_Tasks.clear();
+        }
+        m_Condition.notify_all();
+
+        for (std::thread& worker : m_Workers)
+        {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::Enqueue(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Tasks.push_back(std::move(task));
+        }
+        m_Condition.notify_one();
+    }
+
+    void ThreadPool::ParallelFor(const unsigned int count, const std::function<void(unsigned int)>& body)
+    {
+        struct State
+        {
+            std::atomic<unsigned int> next{ 0 };
+            std::mutex mutex;
+            std::condition_variable done;
+            unsigned int finished = 0;
+        };
+        const auto state = std::make_shared<State>();
+
+        // Workers that only get to their task after every index is taken return without touching
+        // body, so it may go out of scope as soon as the last index is finished
+        auto run = [state, count, &body]
+        {
+            for (unsigned int index = state->next++; index < count; index = state->next++)
+            {
+                body(index);
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (++state->finished == count)
+                {
+                    state->done.notify_all();
+                }
+            }
+        };
+
+        const unsigned int helpers = std::min(count > 0 ? count - 1 : 0, GetThreadCount());
+        for (unsigned int i = 0; i < helpers; i++)
+        {
+            Enqueue(run);
+        }
+        run();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&state, count] { return state->finished == count; });
+    }
+
+    void ThreadPool::WorkerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Condition.wait(lock, [this] { return m_Stopping || !m_Tasks.empty(); });
+                if (m_Stopping)
+                {
+                    return;
+                }
+                task = std::move(m_Tasks.front());
+                m_Tasks.pop_front();
+            }
+
+            task();
+        }
+    }
+}  // namespace Utils
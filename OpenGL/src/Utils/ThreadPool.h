@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+    /**
+     * \brief A fixed set of worker threads running tasks in the order they are enqueued
+     */
+    class ThreadPool
+    {
+    private:
+        std::vector<std::thread> m_Workers;
+        std::deque<std::function<void()>> m_Tasks;
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        bool m_Stopping;
+
+    public:
+        /**
+         * \brief Starts the worker threads
+         * \param threadCount The number of workers, 0 uses one per hardware thread but one
+         */
+        explicit ThreadPool(unsigned int threadCount = 0);
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * \brief Discards the tasks that haven't started and joins the workers
+         */
+        ~ThreadPool();
+
+        /**
+         * \brief Run a task on one of the workers
+         * \param task The function to be called, must not throw
+         */
+        void Enqueue(std::function<void()> task);
+
+        /**
+         * \brief Run a function for every index in [0, count) on the workers and the calling
+         * thread, returning once all of them are done. Safe to call from a worker
+         * \param count The number of indices
+         * \param body The function to be called with each index, must not throw
+         */
+        void ParallelFor(unsigned int count, const std::function<void(unsigned int)>& body);
+
+        /**
+         * \brief Get the number of worker threads
+         * \return The number of workers
+         */
+        inline unsigned int GetThreadCount() const { return static_cast<unsigned int>(m_Workers.size()); }
+
+    private:
+        // Runs tasks until the pool is destroyed
+        void WorkerLoop();
+
+    };  // class ThreadPool
+}  // namespace Utils
@@ -0,0 +1,81 @@
+#include "VertexQuantizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <GLM/gtc/matrix_transform.hpp>
+
+namespace Utils
+{
+    std::vector<QuantizedVertex> VertexQuantizer::Quantize(const MeshData& mesh)
+    {
+        const glm::vec3 scale = 65535.0f / GetExtent(mesh);
+        std::vector<QuantizedVertex> vertices(mesh.vertices.size());
+        for (size_t i = 0; i < mesh.vertices.size(); i++)
+        {
+            const MeshVertex& vertex = mesh.vertices[i];
+            QuantizedVertex& quantized = vertices[i];
+
+            const glm::vec3 position = glm::clamp(glm::round((vertex.position - mesh.boundsMin) * scale), 0.0f, 65535.0f);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                quantized.position[axis] = static_cast<uint16_t>(position[axis]);
+            }
+            quantized.texCoord[0] = Maths::Half::FromFloat(vertex.texCoord.x);
+            quantized.texCoord[1] = Maths::Half::FromFloat(vertex.texCoord.y);
+
+            const glm::vec2 normal = glm::round(EncodeOctahedral(vertex.normal) * 127.0f);
+            quantized.normal[0] = static_cast<int8_t>(normal.x);
+            quantized.normal[1] = static_cast<int8_t>(normal.y);
+        }
+        return vertices;
+    }
+
+    glm::mat4 VertexQuantizer::GetPositionTransform(const MeshData& mesh)
+    {
+        return glm::scale(glm::translate(glm::mat4(1.0f), mesh.boundsMin), GetExtent(mesh));
+    }
+
+    glm::vec2 VertexQuantizer::EncodeOctahedral(const glm::vec3& normal)
+    {
+        const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        if (length == 0.0f)
+        {
+            return glm::vec2(0.0f);
+        }
+        glm::vec2 encoded = glm::vec2(normal) / length;
+        if (normal.z < 0.0f)
+        {
+            // The lower half is folded out over the diagonals
+            const glm::vec2 folded = 1.0f - glm::abs(glm::vec2(encoded.y, encoded.x));
+            encoded = glm::vec2(encoded.x >= 0.0f ? folded.x : -folded.x, encoded.y >= 0.0f ? folded.y : -folded.y);
+        }
+        return encoded;
+    }
+
+    glm::vec3 VertexQuantizer::DecodeOctahedral(const glm::vec2& encoded)
+    {
+        glm::vec3 normal(encoded, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+        const float fold = std::max(-normal.z, 0.0f);
+        normal.x += normal.x >= 0.0f ? -fold : fold;
+        normal.y += normal.y >= 0.0f ? -fold : fold;
+        return glm::normalize(normal);
+    }
+
+    uint32_t VertexQuantizer::PackSnorm2101010(const glm::vec4& value)
+    {
+        const glm::vec4 clamped = glm::clamp(value, -1.0f, 1.0f);
+        const auto x = static_cast<int32_t>(std::round(clamped.x * 511.0f));
+        const auto y = static_cast<int32_t>(std::round(clamped.y * 511.0f));
+        const auto z = static_cast<int32_t>(std::round(clamped.z * 511.0f));
+        const auto w = static_cast<int32_t>(std::round(clamped.w));
+        return static_cast<uint32_t>(x & 0x3FF) | static_cast<uint32_t>(y & 0x3FF) << 10 |
+               static_cast<uint32_t>(z & 0x3FF) << 20 | static_cast<uint32_t>(w & 0x3) << 30;
+    }
+
+    glm::vec3 VertexQuantizer::GetExtent(const MeshData& mesh)
+    {
+        const glm::vec3 extent = mesh.boundsMax - mesh.boundsMin;
+        return glm::vec3(extent.x > 0.0f ? extent.x : 1.0f, extent.y > 0.0f ? extent.y : 1.0f, extent.z > 0.0f ? extent.z : 1.0f);
+    }
+}  // namespace Utils
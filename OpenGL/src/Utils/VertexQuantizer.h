@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <GLM/glm.hpp>
+
+#include "MeshImporter.h"
+#include "../Maths/Half.h"
+
+namespace Utils
+{
+    /**
+     * \brief A mesh vertex in 12 bytes instead of 32. Read the position as normalized unsigned
+     * shorts, the texture coordinate as half floats and the normal as normalized signed chars
+     */
+    struct QuantizedVertex
+    {
+        uint16_t position[3];   // within the mesh's bounds, 0 is boundsMin and 65535 is boundsMax
+        Maths::Half texCoord[2];
+        int8_t normal[2];       // octahedral, see DecodeOctahedral
+    };
+
+    static_assert(sizeof(QuantizedVertex) == 12, "QuantizedVertex must be tightly packed");
+
+    /**
+     * \brief Shrinks the vertices of a mesh for upload. Positions lose at most 1/131070 of the
+     * bounds' size on each axis, which the transform from GetPositionTransform scales back.
+     * Normals are folded onto an octahedron and stored in two bytes, about 1 degree off at worst
+     */
+    class VertexQuantizer
+    {
+    public:
+        /**
+         * \brief Quantize every vertex of a mesh
+         * \param mesh The mesh, whose bounds must be computed
+         * \return The vertices in the same order
+         */
+        static std::vector<QuantizedVertex> Quantize(const MeshData& mesh);
+
+        /**
+         * \brief Get the transform from quantized positions, read in [0, 1], back to model space
+         * \param mesh The mesh that was quantized
+         * \return The matrix to multiply the model matrix with
+         */
+        static glm::mat4 GetPositionTransform(const MeshData& mesh);
+
+        /**
+         * \brief Map a unit vector onto the octahedron |x| + |y| + |z| = 1 and unfold it into a square
+         * \param normal A unit vector
+         * \return The point in [-1, 1]^2
+         */
+        static glm::vec2 EncodeOctahedral(const glm::vec3& normal);
+
+        /**
+         * \brief Turn a point from EncodeOctahedral back into a unit vector
+         * \param encoded The point in [-1, 1]^2
+         * \return The unit vector
+         */
+        static glm::vec3 DecodeOctahedral(const glm::vec2& encoded);
+
+        /**
+         * \brief Pack a vector for a GL_INT_2_10_10_10_REV attribute
+         * \param value Four components in [-1, 1], w is stored with 2 bits so only -1, 0 and 1 survive
+         * \return x in the lowest 10 bits, then y, z and w
+         */
+        static uint32_t PackSnorm2101010(const glm::vec4& value);
+
+    private:
+        // Bounds with no extent on an axis still need a non-zero scale
+        static glm::vec3 GetExtent(const MeshData& mesh);
+
+    };  // class VertexQuantizer
+}  // namespace Utils
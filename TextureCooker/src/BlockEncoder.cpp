@@ -0,0 +1,672 @@
+#include "BlockEncoder.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COOKER_SSE2 1
+#include <emmintrin.h>
+#else
+#define COOKER_SSE2 0
+#endif
+
+namespace Cooker
+{
+    namespace
+    {
+        // 16 texels stored channel by channel so four of them fill one register
+        struct Texels
+        {
+            alignas(16) float channels[4][16];
+        };
+
+        struct Color
+        {
+            float c[4];
+        };
+
+        constexpr int REFINE_ITERATIONS = 3;
+
+        Texels LoadTexels(const unsigned char* texels)
+        {
+            Texels result;
+            for (int i = 0; i < 16; i++)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    result.channels[c][i] = texels[i * 4 + c];
+                }
+            }
+            return result;
+        }
+
+        float Clamp255(const float value)
+        {
+            return std::min(255.0f, std::max(0.0f, value));
+        }
+
+        // Picks the closest palette entry for every texel and returns the summed weighted squared error
+        float FindClosest(const Texels& texels, const Color* palette, const int paletteSize, const float* weights, int* indices)
+        {
+#if COOKER_SSE2
+            float total = 0.0f;
+            for (int i = 0; i < 16; i += 4)
+            {
+                __m128 channels[4];
+                for (int c = 0; c < 4; c++)
+                {
+                    channels[c] = _mm_load_ps(&texels.channels[c][i]);
+                }
+
+                __m128 best = _mm_set1_ps(FLT_MAX);
+                __m128 bestIndex = _mm_setzero_ps();
+                for (int p = 0; p < paletteSize; p++)
+                {
+                    __m128 distance = _mm_setzero_ps();
+                    for (int c = 0; c < 4; c++)
+                    {
+                        const __m128 difference = _mm_sub_ps(channels[c], _mm_set1_ps(palette[p].c[c]));
+                        distance = _mm_add_ps(distance, _mm_mul_ps(_mm_mul_ps(difference, difference), _mm_set1_ps(weights[c])));
+                    }
+
+                    const __m128 closer = _mm_cmplt_ps(distance, best);
+                    best = _mm_min_ps(distance, best);
+                    bestIndex = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps(static_cast<float>(p))), _mm_andnot_ps(closer, bestIndex));
+                }
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(indices + i), _mm_cvtps_epi32(bestIndex));
+                alignas(16) float errors[4];
+                _mm_store_ps(errors, best);
+                total += errors[0] + errors[1] + errors[2] + errors[3];
+            }
+            return total;
+#else
+            float total = 0.0f;
+            for (int i = 0; i < 16; i++)
+            {
+                float best = FLT_MAX;
+                for (int p = 0; p < paletteSize; p++)
+                {
+                    float distance = 0.0f;
+                    for (int c = 0; c < 4; c++)
+                    {
+                        const float difference = texels.channels[c][i] - palette[p].c[c];
+                        distance += difference * difference * weights[c];
+                    }
+                    if (distance < best)
+                    {
+                        best = distance;
+                        indices[i] = p;
+                    }
+                }
+                total += best;
+            }
+            return total;
+#endif
+        }
+
+        // Fits a line through the texels along their principal axis and returns the two ends of their extent on it
+        void FitEndpoints(const Texels& texels, const float* weights, Color& endpoint0, Color& endpoint1)
+        {
+            float mean[4] = {};
+            for (int c = 0; c < 4; c++)
+            {
+                for (int i = 0; i < 16; i++)
+                {
+                    mean[c] += texels.channels[c][i];
+                }
+                mean[c] /= 16.0f;
+            }
+
+            float covariance[4][4] = {};
+            for (int i = 0; i < 16; i++)
+            {
+                float offset[4];
+                for (int c = 0; c < 4; c++)
+                {
+                    offset[c] = (texels.channels[c][i] - mean[c]) * weights[c];
+                }
+                for (int row = 0; row < 4; row++)
+                {
+                    for (int column = 0; column < 4; column++)
+                    {
+                        covariance[row][column] += offset[row] * offset[column];
+                    }
+                }
+            }
+
+            // power iteration converges on the direction of largest variance
+            float axis[4] = { weights[0], weights[1], weights[2], weights[3] };
+            for (int iteration = 0; iteration < 8; iteration++)
+            {
+                float next[4] = {};
+                float largest = 0.0f;
+                for (int row = 0; row < 4; row++)
+                {
+                    for (int column = 0; column < 4; column++)
+                    {
+                        next[row] += covariance[row][column] * axis[column];
+                    }
+                    largest = std::max(largest, std::fabs(next[row]));
+                }
+                if (largest < 1e-6f)
+                {
+                    break;  // every texel is the same colour
+                }
+                for (int c = 0; c < 4; c++)
+                {
+                    axis[c] = next[c] / largest;
+                }
+            }
+
+            const float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3]);
+            for (float& component : axis)
+            {
+                component /= length;
+            }
+
+            float minimum = FLT_MAX, maximum = -FLT_MAX;
+            for (int i = 0; i < 16; i++)
+            {
+                float projection = 0.0f;
+                for (int c = 0; c < 4; c++)
+                {
+                    projection += (texels.channels[c][i] - mean[c]) * axis[c];
+                }
+                minimum = std::min(minimum, projection);
+                maximum = std::max(maximum, projection);
+            }
+
+            for (int c = 0; c < 4; c++)
+            {
+                endpoint0.c[c] = Clamp255(mean[c] + minimum * axis[c]);
+                endpoint1.c[c] = Clamp255(mean[c] + maximum * axis[c]);
+            }
+        }
+
+        // Solves for the endpoints that best reproduce the texels given how far along them each index sits
+        bool RefineEndpoints(const Texels& texels, const int* indices, const float* positions, Color& endpoint0, Color& endpoint1)
+        {
+            float a = 0.0f, b = 0.0f, c = 0.0f;
+            float sum0[4] = {}, sum1[4] = {};
+            for (int i = 0; i < 16; i++)
+            {
+                const float w = positions[indices[i]];
+                a += (1.0f - w) * (1.0f - w);
+                b += (1.0f - w) * w;
+                c += w * w;
+                for (int channel = 0; channel < 4; channel++)
+                {
+                    sum0[channel] += (1.0f - w) * texels.channels[channel][i];
+                    sum1[channel] += w * texels.channels[channel][i];
+                }
+            }
+
+            const float determinant = a * c - b * b;
+            if (std::fabs(determinant) < 1e-6f)
+            {
+                return false;
+            }
+
+            for (int channel = 0; channel < 4; channel++)
+            {
+                endpoint0.c[channel] = Clamp255((c * sum0[channel] - b * sum1[channel]) / determinant);
+                endpoint1.c[channel] = Clamp255((a * sum1[channel] - b * sum0[channel]) / determinant);
+            }
+            return true;
+        }
+
+        class BitWriter
+        {
+        private:
+            unsigned char* m_Data;
+            int m_Position;
+
+        public:
+            explicit BitWriter(unsigned char* data) : m_Data(data), m_Position(0) {}
+
+            void Write(const uint32_t value, const int bits)
+            {
+                for (int bit = 0; bit < bits; bit++, m_Position++)
+                {
+                    if ((value >> bit) & 1)
+                    {
+                        m_Data[m_Position >> 3] |= static_cast<unsigned char>(1 << (m_Position & 7));
+                    }
+                }
+            }
+        };
+
+        class BitReader
+        {
+        private:
+            const unsigned char* m_Data;
+            int m_Position;
+
+        public:
+            explicit BitReader(const unsigned char* data) : m_Data(data), m_Position(0) {}
+
+            uint32_t Read(const int bits)
+            {
+                uint32_t value = 0;
+                for (int bit = 0; bit < bits; bit++, m_Position++)
+                {
+                    value |= static_cast<uint32_t>((m_Data[m_Position >> 3] >> (m_Position & 7)) & 1) << bit;
+                }
+                return value;
+            }
+        };
+
+        // --- BC1 colour and BC3 alpha --------------------------------------------------------------
+
+        uint16_t To565(const Color& color)
+        {
+            const auto r = static_cast<uint16_t>(std::lround(color.c[0] * 31.0f / 255.0f));
+            const auto g = static_cast<uint16_t>(std::lround(color.c[1] * 63.0f / 255.0f));
+            const auto b = static_cast<uint16_t>(std::lround(color.c[2] * 31.0f / 255.0f));
+            return static_cast<uint16_t>(r << 11 | g << 5 | b);
+        }
+
+        Color From565(const uint16_t value)
+        {
+            const int r = value >> 11 & 31, g = value >> 5 & 63, b = value & 31;
+            return { { static_cast<float>(r << 3 | r >> 2), static_cast<float>(g << 2 | g >> 4), static_cast<float>(b << 3 | b >> 2), 255.0f } };
+        }
+
+        // Builds the palette exactly as the decoder does, so the error the search sees is the real one
+        void ColorPalette(const uint16_t color0, const uint16_t color1, const bool threeColor, Color palette[4])
+        {
+            palette[0] = From565(color0);
+            palette[1] = From565(color1);
+            for (int c = 0; c < 3; c++)
+            {
+                const int a = static_cast<int>(palette[0].c[c]), b = static_cast<int>(palette[1].c[c]);
+                palette[2].c[c] = static_cast<float>(threeColor ? (a + b) / 2 : (2 * a + b) / 3);
+                palette[3].c[c] = static_cast<float>(threeColor ? 0 : (a + 2 * b) / 3);
+            }
+            palette[2].c[3] = 255.0f;
+            palette[3].c[3] = threeColor ? 0.0f : 255.0f;
+        }
+
+        // Encodes the colour half of a BC1 or BC3 block. With allowTransparent, texels whose alpha is
+        // below 128 switch the block to three colours plus transparent black
+        void EncodeColorBlock(const unsigned char* texels, const bool allowTransparent, unsigned char* block)
+        {
+            const Texels all = LoadTexels(texels);
+
+            bool transparent[16];
+            int opaqueIndices[16];
+            int opaqueCount = 0;
+            for (int i = 0; i < 16; i++)
+            {
+                transparent[i] = allowTransparent && texels[i * 4 + 3] < 128;
+                if (!transparent[i])
+                {
+                    opaqueIndices[opaqueCount++] = i;
+                }
+            }
+
+            if (opaqueCount == 0)
+            {
+                std::memset(block, 0, 4);
+                std::memset(block + 4, 0xFF, 4);
+                return;
+            }
+            const bool threeColor = opaqueCount < 16;
+
+            // the fit only sees opaque texels, repeating them keeps the SIMD search at 16
+            Texels fit;
+            for (int i = 0; i < 16; i++)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    fit.channels[c][i] = all.channels[c][opaqueIndices[i % opaqueCount]];
+                }
+            }
+
+            constexpr float weights[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+            constexpr float positions4[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+            constexpr float positions3[3] = { 0.0f, 1.0f, 0.5f };
+            const int paletteSize = threeColor ? 3 : 4;
+
+            Color endpoint0, endpoint1;
+            FitEndpoints(fit, weights, endpoint0, endpoint1);
+
+            uint16_t bestColor0 = 0, bestColor1 = 0;
+            float bestError = FLT_MAX;
+            for (int iteration = 0; iteration < REFINE_ITERATIONS; iteration++)
+            {
+                const uint16_t color0 = To565(endpoint0), color1 = To565(endpoint1);
+                Color palette[4];
+                ColorPalette(color0, color1, threeColor, palette);
+
+                int indices[16];
+                const float error = FindClosest(fit, palette, paletteSize, weights, indices);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestColor0 = color0;
+                    bestColor1 = color1;
+                }
+                if (!RefineEndpoints(fit, indices, threeColor ? positions3 : positions4, endpoint0, endpoint1))
+                {
+                    break;
+                }
+            }
+
+            Color palette[4];
+            ColorPalette(bestColor0, bestColor1, threeColor, palette);
+            int indices[16];
+            FindClosest(all, palette, paletteSize, weights, indices);
+
+            // the order of the endpoints selects the mode, swapping them renumbers the indices
+            if (threeColor ? bestColor0 > bestColor1 : bestColor0 < bestColor1)
+            {
+                std::swap(bestColor0, bestColor1);
+                const int swapped[4] = { 1, 0, threeColor ? 2 : 3, threeColor ? 3 : 2 };
+                for (int& index : indices)
+                {
+                    index = swapped[index];
+                }
+            }
+            else if (!threeColor && bestColor0 == bestColor1)
+            {
+                std::fill(indices, indices + 16, 0);
+            }
+
+            uint32_t packed = 0;
+            for (int i = 0; i < 16; i++)
+            {
+                packed |= static_cast<uint32_t>(transparent[i] ? 3 : indices[i]) << (i * 2);
+            }
+
+            std::memcpy(block, &bestColor0, 2);
+            std::memcpy(block + 2, &bestColor1, 2);
+            std::memcpy(block + 4, &packed, 4);
+        }
+
+        void DecodeColorBlock(const unsigned char* block, const bool allowThreeColor, unsigned char* texels)
+        {
+            uint16_t color0, color1;
+            uint32_t packed;
+            std::memcpy(&color0, block, 2);
+            std::memcpy(&color1, block + 2, 2);
+            std::memcpy(&packed, block + 4, 4);
+
+            Color palette[4];
+            ColorPalette(color0, color1, allowThreeColor && color0 <= color1, palette);
+            for (int i = 0; i < 16; i++)
+            {
+                const Color& color = palette[packed >> (i * 2) & 3];
+                for (int c = 0; c < 4; c++)
+                {
+                    texels[i * 4 + c] = static_cast<unsigned char>(color.c[c]);
+                }
+            }
+        }
+
+        void AlphaPalette(const int alpha0, const int alpha1, int palette[8])
+        {
+            palette[0] = alpha0;
+            palette[1] = alpha1;
+            if (alpha0 > alpha1)
+            {
+                for (int k = 2; k < 8; k++)
+                {
+                    palette[k] = ((8 - k) * alpha0 + (k - 1) * alpha1) / 7;
+                }
+            }
+            else
+            {
+                for (int k = 2; k < 6; k++)
+                {
+                    palette[k] = ((6 - k) * alpha0 + (k - 1) * alpha1) / 5;
+                }
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+        }
+
+        void EncodeAlphaBlock(const unsigned char* texels, unsigned char* block)
+        {
+            int minimum = 255, maximum = 0;
+            for (int i = 0; i < 16; i++)
+            {
+                minimum = std::min(minimum, static_cast<int>(texels[i * 4 + 3]));
+                maximum = std::max(maximum, static_cast<int>(texels[i * 4 + 3]));
+            }
+
+            int palette[8];
+            AlphaPalette(maximum, minimum, palette);
+
+            uint64_t packed = 0;
+            for (int i = 0; i < 16; i++)
+            {
+                int bestIndex = 0, bestError = 256;
+                for (int k = 0; k < 8; k++)
+                {
+                    const int error = std::abs(palette[k] - texels[i * 4 + 3]);
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        bestIndex = k;
+                    }
+                }
+                packed |= static_cast<uint64_t>(bestIndex) << (i * 3);
+            }
+
+            block[0] = static_cast<unsigned char>(maximum);
+            block[1] = static_cast<unsigned char>(minimum);
+            for (int byte = 0; byte < 6; byte++)
+            {
+                block[2 + byte] = static_cast<unsigned char>(packed >> (byte * 8));
+            }
+        }
+
+        void DecodeAlphaBlock(const unsigned char* block, unsigned char* texels)
+        {
+            int palette[8];
+            AlphaPalette(block[0], block[1], palette);
+
+            uint64_t packed = 0;
+            for (int byte = 0; byte < 6; byte++)
+            {
+                packed |= static_cast<uint64_t>(block[2 + byte]) << (byte * 8);
+            }
+            for (int i = 0; i < 16; i++)
+            {
+                texels[i * 4 + 3] = static_cast<unsigned char>(palette[packed >> (i * 3) & 7]);
+            }
+        }
+
+        // --- BC7 mode 6 ----------------------------------------------------------------------------
+
+        constexpr int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        struct BC7Endpoint
+        {
+            int quantized[4];  // 7 bits per channel
+            int pBit;
+
+            int Expand(const int channel) const { return quantized[channel] << 1 | pBit; }
+        };
+
+        // Rounds an endpoint to 7 bits per channel plus whichever shared p-bit fits it better
+        BC7Endpoint QuantizeBC7Endpoint(const Color& color)
+        {
+            BC7Endpoint best{};
+            float bestError = FLT_MAX;
+            for (int pBit = 0; pBit < 2; pBit++)
+            {
+                BC7Endpoint candidate{};
+                candidate.pBit = pBit;
+                float error = 0.0f;
+                for (int c = 0; c < 4; c++)
+                {
+                    candidate.quantized[c] = std::min(127, std::max(0, static_cast<int>(std::lround((color.c[c] - pBit) / 2.0f))));
+                    const float difference = static_cast<float>(candidate.Expand(c)) - color.c[c];
+                    error += difference * difference;
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best = candidate;
+                }
+            }
+            return best;
+        }
+
+        void BC7Palette(const BC7Endpoint& endpoint0, const BC7Endpoint& endpoint1, Color palette[16])
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    palette[i].c[c] = static_cast<float>(((64 - BC7_WEIGHTS[i]) * endpoint0.Expand(c) + BC7_WEIGHTS[i] * endpoint1.Expand(c) + 32) >> 6);
+                }
+            }
+        }
+
+        void EncodeBC7Block(const unsigned char* texels, unsigned char* block)
+        {
+            const Texels all = LoadTexels(texels);
+
+            constexpr float weights[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+            float positions[16];
+            for (int i = 0; i < 16; i++)
+            {
+                positions[i] = BC7_WEIGHTS[i] / 64.0f;
+            }
+
+            Color endpoint0, endpoint1;
+            FitEndpoints(all, weights, endpoint0, endpoint1);
+
+            BC7Endpoint best0{}, best1{};
+            int bestIndices[16] = {};
+            float bestError = FLT_MAX;
+            for (int iteration = 0; iteration < REFINE_ITERATIONS; iteration++)
+            {
+                const BC7Endpoint quantized0 = QuantizeBC7Endpoint(endpoint0);
+                const BC7Endpoint quantized1 = QuantizeBC7Endpoint(endpoint1);
+                Color palette[16];
+                BC7Palette(quantized0, quantized1, palette);
+
+                int indices[16];
+                const float error = FindClosest(all, palette, 16, weights, indices);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best0 = quantized0;
+                    best1 = quantized1;
+                    std::copy(indices, indices + 16, bestIndices);
+                }
+                if (!RefineEndpoints(all, indices, positions, endpoint0, endpoint1))
+                {
+                    break;
+                }
+            }
+
+            // the first index is stored without its top bit, so it has to be in the lower half
+            if (bestIndices[0] >= 8)
+            {
+                std::swap(best0, best1);
+                for (int& index : bestIndices)
+                {
+                    index = 15 - index;
+                }
+            }
+
+            std::memset(block, 0, 16);
+            BitWriter writer(block);
+            writer.Write(1 << 6, 7);
+            for (int c = 0; c < 4; c++)
+            {
+                writer.Write(best0.quantized[c], 7);
+                writer.Write(best1.quantized[c], 7);
+            }
+            writer.Write(best0.pBit, 1);
+            writer.Write(best1.pBit, 1);
+            for (int i = 0; i < 16; i++)
+            {
+                writer.Write(bestIndices[i], i == 0 ? 3 : 4);
+            }
+        }
+
+        void DecodeBC7Block(const unsigned char* block, unsigned char* texels)
+        {
+            BitReader reader(block);
+            if (reader.Read(7) != 1 << 6)
+            {
+                std::memset(texels, 0, 64);
+                return;
+            }
+
+            BC7Endpoint endpoint0{}, endpoint1{};
+            for (int c = 0; c < 4; c++)
+            {
+                endpoint0.quantized[c] = static_cast<int>(reader.Read(7));
+                endpoint1.quantized[c] = static_cast<int>(reader.Read(7));
+            }
+            endpoint0.pBit = static_cast<int>(reader.Read(1));
+            endpoint1.pBit = static_cast<int>(reader.Read(1));
+
+            Color palette[16];
+            BC7Palette(endpoint0, endpoint1, palette);
+            for (int i = 0; i < 16; i++)
+            {
+                const Color& color = palette[reader.Read(i == 0 ? 3 : 4)];
+                for (int c = 0; c < 4; c++)
+                {
+                    texels[i * 4 + c] = static_cast<unsigned char>(color.c[c]);
+                }
+            }
+        }
+    }  // namespace
+
+    size_t GetBlockSize(const BlockFormat format)
+    {
+        return format == BlockFormat::BC1 ? 8 : 16;
+    }
+
+    void EncodeBlock(const BlockFormat format, const unsigned char* texels, unsigned char* block)
+    {
+        switch (format)
+        {
+        case BlockFormat::BC1:
+            EncodeColorBlock(texels, true, block);
+            break;
+        case BlockFormat::BC3:
+            EncodeAlphaBlock(texels, block);
+            EncodeColorBlock(texels, false, block + 8);
+            break;
+        case BlockFormat::BC7:
+            EncodeBC7Block(texels, block);
+            break;
+        }
+    }
+
+    void DecodeBlock(const BlockFormat format, const unsigned char* block, unsigned char* texels)
+    {
+        switch (format)
+        {
+        case BlockFormat::BC1:
+            DecodeColorBlock(block, true, texels);
+            break;
+        case BlockFormat::BC3:
+            DecodeColorBlock(block + 8, false, texels);
+            DecodeAlphaBlock(block, texels);
+            break;
+        case BlockFormat::BC7:
+            DecodeBC7Block(block, texels);
+            break;
+        }
+    }
+
+    bool IsSIMDEnabled()
+    {
+        return COOKER_SSE2 != 0;
+    }
+}  // namespace Cooker
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Cooker
+{
+    /**
+     * \brief The block-compressed formats the cooker writes
+     */
+    enum class BlockFormat
+    {
+        BC1,  // RGB with 1-bit alpha, 8 bytes per block
+        BC3,  // RGB with interpolated alpha, 16 bytes per block
+        BC7   // RGBA in mode 6, 16 bytes per block
+    };
+
+    /**
+     * \brief Get the bytes one 4x4 block takes in a format
+     * \param format The block format
+     * \return 8 or 16
+     */
+    size_t GetBlockSize(BlockFormat format);
+
+    /**
+     * \brief Encode one 4x4 block. The endpoint search evaluates four texels at a time with SSE2 where it is available
+     * \param format The block format
+     * \param texels 16 RGBA texels, four bytes each, row by row
+     * \param block Receives GetBlockSize(format) bytes
+     */
+    void EncodeBlock(BlockFormat format, const unsigned char* texels, unsigned char* block);
+
+    /**
+     * \brief Decode one 4x4 block written by EncodeBlock, used to measure the quality of the encoding.
+     * Only mode 6 of BC7 is understood
+     * \param format The block format
+     * \param block GetBlockSize(format) bytes
+     * \param texels Receives 16 RGBA texels, four bytes each, row by row
+     */
+    void DecodeBlock(BlockFormat format, const unsigned char* block, unsigned char* texels);
+
+    /**
+     * \brief Check whether the SSE2 path was compiled in
+     * \return true if the block search uses SSE2; false if it is scalar
+     */
+    bool IsSIMDEnabled();
+}  // namespace Cooker
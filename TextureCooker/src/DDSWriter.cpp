@@ -0,0 +1,92 @@
+#include "DDSWriter.h"
+
+#include <cstdint>
+#include <fstream>
+
+namespace Cooker
+{
+    namespace
+    {
+        constexpr uint32_t FourCC(const char a, const char b, const char c, const char d)
+        {
+            return static_cast<uint32_t>(a) | static_cast<uint32_t>(b) << 8 | static_cast<uint32_t>(c) << 16 | static_cast<uint32_t>(d) << 24;
+        }
+
+        constexpr uint32_t DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000;
+        constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+        constexpr uint32_t DDPF_FOURCC = 0x4;
+        constexpr uint32_t DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+        constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+        uint32_t GetDXGIFormat(const BlockFormat format, const bool srgb)
+        {
+            switch (format)
+            {
+            case BlockFormat::BC1: return srgb ? 72 : 71;
+            case BlockFormat::BC3: return srgb ? 78 : 77;
+            case BlockFormat::BC7: return srgb ? 99 : 98;
+            }
+            return 0;
+        }
+
+        void Write32(std::ofstream& stream, const uint32_t value)
+        {
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+    }  // namespace
+
+    bool WriteDDS(const std::string& path, const BlockFormat format, const bool srgb, const std::vector<EncodedLevel>& levels)
+    {
+        std::ofstream stream(path, std::ios::binary);
+        if (!stream || levels.empty())
+        {
+            return false;
+        }
+
+        const bool dx10 = srgb || format == BlockFormat::BC7;
+        const auto levelCount = static_cast<uint32_t>(levels.size());
+
+        Write32(stream, FourCC('D', 'D', 'S', ' '));
+        Write32(stream, 124);
+        Write32(stream, DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE);
+        Write32(stream, static_cast<uint32_t>(levels[0].height));
+        Write32(stream, static_cast<uint32_t>(levels[0].width));
+        Write32(stream, static_cast<uint32_t>(levels[0].blocks.size()));
+        Write32(stream, 0);  // depth
+        Write32(stream, levelCount);
+        for (int i = 0; i < 11; i++)
+        {
+            Write32(stream, 0);
+        }
+
+        // pixel format
+        Write32(stream, 32);
+        Write32(stream, DDPF_FOURCC);
+        Write32(stream, dx10 ? FourCC('D', 'X', '1', '0') : format == BlockFormat::BC1 ? FourCC('D', 'X', 'T', '1') : FourCC('D', 'X', 'T', '5'));
+        for (int i = 0; i < 5; i++)
+        {
+            Write32(stream, 0);
+        }
+
+        Write32(stream, DDSCAPS_TEXTURE | (levelCount > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0));
+        for (int i = 0; i < 4; i++)
+        {
+            Write32(stream, 0);
+        }
+
+        if (dx10)
+        {
+            Write32(stream, GetDXGIFormat(format, srgb));
+            Write32(stream, DDS_DIMENSION_TEXTURE2D);
+            Write32(stream, 0);  // misc flags
+            Write32(stream, 1);  // array size
+            Write32(stream, 0);  // alpha mode
+        }
+
+        for (const EncodedLevel& level : levels)
+        {
+            stream.write(reinterpret_cast<const char*>(level.blocks.data()), static_cast<std::streamsize>(level.blocks.size()));
+        }
+        return static_cast<bool>(stream);
+    }
+}  // namespace Cooker
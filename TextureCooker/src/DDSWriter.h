@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "BlockEncoder.h"
+
+namespace Cooker
+{
+    /**
+     * \brief One mip level worth of encoded blocks
+     */
+    struct EncodedLevel
+    {
+        int width, height;
+        std::vector<unsigned char> blocks;
+    };
+
+    /**
+     * \brief Write encoded levels to a DDS file. BC7 and sRGB images get the DX10 header,
+     * BC1 and BC3 otherwise use the DXT1 and DXT5 codes older readers know
+     * \param path A string that is the path of the file to write
+     * \param format The format the levels were encoded in
+     * \param srgb Whether the colours are sRGB encoded
+     * \param levels The mip chain, base level first
+     * \return true if the file was written; false otherwise
+     */
+    bool WriteDDS(const std::string& path, BlockFormat format, bool srgb, const std::vector<EncodedLevel>& levels);
+}  // namespace Cooker
@@ -0,0 +1,227 @@
+#include "FontCooker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+// rectpack first, stb_truetype declares stand-ins for its types otherwise
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <ImGui/imstb_rectpack.h>
+
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <ImGui/imstb_truetype.h>
+
+#include "TaskGroup.h"
+#include "../../OpenGL/src/Utils/ImageWriter.h"
+
+namespace Cooker
+{
+    namespace
+    {
+        struct GlyphBitmap
+        {
+            uint32_t codepoint;
+            int glyph;
+            float advance;
+            int width, height;
+            int offsetX, offsetY;  // of the top left corner from the pen, y down
+            std::vector<unsigned char> distances;  // top row first
+            int atlasX, atlasY;    // of the bottom left corner, y up
+        };
+
+        struct KerningPair
+        {
+            uint32_t first, second;
+            float amount;
+        };
+
+        // Rows of first glyphs handed to one task when looking up kerning pairs
+        constexpr size_t KERNING_ROWS_PER_JOB = 16;
+
+        // The atlas keeps this many empty texels between glyphs so filtering never reaches a neighbor
+        constexpr int GLYPH_GAP = 1;
+    }
+
+    bool CookFont(const std::string& fontPath, const std::string& outputPath, const FontOptions& options, Utils::ThreadPool& pool,
+                  FontReport& report)
+    {
+        std::ifstream file(fontPath, std::ios::binary);
+        const std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        stbtt_fontinfo font;
+        if (data.empty() || !stbtt_InitFont(&font, data.data(), stbtt_GetFontOffsetForIndex(data.data(), 0)))
+        {
+            std::cout << "ERROR::COOKER::FONT_LOAD_FAILED " << fontPath << std::endl;
+            return false;
+        }
+
+        const float scale = stbtt_ScaleForPixelHeight(&font, options.pixelHeight);
+        const int spread = std::max(options.spread, 1);
+        int ascent = 0, descent = 0, lineGap = 0;
+        stbtt_GetFontVMetrics(&font, &ascent, &descent, &lineGap);
+
+        std::vector<GlyphBitmap> glyphs;
+        for (uint32_t codepoint = options.firstCodepoint; codepoint <= options.lastCodepoint; codepoint++)
+        {
+            const int glyph = stbtt_FindGlyphIndex(&font, static_cast<int>(codepoint));
+            if (glyph == 0)
+            {
+                continue;
+            }
+            int advance = 0, leftSideBearing = 0;
+            stbtt_GetGlyphHMetrics(&font, glyph, &advance, &leftSideBearing);
+            glyphs.push_back({ codepoint, glyph, advance * scale, 0, 0, 0, 0, {}, 0, 0 });
+        }
+
+        // every glyph is an independent distance field, the font data is only read
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point generateStart = Clock::now();
+        TaskGroup group(pool);
+        for (GlyphBitmap& glyph : glyphs)
+        {
+            GlyphBitmap* pointer = &glyph;
+            group.Run([pointer, &font, scale, spread]
+            {
+                GlyphBitmap& bitmap = *pointer;
+                unsigned char* distances = stbtt_GetGlyphSDF(&font, scale, bitmap.glyph, spread, 128, 128.0f / spread,
+                                                             &bitmap.width, &bitmap.height, &bitmap.offsetX, &bitmap.offsetY);
+                if (!distances)
+                {
+                    // nothing to draw, as for a space
+                    bitmap.width = bitmap.height = 0;
+                    return;
+                }
+                bitmap.distances.assign(distances, distances + static_cast<size_t>(bitmap.width) * bitmap.height);
+                stbtt_FreeSDF(distances, nullptr);
+            });
+        }
+
+        std::vector<std::vector<KerningPair>> kerningRows((glyphs.size() + KERNING_ROWS_PER_JOB - 1) / KERNING_ROWS_PER_JOB);
+        for (size_t job = 0; job < kerningRows.size(); job++)
+        {
+            std::vector<KerningPair>* row = &kerningRows[job];
+            group.Run([row, job, &glyphs, &font, scale]
+            {
+                const size_t last = std::min((job + 1) * KERNING_ROWS_PER_JOB, glyphs.size());
+                for (size_t first = job * KERNING_ROWS_PER_JOB; first < last; first++)
+                {
+                    for (const GlyphBitmap& second : glyphs)
+                    {
+                        const int amount = stbtt_GetGlyphKernAdvance(&font, glyphs[first].glyph, second.glyph);
+                        if (amount != 0)
+                        {
+                            row->push_back({ glyphs[first].codepoint, second.codepoint, amount * scale });
+                        }
+                    }
+                }
+            });
+        }
+        group.Wait();
+        report.generateSeconds = std::chrono::duration<double>(Clock::now() - generateStart).count();
+
+        std::vector<stbrp_rect> rects;
+        for (size_t i = 0; i < glyphs.size(); i++)
+        {
+            if (glyphs[i].width > 0)
+            {
+                stbrp_rect rect{};
+                rect.id = static_cast<int>(i);
+                rect.w = glyphs[i].width + GLYPH_GAP;
+                rect.h = glyphs[i].height + GLYPH_GAP;
+                rects.push_back(rect);
+            }
+        }
+        std::vector<stbrp_node> nodes(options.atlasSize);
+        stbrp_context context;
+        stbrp_init_target(&context, options.atlasSize, options.atlasSize, nodes.data(), static_cast<int>(nodes.size()));
+        if (!rects.empty() && !stbrp_pack_rects(&context, rects.data(), static_cast<int>(rects.size())))
+        {
+            std::cout << "ERROR::COOKER::FONT_ATLAS_FULL " << fontPath << ": the glyphs don't fit in " << options.atlasSize << "x"
+                      << options.atlasSize << std::endl;
+            return false;
+        }
+
+        // the rows above the highest glyph are cropped, the height stays a multiple of 4 for block compression
+        int atlasHeight = 4;
+        for (const stbrp_rect& rect : rects)
+        {
+            atlasHeight = std::max(atlasHeight, (rect.y + rect.h + 3) / 4 * 4);
+        }
+        atlasHeight = std::min(atlasHeight, options.atlasSize);
+
+        // white with the distance in alpha, bottom row first
+        std::vector<unsigned char> atlas(static_cast<size_t>(options.atlasSize) * atlasHeight * 4, 255);
+        for (size_t i = 3; i < atlas.size(); i += 4)
+        {
+            atlas[i] = 0;
+        }
+        for (const stbrp_rect& rect : rects)
+        {
+            GlyphBitmap& glyph = glyphs[rect.id];
+            glyph.atlasX = rect.x;
+            glyph.atlasY = rect.y;
+            for (int y = 0; y < glyph.height; y++)
+            {
+                const unsigned char* source = glyph.distances.data() + static_cast<size_t>(glyph.height - 1 - y) * glyph.width;
+                unsigned char* target = atlas.data() + (static_cast<size_t>(rect.y + y) * options.atlasSize + rect.x) * 4;
+                for (int x = 0; x < glyph.width; x++)
+                {
+                    target[x * 4 + 3] = source[x];
+                }
+            }
+        }
+
+        const std::string atlasPath = outputPath + ".png";
+        if (!Utils::ImageWriter::WritePNG(atlasPath, options.atlasSize, atlasHeight, atlas.data(), true))
+        {
+            std::cout << "ERROR::COOKER::WRITE_FAILED " << atlasPath << std::endl;
+            return false;
+        }
+
+        // metrics are in atlas pixels with y up, the quad of a glyph starts at left, bottom from the pen on the baseline
+        const std::string metricsPath = outputPath + ".json";
+        std::ofstream metrics(metricsPath);
+        metrics << "{\n"
+                << "  \"atlas\": \"" << std::filesystem::path(atlasPath).filename().string() << "\",\n"
+                << "  \"atlasWidth\": " << options.atlasSize << ",\n"
+                << "  \"atlasHeight\": " << atlasHeight << ",\n"
+                << "  \"pixelHeight\": " << options.pixelHeight << ",\n"
+                << "  \"spread\": " << spread << ",\n"
+                << "  \"ascent\": " << ascent * scale << ",\n"
+                << "  \"descent\": " << descent * scale << ",\n"
+                << "  \"lineGap\": " << lineGap * scale << ",\n"
+                << "  \"glyphs\": [\n";
+        for (size_t i = 0; i < glyphs.size(); i++)
+        {
+            const GlyphBitmap& glyph = glyphs[i];
+            metrics << "    { \"codepoint\": " << glyph.codepoint << ", \"advance\": " << glyph.advance
+                    << ", \"x\": " << glyph.atlasX << ", \"y\": " << glyph.atlasY << ", \"width\": " << glyph.width << ", \"height\": " << glyph.height
+                    << ", \"left\": " << glyph.offsetX << ", \"bottom\": " << -(glyph.offsetY + glyph.height) << " }"
+                    << (i + 1 < glyphs.size() ? ",\n" : "\n");
+        }
+        metrics << "  ],\n"
+                << "  \"kerning\": [";
+        report.kerningPairs = 0;
+        for (const std::vector<KerningPair>& row : kerningRows)
+        {
+            for (const KerningPair& pair : row)
+            {
+                metrics << (report.kerningPairs++ ? ",\n    " : "\n    ") << "[" << pair.first << ", " << pair.second << ", " << pair.amount << "]";
+            }
+        }
+        metrics << "\n  ]\n}\n";
+        if (!metrics)
+        {
+            std::cout << "ERROR::COOKER::WRITE_FAILED " << metricsPath << std::endl;
+            return false;
+        }
+
+        report.glyphCount = static_cast<unsigned int>(glyphs.size());
+        return true;
+    }
+}  // namespace Cooker
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Utils
+{
+    class ThreadPool;
+}
+
+namespace Cooker
+{
+    /**
+     * \brief How a font is turned into a signed distance field atlas
+     */
+    struct FontOptions
+    {
+        float pixelHeight = 48.0f;       // the height from the highest ascender to the lowest descender in the atlas
+        int spread = 6;                  // the pixels the distance field reaches out of each glyph
+        int atlasSize = 512;             // the width and most height of the atlas, the rows left empty are cropped
+        uint32_t firstCodepoint = 32;
+        uint32_t lastCodepoint = 126;
+    };
+
+    /**
+     * \brief What cooking a font produced
+     */
+    struct FontReport
+    {
+        unsigned int glyphCount = 0;
+        unsigned int kerningPairs = 0;
+        double generateSeconds = 0.0;    // building the distance fields, on every thread
+    };
+
+    /**
+     * \brief Build a signed distance field for every glyph of a TrueType font on the pool, pack them
+     * into one atlas and write it as outputPath.png, with the glyph metrics and kerning in pixels of
+     * the atlas as outputPath.json. The distance is stored in alpha, 128 on the outline and falling
+     * by 128 / spread per pixel outside of it
+     * \param fontPath The .ttf file
+     * \param outputPath The path of both files without the extension
+     * \param options The size and range of the atlas
+     * \param pool The workers the glyphs are built on
+     * \param report Receives what was written
+     * \return true if both files were written; false otherwise
+     */
+    bool CookFont(const std::string& fontPath, const std::string& outputPath, const FontOptions& options, Utils::ThreadPool& pool,
+                  FontReport& report);
+}  // namespace Cooker
@@ -0,0 +1,367 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stb_image/stb_image.h>
+
+#include "BlockEncoder.h"
+#include "DDSWriter.h"
+#include "FontCooker.h"
+#include "TaskGroup.h"
+#include "../../OpenGL/src/Utils/MipGenerator.h"
+#include "../../OpenGL/src/Utils/ThreadPool.h"
+
+namespace
+{
+    struct Options
+    {
+        Cooker::BlockFormat format = Cooker::BlockFormat::BC7;
+        unsigned int threadCount = 0;
+        std::string outputDirectory;
+        bool srgb = false;
+        bool mips = true;
+        Utils::MipGenerator::Options mipOptions;
+        bool font = false;
+        Cooker::FontOptions fontOptions;
+        std::vector<std::string> inputs;
+    };
+
+    struct SourceImage
+    {
+        std::string path;
+        bool loaded = false;
+        Utils::MipChain mips;  // bottom row first
+        std::vector<Cooker::EncodedLevel> encoded;
+    };
+
+    // One run of block rows of one level, the unit of work handed to the pool
+    struct EncodeJob
+    {
+        SourceImage* image;
+        int level;
+        int firstRow, rowCount;
+        double squaredError;  // of the base level only
+    };
+
+    constexpr int BLOCKS_PER_JOB = 256;
+
+    void PrintUsage()
+    {
+        std::cout << "Usage: TextureCooker [-f bc1|bc3|bc7] [-j threads] [-o directory] [--srgb] [--no-mips]\n"
+                     "                     [--box] [--alpha-coverage reference] image...\n"
+                     "       TextureCooker --font [-j threads] [-o directory] [--font-size pixels] [--spread pixels]\n"
+                     "                     [--atlas-size pixels] [--codepoints first-last] font.ttf...\n"
+                     "Encodes PNG/JPG images to block-compressed DDS files, written next to each\n"
+                     "image unless -o is given, and reports PSNR and encoder throughput. With --font,\n"
+                     "builds a signed distance field atlas of each TrueType font instead, written as\n"
+                     "a PNG and a JSON file of glyph metrics." << std::endl;
+    }
+
+    bool ParseOptions(const int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string argument = argv[i];
+            if (argument == "-f" && i + 1 < argc)
+            {
+                const std::string format = argv[++i];
+                if (format == "bc1") options.format = Cooker::BlockFormat::BC1;
+                else if (format == "bc3") options.format = Cooker::BlockFormat::BC3;
+                else if (format == "bc7") options.format = Cooker::BlockFormat::BC7;
+                else return false;
+            }
+            else if (argument == "-j" && i + 1 < argc)
+            {
+                options.threadCount = static_cast<unsigned int>(std::stoul(argv[++i]));
+            }
+            else if (argument == "-o" && i + 1 < argc)
+            {
+                options.outputDirectory = argv[++i];
+            }
+            else if (argument == "--srgb")
+            {
+                options.srgb = true;
+            }
+            else if (argument == "--no-mips")
+            {
+                options.mips = false;
+            }
+            else if (argument == "--box")
+            {
+                options.mipOptions.filter = Utils::MipGenerator::Filter::Box;
+            }
+            else if (argument == "--alpha-coverage" && i + 1 < argc)
+            {
+                options.mipOptions.alphaCoverageReference = std::stof(argv[++i]);
+            }
+            else if (argument == "--font")
+            {
+                options.font = true;
+            }
+            else if (argument == "--font-size" && i + 1 < argc)
+            {
+                options.fontOptions.pixelHeight = std::stof(argv[++i]);
+            }
+            else if (argument == "--spread" && i + 1 < argc)
+            {
+                options.fontOptions.spread = std::stoi(argv[++i]);
+            }
+            else if (argument == "--atlas-size" && i + 1 < argc)
+            {
+                options.fontOptions.atlasSize = std::stoi(argv[++i]);
+            }
+            else if (argument == "--codepoints" && i + 1 < argc)
+            {
+                const std::string range = argv[++i];
+                const size_t dash = range.find('-');
+                if (dash == std::string::npos)
+                {
+                    return false;
+                }
+                options.fontOptions.firstCodepoint = static_cast<uint32_t>(std::stoul(range.substr(0, dash), nullptr, 0));
+                options.fontOptions.lastCodepoint = static_cast<uint32_t>(std::stoul(range.substr(dash + 1), nullptr, 0));
+            }
+            else if (!argument.empty() && argument[0] == '-')
+            {
+                return false;
+            }
+            else
+            {
+                options.inputs.push_back(argument);
+            }
+        }
+        options.mipOptions.srgb = options.srgb;
+        return !options.inputs.empty();
+    }
+
+    void LoadImage(SourceImage& image, const Options& options)
+    {
+        int width = 0, height = 0, channels = 0;
+        // bottom row first, the order the engine uploads in
+        stbi_set_flip_vertically_on_load_thread(1);
+        unsigned char* pixels = stbi_load(image.path.c_str(), &width, &height, &channels, 4);
+        if (!pixels)
+        {
+            std::cout << "ERROR::COOKER::LOAD_FAILED " << image.path << ": " << stbi_failure_reason() << std::endl;
+            return;
+        }
+
+        if (options.mips)
+        {
+            image.mips = Utils::MipGenerator::Generate(width, height, pixels, options.mipOptions);
+        }
+        else
+        {
+            image.mips.levels.push_back({ width, height, 0 });
+            image.mips.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+        }
+        stbi_image_free(pixels);
+
+        image.loaded = true;
+    }
+
+    void EncodeRows(EncodeJob& job, const Cooker::BlockFormat format)
+    {
+        const SourceImage& image = *job.image;
+        const unsigned char* pixels = image.mips.pixels.data() + image.mips.levels[job.level].offset;
+        const int width = image.mips.levels[job.level].width, height = image.mips.levels[job.level].height;
+        const int blocksX = (width + 3) / 4;
+        const size_t blockSize = Cooker::GetBlockSize(format);
+        const int channels = format == Cooker::BlockFormat::BC1 ? 3 : 4;
+        unsigned char* output = job.image->encoded[job.level].blocks.data();
+
+        unsigned char texels[64], decoded[64];
+        for (int blockY = job.firstRow; blockY < job.firstRow + job.rowCount; blockY++)
+        {
+            for (int blockX = 0; blockX < blocksX; blockX++)
+            {
+                // partial blocks at the edges repeat the last texel
+                for (int y = 0; y < 4; y++)
+                {
+                    const int sourceY = std::min(blockY * 4 + y, height - 1);
+                    for (int x = 0; x < 4; x++)
+                    {
+                        const int sourceX = std::min(blockX * 4 + x, width - 1);
+                        std::memcpy(texels + (y * 4 + x) * 4, pixels + (static_cast<size_t>(sourceY) * width + sourceX) * 4, 4);
+                    }
+                }
+
+                unsigned char* block = output + (static_cast<size_t>(blockY) * blocksX + blockX) * blockSize;
+                Cooker::EncodeBlock(format, texels, block);
+
+                if (job.level == 0)
+                {
+                    Cooker::DecodeBlock(format, block, decoded);
+                    for (int i = 0; i < 16; i++)
+                    {
+                        for (int c = 0; c < channels; c++)
+                        {
+                            const double difference = static_cast<double>(texels[i * 4 + c]) - decoded[i * 4 + c];
+                            job.squaredError += difference * difference;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    double ToPSNR(const double squaredError, const double samples)
+    {
+        if (squaredError <= 0.0)
+        {
+            return INFINITY;
+        }
+        return 10.0 * std::log10(255.0 * 255.0 / (squaredError / samples));
+    }
+
+    std::string GetOutputPath(const Options& options, const std::string& input, const char* extension = ".dds")
+    {
+        std::filesystem::path output = input;
+        output.replace_extension(extension);
+        if (!options.outputDirectory.empty())
+        {
+            output = std::filesystem::path(options.outputDirectory) / output.filename();
+        }
+        return output.string();
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+    if (!options.outputDirectory.empty())
+    {
+        std::filesystem::create_directories(options.outputDirectory);
+    }
+
+    const unsigned int threadCount = options.threadCount ? options.threadCount : std::max(1u, std::thread::hardware_concurrency());
+    Utils::ThreadPool pool(threadCount);
+    if (options.font)
+    {
+        int failures = 0;
+        for (const std::string& input : options.inputs)
+        {
+            const std::string output = GetOutputPath(options, input, "");
+            Cooker::FontReport report;
+            if (!Cooker::CookFont(input, output, options.fontOptions, pool, report))
+            {
+                failures++;
+                continue;
+            }
+            std::cout << input << " -> " << output << ".png/.json: " << report.glyphCount << " glyphs, " << report.kerningPairs
+                      << " kerning pairs, distance fields built in " << report.generateSeconds << " s on " << threadCount << " threads" << std::endl;
+        }
+        return failures == 0 ? 0 : 1;
+    }
+
+    const int channels = options.format == Cooker::BlockFormat::BC1 ? 3 : 4;
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    double encodeSeconds = 0.0;
+    size_t totalBlocks = 0;
+    double totalSquaredError = 0.0, totalSamples = 0.0;
+    int failures = 0;
+
+    // images are cooked in batches so thousands of inputs don't all sit in memory at once
+    const size_t batchSize = static_cast<size_t>(threadCount) * 2;
+    for (size_t first = 0; first < options.inputs.size(); first += batchSize)
+    {
+        std::vector<SourceImage> batch(std::min(batchSize, options.inputs.size() - first));
+        Cooker::TaskGroup group(pool);
+
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            batch[i].path = options.inputs[first + i];
+            SourceImage* image = &batch[i];
+            group.Run([image, &options] { LoadImage(*image, options); });
+        }
+        group.Wait();
+
+        // every image is split into runs of block rows so one large texture still spreads over all cores
+        std::vector<EncodeJob> jobs;
+        for (SourceImage& image : batch)
+        {
+            if (!image.loaded)
+            {
+                continue;
+            }
+            for (int level = 0; level < static_cast<int>(image.mips.levels.size()); level++)
+            {
+                const Utils::MipChain::Level& mip = image.mips.levels[level];
+                const int blocksX = (mip.width + 3) / 4, blocksY = (mip.height + 3) / 4;
+                image.encoded.push_back({ mip.width, mip.height,
+                                          std::vector<unsigned char>(static_cast<size_t>(blocksX) * blocksY * Cooker::GetBlockSize(options.format)) });
+                totalBlocks += static_cast<size_t>(blocksX) * blocksY;
+
+                const int rowsPerJob = std::max(1, BLOCKS_PER_JOB / blocksX);
+                for (int row = 0; row < blocksY; row += rowsPerJob)
+                {
+                    jobs.push_back({ &image, level, row, std::min(rowsPerJob, blocksY - row), 0.0 });
+                }
+            }
+        }
+
+        const Clock::time_point encodeStart = Clock::now();
+        for (EncodeJob& job : jobs)
+        {
+            EncodeJob* pointer = &job;
+            group.Run([pointer, &options] { EncodeRows(*pointer, options.format); });
+        }
+        group.Wait();
+        encodeSeconds += std::chrono::duration<double>(Clock::now() - encodeStart).count();
+
+        for (SourceImage& image : batch)
+        {
+            if (!image.loaded)
+            {
+                failures++;
+                continue;
+            }
+
+            double squaredError = 0.0;
+            for (const EncodeJob& job : jobs)
+            {
+                if (job.image == &image)
+                {
+                    squaredError += job.squaredError;
+                }
+            }
+            // edge blocks count their repeated texels, the padding is small enough to ignore
+            const int width = image.mips.levels[0].width, height = image.mips.levels[0].height;
+            const double samples = static_cast<double>((width + 3) / 4 * 4) * ((height + 3) / 4 * 4) * channels;
+            totalSquaredError += squaredError;
+            totalSamples += samples;
+
+            const std::string output = GetOutputPath(options, image.path);
+            if (!Cooker::WriteDDS(output, options.format, options.srgb, image.encoded))
+            {
+                std::cout << "ERROR::COOKER::WRITE_FAILED " << output << std::endl;
+                failures++;
+                continue;
+            }
+
+            std::cout << image.path << " -> " << output << ": " << width << "x" << height << ", "
+                      << image.mips.levels.size() << " levels, PSNR " << ToPSNR(squaredError, samples) << " dB" << std::endl;
+        }
+    }
+
+    const double totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << "\nEncoded " << totalBlocks << " blocks in " << encodeSeconds << " s ("
+              << (encodeSeconds > 0.0 ? totalBlocks / encodeSeconds : 0.0) << " blocks/s) on " << threadCount << " threads, "
+              << (Cooker::IsSIMDEnabled() ? "SSE2" : "scalar") << " search\n"
+              << "Overall PSNR " << ToPSNR(totalSquaredError, totalSamples) << " dB, " << totalSeconds << " s including I/O" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
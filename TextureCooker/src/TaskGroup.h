@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+#include "../../OpenGL/src/Utils/ThreadPool.h"
+
+namespace Cooker
+{
+    /**
+     * \brief Runs tasks on a pool and waits for all of them, the pool itself has no way to join
+     */
+    class TaskGroup
+    {
+    private:
+        Utils::ThreadPool& m_Pool;
+        std::mutex m_Mutex;
+        std::condition_variable m_Finished;
+        unsigned int m_Pending;
+
+    public:
+        explicit TaskGroup(Utils::ThreadPool& pool) : m_Pool(pool), m_Pending(0) {}
+
+        /**
+         * \brief Run a task on the pool
+         * \param task The task
+         */
+        void Run(std::function<void()> task)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Pending++;
+            }
+            m_Pool.Enqueue([this, task = std::move(task)]
+            {
+                task();
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Pending--;
+                m_Finished.notify_all();
+            });
+        }
+
+        /**
+         * \brief Wait for every task run so far to finish
+         */
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Finished.wait(lock, [this] { return m_Pending == 0; });
+        }
+    };  // class TaskGroup
+}  // namespace Cooker